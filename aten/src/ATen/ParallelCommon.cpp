@@ -74,6 +74,8 @@ std::string get_parallel_info() {
   ss << "ATen parallel backend: ";
   #if AT_PARALLEL_OPENMP
   ss << "OpenMP";
+  #elif AT_PARALLEL_NATIVE_WS
+  ss << "native thread pool with work stealing";
   #elif AT_PARALLEL_NATIVE
   ss << "native thread pool";
   #elif AT_PARALLEL_NATIVE_TBB
@@ -84,6 +86,18 @@ std::string get_parallel_info() {
   #endif
   ss << std::endl;
 
+  #if AT_PARALLEL_NATIVE
+  if (internal::parallel_region_stats_enabled()) {
+    auto stats = internal::get_parallel_region_stats();
+    ss << "Parallel regions: " << stats.regions
+       << " (nested: " << stats.nested_regions
+       << ", nested run inline: " << stats.serialized_nested_regions
+       << "), threads per region: "
+       << (stats.regions > 0 ? (double)stats.threads_used / stats.regions : 0.0)
+       << std::endl;
+  }
+  #endif
+
   #if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
   ss << "Experimental: single thread pool" << std::endl;
   #endif
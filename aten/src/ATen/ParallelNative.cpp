@@ -10,6 +10,10 @@
 #endif // C10_MOBILE
 
 #include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -36,10 +40,6 @@ void _set_thread_num(size_t thread_num) {
   thread_num_ = thread_num;
 }
 
-void _unset_thread_num() {
-  thread_num_ = 0;
-}
-
 #ifndef C10_MOBILE
 
 const int NOT_SET = -1;
@@ -75,6 +75,87 @@ TaskThreadPoolBase& _get_intraop_pool() {
   return *pool;
 }
 
+// Whether regions started from inside another parallel region may use idle
+// intra-op threads, see set_nested_parallelism_enabled(). Only changed before
+// the pool is initialized, so it is constant while regions run.
+std::atomic<bool> nested_enabled{false};
+
+// Thread numbers of the intra-op pool threads claimed by running parallel
+// regions, only tracked with nested parallelism enabled. 0 is the thread that
+// starts a top-level region and 1..pool size are its helpers. Top-level
+// regions always claim 1..num_tasks-1 (these are counts, since regions
+// started from several inter-op threads share them, as before); nested
+// regions only claim numbers that are not claimed yet, so they never add work
+// to a pool that is already saturated nor reuse the number of a running task.
+struct HelperIds {
+  explicit HelperIds(size_t pool_size)
+    : claims(pool_size + 1, 0), num_free(pool_size) {}
+
+  std::mutex mutex;
+  std::vector<int64_t> claims;
+  std::atomic<int64_t> num_free;
+};
+
+HelperIds& _helper_ids() {
+  static HelperIds ids(_get_intraop_pool().size());
+  return ids;
+}
+
+// Claims thread numbers 1..num_helpers for a top-level region.
+void _claim_helpers(size_t num_helpers) {
+  HelperIds& ids = _helper_ids();
+  std::lock_guard<std::mutex> lk(ids.mutex);
+  for (size_t id = 1; id <= num_helpers; ++id) {
+    if (ids.claims[id]++ == 0) {
+      ids.num_free--;
+    }
+  }
+}
+
+// Claims up to `wanted` unclaimed thread numbers for a nested region and
+// returns them.
+std::vector<size_t> _claim_idle_helpers(size_t wanted) {
+  std::vector<size_t> claimed;
+  if (!nested_enabled.load(std::memory_order_relaxed)) {
+    return claimed;
+  }
+  HelperIds& ids = _helper_ids();
+  if (ids.num_free.load() <= 0) {
+    return claimed;
+  }
+  std::lock_guard<std::mutex> lk(ids.mutex);
+  for (size_t id = 1; id < ids.claims.size() && claimed.size() < wanted; ++id) {
+    if (ids.claims[id] == 0) {
+      ids.claims[id] = 1;
+      ids.num_free--;
+      claimed.push_back(id);
+    }
+  }
+  return claimed;
+}
+
+void _release_helper(size_t id) {
+  HelperIds& ids = _helper_ids();
+  std::lock_guard<std::mutex> lk(ids.mutex);
+  if (--ids.claims[id] == 0) {
+    ids.num_free++;
+  }
+}
+
+// Counting regions writes to counters shared by all threads, so it is only
+// done once it has been enabled with set_parallel_region_stats_enabled().
+std::atomic<bool> stats_enabled{false};
+std::atomic<int64_t> stat_regions{0};
+std::atomic<int64_t> stat_nested_regions{0};
+std::atomic<int64_t> stat_serialized_nested_regions{0};
+std::atomic<int64_t> stat_threads_used{0};
+
+void _add_to_stat(std::atomic<int64_t>& stat, int64_t value) {
+  if (stats_enabled.load(std::memory_order_relaxed)) {
+    stat.fetch_add(value, std::memory_order_relaxed);
+  }
+}
+
 #endif // C10_MOBILE
 
 // Run lambda function `fn` over `task_id` in [0, `range`) with threadpool.
@@ -100,18 +181,210 @@ void _run_with_pool(const std::function<void(int, size_t)>& fn, size_t range) {
 }
 
 // RAII guard helps to support in_parallel_region() and get_thread_num() API.
+// The previous state is restored on exit, since a nested region may run on a
+// thread that is itself executing a chunk of an outer region.
 struct ParallelRegionGuard {
-  ParallelRegionGuard(int64_t task_id) {
+  ParallelRegionGuard(int64_t task_id)
+    : prev_thread_num_(thread_num_),
+      prev_in_parallel_region_(in_parallel_region_) {
     _set_thread_num(task_id);
     _set_in_parallel_region(true);
   }
 
   ~ParallelRegionGuard() {
-    _set_in_parallel_region(false);
-    _unset_thread_num();
+    _set_in_parallel_region(prev_in_parallel_region_);
+    _set_thread_num(prev_thread_num_);
   }
+
+ private:
+  size_t prev_thread_num_;
+  bool prev_in_parallel_region_;
 };
 
+#ifndef C10_MOBILE
+
+// Work-stealing scheduling of a single _parallel_run call. Used for every
+// region with ATEN_THREADING=NATIVE_WS and for nested regions otherwise,
+// because it does not need all helpers to run: whatever they do not pick up
+// is processed by the calling thread.
+//
+// Every participating thread owns a deque of ranges. The owner pops ranges
+// from the back, keeps splitting them in halves down to the leaf size and
+// pushes the upper halves back, so the front of each deque always holds the
+// largest remaining ranges; idle participants steal from there. Helpers are
+// plain tasks on the intra-op pool, which makes a late helper (e.g. one
+// scheduled after all work is done) cost nothing more than a slot lookup.
+
+// Upper bound on the number of leaf chunks per participant. Smaller leaves
+// balance skewed work better at the cost of more queue operations.
+constexpr int64_t kWorkStealingSplitFactor = 8;
+
+struct WorkRange {
+  int64_t begin;
+  int64_t end;
+};
+
+struct WorkQueue {
+  void push_back(WorkRange range) {
+    std::lock_guard<std::mutex> lk(mutex);
+    ranges.push_back(range);
+  }
+
+  bool pop_back(WorkRange& range) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (ranges.empty()) {
+      return false;
+    }
+    range = ranges.back();
+    ranges.pop_back();
+    return true;
+  }
+
+  bool steal_front(WorkRange& range) {
+    std::lock_guard<std::mutex> lk(mutex);
+    if (ranges.empty()) {
+      return false;
+    }
+    range = ranges.front();
+    ranges.pop_front();
+    return true;
+  }
+
+  std::mutex mutex;
+  std::deque<WorkRange> ranges;
+};
+
+struct WorkStealingJob {
+  WorkStealingJob(
+      const std::function<void(int64_t, int64_t, size_t)>& f,
+      std::vector<size_t> thread_nums,
+      bool release_helpers,
+      int64_t leaf_size,
+      int64_t total)
+    : f(f),
+      thread_nums(std::move(thread_nums)),
+      num_slots(this->thread_nums.size()),
+      release_helpers(release_helpers),
+      leaf_size(leaf_size),
+      queues(new WorkQueue[num_slots]),
+      remaining(total) {}
+
+  // Only invoked on ranges accounted for in `remaining`; the caller does not
+  // return (and destroy `f`) before `remaining` drops to zero.
+  const std::function<void(int64_t, int64_t, size_t)>& f;
+  // get_thread_num() of the participant in each slot; slot 0 is the caller.
+  const std::vector<size_t> thread_nums;
+  const size_t num_slots;
+  // Whether helpers release their thread number once they are done.
+  const bool release_helpers;
+  const int64_t leaf_size;
+  std::unique_ptr<WorkQueue[]> queues;
+  std::atomic<size_t> next_slot{0};
+  std::atomic<int64_t> remaining;
+  // Number of participants that processed at least one range.
+  std::atomic<int64_t> active_participants{0};
+
+  std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+  std::atomic<bool> failed{false};
+  std::exception_ptr eptr;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+bool _steal(WorkStealingJob& job, size_t slot, WorkRange& range) {
+  for (size_t i = 1; i < job.num_slots; ++i) {
+    if (job.queues[(slot + i) % job.num_slots].steal_front(range)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Processes ranges of `job` as participant `slot` until there is nothing
+// left to pop or steal.
+void _work_stealing_loop(WorkStealingJob& job, size_t slot) {
+  WorkQueue& own = job.queues[slot];
+  const size_t thread_num = job.thread_nums[slot];
+  WorkRange range;
+  bool active = false;
+  while (own.pop_back(range) || _steal(job, slot, range)) {
+    if (!active) {
+      active = true;
+      job.active_participants++;
+    }
+    while (range.end - range.begin > job.leaf_size) {
+      int64_t mid = range.begin + (range.end - range.begin) / 2;
+      own.push_back({mid, range.end});
+      range.end = mid;
+    }
+    try {
+      // Once a chunk failed the remaining ones are only accounted for.
+      if (!job.failed.load(std::memory_order_relaxed)) {
+        ParallelRegionGuard guard(thread_num);
+        job.f(range.begin, range.end, thread_num);
+      }
+    } catch (...) {
+      if (!job.err_flag.test_and_set()) {
+        job.eptr = std::current_exception();
+      }
+      job.failed = true;
+    }
+    int64_t size = range.end - range.begin;
+    if (job.remaining.fetch_sub(size) == size) {
+      std::unique_lock<std::mutex> lk(job.mutex);
+      job.cv.notify_all();
+    }
+  }
+}
+
+// Runs `f` over [begin, end) with the calling thread and a task on the
+// intra-op pool for every other entry of `thread_nums`, which holds the
+// get_thread_num() of each participant, the caller first. With
+// `release_helpers`, the helpers' numbers must have been claimed and are
+// released as the tasks finish. Returns the number of threads that processed
+// work.
+int64_t _parallel_run_work_stealing(
+    const int64_t begin,
+    const int64_t end,
+    std::vector<size_t> thread_nums,
+    const bool release_helpers,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t, size_t)>& f) {
+  const size_t num_slots = thread_nums.size();
+  int64_t leaf_size = std::max(
+      std::max(grain_size, (int64_t)1),
+      divup(end - begin, num_slots * kWorkStealingSplitFactor));
+  auto job = std::make_shared<WorkStealingJob>(
+      f, std::move(thread_nums), release_helpers, leaf_size, end - begin);
+
+  size_t caller_slot = job->next_slot++;
+  job->queues[caller_slot].push_back({begin, end});
+  for (size_t i = 1; i < num_slots; ++i) {
+    _get_intraop_pool().run([job]() {
+      size_t slot = job->next_slot++;
+      if (slot < job->num_slots) {
+        _work_stealing_loop(*job, slot);
+        if (job->release_helpers) {
+          _release_helper(job->thread_nums[slot]);
+        }
+      }
+    });
+  }
+  _work_stealing_loop(*job, caller_slot);
+
+  // Wait for chunks still being processed by helpers.
+  {
+    std::unique_lock<std::mutex> lk(job->mutex);
+    job->cv.wait(lk, [&job]() { return job->remaining.load() == 0; });
+  }
+  if (job->eptr) {
+    std::rethrow_exception(job->eptr);
+  }
+  return job->active_participants.load();
+}
+
+#endif // C10_MOBILE
+
 } // namespace
 
 namespace internal {
@@ -127,12 +400,52 @@ void _parallel_run(
   std::tie(num_tasks, chunk_size) =
       internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
 
+#ifndef C10_MOBILE
+  _add_to_stat(stat_regions, 1);
+  if (in_parallel_region()) {
+    _add_to_stat(stat_nested_regions, 1);
+    // The caller keeps its own thread number; the helpers get numbers that
+    // no running task uses.
+    std::vector<size_t> thread_nums(1, thread_num_);
+    std::vector<size_t> helpers = _claim_idle_helpers(num_tasks - 1);
+    if (helpers.empty()) {
+      _add_to_stat(stat_serialized_nested_regions, 1);
+      _add_to_stat(stat_threads_used, 1);
+      f(begin, end, thread_num_);
+      return;
+    }
+    thread_nums.insert(thread_nums.end(), helpers.begin(), helpers.end());
+    _add_to_stat(
+        stat_threads_used,
+        _parallel_run_work_stealing(
+            begin, end, std::move(thread_nums), true, grain_size, f));
+    return;
+  }
+  // Top-level regions only pay for claiming their helpers when nested
+  // regions may need to know which pool threads are busy.
+  const bool release_helpers = nested_enabled.load();
+  if (release_helpers) {
+    _claim_helpers(num_tasks - 1);
+  }
+#endif // C10_MOBILE
+
+#if AT_PARALLEL_NATIVE_WS && !defined(C10_MOBILE)
+  std::vector<size_t> thread_nums(num_tasks);
+  for (size_t i = 0; i < num_tasks; ++i) {
+    thread_nums[i] = i;
+  }
+  _add_to_stat(
+      stat_threads_used,
+      _parallel_run_work_stealing(
+          begin, end, std::move(thread_nums), release_helpers, grain_size, f));
+#else
   struct {
     std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
     std::exception_ptr eptr;
     std::mutex mutex;
     volatile size_t remaining;
     std::condition_variable cv;
+    bool release_helpers = false;
   } state;
 
   auto task = [f, &state, begin, end, chunk_size]
@@ -149,6 +462,11 @@ void _parallel_run(
         }
       }
     }
+#ifndef C10_MOBILE
+    if (task_id != 0 && state.release_helpers) {
+      _release_helper(task_id);
+    }
+#endif // C10_MOBILE
     {
       std::unique_lock<std::mutex> lk(state.mutex);
       if (--state.remaining == 0) {
@@ -157,6 +475,10 @@ void _parallel_run(
     }
   };
   state.remaining = num_tasks;
+#ifndef C10_MOBILE
+  state.release_helpers = release_helpers;
+  _add_to_stat(stat_threads_used, num_tasks);
+#endif // C10_MOBILE
   _run_with_pool(task, num_tasks);
 
   // Wait for all tasks to finish.
@@ -169,6 +491,73 @@ void _parallel_run(
   if (state.eptr) {
     std::rethrow_exception(state.eptr);
   }
+#endif // AT_PARALLEL_NATIVE_WS && !defined(C10_MOBILE)
+}
+
+bool _can_parallelize_nested() {
+#ifndef C10_MOBILE
+  return nested_enabled.load(std::memory_order_relaxed) &&
+      num_intraop_threads.load() == CONSUMED &&
+      _helper_ids().num_free.load() > 0;
+#else
+  return false;
+#endif // C10_MOBILE
+}
+
+void set_nested_parallelism_enabled(bool enabled) {
+#ifndef C10_MOBILE
+  if (num_intraop_threads.load() == CONSUMED) {
+    if (enabled != nested_enabled.load()) {
+      TORCH_WARN(
+        "Cannot enable or disable nested parallelism "
+        "after parallel work has started when using native parallel backend");
+    }
+    return;
+  }
+  nested_enabled = enabled;
+#endif // C10_MOBILE
+}
+
+bool nested_parallelism_enabled() {
+#ifndef C10_MOBILE
+  return nested_enabled.load();
+#else
+  return false;
+#endif // C10_MOBILE
+}
+
+ParallelRegionStats get_parallel_region_stats() {
+  ParallelRegionStats stats;
+#ifndef C10_MOBILE
+  stats.regions = stat_regions.load();
+  stats.nested_regions = stat_nested_regions.load();
+  stats.serialized_nested_regions = stat_serialized_nested_regions.load();
+  stats.threads_used = stat_threads_used.load();
+#endif // C10_MOBILE
+  return stats;
+}
+
+void set_parallel_region_stats_enabled(bool enabled) {
+#ifndef C10_MOBILE
+  stats_enabled = enabled;
+#endif // C10_MOBILE
+}
+
+bool parallel_region_stats_enabled() {
+#ifndef C10_MOBILE
+  return stats_enabled.load();
+#else
+  return false;
+#endif // C10_MOBILE
+}
+
+void reset_parallel_region_stats() {
+#ifndef C10_MOBILE
+  stat_regions = 0;
+  stat_nested_regions = 0;
+  stat_serialized_nested_regions = 0;
+  stat_threads_used = 0;
+#endif // C10_MOBILE
 }
 
 } // namespace internal
@@ -22,12 +22,51 @@ inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
   return std::make_tuple(num_tasks, chunk_size);
 }
 
+// parallel_reduce splits its range into about this many chunks per task of
+// the equivalent parallel_for, so that threads that are done with their own
+// chunks have some left to steal when the work is skewed.
+constexpr int64_t kReduceChunksPerTask = 8;
+
 CAFFE2_API void _parallel_run(
   const int64_t begin,
   const int64_t end,
   const int64_t grain_size,
   const std::function<void(int64_t, int64_t, size_t)>& f);
 
+// Returns whether a parallel region started from inside another one could
+// currently be spread over idle intra-op threads. If not, the nested region
+// runs inline on the calling thread.
+CAFFE2_API bool _can_parallelize_nested();
+
+// Spreading nested regions over idle intra-op threads is off by default, as
+// it makes every parallel region keep track of the threads it uses. It can
+// only be changed before any parallel work has started. Threads that join a
+// nested region get thread numbers that no running task uses.
+CAFFE2_API void set_nested_parallelism_enabled(bool enabled);
+CAFFE2_API bool nested_parallelism_enabled();
+
+// Statistics about the parallel regions run by the native backend while
+// collecting them was enabled, since the last reset. threads_used / regions
+// is the average number of threads that actually processed work per region.
+struct ParallelRegionStats {
+  // COUNT: regions handed to the scheduler
+  int64_t regions = 0;
+  // COUNT: regions started from inside another parallel region
+  int64_t nested_regions = 0;
+  // COUNT: nested regions that found no idle thread and ran inline
+  int64_t serialized_nested_regions = 0;
+  // SUM: threads that processed at least one chunk, over all regions
+  int64_t threads_used = 0;
+};
+
+CAFFE2_API ParallelRegionStats get_parallel_region_stats();
+CAFFE2_API void reset_parallel_region_stats();
+
+// Collecting the statistics is off by default, as it makes every parallel
+// region update counters shared by all threads.
+CAFFE2_API void set_parallel_region_stats_enabled(bool enabled);
+CAFFE2_API bool parallel_region_stats_enabled();
+
 } // namespace internal
 
 template <class F>
@@ -40,7 +79,8 @@ inline void parallel_for(
   if (begin >= end) {
     return;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && !internal::_can_parallelize_nested())) {
     f(begin, end);
     return;
   }
@@ -66,20 +106,34 @@ inline scalar_t parallel_reduce(
   if (begin >= end) {
     return ident;
   }
-  if ((end - begin) < grain_size || in_parallel_region()) {
+  if ((end - begin) < grain_size ||
+      (in_parallel_region() && !internal::_can_parallelize_nested())) {
     return f(begin, end, ident);
   }
-  size_t num_tasks, chunk_size;
-  std::tie(num_tasks, chunk_size) =
-      internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
-  std::vector<scalar_t> results(num_tasks);
+  const int64_t num_tasks = std::get<0>(
+      internal::calc_num_tasks_and_chunk_size(begin, end, grain_size));
+  // The scheduler may hand a thread several non-adjacent ranges, so results
+  // are kept per chunk rather than per thread, and combined in chunk order:
+  // `sf` need not be commutative. The chunks are scheduled like the indices
+  // of a parallel_for, which lets idle threads steal and split the ranges of
+  // chunks that are still pending.
+  const int64_t chunk_size = std::max(
+      std::max(grain_size, (int64_t)1),
+      divup(end - begin, num_tasks * internal::kReduceChunksPerTask));
+  const int64_t num_chunks = divup(end - begin, chunk_size);
+  std::vector<scalar_t> results(num_chunks, ident);
   scalar_t* results_data = results.data();
   internal::_parallel_run(
-      begin,
-      end,
-      grain_size,
-      [f, ident, results_data](int64_t start, int64_t end, size_t task_id) {
-        results_data[task_id] = f(start, end, ident);
+      0,
+      num_chunks,
+      1,
+      [f, ident, results_data, begin, end, chunk_size](
+          int64_t first_chunk, int64_t last_chunk, size_t /* unused */) {
+        for (int64_t chunk = first_chunk; chunk < last_chunk; ++chunk) {
+          int64_t chunk_begin = begin + chunk * chunk_size;
+          int64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+          results_data[chunk] = f(chunk_begin, chunk_end, ident);
+        }
       }
   );
   scalar_t result = ident;
@@ -7,6 +7,12 @@
 
 namespace at { namespace vec256 {
 
+// The BFloat16 overloads of the helpers below live in functional_bfloat16.h
+// and hand Vec256<float> to the lambdas, see [Note BFloat16 arithmetic in fp32].
+template <typename scalar_t>
+using enable_if_not_bfloat16_t =
+    typename std::enable_if<!std::is_same<scalar_t, BFloat16>::value, int>::type;
+
 // TODO: Make this more efficient
 template <typename scalar_t, typename Op>
 inline scalar_t vec_reduce_all(
@@ -26,7 +32,7 @@ inline scalar_t vec_reduce_all(
   return acc_arr[0];
 }
 
-template <typename scalar_t, typename Op>
+template <typename scalar_t, typename Op, enable_if_not_bfloat16_t<scalar_t> = 0>
 inline scalar_t reduce_all(const Op& vec_fun, scalar_t* data, int64_t size) {
   using Vec = vec256::Vec256<scalar_t>;
   if (size < Vec::size())
@@ -44,7 +50,7 @@ inline scalar_t reduce_all(const Op& vec_fun, scalar_t* data, int64_t size) {
   return vec_reduce_all(vec_fun, acc_vec, Vec::size());
 }
 
-template <typename scalar_t, typename MapOp, typename ReduceOp>
+template <typename scalar_t, typename MapOp, typename ReduceOp, enable_if_not_bfloat16_t<scalar_t> = 0>
 inline scalar_t map_reduce_all(
     const MapOp& map_fun,
     const ReduceOp& red_fun,
@@ -68,7 +74,7 @@ inline scalar_t map_reduce_all(
   return vec_reduce_all(red_fun, acc_vec, Vec::size());
 }
 
-template <typename scalar_t, typename MapOp, typename ReduceOp>
+template <typename scalar_t, typename MapOp, typename ReduceOp, enable_if_not_bfloat16_t<scalar_t> = 0>
 inline scalar_t map2_reduce_all(
     const MapOp& map_fun,
     const ReduceOp& red_fun,
@@ -99,7 +105,7 @@ inline scalar_t map2_reduce_all(
   return vec_reduce_all(red_fun, acc_vec, Vec::size());
 }
 
-template <typename scalar_t, typename Op>
+template <typename scalar_t, typename Op, enable_if_not_bfloat16_t<scalar_t> = 0>
 inline void map(
     const Op& vec_fun,
     scalar_t* output_data,
@@ -117,7 +123,7 @@ inline void map(
   }
 }
 
-template <typename scalar_t, typename Op>
+template <typename scalar_t, typename Op, enable_if_not_bfloat16_t<scalar_t> = 0>
 inline void map2(
     const Op& vec_fun,
     scalar_t* output_data,
@@ -141,3 +147,5 @@ inline void map2(
 }
 
 }} // namespace at::vec256
+
+#include <ATen/cpu/vec256/functional_bfloat16.h>
@@ -0,0 +1,295 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <ATen/cpu/vec256/functional.h>
+
+#include <tuple>
+
+namespace at { namespace vec256 {
+
+// BFloat16 versions of the helpers in functional.h. The data is loaded as
+// bfloat16, widened once to two Vec256<float> halves, and the lambdas are
+// called on Vec256<float>. Reductions accumulate and return float; maps round
+// to bfloat16 once when storing. See [Note BFloat16 arithmetic in fp32].
+
+template <typename scalar_t>
+using enable_if_bfloat16_t =
+    typename std::enable_if<std::is_same<scalar_t, BFloat16>::value, int>::type;
+
+// The type a kernel should do its vectorized arithmetic in, e.g.
+//   using Vec = Vec256<vec_scalar_t<scalar_t>>;
+// lets the same lambdas be used with the helpers for every floating type.
+template <typename scalar_t>
+struct VecScalarType {
+  using type = scalar_t;
+};
+
+template <>
+struct VecScalarType<BFloat16> {
+  using type = float;
+};
+
+template <typename scalar_t>
+using vec_scalar_t = typename VecScalarType<scalar_t>::type;
+
+template <typename scalar_t, typename Op, enable_if_bfloat16_t<scalar_t> = 0>
+inline float reduce_all(const Op& vec_fun, const scalar_t* data, int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_vec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_vec);
+    if (size > fVec::size()) {
+      data_fvec0 = fVec::set(data_fvec0, vec_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(vec_fun, data_fvec0, fVec::size());
+    } else {
+      return vec_reduce_all<float>(vec_fun, data_fvec0, size);
+    }
+  }
+  int64_t d = bVec::size();
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(bVec::loadu(data));
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d));
+    acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = vec_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d, size - d));
+    if (size - d > fVec::size()) {
+      acc_fvec0 = vec_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, vec_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      acc_fvec0 = fVec::set(acc_fvec0, vec_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = vec_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(vec_fun, acc_fvec0, fVec::size());
+}
+
+template <typename scalar_t, typename MapOp, typename ReduceOp, enable_if_bfloat16_t<scalar_t> = 0>
+inline float map_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    const scalar_t* data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    bVec data_vec = bVec::loadu(data, size);
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(data_vec);
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0);
+      data_fvec1 = map_fun(data_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0);
+      return vec_reduce_all<float>(red_fun, data_fvec0, size);
+    }
+  }
+  int64_t d = bVec::size();
+  fVec acc_fvec0, acc_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(bVec::loadu(data));
+  acc_fvec0 = map_fun(acc_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d));
+    data_fvec0 = map_fun(data_fvec0);
+    data_fvec1 = map_fun(data_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d, size - d));
+    if (size - d > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0);
+      data_fvec1 = map_fun(data_fvec1);
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0);
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename scalar_t, typename MapOp, typename ReduceOp, enable_if_bfloat16_t<scalar_t> = 0>
+inline float map2_reduce_all(
+    const MapOp& map_fun,
+    const ReduceOp& red_fun,
+    const scalar_t* data,
+    const scalar_t* data2,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  if (size < bVec::size()) {
+    fVec data_fvec0, data_fvec1, data2_fvec0, data2_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data, size));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(data2, size));
+    if (size > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+      data_fvec0 = fVec::set(data_fvec0, red_fun(data_fvec0, data_fvec1), size - fVec::size());
+      return vec_reduce_all<float>(red_fun, data_fvec0, fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      return vec_reduce_all<float>(red_fun, data_fvec0, size);
+    }
+  }
+  int64_t d = bVec::size();
+  fVec acc_fvec0, acc_fvec1, data2_fvec0, data2_fvec1;
+  std::tie(acc_fvec0, acc_fvec1) = convert_bfloat16_float(bVec::loadu(data));
+  std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(data2));
+  acc_fvec0 = map_fun(acc_fvec0, data2_fvec0);
+  acc_fvec1 = map_fun(acc_fvec1, data2_fvec1);
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(data2 + d));
+    data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+    data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+    acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+    acc_fvec1 = red_fun(acc_fvec1, data_fvec1);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(data + d, size - d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(data2 + d, size - d));
+    if (size - d > fVec::size()) {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      data_fvec1 = map_fun(data_fvec1, data2_fvec1);
+      acc_fvec0 = red_fun(acc_fvec0, data_fvec0);
+      acc_fvec1 = fVec::set(acc_fvec1, red_fun(acc_fvec1, data_fvec1), size - d - fVec::size());
+    } else {
+      data_fvec0 = map_fun(data_fvec0, data2_fvec0);
+      acc_fvec0 = fVec::set(acc_fvec0, red_fun(acc_fvec0, data_fvec0), size - d);
+    }
+  }
+  acc_fvec0 = red_fun(acc_fvec0, acc_fvec1);
+  return vec_reduce_all<float>(red_fun, acc_fvec0, fVec::size());
+}
+
+template <typename scalar_t, typename Op, enable_if_bfloat16_t<scalar_t> = 0>
+inline void map(
+    const Op& vec_fun,
+    scalar_t* output_data,
+    const scalar_t* input_data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d));
+    fVec output_fvec0 = vec_fun(data_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1);
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d, size - d));
+    fVec output_fvec0 = vec_fun(data_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1);
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d, size - d);
+  }
+}
+
+// Maps BFloat16 input to a float buffer, for kernels that need to keep an
+// intermediate result at full precision.
+template <typename Op>
+inline void map(
+    const Op& vec_fun,
+    float* output_data,
+    const BFloat16* input_data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d));
+    vec_fun(data_fvec0).store(output_data + d);
+    vec_fun(data_fvec1).store(output_data + d + fVec::size());
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d, size - d));
+    if (size - d > fVec::size()) {
+      vec_fun(data_fvec0).store(output_data + d);
+      vec_fun(data_fvec1).store(output_data + d + fVec::size(), size - d - fVec::size());
+    } else {
+      vec_fun(data_fvec0).store(output_data + d, size - d);
+    }
+  }
+}
+
+// Maps a float buffer back to BFloat16 output.
+template <typename Op>
+inline void map(
+    const Op& vec_fun,
+    BFloat16* output_data,
+    const float* input_data,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec output_fvec0 = vec_fun(fVec::loadu(input_data + d));
+    fVec output_fvec1 = vec_fun(fVec::loadu(input_data + d + fVec::size()));
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1;
+    if (size - d > fVec::size()) {
+      data_fvec0 = fVec::loadu(input_data + d);
+      data_fvec1 = fVec::loadu(input_data + d + fVec::size(), size - d - fVec::size());
+    } else {
+      data_fvec0 = fVec::loadu(input_data + d, size - d);
+      data_fvec1 = fVec(0);
+    }
+    fVec output_fvec0 = vec_fun(data_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1);
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d, size - d);
+  }
+}
+
+template <typename scalar_t, typename Op, enable_if_bfloat16_t<scalar_t> = 0>
+inline void map2(
+    const Op& vec_fun,
+    scalar_t* output_data,
+    const scalar_t* input_data,
+    const scalar_t* input_data2,
+    int64_t size) {
+  using bVec = vec256::Vec256<BFloat16>;
+  using fVec = vec256::Vec256<float>;
+  int64_t d = 0;
+  for (; d < size - (size % bVec::size()); d += bVec::size()) {
+    fVec data_fvec0, data_fvec1, data2_fvec0, data2_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(input_data2 + d));
+    fVec output_fvec0 = vec_fun(data_fvec0, data2_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1, data2_fvec1);
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d);
+  }
+  if (size - d > 0) {
+    fVec data_fvec0, data_fvec1, data2_fvec0, data2_fvec1;
+    std::tie(data_fvec0, data_fvec1) = convert_bfloat16_float(bVec::loadu(input_data + d, size - d));
+    std::tie(data2_fvec0, data2_fvec1) = convert_bfloat16_float(bVec::loadu(input_data2 + d, size - d));
+    fVec output_fvec0 = vec_fun(data_fvec0, data2_fvec0);
+    fVec output_fvec1 = vec_fun(data_fvec1, data2_fvec1);
+    convert_float_bfloat16(output_fvec0, output_fvec1).store(output_data + d, size - d);
+  }
+}
+
+}} // namespace at::vec256
@@ -41,6 +41,17 @@
 #define __at_align32__
 #endif
 
+// Width in bytes of the vector registers used by the CPU_CAPABILITY this file
+// is compiled for. The Vec256 name predates AVX512 support: when compiled with
+// CPU_CAPABILITY_AVX512 every Vec256<T> (including the generic emulation
+// below) holds 64 bytes, so kernels must use Vec256<T>::size() rather than
+// assume 256-bit vectors.
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+#define VECTOR_WIDTH 64
+#else
+#define VECTOR_WIDTH 32
+#endif
+
 namespace at {
 namespace vec256 {
 // See Note [Acceptable use of anonymous namespace in header]
@@ -74,7 +85,7 @@ using int_same_size_t = typename int_of_size<sizeof(T)>::type;
 template <class T>
 struct Vec256 {
 private:
-  __at_align32__ T values[32 / sizeof(T)];
+  __at_align32__ T values[VECTOR_WIDTH / sizeof(T)];
 public:
   using value_type = T;
   // Note [constexpr static function to avoid odr-usage compiler bug]
@@ -110,7 +121,7 @@ public:
   // identifier is odr-used or not, and in any case it's hard to tell if
   // a variable is odr-used or not.  So best to just cut the problem at the root.
   static constexpr int size() {
-    return 32 / sizeof(T);
+    return VECTOR_WIDTH / sizeof(T);
   }
   Vec256() : values{0} {}
   Vec256(T val) {
@@ -181,7 +192,7 @@ public:
   }
   static Vec256<T> loadu(const void* ptr) {
     Vec256 vec;
-    std::memcpy(vec.values, ptr, 32);
+    std::memcpy(vec.values, ptr, VECTOR_WIDTH);
     return vec;
   }
   static Vec256<T> loadu(const void* ptr, int64_t count) {
@@ -655,7 +666,36 @@ Vec256<T> inline clamp_min(const Vec256<T> &a, const Vec256<T> &min_vec) {
 
 struct Vec256i;
 
-#ifdef CPU_CAPABILITY_AVX2
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+template <class T, typename Op>
+static inline Vec256<T> bitwise_binary_op(const Vec256<T> &a, const Vec256<T> &b, Op op) {
+  __m512i buffer;
+  __m512i a_buffer = _mm512_loadu_si512(reinterpret_cast<const __m512i*>((const T*)a));
+  __m512i b_buffer = _mm512_loadu_si512(reinterpret_cast<const __m512i*>((const T*)b));
+  buffer = op(a_buffer, b_buffer);
+  __at_align32__ T results[Vec256<T>::size()];
+  _mm512_storeu_si512(reinterpret_cast<__m512i*>(results), buffer);
+  return Vec256<T>::loadu(results);
+}
+
+template<class T, typename std::enable_if_t<!std::is_base_of<Vec256i, Vec256<T>>::value, int> = 0>
+inline Vec256<T> operator&(const Vec256<T>& a, const Vec256<T>& b) {
+  // We enclose _mm512_and_si512 with lambda because it is always_inline
+  return bitwise_binary_op(a, b, [](__m512i a, __m512i b) { return _mm512_and_si512(a, b); });
+}
+template<class T, typename std::enable_if_t<!std::is_base_of<Vec256i, Vec256<T>>::value, int> = 0>
+inline Vec256<T> operator|(const Vec256<T>& a, const Vec256<T>& b) {
+  // We enclose _mm512_or_si512 with lambda because it is always_inline
+  return bitwise_binary_op(a, b, [](__m512i a, __m512i b) { return _mm512_or_si512(a, b); });
+}
+template<class T, typename std::enable_if_t<!std::is_base_of<Vec256i, Vec256<T>>::value, int> = 0>
+inline Vec256<T> operator^(const Vec256<T>& a, const Vec256<T>& b) {
+  // We enclose _mm512_xor_si512 with lambda because it is always_inline
+  return bitwise_binary_op(a, b, [](__m512i a, __m512i b) { return _mm512_xor_si512(a, b); });
+}
+
+#elif defined(CPU_CAPABILITY_AVX2)
 
 template <class T, typename Op>
 static inline Vec256<T> bitwise_binary_op(const Vec256<T> &a, const Vec256<T> &b, Op op) {
@@ -688,7 +728,7 @@ inline Vec256<T> operator^(const Vec256<T>& a, const Vec256<T>& b) {
 
 template<class T, typename Op>
 static inline Vec256<T> bitwise_binary_op(const Vec256<T> &a, const Vec256<T> &b, Op op) {
-  static constexpr uint32_t element_no = 32 / sizeof(intmax_t);
+  static constexpr uint32_t element_no = VECTOR_WIDTH / sizeof(intmax_t);
   __at_align32__ intmax_t buffer[element_no];
   const intmax_t *a_ptr = reinterpret_cast<const intmax_t*>((const T*) a);
   const intmax_t *b_ptr = reinterpret_cast<const intmax_t*>((const T*) b);
@@ -29,12 +29,14 @@ public:
   }
 };
 
-#else
+#elif !defined(CPU_CAPABILITY_AVX512) || defined(_MSC_VER)
 
 struct Vec256i {};  // dummy definition to make Vec256i always defined
 
 #endif // CPU_CAPABILITY_AVX2
 
+// The AVX512 definition of Vec256i lives in vec512_int.h.
+
 #ifdef CPU_CAPABILITY_AVX2
 
 template <>
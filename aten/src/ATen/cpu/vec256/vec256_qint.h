@@ -1048,6 +1048,10 @@ Vec256<c10::quint8> inline maximum(const Vec256<c10::quint8>& a, const Vec256<c1
 //
 // If in the future we relax this requirement (AVX2+), we should probably
 // revisit these implementations
+//
+// The AVX512 build also uses these. Their sizes are therefore expressed in
+// terms of Vec256<float>::size() so that dequantize()/quantize() line up
+// with the width of the float vectors.
 
 template <
     typename T,
@@ -1060,11 +1064,11 @@ struct Vec256QuantizedConverter {
   }
 
   static constexpr int float_num_vecs() {
-    return size() / 8;
+    return size() / Vec256<float>::size();
   }
 
   static constexpr int int_num_vecs() {
-    return size() / 8;
+    return size() / Vec256<float>::size();
   }
 
   using float_vec_return_type = float_vec_return_type_;
@@ -1092,11 +1096,19 @@ struct Vec256QuantizedConverter {
       Vec256<float> zero_point,
       Vec256<float> scale_zp_premul) const {
     float_vec_return_type rv;
+    float scale_vals[Vec256<float>::size()];
+    float zero_point_vals[Vec256<float>::size()];
+    scale.store(scale_vals);
+    zero_point.store(zero_point_vals);
     for (int i = 0; i < float_num_vecs(); ++i) {
-      for (int j = 0; j < 8; ++j) {
-        rv[i][j] = at::native::dequantize_val<T>(
-            scale[j], zero_point[j], T(vals[8 * i + j]));
+      float float_vals[Vec256<float>::size()];
+      for (int j = 0; j < Vec256<float>::size(); ++j) {
+        float_vals[j] = at::native::dequantize_val<T>(
+            scale_vals[j],
+            zero_point_vals[j],
+            T(vals[Vec256<float>::size() * i + j]));
       }
+      rv[i] = Vec256<float>::loadu(float_vals);
     }
     return rv;
   }
@@ -1117,25 +1129,25 @@ struct Vec256<c10::qint32> : public Vec256QuantizedConverter<
                                  c10::qint32,
                                  std::array<Vec256<float>, 1>,
                                  std::array<Vec256<c10::qint32>, 1>,
-                                 8> {
+                                 Vec256<float>::size()> {
   Vec256()
       : Vec256QuantizedConverter<
             c10::qint32,
             std::array<Vec256<float>, 1>,
             std::array<Vec256<c10::qint32>, 1>,
-            8>() {}
+            Vec256<float>::size()>() {}
   Vec256(c10::qint32 val)
       : Vec256QuantizedConverter<
             c10::qint32,
             std::array<Vec256<float>, 1>,
             std::array<Vec256<c10::qint32>, 1>,
-            8>(val) {}
+            Vec256<float>::size()>(val) {}
   Vec256(const void* ptr)
       : Vec256QuantizedConverter<
             c10::qint32,
             std::array<Vec256<float>, 1>,
             std::array<Vec256<c10::qint32>, 1>,
-            8>(ptr) {}
+            Vec256<float>::size()>(ptr) {}
 
   static Vec256<c10::qint32> loadu(const void* ptr) {
     return Vec256<c10::qint32>(ptr);
@@ -1147,10 +1159,11 @@ struct Vec256<c10::qint32> : public Vec256QuantizedConverter<
       int32_t zero_point,
       float inverse_scale) {
     std::array<value_type, size()> qvals;
-    std::array<float, float_num_vecs() * 8> float_vals;
+    std::array<float, float_num_vecs() * Vec256<float>::size()> float_vals;
 
     for (int i = 0; i < float_num_vecs(); ++i) {
-      rhs[i].store(&float_vals[i * 8], 8);
+      rhs[i].store(
+          &float_vals[i * Vec256<float>::size()], Vec256<float>::size());
     }
 
     at::native::quantize_vec<c10::qint32, /*precision=*/32>(
@@ -1158,7 +1171,7 @@ struct Vec256<c10::qint32> : public Vec256QuantizedConverter<
         zero_point,
         float_vals.data(),
         (c10::qint32*)qvals.data(),
-        8 * float_num_vecs());
+        Vec256<float>::size() * float_num_vecs());
 
     return Vec256<c10::qint32>::loadu(qvals.data());
   }
@@ -1249,25 +1262,25 @@ struct Vec256<c10::qint8> : public Vec256QuantizedConverter<
                                 c10::qint8,
                                 std::array<Vec256<float>, 4>,
                                 std::array<Vec256<c10::qint32>, 4>,
-                                32> {
+                                4 * Vec256<float>::size()> {
   Vec256()
       : Vec256QuantizedConverter<
             c10::qint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>() {}
+            4 * Vec256<float>::size()>() {}
   Vec256(c10::qint8 val)
       : Vec256QuantizedConverter<
             c10::qint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>(val) {}
+            4 * Vec256<float>::size()>(val) {}
   Vec256(const void* ptr)
       : Vec256QuantizedConverter<
             c10::qint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>(ptr) {}
+            4 * Vec256<float>::size()>(ptr) {}
 
   static Vec256<c10::qint8> loadu(const void* ptr) {
     return Vec256<c10::qint8>(ptr);
@@ -1279,10 +1292,11 @@ struct Vec256<c10::qint8> : public Vec256QuantizedConverter<
       int32_t zero_point,
       float inverse_scale) {
     std::array<value_type, size()> qvals;
-    std::array<float, float_num_vecs() * 8> float_vals;
+    std::array<float, float_num_vecs() * Vec256<float>::size()> float_vals;
 
     for (int i = 0; i < float_num_vecs(); ++i) {
-      rhs[i].store(&float_vals[i * 8], 8);
+      rhs[i].store(
+          &float_vals[i * Vec256<float>::size()], Vec256<float>::size());
     }
 
     at::native::quantize_vec<c10::qint8>(
@@ -1290,7 +1304,7 @@ struct Vec256<c10::qint8> : public Vec256QuantizedConverter<
         zero_point,
         float_vals.data(),
         (c10::qint8*)qvals.data(),
-        8 * float_num_vecs());
+        Vec256<float>::size() * float_num_vecs());
 
     return Vec256<c10::qint8>::loadu(qvals.data());
   }
@@ -1369,25 +1383,25 @@ struct Vec256<c10::quint8> : public Vec256QuantizedConverter<
                                  c10::quint8,
                                  std::array<Vec256<float>, 4>,
                                  std::array<Vec256<c10::qint32>, 4>,
-                                 32> {
+                                 4 * Vec256<float>::size()> {
   Vec256()
       : Vec256QuantizedConverter<
             c10::quint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>() {}
+            4 * Vec256<float>::size()>() {}
   Vec256(c10::quint8 val)
       : Vec256QuantizedConverter<
             c10::quint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>(val) {}
+            4 * Vec256<float>::size()>(val) {}
   Vec256(const void* ptr)
       : Vec256QuantizedConverter<
             c10::quint8,
             std::array<Vec256<float>, 4>,
             std::array<Vec256<c10::qint32>, 4>,
-            32>(ptr) {}
+            4 * Vec256<float>::size()>(ptr) {}
 
   static Vec256<c10::quint8> loadu(const void* ptr) {
     return Vec256<c10::quint8>(ptr);
@@ -1399,10 +1413,11 @@ struct Vec256<c10::quint8> : public Vec256QuantizedConverter<
       int32_t zero_point,
       float inverse_scale) {
     std::array<value_type, size()> qvals;
-    std::array<float, float_num_vecs() * 8> float_vals;
+    std::array<float, float_num_vecs() * Vec256<float>::size()> float_vals;
 
     for (int i = 0; i < float_num_vecs(); ++i) {
-      rhs[i].store(&float_vals[i * 8], 8);
+      rhs[i].store(
+          &float_vals[i * Vec256<float>::size()], Vec256<float>::size());
     }
 
     at::native::quantize_vec<c10::quint8>(
@@ -1410,7 +1425,7 @@ struct Vec256<c10::quint8> : public Vec256QuantizedConverter<
         zero_point,
         float_vals.data(),
         (c10::quint8*)qvals.data(),
-        8 * float_num_vecs());
+        Vec256<float>::size() * float_num_vecs());
 
     return Vec256<c10::quint8>::loadu(qvals.data());
   }
@@ -0,0 +1,443 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <c10/util/complex.h>
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec256/vec256_base.h>
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec256 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+// 512-bit Vec256<c10::complex<double>> holding 4 interleaved (real, imag)
+// pairs, see vec512_complex_float.h.
+template <> class Vec256<c10::complex<double>> {
+private:
+  __m512d values;
+  // Expands a mask over complex elements to a mask over double lanes: xy -> xxyy
+  static inline __mmask8 expand_mask(int64_t mask) {
+    __mmask8 ret = 0;
+    for (int i = 0; i < size(); i++) {
+      if (mask & (1 << i)) {
+        ret |= (0x3 << (2 * i));
+      }
+    }
+    return ret;
+  }
+  static inline __m512d mask_to_vec(__mmask8 mask) {
+    return _mm512_castsi512_pd(
+        _mm512_maskz_set1_epi64(mask, static_cast<int64_t>(0xFFFFFFFFFFFFFFFF)));
+  }
+public:
+  using value_type = c10::complex<double>;
+  static constexpr int size() {
+    return 4;
+  }
+  Vec256() {}
+  Vec256(__m512d v) : values(v) {}
+  Vec256(c10::complex<double> val) {
+    double real_value = val.real();
+    double imag_value = val.imag();
+    values = _mm512_setr_pd(real_value, imag_value, real_value, imag_value,
+                            real_value, imag_value, real_value, imag_value);
+  }
+  Vec256(c10::complex<double> val1, c10::complex<double> val2, c10::complex<double> val3, c10::complex<double> val4) {
+    values = _mm512_setr_pd(val1.real(), val1.imag(), val2.real(), val2.imag(),
+                            val3.real(), val3.imag(), val4.real(), val4.imag());
+  }
+  operator __m512d() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec256<c10::complex<double>> blend(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+    return _mm512_mask_blend_pd(expand_mask(mask), a.values, b.values);
+  }
+  static Vec256<c10::complex<double>> blendv(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b,
+                               const Vec256<c10::complex<double>>& mask) {
+    // use the mask of the real part for the whole complex element
+    auto mask_ = _mm512_movepi64_mask(_mm512_castpd_si512(_mm512_movedup_pd(mask.values)));
+    return _mm512_mask_blend_pd(mask_, a.values, b.values);
+  }
+  template<typename step_t>
+  static Vec256<c10::complex<double>> arange(c10::complex<double> base = 0., step_t step = static_cast<step_t>(1)) {
+    return Vec256<c10::complex<double>>(base,
+                                        base + step,
+                                        base + c10::complex<double>(2)*step,
+                                        base + c10::complex<double>(3)*step);
+  }
+  static Vec256<c10::complex<double>> set(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b,
+                            int64_t count = size()) {
+    if (count >= size()) {
+      return b;
+    }
+    auto mask = static_cast<__mmask8>((1 << (2 * count)) - 1);
+    return _mm512_mask_blend_pd(mask, a.values, b.values);
+  }
+  static Vec256<c10::complex<double>> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size())
+      return _mm512_loadu_pd(reinterpret_cast<const double*>(ptr));
+    // Masked-off lanes are zeroed and never touch memory, see
+    // https://github.com/pytorch/pytorch/issues/32502.
+    auto mask = static_cast<__mmask8>((1 << (2 * count)) - 1);
+    return _mm512_maskz_loadu_pd(mask, ptr);
+  }
+  void store(void* ptr, int count = size()) const {
+    if (count == size()) {
+      _mm512_storeu_pd(reinterpret_cast<double*>(ptr), values);
+    } else if (count > 0) {
+      auto mask = static_cast<__mmask8>((1 << (2 * count)) - 1);
+      _mm512_mask_storeu_pd(ptr, mask, values);
+    }
+  }
+  const c10::complex<double>& operator[](int idx) const  = delete;
+  c10::complex<double>& operator[](int idx) = delete;
+  Vec256<c10::complex<double>> map(c10::complex<double> (*f)(const c10::complex<double> &)) const {
+    __at_align32__ c10::complex<double> tmp[size()];
+    store(tmp);
+    for (int i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  __m512d abs_2_() const {
+    auto val_2 = _mm512_mul_pd(values, values);                        // a*a     b*b
+    return _mm512_add_pd(val_2, _mm512_permute_pd(val_2, 0x55));       // a*a+b*b a*a+b*b
+  }
+  __m512d abs_() const {
+    return _mm512_sqrt_pd(abs_2_());                                   // abs     abs
+  }
+  Vec256<c10::complex<double>> abs() const {
+    const __m512d real_mask = _mm512_castsi512_pd(_mm512_maskz_set1_epi64(0x55, -1));
+    return _mm512_and_pd(abs_(), real_mask);                           // abs     0
+  }
+  __m512d angle_() const {
+    //angle = atan2(b/a)
+    auto b_a = _mm512_permute_pd(values, 0x55);                        // b        a
+    return Sleef_atan2d8_u10(values, b_a);                            // 90-angle angle
+  }
+  Vec256<c10::complex<double>> angle() const {
+    const __m512d real_mask = _mm512_castsi512_pd(_mm512_maskz_set1_epi64(0x55, -1));
+    auto angle = _mm512_permute_pd(angle_(), 0x55);                    // angle    90-angle
+    return _mm512_and_pd(angle, real_mask);                            // angle    0
+  }
+  __m512d real_() const {
+    const __m512d real_mask = _mm512_castsi512_pd(_mm512_maskz_set1_epi64(0x55, -1));
+    return _mm512_and_pd(values, real_mask);
+  }
+  Vec256<c10::complex<double>> real() const {
+    return real_();
+  }
+  __m512d imag_() const {
+    const __m512d imag_mask = _mm512_castsi512_pd(_mm512_maskz_set1_epi64(0xAA, -1));
+    return _mm512_and_pd(values, imag_mask);
+  }
+  Vec256<c10::complex<double>> imag() const {
+    return _mm512_permute_pd(imag_(), 0x55);                           //b        a
+  }
+  __m512d conj_() const {
+    const __m512d sign_mask = _mm512_maskz_mov_pd(0xAA, _mm512_set1_pd(-0.0));
+    return _mm512_xor_pd(values, sign_mask);                           // a       -b
+  }
+  Vec256<c10::complex<double>> conj() const {
+    return conj_();
+  }
+  Vec256<c10::complex<double>> log() const {
+    // Most trigonomic ops use the log() op to improve complex number performance.
+    return map(std::log);
+  }
+  Vec256<c10::complex<double>> log2() const {
+    const __m512d log2_ = _mm512_set1_pd(std::log(2));
+    return _mm512_div_pd(log(), log2_);
+  }
+  Vec256<c10::complex<double>> log10() const {
+    const __m512d log10_ = _mm512_set1_pd(std::log(10));
+    return _mm512_div_pd(log(), log10_);
+  }
+  Vec256<c10::complex<double>> log1p() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> asin() const {
+    // asin(x)
+    // = -i*ln(iz + sqrt(1 -z^2))
+    // = -i*ln((ai - b) + sqrt(1 - (a + bi)*(a + bi)))
+    // = -i*ln((-b + ai) + sqrt(1 - (a**2 - b**2) - 2*abi))
+    const __m512d one = _mm512_set1_pd(1);
+
+    auto conj = conj_();
+    auto b_a = _mm512_permute_pd(conj, 0x55);                          //-b        a
+    auto ab = _mm512_mul_pd(conj, b_a);                                //-ab       -ab
+    auto im = _mm512_add_pd(ab, ab);                                   //-2ab      -2ab
+
+    auto val_2 = _mm512_mul_pd(values, values);                        // a*a      b*b
+    auto re = _mm512_sub_pd(val_2, _mm512_permute_pd(val_2, 0x55));    // a*a-b*b  b*b-a*a
+    re = _mm512_sub_pd(one, re);
+
+    auto root = Vec256(_mm512_mask_blend_pd(0xAA, re, im)).sqrt();   //sqrt(re + i*im)
+    auto ln = Vec256(_mm512_add_pd(b_a, root)).log();                  //ln(iz + sqrt())
+    return Vec256(_mm512_permute_pd(ln.values, 0x55)).conj();          //-i*ln()
+  }
+  Vec256<c10::complex<double>> acos() const {
+    // acos(x) = pi/2 - asin(x)
+    const __m512d pi_2 = _mm512_maskz_mov_pd(0x55, _mm512_set1_pd(M_PI/2));
+    return _mm512_sub_pd(pi_2, asin());
+  }
+  Vec256<c10::complex<double>> atan() const;
+  Vec256<c10::complex<double>> atan2(const Vec256<c10::complex<double>> &b) const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> erf() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> erfc() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> exp() const {
+    //exp(a + bi)
+    // = exp(a)*(cos(b) + sin(b)i)
+    auto exp = Sleef_expd8_u10(values);                               //exp(a)           exp(b)
+    exp = _mm512_movedup_pd(exp);                                     //exp(a)           exp(a)
+
+    auto sin_cos = Sleef_sincosd8_u10(values);                        //[sin(a), cos(a)] [sin(b), cos(b)]
+    auto cos_sin = _mm512_mask_blend_pd(0xAA, _mm512_permute_pd(sin_cos.y, 0x55),
+                                        sin_cos.x);                    //cos(b)           sin(b)
+    return _mm512_mul_pd(exp, cos_sin);
+  }
+  Vec256<c10::complex<double>> expm1() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> sin() const {
+    return map(std::sin);
+  }
+  Vec256<c10::complex<double>> sinh() const {
+    return map(std::sinh);
+  }
+  Vec256<c10::complex<double>> cos() const {
+    return map(std::cos);
+  }
+  Vec256<c10::complex<double>> cosh() const {
+    return map(std::cosh);
+  }
+  Vec256<c10::complex<double>> ceil() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<double>> floor() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<double>> neg() const {
+    auto zero = _mm512_setzero_pd();
+    return _mm512_sub_pd(zero, values);
+  }
+  Vec256<c10::complex<double>> round() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<double>> tan() const {
+    return map(std::tan);
+  }
+  Vec256<c10::complex<double>> tanh() const {
+    return map(std::tanh);
+  }
+  Vec256<c10::complex<double>> trunc() const {
+    return _mm512_roundscale_pd(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<double>> sqrt() const {
+    //   sqrt(a + bi)
+    // = sqrt(2)/2 * [sqrt(sqrt(a**2 + b**2) + a) + sgn(b)*sqrt(sqrt(a**2 + b**2) - a)i]
+    // = sqrt(2)/2 * [sqrt(abs() + a) + sgn(b)*sqrt(abs() - a)i]
+
+    const __m512d scalar = _mm512_set1_pd(std::sqrt(2)/2);               //sqrt(2)/2      sqrt(2)/2
+    const __m512d sign_mask = _mm512_maskz_mov_pd(0xAA, _mm512_set1_pd(-0.0));
+    auto sign = _mm512_and_pd(values, sign_mask);
+    auto factor = _mm512_or_pd(scalar, sign);
+
+    auto a_a = _mm512_xor_pd(_mm512_movedup_pd(values), sign_mask);    // a             -a
+    auto res_re_im = _mm512_sqrt_pd(_mm512_add_pd(abs_(), a_a));        // sqrt(abs + a) sqrt(abs - a)
+    return _mm512_mul_pd(factor, res_re_im);
+  }
+  Vec256<c10::complex<double>> reciprocal() const;
+  Vec256<c10::complex<double>> rsqrt() const {
+    return sqrt().reciprocal();
+  }
+  Vec256<c10::complex<double>> pow(const Vec256<c10::complex<double>> &exp) const {
+    __at_align32__ c10::complex<double> x_tmp[size()];
+    __at_align32__ c10::complex<double> y_tmp[size()];
+    store(x_tmp);
+    exp.store(y_tmp);
+    for (int i = 0; i < size(); i++) {
+      x_tmp[i] = std::pow(x_tmp[i], y_tmp[i]);
+    }
+    return loadu(x_tmp);
+  }
+  // Comparison using the _CMP_**_OQ predicate.
+  //   `O`: get false if an operand is NaN
+  //   `Q`: do not raise if an operand is NaN
+  Vec256<c10::complex<double>> operator==(const Vec256<c10::complex<double>>& other) const {
+    return mask_to_vec(_mm512_cmp_pd_mask(values, other.values, _CMP_EQ_OQ));
+  }
+  Vec256<c10::complex<double>> operator!=(const Vec256<c10::complex<double>>& other) const {
+    return mask_to_vec(_mm512_cmp_pd_mask(values, other.values, _CMP_NEQ_OQ));
+  }
+  Vec256<c10::complex<double>> operator<(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> operator<=(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> operator>(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> operator>=(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+
+  Vec256<c10::complex<double>> eq(const Vec256<c10::complex<double>>& other) const;
+  Vec256<c10::complex<double>> ne(const Vec256<c10::complex<double>>& other) const;
+  Vec256<c10::complex<double>> lt(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> le(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> gt(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<double>> ge(const Vec256<c10::complex<double>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+};
+
+template <> Vec256<c10::complex<double>> inline operator+(const Vec256<c10::complex<double>> &a, const Vec256<c10::complex<double>> &b) {
+  return _mm512_add_pd(a, b);
+}
+
+template <> Vec256<c10::complex<double>> inline operator-(const Vec256<c10::complex<double>> &a, const Vec256<c10::complex<double>> &b) {
+  return _mm512_sub_pd(a, b);
+}
+
+template <> Vec256<c10::complex<double>> inline operator*(const Vec256<c10::complex<double>> &a, const Vec256<c10::complex<double>> &b) {
+  //(a + bi)  * (c + di) = (ac - bd) + (ad + bc)i
+  auto c_c = _mm512_movedup_pd(b);                    //c        c
+  auto d_d = _mm512_permute_pd(b, 0xFF);                    //d        d
+  auto b_a = _mm512_permute_pd(a, 0x55);               //b        a
+  auto bd_ad = _mm512_mul_pd(b_a, d_d);                //bd       ad
+  return _mm512_fmaddsub_pd(a, c_c, bd_ad);            //ac - bd  bc + ad
+}
+
+template <> Vec256<c10::complex<double>> inline operator/(const Vec256<c10::complex<double>> &a, const Vec256<c10::complex<double>> &b) {
+  //re + im*i = (a + bi)  / (c + di)
+  //re = (ac + bd)/abs_2()
+  //im = (bc - ad)/abs_2()
+  auto c_c = _mm512_movedup_pd(b);                    //c        c
+  auto d_d = _mm512_permute_pd(b, 0xFF);                    //d        d
+  auto b_a = _mm512_permute_pd(a, 0x55);               //b        a
+  auto bd_ad = _mm512_mul_pd(b_a, d_d);                //bd       ad
+  auto re_im = _mm512_fmsubadd_pd(a, c_c, bd_ad);      //ac + bd  bc - ad
+  return _mm512_div_pd(re_im, b.abs_2_());
+}
+
+// reciprocal. Implement this here so we can use multiplication.
+Vec256<c10::complex<double>> Vec256<c10::complex<double>>::reciprocal() const {
+  //re + im*i = (a + bi)  / (c + di)
+  //re = (ac + bd)/abs_2() = c/abs_2()
+  //im = (bc - ad)/abs_2() = d/abs_2()
+  const __m512d sign_mask = _mm512_maskz_mov_pd(0xAA, _mm512_set1_pd(-0.0));
+  auto c_d = _mm512_xor_pd(sign_mask, values);    //c       -d
+  return _mm512_div_pd(c_d, abs_2_());
+}
+
+Vec256<c10::complex<double>> Vec256<c10::complex<double>>::atan() const {
+  // atan(x) = i/2 * ln((i + z)/(i - z))
+  const __m512d i = _mm512_maskz_mov_pd(0xAA, _mm512_set1_pd(1.0));
+  const Vec256 i_half = _mm512_maskz_mov_pd(0xAA, _mm512_set1_pd(0.5));
+
+  auto sum = Vec256(_mm512_add_pd(i, values));                      // a        1+b
+  auto sub = Vec256(_mm512_sub_pd(i, values));                      // -a       1-b
+  auto ln = (sum/sub).log();                                        // ln((i + z)/(i - z))
+  return i_half*ln;                                                 // i/2*ln()
+}
+
+template <>
+Vec256<c10::complex<double>> inline maximum(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+  auto abs_a = a.abs_2_();
+  auto abs_b = b.abs_2_();
+  auto mask = _mm512_cmp_pd_mask(abs_a, abs_b, _CMP_LT_OQ);
+  auto max = _mm512_mask_blend_pd(mask, a, b);
+  // Exploit the fact that all-ones is a NaN.
+  auto isnan = _mm512_cmp_pd_mask(abs_a, abs_b, _CMP_UNORD_Q);
+  return _mm512_mask_blend_pd(
+      isnan, max, _mm512_castsi512_pd(_mm512_set1_epi64(static_cast<int64_t>(0xFFFFFFFFFFFFFFFF))));
+}
+
+template <>
+Vec256<c10::complex<double>> inline minimum(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+  auto abs_a = a.abs_2_();
+  auto abs_b = b.abs_2_();
+  auto mask = _mm512_cmp_pd_mask(abs_a, abs_b, _CMP_GT_OQ);
+  auto min = _mm512_mask_blend_pd(mask, a, b);
+  // Exploit the fact that all-ones is a NaN.
+  auto isnan = _mm512_cmp_pd_mask(abs_a, abs_b, _CMP_UNORD_Q);
+  return _mm512_mask_blend_pd(
+      isnan, min, _mm512_castsi512_pd(_mm512_set1_epi64(static_cast<int64_t>(0xFFFFFFFFFFFFFFFF))));
+}
+
+template <>
+Vec256<c10::complex<double>> inline clamp(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& min, const Vec256<c10::complex<double>>& max) {
+  auto abs_a = a.abs_2_();
+  auto abs_min = min.abs_2_();
+  auto max_mask = _mm512_cmp_pd_mask(abs_a, abs_min, _CMP_LT_OQ);
+  auto abs_max = max.abs_2_();
+  auto min_mask = _mm512_cmp_pd_mask(abs_a, abs_max, _CMP_GT_OQ);
+  return _mm512_mask_blend_pd(min_mask, _mm512_mask_blend_pd(max_mask, a, min), max);
+}
+
+template <>
+Vec256<c10::complex<double>> inline clamp_min(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& min) {
+  auto abs_a = a.abs_2_();
+  auto abs_min = min.abs_2_();
+  auto max_mask = _mm512_cmp_pd_mask(abs_a, abs_min, _CMP_LT_OQ);
+  return _mm512_mask_blend_pd(max_mask, a, min);
+}
+
+template <>
+Vec256<c10::complex<double>> inline clamp_max(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& max) {
+  auto abs_a = a.abs_2_();
+  auto abs_max = max.abs_2_();
+  auto min_mask = _mm512_cmp_pd_mask(abs_a, abs_max, _CMP_GT_OQ);
+  return _mm512_mask_blend_pd(min_mask, a, max);
+}
+
+template <>
+Vec256<c10::complex<double>> inline operator&(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+  return _mm512_and_pd(a, b);
+}
+
+template <>
+Vec256<c10::complex<double>> inline operator|(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+  return _mm512_or_pd(a, b);
+}
+
+template <>
+Vec256<c10::complex<double>> inline operator^(const Vec256<c10::complex<double>>& a, const Vec256<c10::complex<double>>& b) {
+  return _mm512_xor_pd(a, b);
+}
+
+Vec256<c10::complex<double>> Vec256<c10::complex<double>>::eq(
+    const Vec256<c10::complex<double>>& other) const {
+  return (*this == other) & Vec256<c10::complex<double>>(_mm512_set1_pd(1.0));
+}
+
+Vec256<c10::complex<double>> Vec256<c10::complex<double>>::ne(
+    const Vec256<c10::complex<double>>& other) const {
+  return (*this != other) & Vec256<c10::complex<double>>(_mm512_set1_pd(1.0));
+}
+
+#endif
+
+}}}
@@ -0,0 +1,453 @@
+#pragma once
+
+// DO NOT DEFINE STATIC DATA IN THIS HEADER!
+// See Note [Do not compile initializers with AVX]
+
+#include <c10/util/complex.h>
+#include <ATen/cpu/vec256/intrinsics.h>
+#include <ATen/cpu/vec256/vec256_base.h>
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+#include <sleef.h>
+#endif
+
+namespace at {
+namespace vec256 {
+// See Note [Acceptable use of anonymous namespace in header]
+namespace {
+
+#if defined(CPU_CAPABILITY_AVX512) && !defined(_MSC_VER)
+
+// 512-bit Vec256<c10::complex<float>> holding 8 interleaved (real, imag)
+// pairs. Unlike the AVX2 version, multiplication and division are done with
+// fmaddsub/fmsubadd instead of horizontal adds, which AVX512 does not have.
+template <> class Vec256<c10::complex<float>> {
+private:
+  __m512 values;
+  // Expands a mask over complex elements to a mask over float lanes: xy -> xxyy
+  static inline __mmask16 expand_mask(int64_t mask) {
+    __mmask16 ret = 0;
+    for (int i = 0; i < size(); i++) {
+      if (mask & (1 << i)) {
+        ret |= (0x3 << (2 * i));
+      }
+    }
+    return ret;
+  }
+  static inline __m512 mask_to_vec(__mmask16 mask) {
+    return _mm512_castsi512_ps(
+        _mm512_maskz_set1_epi32(mask, static_cast<int>(0xFFFFFFFF)));
+  }
+public:
+  using value_type = c10::complex<float>;
+  static constexpr int size() {
+    return 8;
+  }
+  Vec256() {}
+  Vec256(__m512 v) : values(v) {}
+  Vec256(c10::complex<float> val) {
+    float real_value = val.real();
+    float imag_value = val.imag();
+    values = _mm512_setr_ps(real_value, imag_value, real_value, imag_value,
+                            real_value, imag_value, real_value, imag_value,
+                            real_value, imag_value, real_value, imag_value,
+                            real_value, imag_value, real_value, imag_value);
+  }
+  Vec256(c10::complex<float> val1, c10::complex<float> val2, c10::complex<float> val3, c10::complex<float> val4,
+         c10::complex<float> val5, c10::complex<float> val6, c10::complex<float> val7, c10::complex<float> val8) {
+    values = _mm512_setr_ps(val1.real(), val1.imag(), val2.real(), val2.imag(),
+                            val3.real(), val3.imag(), val4.real(), val4.imag(),
+                            val5.real(), val5.imag(), val6.real(), val6.imag(),
+                            val7.real(), val7.imag(), val8.real(), val8.imag());
+  }
+  operator __m512() const {
+    return values;
+  }
+  template <int64_t mask>
+  static Vec256<c10::complex<float>> blend(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+    return _mm512_mask_blend_ps(expand_mask(mask), a.values, b.values);
+  }
+  static Vec256<c10::complex<float>> blendv(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b,
+                               const Vec256<c10::complex<float>>& mask) {
+    // use the mask of the real part for the whole complex element
+    auto mask_ = _mm512_movepi32_mask(_mm512_castps_si512(_mm512_moveldup_ps(mask.values)));
+    return _mm512_mask_blend_ps(mask_, a.values, b.values);
+  }
+  template<typename step_t>
+  static Vec256<c10::complex<float>> arange(c10::complex<float> base = 0., step_t step = static_cast<step_t>(1)) {
+    return Vec256<c10::complex<float>>(base,
+                                        base + step,
+                                        base + c10::complex<float>(2)*step,
+                                        base + c10::complex<float>(3)*step,
+                                        base + c10::complex<float>(4)*step,
+                                        base + c10::complex<float>(5)*step,
+                                        base + c10::complex<float>(6)*step,
+                                        base + c10::complex<float>(7)*step);
+  }
+  static Vec256<c10::complex<float>> set(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b,
+                            int64_t count = size()) {
+    if (count >= size()) {
+      return b;
+    }
+    auto mask = static_cast<__mmask16>((1 << (2 * count)) - 1);
+    return _mm512_mask_blend_ps(mask, a.values, b.values);
+  }
+  static Vec256<c10::complex<float>> loadu(const void* ptr, int64_t count = size()) {
+    if (count == size())
+      return _mm512_loadu_ps(reinterpret_cast<const float*>(ptr));
+    // Masked-off lanes are zeroed and never touch memory, see
+    // https://github.com/pytorch/pytorch/issues/32502.
+    auto mask = static_cast<__mmask16>((1 << (2 * count)) - 1);
+    return _mm512_maskz_loadu_ps(mask, ptr);
+  }
+  void store(void* ptr, int count = size()) const {
+    if (count == size()) {
+      _mm512_storeu_ps(reinterpret_cast<float*>(ptr), values);
+    } else if (count > 0) {
+      auto mask = static_cast<__mmask16>((1 << (2 * count)) - 1);
+      _mm512_mask_storeu_ps(ptr, mask, values);
+    }
+  }
+  const c10::complex<float>& operator[](int idx) const  = delete;
+  c10::complex<float>& operator[](int idx) = delete;
+  Vec256<c10::complex<float>> map(c10::complex<float> (*f)(const c10::complex<float> &)) const {
+    __at_align32__ c10::complex<float> tmp[size()];
+    store(tmp);
+    for (int i = 0; i < size(); i++) {
+      tmp[i] = f(tmp[i]);
+    }
+    return loadu(tmp);
+  }
+  __m512 abs_2_() const {
+    auto val_2 = _mm512_mul_ps(values, values);                        // a*a     b*b
+    return _mm512_add_ps(val_2, _mm512_permute_ps(val_2, 0xB1));       // a*a+b*b a*a+b*b
+  }
+  __m512 abs_() const {
+    return _mm512_sqrt_ps(abs_2_());                                   // abs     abs
+  }
+  Vec256<c10::complex<float>> abs() const {
+    const __m512 real_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x00000000FFFFFFFF));
+    return _mm512_and_ps(abs_(), real_mask);                           // abs     0
+  }
+  __m512 angle_() const {
+    //angle = atan2(b/a)
+    auto b_a = _mm512_permute_ps(values, 0xB1);                        // b        a
+    return Sleef_atan2f16_u10(values, b_a);                            // 90-angle angle
+  }
+  Vec256<c10::complex<float>> angle() const {
+    const __m512 real_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x00000000FFFFFFFF));
+    auto angle = _mm512_permute_ps(angle_(), 0xB1);                    // angle    90-angle
+    return _mm512_and_ps(angle, real_mask);                            // angle    0
+  }
+  __m512 real_() const {
+    const __m512 real_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x00000000FFFFFFFF));
+    return _mm512_and_ps(values, real_mask);
+  }
+  Vec256<c10::complex<float>> real() const {
+    return real_();
+  }
+  __m512 imag_() const {
+    const __m512 imag_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0xFFFFFFFF00000000));
+    return _mm512_and_ps(values, imag_mask);
+  }
+  Vec256<c10::complex<float>> imag() const {
+    return _mm512_permute_ps(imag_(), 0xB1);                           //b        a
+  }
+  __m512 conj_() const {
+    const __m512 sign_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x8000000000000000));
+    return _mm512_xor_ps(values, sign_mask);                           // a       -b
+  }
+  Vec256<c10::complex<float>> conj() const {
+    return conj_();
+  }
+  Vec256<c10::complex<float>> log() const {
+    // Most trigonomic ops use the log() op to improve complex number performance.
+    return map(std::log);
+  }
+  Vec256<c10::complex<float>> log2() const {
+    const __m512 log2_ = _mm512_set1_ps(std::log(2));
+    return _mm512_div_ps(log(), log2_);
+  }
+  Vec256<c10::complex<float>> log10() const {
+    const __m512 log10_ = _mm512_set1_ps(std::log(10));
+    return _mm512_div_ps(log(), log10_);
+  }
+  Vec256<c10::complex<float>> log1p() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> asin() const {
+    // asin(x)
+    // = -i*ln(iz + sqrt(1 -z^2))
+    // = -i*ln((ai - b) + sqrt(1 - (a + bi)*(a + bi)))
+    // = -i*ln((-b + ai) + sqrt(1 - (a**2 - b**2) - 2*abi))
+    const __m512 one = _mm512_set1_ps(1);
+
+    auto conj = conj_();
+    auto b_a = _mm512_permute_ps(conj, 0xB1);                          //-b        a
+    auto ab = _mm512_mul_ps(conj, b_a);                                //-ab       -ab
+    auto im = _mm512_add_ps(ab, ab);                                   //-2ab      -2ab
+
+    auto val_2 = _mm512_mul_ps(values, values);                        // a*a      b*b
+    auto re = _mm512_sub_ps(val_2, _mm512_permute_ps(val_2, 0xB1));    // a*a-b*b  b*b-a*a
+    re = _mm512_sub_ps(one, re);
+
+    auto root = Vec256(_mm512_mask_blend_ps(0xAAAA, re, im)).sqrt();   //sqrt(re + i*im)
+    auto ln = Vec256(_mm512_add_ps(b_a, root)).log();                  //ln(iz + sqrt())
+    return Vec256(_mm512_permute_ps(ln.values, 0xB1)).conj();          //-i*ln()
+  }
+  Vec256<c10::complex<float>> acos() const {
+    // acos(x) = pi/2 - asin(x)
+    const __m512 pi_2 = _mm512_maskz_mov_ps(0x5555, _mm512_set1_ps(M_PI/2));
+    return _mm512_sub_ps(pi_2, asin());
+  }
+  Vec256<c10::complex<float>> atan() const;
+  Vec256<c10::complex<float>> atan2(const Vec256<c10::complex<float>> &b) const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> erf() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> erfc() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> exp() const {
+    //exp(a + bi)
+    // = exp(a)*(cos(b) + sin(b)i)
+    auto exp = Sleef_expf16_u10(values);                               //exp(a)           exp(b)
+    exp = _mm512_moveldup_ps(exp);                                     //exp(a)           exp(a)
+
+    auto sin_cos = Sleef_sincosf16_u10(values);                        //[sin(a), cos(a)] [sin(b), cos(b)]
+    auto cos_sin = _mm512_mask_blend_ps(0xAAAA, _mm512_permute_ps(sin_cos.y, 0xB1),
+                                        sin_cos.x);                    //cos(b)           sin(b)
+    return _mm512_mul_ps(exp, cos_sin);
+  }
+  Vec256<c10::complex<float>> expm1() const {
+    AT_ERROR("not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> sin() const {
+    return map(std::sin);
+  }
+  Vec256<c10::complex<float>> sinh() const {
+    return map(std::sinh);
+  }
+  Vec256<c10::complex<float>> cos() const {
+    return map(std::cos);
+  }
+  Vec256<c10::complex<float>> cosh() const {
+    return map(std::cosh);
+  }
+  Vec256<c10::complex<float>> ceil() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<float>> floor() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<float>> neg() const {
+    auto zero = _mm512_setzero_ps();
+    return _mm512_sub_ps(zero, values);
+  }
+  Vec256<c10::complex<float>> round() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<float>> tan() const {
+    return map(std::tan);
+  }
+  Vec256<c10::complex<float>> tanh() const {
+    return map(std::tanh);
+  }
+  Vec256<c10::complex<float>> trunc() const {
+    return _mm512_roundscale_ps(values, (_MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC));
+  }
+  Vec256<c10::complex<float>> sqrt() const {
+    //   sqrt(a + bi)
+    // = sqrt(2)/2 * [sqrt(sqrt(a**2 + b**2) + a) + sgn(b)*sqrt(sqrt(a**2 + b**2) - a)i]
+    // = sqrt(2)/2 * [sqrt(abs() + a) + sgn(b)*sqrt(abs() - a)i]
+
+    const __m512 scalar = _mm512_set1_ps(std::sqrt(2)/2);               //sqrt(2)/2      sqrt(2)/2
+    const __m512 sign_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x8000000000000000));
+    auto sign = _mm512_and_ps(values, sign_mask);
+    auto factor = _mm512_or_ps(scalar, sign);
+
+    auto a_a = _mm512_xor_ps(_mm512_moveldup_ps(values), sign_mask);    // a             -a
+    auto res_re_im = _mm512_sqrt_ps(_mm512_add_ps(abs_(), a_a));        // sqrt(abs + a) sqrt(abs - a)
+    return _mm512_mul_ps(factor, res_re_im);
+  }
+  Vec256<c10::complex<float>> reciprocal() const;
+  Vec256<c10::complex<float>> rsqrt() const {
+    return sqrt().reciprocal();
+  }
+  Vec256<c10::complex<float>> pow(const Vec256<c10::complex<float>> &exp) const {
+    __at_align32__ c10::complex<float> x_tmp[size()];
+    __at_align32__ c10::complex<float> y_tmp[size()];
+    store(x_tmp);
+    exp.store(y_tmp);
+    for (int i = 0; i < size(); i++) {
+      x_tmp[i] = std::pow(x_tmp[i], y_tmp[i]);
+    }
+    return loadu(x_tmp);
+  }
+  // Comparison using the _CMP_**_OQ predicate.
+  //   `O`: get false if an operand is NaN
+  //   `Q`: do not raise if an operand is NaN
+  Vec256<c10::complex<float>> operator==(const Vec256<c10::complex<float>>& other) const {
+    return mask_to_vec(_mm512_cmp_ps_mask(values, other.values, _CMP_EQ_OQ));
+  }
+  Vec256<c10::complex<float>> operator!=(const Vec256<c10::complex<float>>& other) const {
+    return mask_to_vec(_mm512_cmp_ps_mask(values, other.values, _CMP_NEQ_OQ));
+  }
+  Vec256<c10::complex<float>> operator<(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> operator<=(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> operator>(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> operator>=(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+
+  Vec256<c10::complex<float>> eq(const Vec256<c10::complex<float>>& other) const;
+  Vec256<c10::complex<float>> ne(const Vec256<c10::complex<float>>& other) const;
+  Vec256<c10::complex<float>> lt(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> le(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> gt(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+  Vec256<c10::complex<float>> ge(const Vec256<c10::complex<float>>& other) const {
+    TORCH_CHECK(false, "not supported for complex numbers");
+  }
+};
+
+template <> Vec256<c10::complex<float>> inline operator+(const Vec256<c10::complex<float>> &a, const Vec256<c10::complex<float>> &b) {
+  return _mm512_add_ps(a, b);
+}
+
+template <> Vec256<c10::complex<float>> inline operator-(const Vec256<c10::complex<float>> &a, const Vec256<c10::complex<float>> &b) {
+  return _mm512_sub_ps(a, b);
+}
+
+template <> Vec256<c10::complex<float>> inline operator*(const Vec256<c10::complex<float>> &a, const Vec256<c10::complex<float>> &b) {
+  //(a + bi)  * (c + di) = (ac - bd) + (ad + bc)i
+  auto c_c = _mm512_moveldup_ps(b);                    //c        c
+  auto d_d = _mm512_movehdup_ps(b);                    //d        d
+  auto b_a = _mm512_permute_ps(a, 0xB1);               //b        a
+  auto bd_ad = _mm512_mul_ps(b_a, d_d);                //bd       ad
+  return _mm512_fmaddsub_ps(a, c_c, bd_ad);            //ac - bd  bc + ad
+}
+
+template <> Vec256<c10::complex<float>> inline operator/(const Vec256<c10::complex<float>> &a, const Vec256<c10::complex<float>> &b) {
+  //re + im*i = (a + bi)  / (c + di)
+  //re = (ac + bd)/abs_2()
+  //im = (bc - ad)/abs_2()
+  auto c_c = _mm512_moveldup_ps(b);                    //c        c
+  auto d_d = _mm512_movehdup_ps(b);                    //d        d
+  auto b_a = _mm512_permute_ps(a, 0xB1);               //b        a
+  auto bd_ad = _mm512_mul_ps(b_a, d_d);                //bd       ad
+  auto re_im = _mm512_fmsubadd_ps(a, c_c, bd_ad);      //ac + bd  bc - ad
+  return _mm512_div_ps(re_im, b.abs_2_());
+}
+
+// reciprocal. Implement this here so we can use multiplication.
+Vec256<c10::complex<float>> Vec256<c10::complex<float>>::reciprocal() const {
+  //re + im*i = (a + bi)  / (c + di)
+  //re = (ac + bd)/abs_2() = c/abs_2()
+  //im = (bc - ad)/abs_2() = d/abs_2()
+  const __m512 sign_mask = _mm512_castsi512_ps(_mm512_set1_epi64(0x8000000000000000));
+  auto c_d = _mm512_xor_ps(sign_mask, values);    //c       -d
+  return _mm512_div_ps(c_d, abs_2_());
+}
+
+Vec256<c10::complex<float>> Vec256<c10::complex<float>>::atan() const {
+  // atan(x) = i/2 * ln((i + z)/(i - z))
+  const __m512 i = _mm512_maskz_mov_ps(0xAAAA, _mm512_set1_ps(1.0));
+  const Vec256 i_half = _mm512_maskz_mov_ps(0xAAAA, _mm512_set1_ps(0.5));
+
+  auto sum = Vec256(_mm512_add_ps(i, values));                      // a        1+b
+  auto sub = Vec256(_mm512_sub_ps(i, values));                      // -a       1-b
+  auto ln = (sum/sub).log();                                        // ln((i + z)/(i - z))
+  return i_half*ln;                                                 // i/2*ln()
+}
+
+template <>
+Vec256<c10::complex<float>> inline maximum(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+  auto abs_a = a.abs_2_();
+  auto abs_b = b.abs_2_();
+  auto mask = _mm512_cmp_ps_mask(abs_a, abs_b, _CMP_LT_OQ);
+  auto max = _mm512_mask_blend_ps(mask, a, b);
+  // Exploit the fact that all-ones is a NaN.
+  auto isnan = _mm512_cmp_ps_mask(abs_a, abs_b, _CMP_UNORD_Q);
+  return _mm512_mask_blend_ps(
+      isnan, max, _mm512_castsi512_ps(_mm512_set1_epi32(static_cast<int>(0xFFFFFFFF))));
+}
+
+template <>
+Vec256<c10::complex<float>> inline minimum(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+  auto abs_a = a.abs_2_();
+  auto abs_b = b.abs_2_();
+  auto mask = _mm512_cmp_ps_mask(abs_a, abs_b, _CMP_GT_OQ);
+  auto min = _mm512_mask_blend_ps(mask, a, b);
+  // Exploit the fact that all-ones is a NaN.
+  auto isnan = _mm512_cmp_ps_mask(abs_a, abs_b, _CMP_UNORD_Q);
+  return _mm512_mask_blend_ps(
+      isnan, min, _mm512_castsi512_ps(_mm512_set1_epi32(static_cast<int>(0xFFFFFFFF))));
+}
+
+template <>
+Vec256<c10::complex<float>> inline clamp(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& min, const Vec256<c10::complex<float>>& max) {
+  auto abs_a = a.abs_2_();
+  auto abs_min = min.abs_2_();
+  auto max_mask = _mm512_cmp_ps_mask(abs_a, abs_min, _CMP_LT_OQ);
+  auto abs_max = max.abs_2_();
+  auto min_mask = _mm512_cmp_ps_mask(abs_a, abs_max, _CMP_GT_OQ);
+  return _mm512_mask_blend_ps(min_mask, _mm512_mask_blend_ps(max_mask, a, min), max);
+}
+
+template <>
+Vec256<c10::complex<float>> inline clamp_min(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& min) {
+  auto abs_a = a.abs_2_();
+  auto abs_min = min.abs_2_();
+  auto max_mask = _mm512_cmp_ps_mask(abs_a, abs_min, _CMP_LT_OQ);
+  return _mm512_mask_blend_ps(max_mask, a, min);
+}
+
+template <>
+Vec256<c10::complex<float>> inline clamp_max(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& max) {
+  auto abs_a = a.abs_2_();
+  auto abs_max = max.abs_2_();
+  auto min_mask = _mm512_cmp_ps_mask(abs_a, abs_max, _CMP_GT_OQ);
+  return _mm512_mask_blend_ps(min_mask, a, max);
+}
+
+template <>
+Vec256<c10::complex<float>> inline operator&(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+  return _mm512_and_ps(a, b);
+}
+
+template <>
+Vec256<c10::complex<float>> inline operator|(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+  return _mm512_or_ps(a, b);
+}
+
+template <>
+Vec256<c10::complex<float>> inline operator^(const Vec256<c10::complex<float>>& a, const Vec256<c10::complex<float>>& b) {
+  return _mm512_xor_ps(a, b);
+}
+
+Vec256<c10::complex<float>> Vec256<c10::complex<float>>::eq(
+    const Vec256<c10::complex<float>>& other) const {
+  return (*this == other) & Vec256<c10::complex<float>>(_mm512_set1_ps(1.0f));
+}
+
+Vec256<c10::complex<float>> Vec256<c10::complex<float>>::ne(
+    const Vec256<c10::complex<float>>& other) const {
+  return (*this != other) & Vec256<c10::complex<float>>(_mm512_set1_ps(1.0f));
+}
+
+#endif
+
+}}}
@@ -8,19 +8,38 @@
 
 namespace at { namespace native {
 
+// The AVX512 kernels use instructions from the F, BW, VL and DQ subsets,
+// which are all present starting with Skylake-SP.
+static bool cpu_has_avx512() {
+#if !defined(__powerpc__) && !defined(__s390x__)
+  return cpuinfo_initialize() && cpuinfo_has_x86_avx512f() &&
+      cpuinfo_has_x86_avx512bw() && cpuinfo_has_x86_avx512vl() &&
+      cpuinfo_has_x86_avx512dq() && cpuinfo_has_x86_fma3();
+#else
+  return false;
+#endif
+}
+
 static CPUCapability compute_cpu_capability() {
   auto envar = std::getenv("ATEN_CPU_CAPABILITY");
   if (envar) {
-    if (strcmp(envar, "avx2") == 0) {
+    // AVX512 is only used when asked for: the quantized, Half, int8 and
+    // avx_mathfun kernels have no 512-bit paths yet and run their scalar
+    // code under it, so AVX2 stays the default on AVX512 machines.
+    if (strcmp(envar, "avx512") == 0) {
+      if (cpu_has_avx512()) {
+        return CPUCapability::AVX512;
+      }
+      TORCH_WARN("ignoring ATEN_CPU_CAPABILITY=avx512, which this CPU does not support");
+    } else if (strcmp(envar, "avx2") == 0) {
       return CPUCapability::AVX2;
-    }
-    if (strcmp(envar, "avx") == 0) {
+    } else if (strcmp(envar, "avx") == 0) {
       return CPUCapability::AVX;
-    }
-    if (strcmp(envar, "default") == 0) {
+    } else if (strcmp(envar, "default") == 0) {
       return CPUCapability::DEFAULT;
+    } else {
+      TORCH_WARN("ignoring invalid value for ATEN_CPU_CAPABILITY: ", envar);
     }
-    TORCH_WARN("ignoring invalid value for ATEN_CPU_CAPABILITY: ", envar);
   }
 
 #if !defined(__powerpc__) && !defined(__s390x__)
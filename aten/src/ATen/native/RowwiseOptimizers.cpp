@@ -0,0 +1,179 @@
+// Optimizer updates of the rows of a weight selected by the indices of a
+// sparse gradient, as produced by embedding(sparse=True). Only the selected
+// rows of the weight and of the optimizer state are read and written, in one
+// pass per row, without building sparse tensors for the intermediate results.
+//
+// The indices must not repeat: callers coalesce the gradient first, which
+// sums the gradient rows of repeated indices.
+
+#include <ATen/native/RowwiseOptimizers.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/Parallel.h>
+
+#include <TH/THBlasUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+#include <caffe2/perfkernels/adagrad.h>
+
+namespace at {
+namespace native {
+
+namespace {
+
+// Checks the arguments of a row-wise update of `self` and returns the number
+// of elements in a row.
+int64_t check_rowwise_update(
+    const char* name,
+    const Tensor& self,
+    TensorList states,
+    const Tensor& indices,
+    const Tensor& grad_values) {
+  TORCH_CHECK(self.dim() >= 1, name, ": expected a weight with at least one dimension");
+  TORCH_CHECK(self.is_contiguous(), name, ": expected a contiguous weight");
+  for (const auto& state : states) {
+    TORCH_CHECK(state.sizes() == self.sizes(), name, ": expected a state of size ",
+                self.sizes(), " but got ", state.sizes());
+    TORCH_CHECK(state.scalar_type() == self.scalar_type(), name, ": expected a state of dtype ",
+                self.scalar_type(), " but got ", state.scalar_type());
+    TORCH_CHECK(state.is_contiguous(), name, ": expected a contiguous state");
+  }
+  TORCH_CHECK(indices.dim() == 1 && indices.scalar_type() == kLong, name,
+              ": expected a 1-D tensor of int64 indices");
+  TORCH_CHECK(grad_values.dim() == self.dim() && grad_values.size(0) == indices.numel() &&
+              grad_values.sizes().slice(1) == self.sizes().slice(1), name,
+              ": expected gradient rows of size ", self.sizes().slice(1), " for ",
+              indices.numel(), " indices but got ", grad_values.sizes());
+  TORCH_CHECK(grad_values.scalar_type() == self.scalar_type(), name,
+              ": expected gradient rows of dtype ", self.scalar_type(), " but got ",
+              grad_values.scalar_type());
+  TORCH_CHECK(grad_values.is_contiguous(), name, ": expected contiguous gradient rows");
+
+  const auto num_rows = self.size(0);
+  const auto contiguous_indices = indices.contiguous();
+  const auto* index = contiguous_indices.data_ptr<int64_t>();
+  for (int64_t i = 0; i < indices.numel(); ++i) {
+    TORCH_CHECK(index[i] >= 0 && index[i] < num_rows, name, ": index ", index[i],
+                " is out of bounds for a weight with ", num_rows, " rows");
+  }
+  return num_rows == 0 ? 0 : self.numel() / num_rows;
+}
+
+// The number of rows updated by a task, so that it updates about GRAIN_SIZE
+// elements.
+int64_t rows_per_task(int64_t row_size) {
+  return std::max<int64_t>(1, at::internal::GRAIN_SIZE / row_size);
+}
+
+template <typename scalar_t>
+void adagrad_row(
+    int64_t size,
+    scalar_t* weight,
+    scalar_t* sum,
+    const scalar_t* grad,
+    scalar_t lr,
+    scalar_t eps) {
+  for (int64_t i = 0; i < size; ++i) {
+    const auto s = sum[i] + grad[i] * grad[i];
+    sum[i] = s;
+    weight[i] -= lr * grad[i] / (std::sqrt(s) + eps);
+  }
+}
+
+template <>
+void adagrad_row<float>(
+    int64_t size,
+    float* weight,
+    float* sum,
+    const float* grad,
+    float lr,
+    float eps) {
+  caffe2::adagrad_update(
+      static_cast<int>(size), weight, grad, sum, weight, sum, eps,
+      /*decay=*/1.0f, -lr, /*weight_decay=*/0.0f);
+}
+
+} // namespace
+
+void rowwise_adagrad_cpu_(
+    Tensor& self,
+    Tensor& state_sum,
+    const Tensor& indices,
+    const Tensor& grad_values,
+    double lr,
+    double eps) {
+  const auto row_size = check_rowwise_update(
+      "_rowwise_adagrad_", self, {state_sum}, indices, grad_values);
+  if (indices.numel() == 0 || row_size == 0) {
+    return;
+  }
+  const auto index = indices.contiguous();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "_rowwise_adagrad_", [&] {
+    auto* weight = self.data_ptr<scalar_t>();
+    auto* sum = state_sum.data_ptr<scalar_t>();
+    const auto* grad = grad_values.data_ptr<scalar_t>();
+    const auto* rows = index.data_ptr<int64_t>();
+    at::parallel_for(0, index.numel(), rows_per_task(row_size), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const auto offset = rows[i] * row_size;
+        adagrad_row<scalar_t>(
+            row_size, weight + offset, sum + offset, grad + i * row_size,
+            static_cast<scalar_t>(lr), static_cast<scalar_t>(eps));
+      }
+    });
+  });
+}
+
+void rowwise_adam_cpu_(
+    Tensor& self,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    const Tensor& indices,
+    const Tensor& grad_values,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps) {
+  const auto row_size = check_rowwise_update(
+      "_rowwise_adam_", self, {exp_avg, exp_avg_sq}, indices, grad_values);
+  if (indices.numel() == 0 || row_size == 0) {
+    return;
+  }
+  rowwise_adam_stub(
+      kCPU, self, exp_avg, exp_avg_sq, indices.contiguous(), grad_values,
+      lr, beta1, beta2, eps);
+}
+
+void rowwise_sgd_cpu_(
+    Tensor& self,
+    const Tensor& indices,
+    const Tensor& grad_values,
+    double lr) {
+  const auto row_size = check_rowwise_update(
+      "_rowwise_sgd_", self, {}, indices, grad_values);
+  if (indices.numel() == 0 || row_size == 0) {
+    return;
+  }
+  const auto index = indices.contiguous();
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "_rowwise_sgd_", [&] {
+    auto* weight = self.data_ptr<scalar_t>();
+    auto* grad = grad_values.data_ptr<scalar_t>();
+    const auto* rows = index.data_ptr<int64_t>();
+    at::parallel_for(0, index.numel(), rows_per_task(row_size), [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        THBlas_axpy<scalar_t>(
+            row_size, static_cast<scalar_t>(-lr), grad + i * row_size, 1,
+            weight + rows[i] * row_size, 1);
+      }
+    });
+  });
+}
+
+DEFINE_DISPATCH(rowwise_adam_stub);
+
+} // namespace native
+} // namespace at
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at {
+namespace native {
+
+using rowwise_adam_fn = void (*)(
+    Tensor& self,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    const Tensor& indices,
+    const Tensor& grad_values,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps);
+
+DECLARE_DISPATCH(rowwise_adam_fn, rowwise_adam_stub);
+
+} // namespace native
+} // namespace at
@@ -1,6 +1,7 @@
 #include <ATen/native/TensorIterator.h>
 
 #include <array>
+#include <atomic>
 #include <ATen/ExpandUtils.h>
 #include <ATen/Parallel.h>
 #include <ATen/native/TypeProperties.h>
@@ -1121,6 +1122,174 @@ FastSetupType TensorIterator::compute_fast_setup_type(const TensorIteratorConfig
   return FastSetupType::NONE;
 }
 
+// Note [TensorIterator plan cache]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// For small tensors the work done by build() (broadcasting, type checks,
+// dimension reordering and coalescing) can cost more than the kernel itself.
+// When the plan cache is enabled, build() looks up the result of that work
+// (the "plan") by a key that captures everything it depends on:
+//
+//   - the config flags,
+//   - for every operand: whether it is defined, its dtype, whether it is
+//     also an input, and its sizes and strides.
+//
+// Everything else build() derives (the broadcast shape, common dtype,
+// dimension permutation, strides in bytes, sizes and strides of allocated
+// outputs) is a pure function of this key, so a plan stays valid for as long
+// as it is cached. Checks that depend on data pointers (memory overlap) run
+// on every build. Only CPU builds without named tensors, static shapes or
+// dtypes are cached, and only if they neither resized an output nor created
+// type-promotion temporaries.
+//
+// Plans live in a small direct-mapped cache per thread, so lookups take no
+// locks. clear_plan_cache() invalidates the caches of all threads by bumping
+// a global generation number.
+
+struct TensorIteratorPlan {
+  struct Operand {
+    StrideVector stride_bytes;
+    ScalarType target_dtype;
+    ScalarType current_dtype;
+    Device device = kCPU;
+    // Only used for outputs that build() has to allocate
+    DimVector sizes;
+    DimVector strides;
+  };
+
+  SmallVector<int64_t, 32> key;
+  uint64_t generation = 0;
+  bool valid = false;
+
+  DimVector shape;
+  DimVector perm;
+  bool has_coalesced_dimensions = false;
+  bool all_ops_same_shape = false;
+  ScalarType common_dtype = ScalarType::Undefined;
+  SmallVector<Operand, 4> operands;
+};
+
+namespace {
+
+constexpr size_t kPlanCacheSize = 64;
+
+std::atomic<bool> plan_cache_enabled{false};
+std::atomic<uint64_t> plan_cache_generation{1};
+std::atomic<int64_t> plan_cache_hits{0};
+std::atomic<int64_t> plan_cache_misses{0};
+
+size_t hash_plan_key(const SmallVector<int64_t, 32>& key) {
+  // FNV-1a over the key words
+  uint64_t hash = 14695981039346656037ull;
+  for (int64_t v : key) {
+    hash ^= static_cast<uint64_t>(v);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+TensorIteratorPlan& plan_cache_slot(const SmallVector<int64_t, 32>& key) {
+  static thread_local std::array<TensorIteratorPlan, kPlanCacheSize> cache;
+  return cache[hash_plan_key(key) % kPlanCacheSize];
+}
+
+} // namespace
+
+void TensorIterator::set_plan_cache_enabled(bool enabled) {
+  plan_cache_enabled.store(enabled);
+}
+
+bool TensorIterator::is_plan_cache_enabled() {
+  return plan_cache_enabled.load(std::memory_order_relaxed);
+}
+
+void TensorIterator::clear_plan_cache() {
+  plan_cache_generation++;
+}
+
+TensorIteratorPlanCacheStats TensorIterator::plan_cache_stats() {
+  TensorIteratorPlanCacheStats stats;
+  stats.hits = plan_cache_hits.load();
+  stats.misses = plan_cache_misses.load();
+  return stats;
+}
+
+void TensorIterator::reset_plan_cache_stats() {
+  plan_cache_hits = 0;
+  plan_cache_misses = 0;
+}
+
+bool TensorIterator::compute_plan_key(const TensorIteratorConfig& config, SmallVector<int64_t, 32>& key) const {
+  if (config.static_shape_.has_value() || config.static_dtype_and_device_.has_value()) {
+    return false;
+  }
+  key.push_back(
+      (config.is_reduction_ << 0) |
+      (config.resize_outputs_ << 1) |
+      (config.check_all_same_dtype_ << 2) |
+      (config.check_all_same_device_ << 3) |
+      (config.enforce_safe_casting_to_output_ << 4) |
+      (config.promote_inputs_to_common_dtype_ << 5) |
+      (config.cast_common_dtype_to_outputs_ << 6) |
+      (config.allow_cpu_scalars_ << 7));
+  key.push_back(num_outputs_);
+  key.push_back(ntensors());
+  for (const auto& op : operands_) {
+    const auto& t = op.tensor;
+    if (!t.defined()) {
+      key.push_back(-1);
+      continue;
+    }
+    if (op.device != kCPU || t.has_names()) {
+      return false;
+    }
+    key.push_back(static_cast<int64_t>(op.current_dtype) | (op.is_read_write << 8));
+    key.push_back(t.dim());
+    key.append(t.sizes().begin(), t.sizes().end());
+    key.append(t.strides().begin(), t.strides().end());
+  }
+  return true;
+}
+
+void TensorIterator::save_plan(TensorIteratorPlan& plan) const {
+  plan.shape = shape_;
+  plan.perm = perm_;
+  plan.has_coalesced_dimensions = has_coalesced_dimensions_;
+  plan.all_ops_same_shape = all_ops_same_shape_;
+  plan.common_dtype = common_dtype_;
+  plan.operands.resize(ntensors());
+  for (int i = 0; i < ntensors(); i++) {
+    const auto& op = operands_[i];
+    auto& plan_op = plan.operands[i];
+    plan_op.stride_bytes = op.stride_bytes;
+    plan_op.target_dtype = op.target_dtype;
+    plan_op.current_dtype = op.current_dtype;
+    plan_op.device = op.device;
+    if (op.is_output) {
+      plan_op.sizes = DimVector(op.tensor.sizes());
+      plan_op.strides = DimVector(op.tensor.strides());
+    }
+  }
+}
+
+void TensorIterator::load_plan(const TensorIteratorPlan& plan) {
+  shape_ = plan.shape;
+  perm_ = plan.perm;
+  has_coalesced_dimensions_ = plan.has_coalesced_dimensions;
+  all_ops_same_shape_ = plan.all_ops_same_shape;
+  common_dtype_ = plan.common_dtype;
+  for (int i = 0; i < ntensors(); i++) {
+    auto& op = operands_[i];
+    const auto& plan_op = plan.operands[i];
+    op.stride_bytes = plan_op.stride_bytes;
+    op.target_dtype = plan_op.target_dtype;
+    op.device = plan_op.device;
+    if (!op.tensor.defined()) {
+      op.tensor = at::empty_strided(plan_op.sizes, plan_op.strides, op.options());
+    }
+    op.current_dtype = plan_op.current_dtype;
+  }
+}
+
 TensorIterator::TensorIterator(TensorIteratorConfig& config) {
   build(config);
 }
@@ -1136,10 +1305,31 @@ void TensorIterator::build(TensorIteratorConfig& config) {
   // Check that the outputs have no internal overlap
   // and do not share memory with inputs.
   compute_mem_overlaps(config);
+
+  // reuse a cached plan if possible, see Note [TensorIterator plan cache]
+  SmallVector<int64_t, 32> plan_key;
+  bool cacheable = is_plan_cache_enabled() && compute_plan_key(config, plan_key);
+  if (cacheable) {
+    auto& plan = plan_cache_slot(plan_key);
+    if (plan.valid && plan.generation == plan_cache_generation.load() &&
+        plan.key == plan_key) {
+      plan_cache_hits.fetch_add(1, std::memory_order_relaxed);
+      load_plan(plan);
+      finish_build();
+      return;
+    }
+    plan_cache_misses.fetch_add(1, std::memory_order_relaxed);
+  }
+
   // Check that input dimensions are aligned correctly & compute outnames.
   compute_names(config);
   // compute the broadcasted shape
   compute_shape(config);
+  // outputs resized below have side effects a cached plan would not replay
+  for (int i = 0; cacheable && i < num_outputs_; i++) {
+    const auto& tensor = operands_[i].tensor;
+    cacheable = !tensor.defined() || tensor.sizes().equals(shape_);
+  }
   // resize outputs if necessary
   resize_outputs(config);
   // compute the result dtype and device
@@ -1158,6 +1348,24 @@ void TensorIterator::build(TensorIteratorConfig& config) {
   // perform name inference
   propagate_names_to_outputs();
 
+  if (cacheable) {
+    // type promotion temporaries have to be created on every build
+    bool has_temporaries = std::any_of(
+        operands_.begin(), operands_.end(),
+        [](const OperandInfo& op) { return op.original_tensor.defined(); });
+    if (!has_temporaries) {
+      auto& plan = plan_cache_slot(plan_key);
+      save_plan(plan);
+      plan.key = std::move(plan_key);
+      plan.generation = plan_cache_generation.load();
+      plan.valid = true;
+    }
+  }
+
+  finish_build();
+}
+
+void TensorIterator::finish_build() {
   for (auto& op : operands_) {
     TORCH_INTERNAL_ASSERT(op.tensor.defined());
     op.data = op.tensor.data_ptr();
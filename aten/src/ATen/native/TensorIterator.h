@@ -129,6 +129,15 @@ enum class FastSetupType : uint8_t {
 };
 
 class TensorIteratorConfig;
+struct TensorIteratorPlan;
+
+// Counters of the plan cache, see Note [TensorIterator plan cache]
+struct TensorIteratorPlanCacheStats {
+  // COUNT: builds that reused a cached plan
+  int64_t hits = 0;
+  // COUNT: cacheable builds that had to compute their plan
+  int64_t misses = 0;
+};
 
 struct CAFFE2_API TensorIterator {
   using DimMask = std::bitset<64>;
@@ -285,6 +294,14 @@ struct CAFFE2_API TensorIterator {
   /// CUDA reductions.
   bool is_final_output() const { return final_output_; }
 
+  /// Plan cache controls, see Note [TensorIterator plan cache]
+  static void set_plan_cache_enabled(bool enabled);
+  static bool is_plan_cache_enabled();
+  /// Drops the cached plans of all threads
+  static void clear_plan_cache();
+  static TensorIteratorPlanCacheStats plan_cache_stats();
+  static void reset_plan_cache_stats();
+
   bool has_contiguous_first_dim() const {
     int num_tensors = ntensors();
     for (int i = 0; i < num_tensors; i++) {
@@ -315,6 +332,10 @@ protected:
   void resize_outputs(const TensorIteratorConfig&);
   void propagate_names_to_outputs();
   void coalesce_dimensions();
+  bool compute_plan_key(const TensorIteratorConfig&, SmallVector<int64_t, 32>& key) const;
+  void save_plan(TensorIteratorPlan&) const;
+  void load_plan(const TensorIteratorPlan&);
+  void finish_build();
 
   template <int dim, MemoryFormat memory_format> bool requires_channels_last_nd_output();
   bool requires_channels_last_2d_output();
@@ -256,7 +256,27 @@ void elu_backward_kernel(TensorIterator& it, Scalar alpha, Scalar scale, Scalar
 // y = 0.5x * (1 + tanh(sqrt(2/Pi) * (x + 0.044715x^3)))
 // and the fast tanh impl from Eigen.
 void GeluKernelImpl(TensorIterator& it) {
-  if (at::hasMKL() && it.is_contiguous()) {
+  if (it.dtype() == kBFloat16) {
+    // Compute in float and round once, see [Note BFloat16 arithmetic in fp32].
+    using fVec = vec256::Vec256<float>;
+    const fVec kAlphaVec(M_SQRT1_2);
+    const fVec kOneVec(1);
+    const fVec kPointFiveVec(0.5);
+    cpu_kernel_vec(
+        it,
+        [](BFloat16 x) -> BFloat16 {
+          constexpr float kAlpha = M_SQRT1_2;
+          const float x0 = static_cast<float>(x);
+          return x0 * 0.5f * (1.0f + std::erf(x0 * kAlpha));
+        },
+        [&](vec256::Vec256<BFloat16> x_vec) {
+          fVec x0, x1;
+          std::tie(x0, x1) = convert_bfloat16_float(x_vec);
+          x0 = x0 * kPointFiveVec * (kOneVec + (x0 * kAlphaVec).erf());
+          x1 = x1 * kPointFiveVec * (kOneVec + (x1 * kAlphaVec).erf());
+          return convert_float_bfloat16(x0, x1);
+        });
+  } else if (at::hasMKL() && it.is_contiguous()) {
     AT_DISPATCH_FLOATING_TYPES(it.dtype(), "GeluKernelImpl", [&]() {
       GeluMKLKernelImpl<scalar_t>(&it);
     });
@@ -281,7 +301,39 @@ void GeluKernelImpl(TensorIterator& it) {
 }
 
 void GeluBackwardKernelImpl(TensorIterator& it) {
-  if (hasMKL() && it.is_contiguous()) {
+  if (it.dtype() == kBFloat16) {
+    using fVec = vec256::Vec256<float>;
+    const fVec kAlphaVec(M_SQRT1_2);
+    const fVec kBetaVec(M_2_SQRTPI * M_SQRT1_2 * 0.5);
+    const fVec kOneVec(1);
+    const fVec kPointFiveVec(0.5);
+    const fVec kMinusPointFiveVec(-0.5);
+    auto gelu_backward = [&](fVec dy_vec, fVec x_vec) {
+      const fVec cdf_vec =
+          kPointFiveVec * (kOneVec + (x_vec * kAlphaVec).erf());
+      const fVec pdf_vec =
+          kBetaVec * (x_vec * x_vec * kMinusPointFiveVec).exp();
+      return dy_vec * (cdf_vec + x_vec * pdf_vec);
+    };
+    cpu_kernel_vec(
+        it,
+        [](BFloat16 dy, BFloat16 x) -> BFloat16 {
+          constexpr float kAlpha = M_SQRT1_2;
+          constexpr float kBeta = M_2_SQRTPI * M_SQRT1_2 * 0.5;
+          const float dy0 = static_cast<float>(dy);
+          const float x0 = static_cast<float>(x);
+          const float cdf = 0.5f * (1.0f + std::erf(x0 * kAlpha));
+          const float pdf = kBeta * std::exp(x0 * x0 * -0.5f);
+          return dy0 * (cdf + x0 * pdf);
+        },
+        [&](vec256::Vec256<BFloat16> dy_vec, vec256::Vec256<BFloat16> x_vec) {
+          fVec dy0, dy1, x0, x1;
+          std::tie(dy0, dy1) = convert_bfloat16_float(dy_vec);
+          std::tie(x0, x1) = convert_bfloat16_float(x_vec);
+          return convert_float_bfloat16(
+              gelu_backward(dy0, x0), gelu_backward(dy1, x1));
+        });
+  } else if (hasMKL() && it.is_contiguous()) {
     AT_DISPATCH_FLOATING_TYPES(it.dtype(), "GeluBackwardKernelImpl", [&]() {
       GeluBackwardMKLKernelImpl<scalar_t>(&it);
     });
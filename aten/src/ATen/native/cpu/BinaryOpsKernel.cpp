@@ -499,6 +499,24 @@ void smooth_l1_kernel(TensorIterator& iter) {
 }
 
 void sigmoid_backward_kernel(TensorIterator& iter) {
+  if (iter.dtype() == kBFloat16) {
+    auto one_vec = Vec256<float>((float)(1));
+    cpu_kernel_vec(iter,
+      [=](BFloat16 a, BFloat16 b) -> BFloat16 {
+        float a0 = static_cast<float>(a);
+        float b0 = static_cast<float>(b);
+        return a0 * (float(1) - b0) * b0;
+      },
+      [=](Vec256<BFloat16> a, Vec256<BFloat16> b) {
+        Vec256<float> a0, a1, b0, b1;
+        std::tie(a0, a1) = convert_bfloat16_float(a);
+        std::tie(b0, b1) = convert_bfloat16_float(b);
+        a0 = a0 * (one_vec - b0) * b0;
+        a1 = a1 * (one_vec - b1) * b1;
+        return convert_float_bfloat16(a0, a1);
+      });
+    return;
+  }
   AT_DISPATCH_FLOATING_TYPES(iter.dtype(), "sigmoid_backward_cpu", [&]() {
     auto one_vec = Vec256<scalar_t>((scalar_t)(1));
     cpu_kernel_vec(iter,
@@ -512,6 +530,25 @@ void sigmoid_backward_kernel(TensorIterator& iter) {
 }
 
 void tanh_backward_kernel(TensorIterator& iter) {
+  if (iter.dtype() == kBFloat16) {
+    auto one_vec = Vec256<float>(float{1});
+    cpu_kernel_vec(
+      iter,
+      [=](BFloat16 a, BFloat16 b) -> BFloat16 {
+        float a0 = static_cast<float>(a);
+        float b0 = static_cast<float>(b);
+        return a0 * (float{1} - b0 * b0);
+      },
+      [=](Vec256<BFloat16> a, Vec256<BFloat16> b) {
+        Vec256<float> a0, a1, b0, b1;
+        std::tie(a0, a1) = convert_bfloat16_float(a);
+        std::tie(b0, b1) = convert_bfloat16_float(b);
+        a0 = a0 * (one_vec - b0 * b0);
+        a1 = a1 * (one_vec - b1 * b1);
+        return convert_float_bfloat16(a0, a1);
+      });
+    return;
+  }
   AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES(iter.dtype(), "tanh_backward_cpu", [&]() {
     auto one_vec = Vec256<scalar_t>(scalar_t{1});
     cpu_kernel_vec(
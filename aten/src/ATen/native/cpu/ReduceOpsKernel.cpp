@@ -1,9 +1,11 @@
 #include <numeric>
 #include <iterator>
 #include <algorithm>
+#include <functional>
 
 #include <ATen/Dispatch.h>
 #include <ATen/cpu/vec256/vec256.h>
+#include <ATen/cpu/vec256/functional.h>
 #include <ATen/native/ReduceOps.h>
 #include <ATen/native/ReduceOpsUtils.h>
 #include <ATen/native/TensorIterator.h>
@@ -124,7 +126,125 @@ static void logcumsumexp_cpu_kernel(Tensor& result, const Tensor& self, int64_t
   });
 }
 
+// Sum of BFloat16 that accumulates in float and rounds once per output
+// element, instead of rounding after every addition as the generic
+// binary_kernel_reduce_vec path does. The loop may be called several times
+// for the same output element, so partial sums are kept in a float buffer
+// laid out like the output and only cast to BFloat16 at the end.
+static void bfloat16_sum_kernel(TensorIterator& iter) {
+  using bVec = Vec256<BFloat16>;
+  using fVec = Vec256<float>;
+  auto loop = [&](char** data, const int64_t* strides, int64_t size0, int64_t size1) {
+    int64_t outer_strides[] = { strides[2], strides[3] };
+    if (strides[0] == 0 && strides[1] == sizeof(BFloat16)) {
+      // input is contiguous in dim 0, output is reduced in dim 0
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        float* out = (float*)data[0];
+        *out += vec256::reduce_all<BFloat16>(
+            [](fVec& x, fVec& y) { return x + y; },
+            (const BFloat16*)data[1],
+            size0);
+      });
+    } else if (strides[0] == 0 && strides[2] == sizeof(float) &&
+               strides[3] == sizeof(BFloat16)) {
+      // input and output are contiguous in dim 1; reduce bVec::size()
+      // columns at a time down dim 0
+      int64_t inner_stride = strides[1];
+      int64_t j = 0;
+      for (; j + bVec::size() <= size1; j += bVec::size()) {
+        fVec acc0(0), acc1(0);
+        const char* in = data[1] + j * sizeof(BFloat16);
+        for (int64_t i = 0; i < size0; ++i) {
+          fVec x0, x1;
+          std::tie(x0, x1) = convert_bfloat16_float(bVec::loadu(in + i * inner_stride));
+          acc0 = acc0 + x0;
+          acc1 = acc1 + x1;
+        }
+        float* out = (float*)data[0] + j;
+        (fVec::loadu(out) + acc0).store(out);
+        (fVec::loadu(out + fVec::size()) + acc1).store(out + fVec::size());
+      }
+      for (; j < size1; ++j) {
+        float acc = 0;
+        const char* in = data[1] + j * sizeof(BFloat16);
+        for (int64_t i = 0; i < size0; ++i) {
+          acc += static_cast<float>(*(const BFloat16*)(in + i * inner_stride));
+        }
+        *((float*)data[0] + j) += acc;
+      }
+    } else if (strides[0] == 0) {
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        float acc = 0;
+        const char* in = data[1];
+        for (int64_t i = 0; i < size0; ++i) {
+          acc += static_cast<float>(*(const BFloat16*)in);
+          in += strides[1];
+        }
+        *(float*)data[0] += acc;
+      });
+    } else {
+      UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
+        char* out = data[0];
+        const char* in = data[1];
+        for (int64_t i = 0; i < size0; ++i) {
+          *(float*)out += static_cast<float>(*(const BFloat16*)in);
+          out += strides[0];
+          in += strides[1];
+        }
+      });
+    }
+  };
+
+  const Tensor& out = iter.output();
+  Tensor acc = at::empty_strided(
+      out.sizes(), out.strides(), out.options().dtype(kFloat));
+  // Reduced dimensions have stride 0 in the output; narrowing them gives
+  // views of the output elements without internal overlap.
+  Tensor out_elems = out;
+  Tensor acc_elems = acc;
+  for (int64_t dim = 0; dim < out.dim(); ++dim) {
+    if (out.stride(dim) == 0) {
+      out_elems = out_elems.narrow(dim, 0, 1);
+      acc_elems = acc_elems.narrow(dim, 0, 1);
+    }
+  }
+  acc_elems.zero_();
+
+  auto make_acc_iter = [&](Tensor& acc_out) {
+    return TensorIteratorConfig()
+      .add_output(acc_out)
+      .add_input(iter.input())
+      .resize_outputs(false)
+      .is_reduction(true)
+      .check_all_same_dtype(false)
+      .build();
+  };
+  auto acc_iter = make_acc_iter(acc);
+  if (acc_elems.numel() == 1) {
+    // TensorIterator::parallel_reduce would combine the per-thread partial
+    // sums of a full reduction with `loop`, which expects BFloat16 inputs.
+    float total = at::parallel_reduce(
+        0, acc_iter.numel(), internal::GRAIN_SIZE, 0.f,
+        [&](int64_t begin, int64_t end, float ident) {
+          float partial = ident;
+          Tensor partial_out = at::from_blob(
+              &partial, acc.sizes(), acc.strides(), acc.options());
+          auto sub_iter = make_acc_iter(partial_out);
+          sub_iter.serial_for_each(loop, {begin, end});
+          return partial;
+        },
+        std::plus<float>());
+    acc_elems.fill_(total);
+  } else {
+    acc_iter.parallel_reduce(loop);
+  }
+  out_elems.copy_(acc_elems);
+}
+
 static void sum_kernel_impl(TensorIterator& iter) {
+  if (iter.dtype() == ScalarType::BFloat16) {
+    return bfloat16_sum_kernel(iter);
+  }
   AT_DISPATCH_ALL_TYPES_AND_COMPLEX_AND3(
       ScalarType::BFloat16, ScalarType::Half, ScalarType::Bool, iter.dtype(), "sum_cpu", [&] {
         binary_kernel_reduce_vec(
@@ -164,6 +284,34 @@ static void prod_kernel_impl(TensorIterator& iter) {
   });
 }
 
+// Adapts the float norm ops to BFloat16 input and output, so that the
+// accumulation happens in float and the result is rounded only once.
+template <typename ops_t>
+struct BFloat16NormOps {
+  ops_t ops;
+
+  inline float reduce(float acc, BFloat16 data, int64_t idx) const {
+    return ops.reduce(acc, static_cast<float>(data), idx);
+  }
+
+  inline float combine(float a, float b) const {
+    return ops.combine(a, b);
+  }
+
+  inline BFloat16 project(float a) const {
+    return ops.project(a);
+  }
+
+  static float translate_idx(float acc, int64_t /*base_idx*/) {
+    return acc;
+  }
+};
+
+template <typename ops_t>
+static void bfloat16_norm_kernel(TensorIterator& iter, ops_t ops, float init) {
+  binary_kernel_reduce(iter, BFloat16NormOps<ops_t>{ops}, init);
+}
+
 static void norm_kernel_tensor_iterator_impl(
     TensorIterator& iter,
     Scalar p) {
@@ -177,7 +325,21 @@ static void norm_kernel_tensor_iterator_impl(
   }
 
 
-  if (val == 0) {
+  if (iter.dtype() == kBFloat16) {
+    if (val == 0) {
+      bfloat16_norm_kernel(iter, NormZeroOps<float>(), 0.f);
+    } else if (val == 1) {
+      bfloat16_norm_kernel(iter, NormOneOps<float>(), 0.f);
+    } else if (val == 2) {
+      bfloat16_norm_kernel(iter, NormTwoOps<float>(), 0.f);
+    } else if (val == INFINITY) {
+      bfloat16_norm_kernel(iter, AbsMaxOps<float>(), std::numeric_limits<float>::min());
+    } else if (val == -INFINITY) {
+      bfloat16_norm_kernel(iter, AbsMinOps<float>(), std::numeric_limits<float>::max());
+    } else {
+      bfloat16_norm_kernel(iter, NormOps<float>{val}, 0.f);
+    }
+  } else if (val == 0) {
     AT_DISPATCH_FLOATING_AND_COMPLEX_TYPES_AND1(kHalf, iter.dtype(), "norm_cpu", [&] {
       binary_kernel_reduce(
         iter,
@@ -0,0 +1,79 @@
+#include <ATen/native/RowwiseOptimizers.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+#include <algorithm>
+
+namespace at {
+namespace native {
+namespace {
+
+// Updates the rows of the weight and of the Adam moments selected by the
+// indices, like torch.optim.SparseAdam. The bias corrections are folded in
+// `lr` by the caller.
+static void rowwise_adam_kernel(
+    Tensor& self,
+    Tensor& exp_avg,
+    Tensor& exp_avg_sq,
+    const Tensor& indices,
+    const Tensor& grad_values,
+    double lr,
+    double beta1,
+    double beta2,
+    double eps) {
+  const int64_t row_size = self.numel() / self.size(0);
+  const int64_t grain_size =
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / row_size);
+  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "_rowwise_adam_", [&] {
+    using Vec = vec256::Vec256<scalar_t>;
+    auto* weight_data = self.data_ptr<scalar_t>();
+    auto* exp_avg_data = exp_avg.data_ptr<scalar_t>();
+    auto* exp_avg_sq_data = exp_avg_sq.data_ptr<scalar_t>();
+    const auto* grad_data = grad_values.data_ptr<scalar_t>();
+    const auto* rows = indices.data_ptr<int64_t>();
+    const Vec beta1_vec(static_cast<scalar_t>(beta1));
+    const Vec beta2_vec(static_cast<scalar_t>(beta2));
+    const Vec one_minus_beta1_vec(static_cast<scalar_t>(1 - beta1));
+    const Vec one_minus_beta2_vec(static_cast<scalar_t>(1 - beta2));
+    const Vec eps_vec(static_cast<scalar_t>(eps));
+    const Vec lr_vec(static_cast<scalar_t>(lr));
+
+    at::parallel_for(0, indices.numel(), grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        const auto offset = rows[i] * row_size;
+        auto* weight = weight_data + offset;
+        auto* m = exp_avg_data + offset;
+        auto* v = exp_avg_sq_data + offset;
+        const auto* grad = grad_data + i * row_size;
+        // Updates `count` elements from `d`, which are a whole vector except
+        // at the end of the row.
+        auto update = [&](int64_t d, int64_t count) {
+          const Vec g = Vec::loadu(grad + d, count);
+          const Vec m_vec = Vec::loadu(m + d, count) * beta1_vec + g * one_minus_beta1_vec;
+          const Vec v_vec = Vec::loadu(v + d, count) * beta2_vec + g * g * one_minus_beta2_vec;
+          const Vec w_vec = Vec::loadu(weight + d, count) - lr_vec * m_vec / (v_vec.sqrt() + eps_vec);
+          m_vec.store(m + d, count);
+          v_vec.store(v + d, count);
+          w_vec.store(weight + d, count);
+        };
+        int64_t d = 0;
+        for (; d < row_size - (row_size % Vec::size()); d += Vec::size()) {
+          update(d, Vec::size());
+        }
+        if (row_size - d > 0) {
+          update(d, row_size - d);
+        }
+      }
+    });
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(rowwise_adam_stub, &rowwise_adam_kernel);
+
+} // namespace native
+} // namespace at
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <numeric>
 
 #include <ATen/Dispatch.h>
@@ -28,7 +29,7 @@ inline void _vec_log_softmax_lastdim(
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
-  using Vec = vec256::Vec256<scalar_t>;
+  using Vec = vec256::Vec256<vec256::vec_scalar_t<scalar_t>>;
   static constexpr int64_t CHUNK_SIZE = (128 / sizeof(scalar_t)) * Vec::size();
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size * CHUNK_SIZE);
   if (grain_size < CHUNK_SIZE)
@@ -40,8 +41,8 @@ inline void _vec_log_softmax_lastdim(
       grain_size,
       [&](int64_t begin, int64_t end) {
         for (int64_t ii = begin; ii < end; ii += CHUNK_SIZE) {
-          scalar_t tmp_sum_scalar[CHUNK_SIZE];
-          scalar_t max_input_arr[CHUNK_SIZE];
+          vec256::vec_scalar_t<scalar_t> tmp_sum_scalar[CHUNK_SIZE];
+          vec256::vec_scalar_t<scalar_t> max_input_arr[CHUNK_SIZE];
           int64_t loop_end = CHUNK_SIZE;
           if (ii + CHUNK_SIZE > end)
             loop_end = end - ii;
@@ -56,7 +57,7 @@ inline void _vec_log_softmax_lastdim(
           for (int64_t j = 0; j < loop_end; j++) {
             int64_t i = ii + j;
             scalar_t* input_data = input_data_base + i * dim_size;
-            scalar_t max_input = max_input_arr[j];
+            auto max_input = max_input_arr[j];
             tmp_sum_scalar[j] = vec256::map_reduce_all<scalar_t>(
                 [max_input](Vec x) { return (x - Vec(max_input)).exp(); },
                 [](Vec x, Vec y) { return x + y; },
@@ -74,9 +75,9 @@ inline void _vec_log_softmax_lastdim(
             int64_t i = ii + j;
             scalar_t* input_data = input_data_base + i * dim_size;
             scalar_t* output_data = output_data_base + i * dim_size;
-            scalar_t tmp_sum = tmp_sum_scalar[j];
-            scalar_t max_input = max_input_arr[j];
-            
+            auto tmp_sum = tmp_sum_scalar[j];
+            auto max_input = max_input_arr[j];
+
             // It's necessary to keep the order of the operations below.
             // In some cases that input is large digits and the difference
             // is small, if we compute `max_input` plus `tmp_sum` before,
@@ -132,6 +133,51 @@ inline void _vec_softmax_lastdim(
       });
 }
 
+// BFloat16 keeps the exponentials of a row in a float buffer, so that the
+// normalizing sum and the final scaling see them at full precision and the
+// output is rounded only once.
+template <>
+inline void _vec_softmax_lastdim<BFloat16>(
+    BFloat16* input_data_base,
+    BFloat16* output_data_base,
+    int64_t outer_size,
+    int64_t dim_size) {
+  using fVec = vec256::Vec256<float>;
+  int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
+  if (grain_size < 1)
+    grain_size = 1;
+
+  parallel_for(
+      0,
+      outer_size,
+      grain_size,
+      [&](int64_t begin, int64_t end) {
+        std::unique_ptr<float[]> buffer(new float[dim_size]);
+        float* buffer_data = buffer.get();
+        for (int64_t i = begin; i < end; i++) {
+          BFloat16* input_data = input_data_base + i * dim_size;
+          BFloat16* output_data = output_data_base + i * dim_size;
+          float max_input = vec256::reduce_all<BFloat16>(
+              [](fVec& x, fVec& y) { return vec256::maximum(x, y); },
+              input_data,
+              dim_size);
+          vec256::map(
+              [max_input](fVec x) { return (x - fVec(max_input)).exp(); },
+              buffer_data,
+              input_data,
+              dim_size);
+          float tmp_sum = vec256::reduce_all<float>(
+              [](fVec x, fVec y) { return x + y; }, buffer_data, dim_size);
+          tmp_sum = 1 / tmp_sum;
+          vec256::map(
+              [tmp_sum](fVec x) { return x * fVec(tmp_sum); },
+              output_data,
+              buffer_data,
+              dim_size);
+        }
+      });
+}
+
 template <typename scalar_t, bool log_softmax>
 inline void _vec_host_softmax_backward_lastdim(
     scalar_t* grad_input_data_base,
@@ -139,7 +185,7 @@ inline void _vec_host_softmax_backward_lastdim(
     scalar_t* output_data_base,
     int64_t outer_size,
     int64_t dim_size) {
-  using Vec = vec256::Vec256<scalar_t>;
+  using Vec = vec256::Vec256<vec256::vec_scalar_t<scalar_t>>;
   int64_t grain_size = internal::GRAIN_SIZE / (16 * dim_size);
   if (grain_size < 1)
     grain_size = 1;
@@ -153,7 +199,7 @@ inline void _vec_host_softmax_backward_lastdim(
           scalar_t* grad_input_data = grad_input_data_base + i * dim_size;
           scalar_t* grad_data = grad_data_base + i * dim_size;
           scalar_t* output_data = output_data_base + i * dim_size;
-          scalar_t sum;
+          vec256::vec_scalar_t<scalar_t> sum;
           if (log_softmax) {
             sum = vec256::reduce_all<scalar_t>(
                 [](Vec& x, Vec& y) { return x + y; }, grad_data, dim_size);
@@ -224,9 +270,10 @@ struct vec_host_softmax_backward_lastdim {
 };
 
 static void softmax_lastdim_kernel_impl(Tensor& result, const Tensor& self) {
-  AT_DISPATCH_FLOATING_TYPES(self.scalar_type(), "softmax_lastdim_kernel_impl", [&] {
-    vec_host_softmax_lastdim<scalar_t, false>::apply(result, self);
-  });
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, self.scalar_type(),
+      "softmax_lastdim_kernel_impl",
+      [&] { vec_host_softmax_lastdim<scalar_t, false>::apply(result, self); });
 }
 
 static void log_softmax_lastdim_kernel_impl(
@@ -242,8 +289,9 @@ static void softmax_backward_lastdim_kernel_impl(
     Tensor& grad_input,
     const Tensor& grad,
     const Tensor& output) {
-  AT_DISPATCH_FLOATING_TYPES(
-      grad.scalar_type(), "softmax_backward_lastdim_kernel_impl", [&] {
+  AT_DISPATCH_FLOATING_TYPES_AND(
+      at::ScalarType::BFloat16, grad.scalar_type(),
+      "softmax_backward_lastdim_kernel_impl", [&] {
         vec_host_softmax_backward_lastdim<scalar_t, false>::apply(
             grad_input, grad, output);
       });
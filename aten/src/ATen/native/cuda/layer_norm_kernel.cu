@@ -24,8 +24,8 @@ __global__ void RowwiseMomentsCUDAKernel(
     int64_t N,
     T eps,
     const T* X,
-    T* mean,
-    T* rstd) {
+    acc_type<T, true>* mean,
+    acc_type<T, true>* rstd) {
   using T_ACC = acc_type<T, true>;
   __shared__ T_ACC m_shared[C10_WARP_SIZE];
   __shared__ T_ACC v_shared[C10_WARP_SIZE];
@@ -52,8 +52,8 @@ template <typename T>
 __global__ void LayerNormForwardCUDAKernel(
     int64_t N,
     const T* X,
-    const T* mean,
-    const T* rstd,
+    const acc_type<T, true>* mean,
+    const acc_type<T, true>* rstd,
     const T* gamma,
     const T* beta,
     T* Y) {
@@ -65,8 +65,7 @@ __global__ void LayerNormForwardCUDAKernel(
         gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
     const T_ACC beta_v =
         beta == nullptr ? T_ACC(0) : static_cast<T_ACC>(beta[j]);
-    Y[index] = (static_cast<T_ACC>(X[index]) - static_cast<T_ACC>(mean[i])) *
-            static_cast<T_ACC>(rstd[i]) * gamma_v +
+    Y[index] = (static_cast<T_ACC>(X[index]) - mean[i]) * rstd[i] * gamma_v +
         beta_v;
   }
 }
@@ -105,8 +104,8 @@ template <typename T>
 __global__ void ComputeGradientFusedParamsCUDAKernel(
     int64_t M,
     int64_t N,
-    const T* mean,
-    const T* rstd,
+    const acc_type<T, true>* mean,
+    const acc_type<T, true>* rstd,
     const acc_type<T, true>* ds,
     const acc_type<T, true>* db,
     acc_type<T, true>* c1,
@@ -115,13 +114,10 @@ __global__ void ComputeGradientFusedParamsCUDAKernel(
   const int64_t index = blockIdx.x * blockDim.x + threadIdx.x;
   if (index < M) {
     const T_ACC s = T_ACC(1) / static_cast<T_ACC>(N);
-    const T_ACC a = (db[index] * static_cast<T_ACC>(mean[index]) - ds[index]) *
-        static_cast<T_ACC>(rstd[index]) * static_cast<T_ACC>(rstd[index]) *
-        static_cast<T_ACC>(rstd[index]) * s;
+    const T_ACC a = (db[index] * mean[index] - ds[index]) * rstd[index] *
+        rstd[index] * rstd[index] * s;
     c1[index] = a;
-    c2[index] =
-        -(a * static_cast<T_ACC>(mean[index]) +
-          db[index] * static_cast<T_ACC>(rstd[index]) * s);
+    c2[index] = -(a * mean[index] + db[index] * rstd[index] * s);
   }
 }
 
@@ -131,7 +127,7 @@ __global__ void LayerNormBackwardCUDAKenrel(
     const T* dY,
     const T* X,
     const T* gamma,
-    const T* a,
+    const acc_type<T, true>* a,
     const acc_type<T, true>* b,
     const acc_type<T, true>* c,
     T* dX) {
@@ -142,7 +138,7 @@ __global__ void LayerNormBackwardCUDAKenrel(
     const T_ACC gamma_v =
         gamma == nullptr ? T_ACC(1) : static_cast<T_ACC>(gamma[j]);
     dX[index] =
-        static_cast<T_ACC>(a[i]) * static_cast<T_ACC>(dY[index]) * gamma_v +
+        a[i] * static_cast<T_ACC>(dY[index]) * gamma_v +
         b[i] * static_cast<T_ACC>(X[index]) + c[i];
   }
 }
@@ -153,8 +149,8 @@ __global__ void GammaBetaBackwardSimpleCUDAKernel(
     int64_t N,
     const T* dY,
     const T* X,
-    const T* mean,
-    const T* rstd,
+    const acc_type<T, true>* mean,
+    const acc_type<T, true>* rstd,
     T* dg,
     T* db) {
   using T_ACC = acc_type<T, true>;
@@ -166,8 +162,7 @@ __global__ void GammaBetaBackwardSimpleCUDAKernel(
       const int64_t index = i * N + j;
       sum1 += dg == nullptr ? T_ACC(0)
                             : static_cast<T_ACC>(dY[index]) *
-              (static_cast<T_ACC>(X[index]) - static_cast<T_ACC>(mean[i])) *
-              static_cast<T_ACC>(rstd[i]);
+              (static_cast<T_ACC>(X[index]) - mean[i]) * rstd[i];
       sum2 += db == nullptr ? T_ACC(0) : static_cast<T_ACC>(dY[index]);
     }
     if (dg != nullptr) {
@@ -185,8 +180,8 @@ __global__ void GammaBetaBackwardCUDAKernel(
     int64_t N,
     const T* dY,
     const T* X,
-    const T* mean,
-    const T* rstd,
+    const acc_type<T, true>* mean,
+    const acc_type<T, true>* rstd,
     T* dg,
     T* db) {
   using T_ACC = acc_type<T, true>;
@@ -205,14 +200,12 @@ __global__ void GammaBetaBackwardCUDAKernel(
       const int64_t index2 = i2 * N + j;
       dg_sum1 += dg == nullptr ? T_ACC(0)
                                : static_cast<T_ACC>(dY[index1]) *
-              (static_cast<T_ACC>(X[index1]) - static_cast<T_ACC>(mean[i1])) *
-              static_cast<T_ACC>(rstd[i1]);
+              (static_cast<T_ACC>(X[index1]) - mean[i1]) * rstd[i1];
       db_sum1 += db == nullptr ? T_ACC(0) : static_cast<T_ACC>(dY[index1]);
       if (i2 < M) {
         dg_sum2 += dg == nullptr ? T_ACC(0)
                                  : static_cast<T_ACC>(dY[index2]) *
-                (static_cast<T_ACC>(X[index2]) - static_cast<T_ACC>(mean[i2])) *
-                static_cast<T_ACC>(rstd[i2]);
+                (static_cast<T_ACC>(X[index2]) - mean[i2]) * rstd[i2];
         db_sum2 += db == nullptr ? T_ACC(0) : static_cast<T_ACC>(dY[index2]);
       }
     }
@@ -265,6 +258,7 @@ void LayerNormKernelImplInternal(
     Tensor* Y,
     Tensor* mean,
     Tensor* rstd) {
+  using T_ACC = acc_type<T, true>;
   DCHECK_EQ(X.numel(), M * N);
   DCHECK(!gamma.defined() || gamma.numel() == N);
   DCHECK(!beta.defined() || beta.numel() == N);
@@ -272,8 +266,8 @@ void LayerNormKernelImplInternal(
   const T* gamma_data = gamma.defined() ? gamma.data_ptr<T>() : nullptr;
   const T* beta_data = beta.defined() ? beta.data_ptr<T>() : nullptr;
   T* Y_data = Y->data_ptr<T>();
-  T* mean_data = mean->data_ptr<T>();
-  T* rstd_data = rstd->data_ptr<T>();
+  T_ACC* mean_data = mean->data_ptr<T_ACC>();
+  T_ACC* rstd_data = rstd->data_ptr<T_ACC>();
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
   RowwiseMomentsCUDAKernel<T>
       <<<M, cuda_utils::kCUDABlockReduceNumThreads, 0, cuda_stream>>>(
@@ -322,14 +316,14 @@ void LayerNormBackwardKernelImplInternal(
   DCHECK(!gamma.defined() || gamma.numel() == N);
   const T* dY_data = dY.template data_ptr<T>();
   const T* X_data = X.template data_ptr<T>();
-  const T* mean_data = mean.template data_ptr<T>();
-  const T* rstd_data = rstd.template data_ptr<T>();
+  const T_ACC* mean_data = mean.template data_ptr<T_ACC>();
+  const T_ACC* rstd_data = rstd.template data_ptr<T_ACC>();
   const T* gamma_data =
       gamma.defined() ? gamma.template data_ptr<T>() : nullptr;
   T* dX_data = dX->defined() ? dX->template data_ptr<T>() : nullptr;
   cudaStream_t cuda_stream = at::cuda::getCurrentCUDAStream();
   if (dX_data != nullptr) {
-    const auto kAccType = (X.scalar_type() == kHalf || X.scalar_type() == kBFloat16) ? kFloat : X.scalar_type();
+    const auto kAccType = layer_norm_stats_type(X.scalar_type());
     Tensor ds = at::empty({M}, X.options().dtype(kAccType));
     Tensor db = at::empty({M}, X.options().dtype(kAccType));
     Tensor scale = at::empty({M}, X.options().dtype(kAccType));
@@ -428,8 +422,9 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_cuda(
     int64_t N,
     double eps) {
   Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
-  Tensor mean = at::empty({M}, X.options());
-  Tensor rstd = at::empty({M}, X.options());
+  const auto stats_type = layer_norm_stats_type(X.scalar_type());
+  Tensor mean = at::empty({M}, X.options().dtype(stats_type));
+  Tensor rstd = at::empty({M}, X.options().dtype(stats_type));
   if (M > 0) {
     LayerNormKernelImpl(X, gamma, beta, M, N, eps, &Y, &mean, &rstd);
   }
@@ -458,8 +453,10 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cuda(
     dbeta = M > 0 ? at::native::empty_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT) : at::native::zeros_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
   if (M > 0) {
+    const auto stats_type = layer_norm_stats_type(X.scalar_type());
     LayerNormBackwardKernelImpl(
-        dY, X, mean, rstd, gamma, M, N, &dX, &dgamma, &dbeta);
+        dY, X, mean.to(stats_type), rstd.to(stats_type), gamma, M, N, &dX,
+        &dgamma, &dbeta);
   }
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
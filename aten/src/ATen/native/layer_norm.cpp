@@ -25,8 +25,9 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_cpu(
     int64_t N,
     double eps) {
   Tensor Y = at::native::empty_like(X, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
-  Tensor mean = at::empty({M}, X.options());
-  Tensor rstd = at::empty({M}, X.options());
+  const auto stats_type = layer_norm_stats_type(X.scalar_type());
+  Tensor mean = at::empty({M}, X.options().dtype(stats_type));
+  Tensor rstd = at::empty({M}, X.options().dtype(stats_type));
   if (M > 0) {
     LayerNormKernel(kCPU, X, gamma, beta, M, N, eps, &Y, &mean, &rstd);
   }
@@ -55,8 +56,10 @@ std::tuple<Tensor, Tensor, Tensor> layer_norm_backward_cpu(
     dbeta = M > 0 ? at::native::empty_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT) : at::native::zeros_like(gamma, LEGACY_CONTIGUOUS_MEMORY_FORMAT);
   }
   if (M > 0) {
+    const auto stats_type = layer_norm_stats_type(X.scalar_type());
     LayerNormBackwardKernel(
-        kCPU, dY, X, mean, rstd, gamma, M, N, &dX, &dgamma, &dbeta);
+        kCPU, dY, X, mean.to(stats_type), rstd.to(stats_type), gamma, M, N,
+        &dX, &dgamma, &dbeta);
   }
   return std::make_tuple(std::move(dX), std::move(dgamma), std::move(dbeta));
 }
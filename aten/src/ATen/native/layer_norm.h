@@ -72,6 +72,13 @@ std::tuple<Tensor, Tensor, Tensor, int64_t, int64_t> _prepare_layer_norm_inputs(
 
 } // namespace
 
+// The mean and rstd of reduced precision inputs are computed, returned and
+// taken by the backward pass in float, on every backend, so that they are
+// never rounded to the input type.
+inline ScalarType layer_norm_stats_type(ScalarType input_type) {
+  return input_type == kHalf || input_type == kBFloat16 ? kFloat : input_type;
+}
+
 using forward_fn = void (*)(
     const Tensor& /* X */,
     const Tensor& /* gamma */,
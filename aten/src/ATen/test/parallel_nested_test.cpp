@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+// Runs in its own binary: nested parallelism and the number of threads can
+// only be set before any parallel work has started.
+
+#if AT_PARALLEL_NATIVE
+TEST(TestParallelNested, NestedParallelFor) {
+  at::internal::set_nested_parallelism_enabled(true);
+  at::set_num_threads(4);
+  ASSERT_TRUE(at::internal::nested_parallelism_enabled());
+
+  // Two outer tasks leave two of the four threads idle for the inner regions.
+  // Each index must still be visited exactly once, the outer region state
+  // restored, and no two threads may run with the same thread number.
+  const int64_t outer = 2;
+  const int64_t inner = 64;
+  const int num_threads = at::get_num_threads();
+  std::vector<std::atomic<int>> visits(outer * inner);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  std::vector<std::atomic<int>> running(num_threads);
+  for (auto& r : running) {
+    r = 0;
+  }
+  std::atomic<bool> duplicate_thread_num{false};
+  std::atomic<int> max_inner_threads{0};
+
+  at::parallel_for(0, outer, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      int thread_num = at::get_thread_num();
+      std::mutex mutex;
+      std::set<std::thread::id> inner_threads;
+      at::parallel_for(0, inner, 1, [&](int64_t inner_begin, int64_t inner_end) {
+        int inner_thread_num = at::get_thread_num();
+        ASSERT_LT(inner_thread_num, num_threads);
+        {
+          std::lock_guard<std::mutex> lk(mutex);
+          inner_threads.insert(std::this_thread::get_id());
+        }
+        for (int64_t j = inner_begin; j < inner_end; ++j) {
+          if (running[inner_thread_num]++ != 0) {
+            duplicate_thread_num = true;
+          }
+          std::this_thread::sleep_for(std::chrono::milliseconds(1));
+          running[inner_thread_num]--;
+          visits[i * inner + j]++;
+        }
+      });
+      ASSERT_TRUE(at::in_parallel_region());
+      ASSERT_EQ(at::get_thread_num(), thread_num);
+      int used = inner_threads.size();
+      int prev = max_inner_threads.load();
+      while (used > prev && !max_inner_threads.compare_exchange_weak(prev, used)) {
+      }
+    }
+  });
+  for (auto& v : visits) {
+    ASSERT_EQ(v.load(), 1);
+  }
+  ASSERT_FALSE(duplicate_thread_num.load());
+  ASSERT_GT(max_inner_threads.load(), 1);
+}
+#endif
@@ -210,3 +210,46 @@ TEST(TensorIteratorTest, FailNonPromotingBinaryOp) {
   config.add_input(at::ones({1,1}, at::dtype(at::kInt)));
   ASSERT_ANY_THROW(config.build());
 }
+
+TEST(TensorIteratorTest, PlanCache) {
+  auto a = at::randn({3, 5});
+  auto b = at::randn({5});
+  auto transposed = at::randn({5, 3}).t();
+  auto expected = a + b;
+  auto expected_transposed = transposed + b;
+
+  bool was_enabled = TensorIterator::is_plan_cache_enabled();
+  TensorIterator::set_plan_cache_enabled(true);
+  TensorIterator::clear_plan_cache();
+  TensorIterator::reset_plan_cache_stats();
+
+  // The first build computes the plan, the second one reuses it.
+  ASSERT_TRUE(at::add(a, b).equal(expected));
+  ASSERT_TRUE(at::add(a, b).equal(expected));
+  auto stats = TensorIterator::plan_cache_stats();
+  ASSERT_EQ(stats.misses, 1);
+  ASSERT_EQ(stats.hits, 1);
+
+  // Different strides produce a different plan, and a cached plan must
+  // reproduce the output layout.
+  ASSERT_TRUE(at::add(transposed, b).equal(expected_transposed));
+  auto out = at::add(transposed, b);
+  ASSERT_TRUE(out.equal(expected_transposed));
+  ASSERT_EQ(out.strides(), expected_transposed.strides());
+  stats = TensorIterator::plan_cache_stats();
+  ASSERT_EQ(stats.misses, 2);
+  ASSERT_EQ(stats.hits, 2);
+
+  // Outputs that get resized are not cached.
+  auto resized = at::empty({0});
+  at::add_out(resized, a, b);
+  ASSERT_TRUE(resized.equal(expected));
+
+  // Clearing invalidates all plans.
+  TensorIterator::clear_plan_cache();
+  TensorIterator::reset_plan_cache_stats();
+  ASSERT_TRUE(at::add(a, b).equal(expected));
+  ASSERT_EQ(TensorIterator::plan_cache_stats().hits, 0);
+
+  TensorIterator::set_plan_cache_enabled(was_enabled);
+}
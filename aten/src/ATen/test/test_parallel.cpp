@@ -4,9 +4,14 @@
 #include <ATen/DLConvertor.h>
 #include <ATen/Parallel.h>
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <string.h>
 #include <sstream>
+#include <thread>
+#include <utility>
 
 using namespace at;
 
@@ -69,3 +74,92 @@ TEST(TestParallel, IntraOpLaunchFuture) {
 
   ASSERT_TRUE(v1 == 1 && v2 == 2);
 }
+
+TEST(TestParallel, EveryIndexOnce) {
+  // Skewed per-index cost exercises chunk splitting and stealing in the
+  // work-stealing backend; every backend must still visit each index once.
+  const int64_t n = 10007;
+  std::vector<std::atomic<int>> visits(n);
+  for (auto& v : visits) {
+    v = 0;
+  }
+  at::parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (i % 1000 == 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+      }
+      visits[i]++;
+    }
+  });
+  for (auto& v : visits) {
+    ASSERT_EQ(v.load(), 1);
+  }
+
+  int64_t sum = at::parallel_reduce(
+      0, n, 1, (int64_t)0,
+      [](int64_t begin, int64_t end, int64_t ident) {
+        int64_t partial = ident;
+        for (int64_t i = begin; i < end; ++i) {
+          partial += i;
+        }
+        return partial;
+      },
+      std::plus<int64_t>());
+  ASSERT_EQ(sum, n * (n - 1) / 2);
+}
+
+TEST(TestParallel, ReduceCombinesInOrder) {
+  // Partial results are [begin, end) ranges, and combining them is only
+  // valid for adjacent ranges in order, so `sf` is not commutative.
+  using Range = std::pair<int64_t, int64_t>;
+  const int64_t n = 10007;
+  const Range ident(-1, -1);
+  const Range invalid(-2, -2);
+  Range range = at::parallel_reduce(
+      0, n, 1, ident,
+      [&](int64_t begin, int64_t end, Range partial) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i % 1000 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+          }
+        }
+        return partial == ident ? Range(begin, end) : invalid;
+      },
+      [&](Range a, Range b) {
+        if (a == ident) {
+          return b;
+        }
+        if (b == ident) {
+          return a;
+        }
+        return a.second == b.first ? Range(a.first, b.second) : invalid;
+      });
+  ASSERT_EQ(range, Range(0, n));
+}
+
+#if AT_PARALLEL_NATIVE
+TEST(TestParallel, ReduceSplitsIntoStealableChunks) {
+  // Skewed work: the first tenth of the range is much slower. The range is
+  // split into more chunks than threads so that threads done with the cheap
+  // part can take over pending chunks of the slow one.
+  const int64_t n = 100000;
+  std::atomic<int64_t> calls{0};
+  int64_t sum = at::parallel_reduce(
+      0, n, 1, (int64_t)0,
+      [&](int64_t begin, int64_t end, int64_t partial) {
+        calls++;
+        for (int64_t i = begin; i < end; ++i) {
+          if (i < n / 10 && i % 100 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds(10));
+          }
+          partial += i;
+        }
+        return partial;
+      },
+      std::plus<int64_t>());
+  ASSERT_EQ(sum, n * (n - 1) / 2);
+  if (at::get_num_threads() > 1) {
+    ASSERT_GT(calls.load(), (int64_t)at::get_num_threads());
+  }
+}
+#endif
@@ -0,0 +1,115 @@
+"""Microbenchmark for the overhead of the autograd engine.
+
+Each workload builds a backward graph made of many nodes that do very little
+work on tiny CPU tensors, so that the time of a backward pass is dominated by
+scheduling nodes (ready queue pushes and pops, dependency tracking) rather
+than by the kernels themselves.
+
+    python benchmarks/autograd_engine/backward_bench.py --nodes 10000
+
+With --cpu-workers, ready CPU nodes on independent branches are also run by
+that many extra autograd threads (see Note [Parallel CPU backward]), which
+pays off with larger tensors, e.g. for the towers workload:
+
+    python benchmarks/autograd_engine/backward_bench.py --workloads towers \
+        --nodes 64 --size 100000 --cpu-workers 4
+"""
+import argparse
+import statistics
+import timeit
+
+import torch
+
+
+def chain(x, num_nodes):
+    # A single long chain: every node makes exactly one other node ready.
+    for _ in range(num_nodes):
+        x = x * 1.0
+    return x
+
+
+def fan_out(x, num_nodes):
+    # Many short independent branches summed together.
+    branches = [x * 1.0 for _ in range(num_nodes // 2)]
+    return torch.stack(branches).sum(0)
+
+
+def diamonds(x, num_nodes):
+    # A chain of diamonds: every node makes two nodes ready, one of which has
+    # to wait for the other.
+    for _ in range(num_nodes // 3):
+        x = x * 1.0 + x
+    return x
+
+
+def towers(x, num_nodes):
+    # Eight independent chains, like the towers of a multi-tower model.
+    outs = []
+    for i in range(8):
+        y = x
+        for _ in range(num_nodes // 8):
+            y = y.sin()
+        outs.append(y)
+    return sum(outs)
+
+
+WORKLOADS = {
+    'chain': chain,
+    'fan_out': fan_out,
+    'diamonds': diamonds,
+    'towers': towers,
+}
+
+
+def run(workload, num_nodes, size, repeat, number):
+    x = torch.randn(size, requires_grad=True)
+
+    def step():
+        out = workload(x, num_nodes).sum()
+        out.backward()
+
+    # Time the forward pass separately so that the backward time can be
+    # isolated from the cost of building the graph.
+    forward_times = timeit.repeat(
+        lambda: workload(x, num_nodes).sum(), repeat=repeat, number=number)
+    total_times = timeit.repeat(step, repeat=repeat, number=number)
+    forward = statistics.median(forward_times) / number
+    backward = statistics.median(total_times) / number - forward
+    return forward, backward
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--nodes', type=int, default=10000,
+                        help='approximate number of nodes in each graph')
+    parser.add_argument('--size', type=int, default=1,
+                        help='number of elements in each tensor')
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--number', type=int, default=10)
+    parser.add_argument('--threads', type=int, default=1,
+                        help='intra-op threads, see torch.set_num_threads')
+    parser.add_argument('--cpu-workers', type=int, default=0,
+                        help='extra autograd threads running CPU nodes')
+    parser.add_argument('--workloads', nargs='+', default=list(WORKLOADS),
+                        choices=list(WORKLOADS))
+    args = parser.parse_args()
+
+    torch.set_num_threads(args.threads)
+    torch.autograd._set_num_cpu_workers(args.cpu_workers)
+    print('{:<10} {:>8} {:>14} {:>14} {:>12}'.format(
+        'workload', 'nodes', 'forward (ms)', 'backward (ms)', 'us/node'))
+    for name in args.workloads:
+        forward, backward = run(WORKLOADS[name], args.nodes, args.size,
+                                args.repeat, args.number)
+        print('{:<10} {:>8} {:>14.2f} {:>14.2f} {:>12.3f}'.format(
+            name, args.nodes, forward * 1e3, backward * 1e3,
+            backward * 1e6 / args.nodes))
+    if args.cpu_workers > 0:
+        stats = torch.autograd._cpu_worker_stats()
+        print('nodes run by workers: {}/{}, max concurrent nodes: {}'.format(
+            stats['nodes_run_by_workers'], stats['nodes_run'],
+            stats['max_concurrent_nodes']))
+
+
+if __name__ == '__main__':
+    main()
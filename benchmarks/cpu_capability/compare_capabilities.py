@@ -0,0 +1,95 @@
+"""Microbenchmark comparing the ATen CPU kernels built for two capabilities.
+
+The capability is picked once per process from ATEN_CPU_CAPABILITY, so every
+capability is timed in its own subprocess and the times are compared:
+
+    python benchmarks/cpu_capability/compare_capabilities.py
+
+AVX512 is opt-in: without ATEN_CPU_CAPABILITY, AVX2 kernels are used even on
+AVX512 machines. This benchmark shows which operators are faster or slower
+with the AVX512 kernels, including the quantized, Half and int8 ones, which
+have no 512-bit paths yet.
+"""
+import argparse
+import json
+import os
+import subprocess
+import sys
+import timeit
+
+import torch
+
+
+def make_ops(size):
+    x = torch.randn(size)
+    y = torch.randn(size)
+    xd = x.double()
+    xb = x.bfloat16()
+    xi8 = torch.randint(-100, 100, (size,), dtype=torch.int8)
+    xq = torch.quantize_per_tensor(x, 0.1, 0, torch.quint8)
+    yq = torch.quantize_per_tensor(y, 0.1, 0, torch.quint8)
+    x4d = torch.randn(16, 64, 32, 32)
+    return {
+        'add_float': lambda: torch.add(x, y),
+        'mul_double': lambda: torch.mul(xd, xd),
+        'exp_float': lambda: torch.exp(x),
+        'sigmoid_float': lambda: torch.sigmoid(x),
+        'sum_float': lambda: torch.sum(x),
+        'sum_bfloat16': lambda: torch.sum(xb),
+        'softmax_float': lambda: torch.softmax(x4d, -1),
+        'normal_float': lambda: x.normal_(),
+        'add_int8': lambda: torch.add(xi8, xi8),
+        'relu_quint8': lambda: torch.relu(xq),
+        'add_quint8': lambda: torch.ops.quantized.add(xq, yq, 0.1, 0),
+        'quantize_float': lambda: torch.quantize_per_tensor(x, 0.1, 0, torch.quint8),
+    }
+
+
+def run_ops(size, number, repeat):
+    results = {}
+    for name, op in make_ops(size).items():
+        op()
+        times = timeit.repeat(op, number=number, repeat=repeat)
+        results[name] = min(times) / number * 1e6
+    return results
+
+
+def run_capability(capability, args):
+    env = dict(os.environ, ATEN_CPU_CAPABILITY=capability)
+    out = subprocess.check_output(
+        [sys.executable, __file__, '--worker', '--size', str(args.size),
+         '--number', str(args.number), '--repeat', str(args.repeat),
+         '--threads', str(args.threads)],
+        env=env)
+    return json.loads(out.decode())
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--capabilities', default='avx2,avx512',
+                        help='the two capabilities to compare')
+    parser.add_argument('--size', type=int, default=1 << 20)
+    parser.add_argument('--number', type=int, default=20)
+    parser.add_argument('--repeat', type=int, default=5)
+    parser.add_argument('--threads', type=int, default=1)
+    parser.add_argument('--worker', action='store_true', help=argparse.SUPPRESS)
+    args = parser.parse_args()
+
+    torch.set_num_threads(args.threads)
+    if args.worker:
+        print(json.dumps(run_ops(args.size, args.number, args.repeat)))
+        return
+
+    base, other = args.capabilities.split(',')
+    base_times = run_capability(base, args)
+    other_times = run_capability(other, args)
+    print('{:<16} {:>12} {:>12} {:>8}'.format(
+        'op', base + ' (us)', other + ' (us)', 'speedup'))
+    for name, base_time in base_times.items():
+        other_time = other_times[name]
+        print('{:<16} {:>12.1f} {:>12.1f} {:>7.2f}x'.format(
+            name, base_time, other_time, base_time / other_time))
+
+
+if __name__ == '__main__':
+    main()
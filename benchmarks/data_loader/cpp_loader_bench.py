@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+#
+# Measure the throughput of the C++ frontend DataLoader.
+#
+# The dataset returns image-sized example tensors, which are normalized by a
+# per-example transform and collated into batches. This compares the plain
+# pipeline, with the transform applied one example after the other and
+# batches built with torch::stack, against the one that applies the
+# transform with transforms::Parallel and collates with transforms::Stack.
+#
+
+import argparse
+
+from torch.utils.cpp_extension import load_inline
+
+SOURCE = """
+#include <torch/torch.h>
+
+#include <chrono>
+
+using namespace torch::data;
+
+struct Images : datasets::Dataset<Images> {
+  explicit Images(int64_t size) : images(torch::rand({size, 3, 64, 64})) {}
+
+  Example<> get(size_t index) override {
+    return {images[index], torch::tensor(static_cast<int64_t>(index % 10))};
+  }
+
+  torch::optional<size_t> size() const override {
+    return images.size(0);
+  }
+
+  torch::Tensor images;
+};
+
+torch::Tensor normalize(torch::Tensor image) {
+  return image.sub(0.5).div(0.25);
+}
+
+template <typename Dataset>
+double run_loader(Dataset dataset, int64_t workers, int64_t batch_size,
+                  int64_t max_jobs, int64_t epochs) {
+  auto loader = make_data_loader(
+      std::move(dataset),
+      DataLoaderOptions(batch_size).workers(workers).max_jobs(max_jobs));
+  int64_t examples = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int64_t epoch = 0; epoch < epochs; ++epoch) {
+    for (auto& batch : *loader) {
+      examples += batch.data.size(0);
+    }
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return examples / elapsed.count();
+}
+
+double run(bool pipelined, int64_t size, int64_t workers, int64_t batch_size,
+           int64_t max_jobs, int64_t epochs) {
+  if (pipelined) {
+    auto dataset = Images(size)
+        .map(transforms::Parallel<transforms::TensorLambda<>>(
+            transforms::TensorLambda<>(normalize)))
+        .map(transforms::Stack<>());
+    return run_loader(std::move(dataset), workers, batch_size, max_jobs, epochs);
+  }
+  auto dataset = Images(size)
+      .map(transforms::TensorLambda<>(normalize))
+      .map(transforms::Collate<Example<>>([](std::vector<Example<>> examples) {
+        std::vector<torch::Tensor> data, targets;
+        for (auto& example : examples) {
+          data.push_back(example.data);
+          targets.push_back(example.target);
+        }
+        return Example<>(torch::stack(data), torch::stack(targets));
+      }));
+  return run_loader(std::move(dataset), workers, batch_size, max_jobs, epochs);
+}
+"""
+
+
+def main():
+    parser = argparse.ArgumentParser(description="C++ DataLoader benchmark")
+    parser.add_argument("--size", type=int, default=4096)
+    parser.add_argument("--workers", type=int, nargs="+", default=[1, 4])
+    parser.add_argument("--batch-size", type=int, default=256)
+    parser.add_argument("--max-jobs", type=int, default=8)
+    parser.add_argument("--epochs", type=int, default=3)
+    args = parser.parse_args()
+
+    module = load_inline(
+        name="cpp_loader_bench",
+        cpp_sources=SOURCE,
+        functions=["run"],
+        extra_cflags=["-O2"],
+    )
+
+    print("{:>10}{:>12}{:>16}".format("workers", "pipeline", "examples/s"))
+    for workers in args.workers:
+        for pipelined in [False, True]:
+            throughput = module.run(
+                pipelined,
+                args.size,
+                workers,
+                args.batch_size,
+                args.max_jobs,
+                args.epochs,
+            )
+            print(
+                "{:>10}{:>12}{:>16.0f}".format(
+                    workers, "parallel" if pipelined else "serial", throughput
+                )
+            )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+#
+# Measure the Gloo reduce_scatter and alltoall collectives.
+#
+# This program runs a number of processes on the local machine, connected
+# through Gloo's TCP transport over the loopback interface, and compares
+# the native collectives with their emulation on top of allreduce:
+#
+#   reduce_scatter: allreduce the concatenated inputs and keep the slice
+#                   that belongs to this rank.
+#   alltoall:       place the input of this rank in row `rank` of an
+#                   otherwise zero world_size x N matrix, allreduce it and
+#                   keep column block `rank`.
+#
+
+import argparse
+import os
+import time
+
+import torch
+import torch.distributed as dist
+import torch.multiprocessing as mp
+
+
+def measure(fn, warmup, iterations):
+    for _ in range(warmup):
+        fn()
+    dist.barrier()
+    start = time.perf_counter()
+    for _ in range(iterations):
+        fn()
+    dist.barrier()
+    return (time.perf_counter() - start) / iterations
+
+
+def splits(numel, world_size, uneven):
+    if not uneven:
+        return [numel // world_size] * world_size
+    # Split sizes proportional to 1, 2, ..., world_size.
+    total = world_size * (world_size + 1) // 2
+    sizes = [numel * (i + 1) // total for i in range(world_size)]
+    sizes[-1] += numel - sum(sizes)
+    return sizes
+
+
+def bench_reduce_scatter(rank, world_size, numel, uneven, args):
+    sizes = splits(numel, world_size, uneven)
+    inputs = [torch.randn(size) for size in sizes]
+    output = torch.empty(sizes[rank])
+    flat = torch.empty(numel)
+    offset = sum(sizes[:rank])
+
+    def native():
+        dist.reduce_scatter(output, inputs)
+
+    def emulated():
+        torch.cat(inputs, out=flat)
+        dist.all_reduce(flat)
+        output.copy_(flat.narrow(0, offset, sizes[rank]))
+
+    return (
+        measure(native, args.warmup, args.iterations),
+        measure(emulated, args.warmup, args.iterations),
+    )
+
+
+def bench_alltoall(rank, world_size, numel, uneven, args):
+    # Rank i sends send_sizes[j] elements to rank j. For uneven splits the
+    # sizes are rotated by rank, so that every process sends and receives
+    # different amounts.
+    sizes = splits(numel, world_size, uneven)
+    send_sizes = [sizes[(rank + j) % world_size] for j in range(world_size)]
+    recv_sizes = [sizes[(i + rank) % world_size] for i in range(world_size)]
+    input = torch.randn(numel)
+    output = torch.empty(sum(recv_sizes))
+    matrix = torch.zeros(world_size, numel)
+
+    # Offset of the split for this rank in the input of rank i.
+    def offset_in(src):
+        return sum(sizes[(src + j) % world_size] for j in range(rank))
+
+    recv_offsets = [offset_in(i) for i in range(world_size)]
+
+    def native():
+        dist.all_to_all_single(output, input, recv_sizes, send_sizes)
+
+    def emulated():
+        matrix.zero_()
+        matrix[rank].copy_(input)
+        dist.all_reduce(matrix)
+        torch.cat(
+            [matrix[i].narrow(0, recv_offsets[i], recv_sizes[i])
+             for i in range(world_size)],
+            out=output)
+
+    return (
+        measure(native, args.warmup, args.iterations),
+        measure(emulated, args.warmup, args.iterations),
+    )
+
+
+def run(rank, world_size, args):
+    os.environ.setdefault("GLOO_SOCKET_IFNAME", args.interface)
+    dist.init_process_group(
+        "gloo",
+        init_method="tcp://127.0.0.1:%d" % args.port,
+        rank=rank,
+        world_size=world_size)
+
+    benchmarks = {
+        "reduce_scatter": bench_reduce_scatter,
+        "alltoall": bench_alltoall,
+    }
+    if rank == 0:
+        print("%-16s %-7s %12s %12s %12s %8s" % (
+            "collective", "splits", "bytes", "native (us)",
+            "emulated (us)", "speedup"))
+    for name in args.collectives:
+        for uneven in [False, True]:
+            for numel in args.numel:
+                native, emulated = benchmarks[name](
+                    rank, world_size, numel, uneven, args)
+                if rank == 0:
+                    print("%-16s %-7s %12d %12.1f %12.1f %7.2fx" % (
+                        name,
+                        "uneven" if uneven else "even",
+                        numel * 4,
+                        native * 1e6,
+                        emulated * 1e6,
+                        emulated / native))
+
+    dist.destroy_process_group()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Gloo collectives benchmark")
+    parser.add_argument("--world-size", type=int, default=4)
+    parser.add_argument("--port", type=int, default=29500)
+    parser.add_argument("--interface", type=str, default="lo")
+    parser.add_argument("--warmup", type=int, default=5)
+    parser.add_argument("--iterations", type=int, default=20)
+    parser.add_argument(
+        "--collectives",
+        nargs="+",
+        default=["reduce_scatter", "alltoall"],
+        choices=["reduce_scatter", "alltoall"])
+    parser.add_argument(
+        "--numel",
+        type=int,
+        nargs="+",
+        default=[1 << 10, 1 << 14, 1 << 18, 1 << 22],
+        help="number of float32 elements of the input of every process")
+    args = parser.parse_args()
+
+    mp.spawn(run, args=(args.world_size, args), nprocs=args.world_size)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+#
+# Measure RPCs that carry large tensors over loopback.
+#
+# Worker 0 sends a tensor to worker 1, which returns it, as a parameter
+# server does with embedding shards. The reported bandwidth counts the
+# tensor once in each direction.
+#
+
+import argparse
+import multiprocessing
+import os
+import time
+
+import torch
+import torch.distributed.rpc as rpc
+
+
+def identity(tensor):
+    return tensor
+
+
+def run(rank, backend, args, queue):
+    os.environ["MASTER_ADDR"] = "127.0.0.1"
+    os.environ["MASTER_PORT"] = str(args.port)
+    rpc.init_rpc(
+        "worker{}".format(rank),
+        backend=rpc.BackendType[backend],
+        rank=rank,
+        world_size=2,
+    )
+    if rank == 0:
+        results = []
+        for megabytes in args.sizes:
+            tensor = torch.rand(megabytes * 2 ** 20 // 4)
+            rpc.rpc_sync("worker1", identity, args=(tensor,))
+            times = []
+            for _ in range(args.iterations):
+                start = time.perf_counter()
+                rpc.rpc_sync("worker1", identity, args=(tensor,))
+                times.append(time.perf_counter() - start)
+            results.append(sorted(times)[len(times) // 2])
+        queue.put(results)
+    rpc.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="RPC tensor payload benchmark")
+    parser.add_argument(
+        "--sizes",
+        type=int,
+        nargs="+",
+        default=[1, 16, 128, 512],
+        help="tensor sizes in MB",
+    )
+    parser.add_argument(
+        "--backends", nargs="+", default=["PROCESS_GROUP", "TENSORPIPE"]
+    )
+    parser.add_argument("--iterations", type=int, default=10)
+    parser.add_argument("--port", type=int, default=29500)
+    args = parser.parse_args()
+
+    ctx = multiprocessing.get_context("spawn")
+    print("{:>16}{:>10}{:>12}{:>10}".format("backend", "MB", "rpc (ms)", "GB/s"))
+    for backend in args.backends:
+        queue = ctx.Queue()
+        processes = [
+            ctx.Process(target=run, args=(rank, backend, args, queue))
+            for rank in range(2)
+        ]
+        for process in processes:
+            process.start()
+        results = queue.get()
+        for process in processes:
+            process.join()
+        for megabytes, median in zip(args.sizes, results):
+            print(
+                "{:>16}{:>10}{:>12.1f}{:>10.2f}".format(
+                    backend, megabytes, median * 1000, 2 * megabytes / 1024 / median
+                )
+            )
+
+
+if __name__ == "__main__":
+    main()
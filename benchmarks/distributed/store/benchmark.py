@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+#
+# Measure the TCPStore server under a large rendezvous.
+#
+# This program starts a TCPStore server in its own process and simulates
+# thousands of clients on the local machine, spread over a number of
+# processes with one thread per client. Every client goes through the
+# steps of a typical rendezvous:
+#
+#   join:     connect to the server (waits for all clients to connect).
+#   publish:  set a key with its address.
+#   exchange: read the keys of a number of peers, one get per key or a
+#             single multi_get.
+#   barrier:  add to a counter, the last client sets a key that all of
+#             them wait for.
+#
+# The time at which the last client completes a step is reported relative
+# to the start of the benchmark.
+#
+
+import argparse
+import multiprocessing
+import resource
+import socket
+import threading
+import time
+from datetime import timedelta
+
+import torch.distributed as dist
+
+
+STEPS = ["join", "publish", "exchange", "barrier"]
+
+
+def raise_fd_limit():
+    # Every client takes a file descriptor in its own process and one in
+    # the server process.
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+
+
+def find_free_port():
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        sock.bind(("127.0.0.1", 0))
+        return sock.getsockname()[1]
+
+
+def run_client(rank, args, port, timeout, times):
+    store = dist.TCPStore("127.0.0.1", port, args.clients + 1, False, timeout)
+    t_join = time.time()
+
+    store.set("addr/{}".format(rank), "10.0.0.{}:{}".format(rank % 256, rank))
+    t_publish = time.time()
+
+    peers = [
+        "addr/{}".format((rank + i + 1) % args.clients)
+        for i in range(args.peers)
+    ]
+    if args.multi_get:
+        store.multi_get(peers)
+    else:
+        for peer in peers:
+            store.get(peer)
+    t_exchange = time.time()
+
+    if store.add("arrived", 1) == args.clients:
+        store.set("go", "")
+    store.wait(["go"])
+    t_barrier = time.time()
+
+    times[rank] = (t_join, t_publish, t_exchange, t_barrier)
+
+
+def run_process(index, args, port, start, queue):
+    raise_fd_limit()
+    timeout = timedelta(seconds=args.timeout)
+    ranks = range(index, args.clients, args.processes)
+    times = {}
+    threads = [
+        threading.Thread(target=run_client, args=(rank, args, port, timeout, times))
+        for rank in ranks
+    ]
+    start.wait()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    queue.put(times)
+
+
+def run_server(args, port, done):
+    raise_fd_limit()
+    # Returns once all clients have connected.
+    server = dist.TCPStore(  # noqa: F841
+        "127.0.0.1", port, args.clients + 1, True, timedelta(seconds=args.timeout)
+    )
+    done.wait()
+
+
+def wait_for_server(port):
+    while True:
+        try:
+            socket.create_connection(("127.0.0.1", port)).close()
+            return
+        except ConnectionRefusedError:
+            time.sleep(0.01)
+
+
+def run(args):
+    port = find_free_port()
+    ctx = multiprocessing.get_context("spawn")
+    start = ctx.Event()
+    done = ctx.Event()
+    queue = ctx.Queue()
+    server = ctx.Process(target=run_server, args=(args, port, done))
+    server.start()
+    processes = [
+        ctx.Process(target=run_process, args=(i, args, port, start, queue))
+        for i in range(args.processes)
+    ]
+    for process in processes:
+        process.start()
+
+    # Don't let clients back off because the server isn't listening yet.
+    wait_for_server(port)
+    t0 = time.time()
+    start.set()
+
+    times = {}
+    for _ in processes:
+        times.update(queue.get())
+    for process in processes:
+        process.join()
+    done.set()
+    server.join()
+
+    if len(times) != args.clients:
+        raise RuntimeError(
+            "only {} of {} clients completed".format(len(times), args.clients)
+        )
+    return [max(t[i] for t in times.values()) - t0 for i in range(len(STEPS))]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TCPStore rendezvous benchmark")
+    parser.add_argument("--clients", type=int, default=2048)
+    parser.add_argument("--processes", type=int, default=16)
+    parser.add_argument(
+        "--peers", type=int, default=64, help="number of keys read in the exchange step"
+    )
+    parser.add_argument("--timeout", type=int, default=300, help="in seconds")
+    args = parser.parse_args()
+
+    raise_fd_limit()
+    print(
+        "{} clients in {} processes, {} peers per client".format(
+            args.clients, args.processes, args.peers
+        )
+    )
+    print("{:>10}".format("exchange") + "".join("{:>12}".format(s) for s in STEPS))
+    for multi_get in [False, True]:
+        args.multi_get = multi_get
+        results = run(args)
+        print(
+            "{:>10}".format("multi_get" if multi_get else "get")
+            + "".join("{:>11.3f}s".format(r) for r in results)
+        )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,73 @@
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+from __future__ import unicode_literals
+
+
+import operator_benchmark as op_bench
+import torch
+import torch.nn.functional as F
+
+
+"""
+Microbenchmarks comparing bfloat16 and float32 on CPU for the kernels that
+compute bfloat16 in float registers (softmax, layer_norm, sum, mean, norm and
+the pointwise activations).
+"""
+
+
+bfloat16_configs_short = op_bench.config_list(
+    attr_names=['M', 'N'],
+    attrs=[
+        [128, 1024],
+        [1024, 1024],
+    ],
+    cross_product_configs={
+        'device': ['cpu'],
+        'dtype': [torch.float, torch.bfloat16],
+    },
+    tags=['short']
+)
+
+
+bfloat16_configs_long = op_bench.cross_product_configs(
+    M=[64, 512, 4096],
+    N=[768, 4096],
+    device=['cpu'],
+    dtype=[torch.float, torch.bfloat16],
+    tags=['long']
+)
+
+
+bfloat16_ops_list = op_bench.op_list(
+    attr_names=['op_name', 'op_func'],
+    attrs=[
+        ['softmax', lambda x: F.softmax(x, dim=-1)],
+        ['log_softmax', lambda x: F.log_softmax(x, dim=-1)],
+        ['layer_norm', lambda x: F.layer_norm(x, x.size()[-1:])],
+        ['sum_inner', lambda x: x.sum(dim=-1)],
+        ['sum_outer', lambda x: x.sum(dim=0)],
+        ['mean', lambda x: x.mean(dim=-1)],
+        ['norm', lambda x: x.norm(dim=-1)],
+        ['sigmoid', torch.sigmoid],
+        ['gelu', F.gelu],
+    ],
+)
+
+
+class BFloat16Benchmark(op_bench.TorchBenchmarkBase):
+    def init(self, M, N, device, dtype, op_func):
+        self.input_one = torch.randn(M, N, device=device).to(dtype=dtype)
+        self.op_func = op_func
+
+    def forward(self):
+        return self.op_func(self.input_one)
+
+
+op_bench.generate_pt_tests_from_op_list(bfloat16_ops_list,
+                                        bfloat16_configs_short + bfloat16_configs_long,
+                                        BFloat16Benchmark)
+
+
+if __name__ == "__main__":
+    op_bench.benchmark_runner.main()
@@ -0,0 +1,90 @@
+#!/usr/bin/env python3
+#
+# Measure torch.jit.load for models with thousands of parameters.
+#
+# The tensor records of a model are read on the inter-op thread pool while
+# its object graph is unpickled. This runs every load in a fresh process
+# with a given number of inter-op threads, so that their effect can be
+# compared; a single thread still overlaps reading with unpickling.
+#
+
+import argparse
+import multiprocessing
+import os
+import tempfile
+import time
+
+import torch
+
+
+class Model(torch.nn.Module):
+    def __init__(self, num_layers, width):
+        super(Model, self).__init__()
+        self.layers = torch.nn.ModuleList(
+            [torch.nn.Linear(width, width) for _ in range(num_layers)]
+        )
+
+    def forward(self, x):
+        for layer in self.layers:
+            x = layer(x)
+        return x
+
+
+def load(path, threads, iterations, queue):
+    torch.set_num_interop_threads(threads)
+    # Warm up the page cache and the thread pool.
+    torch.jit.load(path)
+    times = []
+    for _ in range(iterations):
+        start = time.perf_counter()
+        torch.jit.load(path)
+        times.append(time.perf_counter() - start)
+    queue.put(sorted(times)[len(times) // 2])
+
+
+def measure(path, threads, iterations):
+    ctx = multiprocessing.get_context("spawn")
+    queue = ctx.Queue()
+    process = ctx.Process(target=load, args=(path, threads, iterations, queue))
+    process.start()
+    result = queue.get()
+    process.join()
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TorchScript load benchmark")
+    parser.add_argument(
+        "--layers",
+        type=int,
+        nargs="+",
+        default=[1000, 4000],
+        help="number of linear layers, each has two parameters",
+    )
+    parser.add_argument("--width", type=int, default=64)
+    parser.add_argument(
+        "--threads", type=int, nargs="+", default=[1, os.cpu_count()]
+    )
+    parser.add_argument("--iterations", type=int, default=5)
+    args = parser.parse_args()
+
+    print(
+        "{:>10}{:>12}{:>10}{:>12}".format("params", "MB", "threads", "load (ms)")
+    )
+    with tempfile.TemporaryDirectory() as tmpdir:
+        for num_layers in args.layers:
+            path = os.path.join(tmpdir, "model_{}.pt".format(num_layers))
+            module = torch.jit.script(Model(num_layers, args.width))
+            torch.jit.save(module, path)
+            megabytes = os.path.getsize(path) / 2 ** 20
+            for threads in args.threads:
+                median = measure(path, threads, args.iterations)
+                print(
+                    "{:>10}{:>12.1f}{:>10}{:>12.1f}".format(
+                        2 * num_layers, megabytes, threads, median * 1000
+                    )
+                )
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+#
+# Measure the throughput of the TorchScript unpickler.
+#
+# Saves modules whose state is a dict of names to small tensors and a list
+# of small tensors, as in a large state dict, and loads them back. With
+# tiny tensors the load time is dominated by unpickling data.pkl, whose
+# size is reported along with its throughput.
+#
+
+import argparse
+import io
+import time
+import zipfile
+from typing import Dict, List
+
+import torch
+
+
+class State(torch.nn.Module):
+    tensors: List[torch.Tensor]
+    named: Dict[str, torch.Tensor]
+
+    def __init__(self, num_tensors):
+        super(State, self).__init__()
+        self.tensors = [torch.zeros(1) for _ in range(num_tensors)]
+        self.named = {
+            "layers.{}.weight".format(i): torch.zeros(1)
+            for i in range(num_tensors)
+        }
+
+    def forward(self):
+        return len(self.tensors) + len(self.named)
+
+
+def pickle_size(buffer):
+    with zipfile.ZipFile(io.BytesIO(buffer)) as archive:
+        for info in archive.infolist():
+            if info.filename.endswith("/data.pkl"):
+                return info.file_size
+    raise RuntimeError("no data.pkl in archive")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="TorchScript unpickler benchmark")
+    parser.add_argument(
+        "--tensors", type=int, nargs="+", default=[1000, 10000, 100000]
+    )
+    parser.add_argument("--iterations", type=int, default=5)
+    args = parser.parse_args()
+
+    print(
+        "{:>10}{:>12}{:>12}{:>12}".format(
+            "tensors", "pkl (MB)", "load (ms)", "MB/s"
+        )
+    )
+    for num_tensors in args.tensors:
+        f = io.BytesIO()
+        torch.jit.save(torch.jit.script(State(num_tensors)), f)
+        buffer = f.getvalue()
+        megabytes = pickle_size(buffer) / 2 ** 20
+
+        torch.jit.load(io.BytesIO(buffer))
+        times = []
+        for _ in range(args.iterations):
+            start = time.perf_counter()
+            torch.jit.load(io.BytesIO(buffer))
+            times.append(time.perf_counter() - start)
+        median = sorted(times)[len(times) // 2]
+        print(
+            "{:>10}{:>12.2f}{:>12.1f}{:>12.1f}".format(
+                num_tensors, megabytes, median * 1000, megabytes / median
+            )
+        )
+
+
+if __name__ == "__main__":
+    main()
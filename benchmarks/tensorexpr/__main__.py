@@ -9,10 +9,10 @@ from . import broadcast      # noqa: F401
 # from . import conv           # noqa: F401
 from . import elementwise    # noqa: F401
 from . import matmul         # noqa: F401
-# from . import normalization  # noqa: F401
+from . import normalization  # noqa: F401
 # from . import pooling        # noqa: F401
-# from . import reduction      # noqa: F401
-# from . import softmax        # noqa: F401
+from . import reduction      # noqa: F401
+from . import softmax        # noqa: F401
 from . import swish          # noqa: F401
 
 
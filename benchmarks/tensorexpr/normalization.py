@@ -18,6 +18,7 @@ class NormalizationBench(benchmark.Benchmark):
         self.running_mean = self.rand([self.C], device=device)
         self.running_var = self.rand([self.C], device=device)
         self.training = self.mode == "both"
+        self.inputs = [self.data]
 
     def config(self):
         return [self.N, self.C, self.H, self.W]
@@ -42,9 +43,9 @@ class NormalizationBench(benchmark.Benchmark):
 
 
 class BatchNormBench(NormalizationBench):
-    def forward(self):
+    def forward(self, inp):
         y = self.batch_norm(
-            self.data, self.running_mean, self.running_var, training=self.training
+            inp, self.running_mean, self.running_var, training=self.training
         )
         return y
 
@@ -54,8 +55,8 @@ class BatchNormBench(NormalizationBench):
 
 
 class InstanceNormBench(NormalizationBench):
-    def forward(self):
-        y = self.instance_norm(self.data)
+    def forward(self, inp):
+        y = self.instance_norm(inp)
         return y
 
     @staticmethod
@@ -67,8 +68,8 @@ class InstanceNormBench(NormalizationBench):
 
 
 class LayerNormBench(NormalizationBench):
-    def forward(self):
-        y = self.layer_norm(self.data, [self.H, self.W])
+    def forward(self, inp):
+        y = self.layer_norm(inp, [self.H, self.W])
         return y
 
     @staticmethod
@@ -76,6 +77,23 @@ class LayerNormBench(NormalizationBench):
         return "layernorm"
 
 
+class DecomposedLayerNormBench(NormalizationBench):
+    """Layer norm written with reductions and pointwise ops, so that a fuser
+    that handles reductions can compile all of it into one kernel."""
+
+    def forward(self, inp):
+        mean = self.mean(inp, [2, 3], keepdim=True)
+        centered = inp - mean
+        var = self.mean(centered * centered, [2, 3], keepdim=True)
+        y = centered * self.rsqrt(var + 1e-5)
+        return y
+
+    @staticmethod
+    def module():
+        return "decomposed_layernorm"
+
+
 benchmark.register_benchmark_class(BatchNormBench)
 benchmark.register_benchmark_class(InstanceNormBench)
 benchmark.register_benchmark_class(LayerNormBench)
+benchmark.register_benchmark_class(DecomposedLayerNormBench)
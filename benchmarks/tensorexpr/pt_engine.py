@@ -41,9 +41,18 @@ class TorchTensorEngine(object):
     def sum(self, data, dims):
         return torch.sum(data, dims)
 
+    def mean(self, data, dims, keepdim=False):
+        return torch.mean(data, dims, keepdim=keepdim)
+
+    def rsqrt(self, data):
+        return torch.rsqrt(data)
+
     def softmax(self, data, dim=None):
         return torch.nn.functional.softmax(data, dim)
 
+    def log_softmax(self, data, dim=None):
+        return torch.nn.functional.log_softmax(data, dim)
+
     def max_pool2d(self, data, kernel_size, stride=1):
         return torch.nn.functional.max_pool2d(data, kernel_size, stride=stride)
 
@@ -20,9 +20,10 @@ class ReduceBench(benchmark.Benchmark):
             self.dims = [0, 1]
         else:
             raise ValueError("invalid case: %s" % case)
+        self.inputs = [self.data]
 
-    def forward(self):
-        y = self.sum(self.data, self.dims)
+    def forward(self, inp):
+        y = self.sum(inp, self.dims)
         return y
 
     def config(self):
@@ -8,9 +8,10 @@ class SoftmaxBench(benchmark.Benchmark):
         self.M = M
         self.N = N
         self.data = self.rand([M, N], device=device, requires_grad=self.requires_grad)
+        self.inputs = [self.data]
 
-    def forward(self):
-        y = self.softmax(self.data, dim=1)
+    def forward(self, inp):
+        y = self.softmax(inp, dim=1)
         return y
 
     def reference(self):
@@ -39,7 +40,21 @@ class SoftmaxBench(benchmark.Benchmark):
 
     @staticmethod
     def default_configs():
-        return [[128, 1 << 16]]
+        return [[128, 1 << 16], [4096, 1024]]
+
+
+class LogSoftmaxBench(SoftmaxBench):
+    def forward(self, inp):
+        y = self.log_softmax(inp, dim=1)
+        return y
+
+    def reference(self):
+        return scipy.special.log_softmax(self.numpy(self.data), axis=1)
+
+    @staticmethod
+    def module():
+        return "log_softmax"
 
 
 benchmark.register_benchmark_class(SoftmaxBench)
+benchmark.register_benchmark_class(LogSoftmaxBench)
@@ -0,0 +1,114 @@
+// Measures how fast examples are read from a memory mapped dataset written by
+// torch::data::datasets::MmapDatasetWriter.
+//
+// Every example is copied out of the mapping, as a collation would, so that
+// its pages are read. Examples are read in order or at random, by a number of
+// threads that each read a share of them. With --drop_cache, the pages of the
+// file are evicted from the page cache before every run, which measures reads
+// from storage instead of from memory.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "c10/util/Flags.h"
+#include "torch/data/datasets/mmap.h"
+
+C10_DEFINE_string(dataset, "", "The dataset file to read.");
+C10_DEFINE_bool(random, false, "If true, read examples in random order.");
+C10_DEFINE_int(threads, 1, "The number of concurrent reading threads.");
+C10_DEFINE_int(
+    examples,
+    -1,
+    "The number of examples to read in every run, all of them by default.");
+C10_DEFINE_int(repeat, 5, "The number of runs.");
+C10_DEFINE_bool(
+    drop_cache,
+    false,
+    "If true, evict the file from the page cache before every run.");
+
+namespace {
+void drop_cache(const std::string& path) {
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd != -1) {
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+  }
+#endif
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Measure the read throughput of a memory mapped dataset.\n"
+      "Example usage:\n"
+      "./mmap_dataset_throughput --dataset=<dataset file> --random"
+      " --threads=4");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::fprintf(stderr, "Failed to parse command line flags!\n");
+    return 1;
+  }
+
+  std::vector<size_t> indices;
+  {
+    torch::data::datasets::MmapDataset dataset(FLAGS_dataset);
+    indices.resize(*dataset.size());
+  }
+  std::iota(indices.begin(), indices.end(), 0);
+  if (FLAGS_random) {
+    std::mt19937 generator(0);
+    std::shuffle(indices.begin(), indices.end(), generator);
+  }
+  if (FLAGS_examples >= 0 &&
+      static_cast<size_t>(FLAGS_examples) < indices.size()) {
+    indices.resize(FLAGS_examples);
+  }
+
+  for (int run = 0; run < FLAGS_repeat; ++run) {
+    if (FLAGS_drop_cache) {
+      drop_cache(FLAGS_dataset);
+    }
+    // Map the file for every run, so that dropped pages fault again.
+    torch::data::datasets::MmapDataset dataset(FLAGS_dataset);
+    std::atomic<size_t> bytes{0};
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < FLAGS_threads; ++t) {
+      threads.emplace_back([&, t]() {
+        size_t thread_bytes = 0;
+        for (size_t i = t; i < indices.size(); i += FLAGS_threads) {
+          for (const auto& values : dataset.get(indices[i])) {
+            thread_bytes += values.clone().nbytes();
+          }
+        }
+        bytes += thread_bytes;
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+    std::printf(
+        "Run %02d, read %zu examples in %4.5f seconds, throughput %f "
+        "examples/sec, %f MB/sec.\n",
+        run,
+        indices.size(),
+        seconds,
+        indices.size() / seconds,
+        bytes / seconds / (1 << 20));
+  }
+  return 0;
+}
@@ -0,0 +1,114 @@
+// Measures how long a step of the C++ optimizers takes on many parameters.
+//
+// Every optimizer is timed twice: once on contiguous parameters, whose
+// updates are fused, and once on the same parameters stored transposed,
+// which are updated one by one. The second run shows what the step costs
+// without the fused kernels.
+
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ATen/Parallel.h"
+#include "c10/util/Flags.h"
+#include "torch/optim.h"
+
+C10_DEFINE_string(
+    optimizers,
+    "sgd,adam,adagrad,rmsprop",
+    "Comma separated list of the optimizers to time.");
+C10_DEFINE_int(params, 1000, "The number of parameters.");
+C10_DEFINE_int(rows, 16, "The number of rows of every parameter.");
+C10_DEFINE_int(cols, 16, "The number of columns of every parameter.");
+C10_DEFINE_int(iter, 100, "The number of timed steps.");
+C10_DEFINE_int(warmup_iter, 10, "The number of steps before timing.");
+C10_DEFINE_int(threads, 0, "The number of intra-op threads, if positive.");
+
+namespace {
+std::unique_ptr<torch::optim::Optimizer> make_optimizer(
+    const std::string& name,
+    const std::vector<torch::Tensor>& params) {
+  using namespace torch::optim;
+  if (name == "sgd") {
+    return std::make_unique<SGD>(params, SGDOptions(0.01).momentum(0.9));
+  } else if (name == "adam") {
+    return std::make_unique<Adam>(params, AdamOptions(0.01));
+  } else if (name == "adagrad") {
+    return std::make_unique<Adagrad>(params, AdagradOptions(0.01));
+  } else if (name == "rmsprop") {
+    return std::make_unique<RMSprop>(params, RMSpropOptions(0.01));
+  }
+  return nullptr;
+}
+
+// Returns the average time of a step, in microseconds.
+double time_steps(const std::string& name, bool contiguous) {
+  torch::NoGradGuard no_grad;
+  std::vector<torch::Tensor> params;
+  for (int i = 0; i < FLAGS_params; ++i) {
+    auto param = torch::randn({FLAGS_rows, FLAGS_cols});
+    if (!contiguous) {
+      param = param.t().contiguous().t();
+    }
+    param.grad() = torch::randn({FLAGS_rows, FLAGS_cols});
+    params.push_back(param);
+  }
+  auto optimizer = make_optimizer(name, params);
+  if (!optimizer) {
+    return -1;
+  }
+  for (int i = 0; i < FLAGS_warmup_iter; ++i) {
+    optimizer->step();
+  }
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < FLAGS_iter; ++i) {
+    optimizer->step();
+  }
+  const std::chrono::duration<double, std::micro> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / FLAGS_iter;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Time the steps of the C++ optimizers with and without fusion.\n"
+      "Example usage:\n"
+      "./optimizer_step_benchmark --optimizers=adam,sgd --params=5000"
+      " --rows=8 --cols=8");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::fprintf(stderr, "Failed to parse command line flags!\n");
+    return 1;
+  }
+  if (FLAGS_threads > 0) {
+    at::set_num_threads(FLAGS_threads);
+  }
+
+  std::printf(
+      "%d parameters of %dx%d elements, %d threads\n",
+      FLAGS_params,
+      FLAGS_rows,
+      FLAGS_cols,
+      at::get_num_threads());
+  std::stringstream optimizers(FLAGS_optimizers);
+  std::string name;
+  while (std::getline(optimizers, name, ',')) {
+    const auto fused = time_steps(name, /*contiguous=*/true);
+    if (fused < 0) {
+      std::fprintf(stderr, "Unknown optimizer '%s'\n", name.c_str());
+      return 1;
+    }
+    const auto unfused = time_steps(name, /*contiguous=*/false);
+    std::printf(
+        "%-8s fused %10.1f us/step, unfused %10.1f us/step, speedup %.2fx\n",
+        name.c_str(),
+        fused,
+        unfused,
+        unfused / fused);
+  }
+  return 0;
+}
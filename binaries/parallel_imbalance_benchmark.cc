@@ -0,0 +1,132 @@
+#include "ATen/Parallel.h"
+
+#include "c10/util/Flags.h"
+#include "caffe2/core/init.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+C10_DEFINE_int(num_items, 4096, "Number of items per at::parallel_for call");
+C10_DEFINE_int(iter, 1000, "Number of timed at::parallel_for calls");
+C10_DEFINE_int(warmup_iter, 50, "Number of warmup calls");
+C10_DEFINE_int(intra_op_threads, 0, "Number of intra-op threads");
+C10_DEFINE_double(
+    skew,
+    1.2,
+    "Pareto shape of the per-item cost, smaller values mean heavier tails");
+
+// Measures tail latency of at::parallel_for on ranges whose items have very
+// different costs (e.g. EmbeddingBag with variable bag lengths).
+//
+// Two schedules are compared within the same build:
+//  - static: the range is cut into get_num_threads() fixed partitions, i.e.
+//    what the plain native backend does; the call waits for the slowest one
+//  - adaptive: the whole range is handed to at::parallel_for with grain 1, so
+//    a work-stealing backend (ATEN_THREADING=NATIVE_WS) can rebalance it
+//
+// Build once with ATEN_THREADING=NATIVE and once with NATIVE_WS to see the
+// effect of the scheduler on the adaptive numbers.
+
+namespace {
+
+std::vector<int> make_costs(int n, double skew) {
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> uniform(0.0, 1.0);
+  std::vector<int> costs(n);
+  for (auto& cost : costs) {
+    // Pareto distributed number of inner iterations, capped to keep the
+    // benchmark bounded.
+    double sample = 16.0 / std::pow(1.0 - uniform(gen), 1.0 / skew);
+    cost = static_cast<int>(std::min(sample, 1e5));
+  }
+  return costs;
+}
+
+volatile float sink;
+
+void process_item(int cost) {
+  float acc = 0;
+  for (int i = 0; i < cost; ++i) {
+    acc += std::sqrt(static_cast<float>(i));
+  }
+  sink = acc;
+}
+
+template <typename F>
+std::vector<double> time_calls(int iters, const F& fn) {
+  typedef std::chrono::high_resolution_clock clock;
+  std::vector<double> latencies;
+  latencies.reserve(iters);
+  for (int i = 0; i < iters; ++i) {
+    auto start = clock::now();
+    fn();
+    latencies.push_back(
+        std::chrono::duration<double, std::micro>(clock::now() - start)
+            .count());
+  }
+  std::sort(latencies.begin(), latencies.end());
+  return latencies;
+}
+
+void report(const std::string& name, const std::vector<double>& latencies) {
+  auto percentile = [&](double p) {
+    size_t idx = std::min(
+        latencies.size() - 1, static_cast<size_t>(p * latencies.size()));
+    return latencies[idx];
+  };
+  std::cout << name << ": p50 " << percentile(0.5) << " us, p90 "
+            << percentile(0.9) << " us, p99 " << percentile(0.99)
+            << " us, max " << latencies.back() << " us" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cout << "Failed to parse command line flags" << std::endl;
+    return -1;
+  }
+  caffe2::unsafeRunCaffe2InitFunction("registerThreadPools");
+  at::init_num_threads();
+
+  if (FLAGS_intra_op_threads > 0) {
+    at::set_num_threads(FLAGS_intra_op_threads);
+  }
+  const int nthreads = at::get_num_threads();
+  const int n = FLAGS_num_items;
+  const auto costs = make_costs(n, FLAGS_skew);
+
+  std::cout << at::get_parallel_info();
+  std::cout << "Running " << FLAGS_iter << " calls over " << n
+            << " items using " << nthreads << " threads" << std::endl;
+
+  auto static_schedule = [&]() {
+    const int64_t chunk = at::divup(n, nthreads);
+    at::parallel_for(0, nthreads, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t part = begin; part < end; ++part) {
+        int64_t stop = std::min<int64_t>(n, (part + 1) * chunk);
+        for (int64_t i = part * chunk; i < stop; ++i) {
+          process_item(costs[i]);
+        }
+      }
+    });
+  };
+  auto adaptive_schedule = [&]() {
+    at::parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t i = begin; i < end; ++i) {
+        process_item(costs[i]);
+      }
+    });
+  };
+
+  time_calls(FLAGS_warmup_iter, static_schedule);
+  report("static  ", time_calls(FLAGS_iter, static_schedule));
+  time_calls(FLAGS_warmup_iter, adaptive_schedule);
+  report("adaptive", time_calls(FLAGS_iter, adaptive_schedule));
+
+  return 0;
+}
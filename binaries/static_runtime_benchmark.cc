@@ -0,0 +1,194 @@
+// Compares the per-call cost of running frozen inference modules through the
+// GraphExecutor (Module::forward) and through torch::jit::StaticRuntime.
+//
+// The models are small ResNet and BERT style networks defined in
+// TorchScript, sized so that framework overhead is a visible fraction of the
+// time spent in each call.
+
+#include "benchmark/benchmark.h"
+
+#include <cmath>
+#include <sstream>
+
+#include "ATen/ATen.h"
+#include "ATen/core/grad_mode.h"
+#include "torch/csrc/jit/api/module.h"
+#include "torch/csrc/jit/passes/freeze_module.h"
+#include "torch/csrc/jit/runtime/static_runtime.h"
+
+namespace {
+
+using torch::jit::Module;
+
+constexpr int kResNetChannels = 32;
+constexpr int kResNetBlocks = 4;
+constexpr int kResNetImageSize = 64;
+
+constexpr int kBertLayers = 2;
+constexpr int kBertHidden = 256;
+constexpr int kBertHeads = 4;
+constexpr int kBertSeqLen = 64;
+
+void addBatchNorm(Module& m, const std::string& name, int64_t channels) {
+  m.register_parameter(name + "_weight", at::rand({channels}), false);
+  m.register_parameter(name + "_bias", at::randn({channels}), false);
+  m.register_buffer(name + "_mean", at::randn({channels}));
+  m.register_buffer(name + "_var", at::rand({channels}) + 0.5);
+}
+
+std::string batchNorm(const std::string& input, const std::string& name) {
+  std::ostringstream ss;
+  ss << "torch.batch_norm(" << input << ", self." << name << "_weight, self."
+     << name << "_bias, self." << name << "_mean, self." << name
+     << "_var, False, 0.1, 1e-5, False)";
+  return ss.str();
+}
+
+Module resNet() {
+  Module m("resnet");
+  const int64_t c = kResNetChannels;
+  std::ostringstream src;
+  src << "def forward(self, x):\n";
+
+  m.register_parameter("stem", at::randn({c, 3, 7, 7}) * 0.1, false);
+  addBatchNorm(m, "stem_bn", c);
+  src << "    y = torch.conv2d(x, self.stem, None, [2, 2], [3, 3])\n"
+      << "    y = torch.relu(" << batchNorm("y", "stem_bn") << ")\n"
+      << "    y = torch.max_pool2d(y, [3, 3], [2, 2], [1, 1])\n";
+
+  for (int i = 0; i < kResNetBlocks; i++) {
+    std::string b = "block" + std::to_string(i);
+    m.register_parameter(b + "_conv1", at::randn({c, c, 3, 3}) * 0.1, false);
+    m.register_parameter(b + "_conv2", at::randn({c, c, 3, 3}) * 0.1, false);
+    addBatchNorm(m, b + "_bn1", c);
+    addBatchNorm(m, b + "_bn2", c);
+    src << "    z = torch.conv2d(y, self." << b
+        << "_conv1, None, [1, 1], [1, 1])\n"
+        << "    z = torch.relu(" << batchNorm("z", b + "_bn1") << ")\n"
+        << "    z = torch.conv2d(z, self." << b
+        << "_conv2, None, [1, 1], [1, 1])\n"
+        << "    y = torch.relu(" << batchNorm("z", b + "_bn2") << " + y)\n";
+  }
+
+  m.register_parameter("fc_weight", at::randn({10, c}), false);
+  m.register_parameter("fc_bias", at::randn({10}), false);
+  src << "    y = torch.flatten(torch.adaptive_avg_pool2d(y, [1, 1]), 1)\n"
+      << "    return torch.linear(y, self.fc_weight, self.fc_bias)\n";
+
+  m.define(src.str());
+  m.eval();
+  return m;
+}
+
+Module bert() {
+  Module m("bert");
+  const int64_t e = kBertHidden;
+  const int64_t d = kBertHidden / kBertHeads;
+  std::ostringstream src;
+  src << "def forward(self, x):\n";
+
+  m.register_buffer("scale", at::full({}, std::sqrt(static_cast<double>(d))));
+  auto linear = [&](const std::string& name, int64_t in, int64_t out) {
+    m.register_parameter(name + "_weight", at::randn({out, in}) * 0.05, false);
+    m.register_parameter(name + "_bias", at::randn({out}) * 0.05, false);
+  };
+  auto layerNorm = [&](const std::string& name) {
+    m.register_parameter(name + "_weight", at::ones({e}), false);
+    m.register_parameter(name + "_bias", at::zeros({e}), false);
+  };
+
+  for (int i = 0; i < kBertLayers; i++) {
+    std::string l = "layer" + std::to_string(i);
+    for (const char* proj : {"_q", "_k", "_v", "_o"}) {
+      linear(l + proj, e, e);
+    }
+    linear(l + "_ff1", e, 4 * e);
+    linear(l + "_ff2", 4 * e, e);
+    layerNorm(l + "_ln1");
+    layerNorm(l + "_ln2");
+
+    std::ostringstream heads;
+    heads << ".view([-1, " << kBertSeqLen << ", " << kBertHeads << ", " << d
+          << "]).permute([0, 2, 1, 3])";
+    for (const char* proj : {"q", "k", "v"}) {
+      src << "    " << proj << " = torch.linear(x, self." << l << "_" << proj
+          << "_weight, self." << l << "_" << proj << "_bias)" << heads.str()
+          << "\n";
+    }
+    src << "    p = torch.softmax(torch.matmul(q, k.transpose(2, 3)) / "
+           "self.scale, -1)\n"
+        << "    a = torch.matmul(p, v).permute([0, 2, 1, 3]).reshape([-1, "
+        << kBertSeqLen << ", " << e << "])\n"
+        << "    a = torch.linear(a, self." << l << "_o_weight, self." << l
+        << "_o_bias)\n"
+        << "    x = torch.layer_norm(x + a, [" << e << "], self." << l
+        << "_ln1_weight, self." << l << "_ln1_bias, 1e-12, False)\n"
+        << "    f = torch.gelu(torch.linear(x, self." << l
+        << "_ff1_weight, self." << l << "_ff1_bias))\n"
+        << "    f = torch.linear(f, self." << l << "_ff2_weight, self." << l
+        << "_ff2_bias)\n"
+        << "    x = torch.layer_norm(x + f, [" << e << "], self." << l
+        << "_ln2_weight, self." << l << "_ln2_bias, 1e-12, False)\n";
+  }
+  src << "    return x\n";
+
+  m.define(src.str());
+  m.eval();
+  return m;
+}
+
+at::Tensor resNetInput(int64_t batch) {
+  return at::randn({batch, 3, kResNetImageSize, kResNetImageSize});
+}
+
+at::Tensor bertInput(int64_t batch) {
+  return at::randn({batch, kBertSeqLen, kBertHidden});
+}
+
+void runGraphExecutor(
+    benchmark::State& state,
+    const Module& module,
+    const at::Tensor& input) {
+  at::NoGradGuard no_grad;
+  Module frozen = torch::jit::freeze_module(module);
+  std::vector<c10::IValue> inputs = {input};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(frozen.forward(inputs));
+  }
+}
+
+void runStaticRuntime(
+    benchmark::State& state,
+    const Module& module,
+    const at::Tensor& input) {
+  torch::jit::StaticRuntime runtime(module);
+  std::vector<at::Tensor> inputs = {input};
+  while (state.KeepRunning()) {
+    benchmark::DoNotOptimize(runtime.run(inputs));
+  }
+}
+
+void BM_ResNet_GraphExecutor(benchmark::State& state) {
+  runGraphExecutor(state, resNet(), resNetInput(state.range(0)));
+}
+
+void BM_ResNet_StaticRuntime(benchmark::State& state) {
+  runStaticRuntime(state, resNet(), resNetInput(state.range(0)));
+}
+
+void BM_Bert_GraphExecutor(benchmark::State& state) {
+  runGraphExecutor(state, bert(), bertInput(state.range(0)));
+}
+
+void BM_Bert_StaticRuntime(benchmark::State& state) {
+  runStaticRuntime(state, bert(), bertInput(state.range(0)));
+}
+
+} // namespace
+
+BENCHMARK(BM_ResNet_GraphExecutor)->Arg(1)->Arg(8);
+BENCHMARK(BM_ResNet_StaticRuntime)->Arg(1)->Arg(8);
+BENCHMARK(BM_Bert_GraphExecutor)->Arg(1)->Arg(8);
+BENCHMARK(BM_Bert_StaticRuntime)->Arg(1)->Arg(8);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,78 @@
+// Converts tensors saved with torch.save into the memory mapped dataset
+// format read by torch::data::datasets::MmapDataset.
+//
+// The input is a dict from column names to the values of the column, which
+// are either a tensor whose slices along the first dimension are the
+// examples, or a list of tensors that may differ in the size of their first
+// dimension. For example:
+//
+//   torch.save({"images": images, "tokens": [t0, t1, t2]}, "input.pt",
+//              _use_new_zipfile_serialization=True)
+//
+// Columns are written in the order of the dict.
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "c10/util/Flags.h"
+#include "torch/data/datasets/mmap.h"
+#include "torch/serialize.h"
+
+C10_DEFINE_string(input, "", "The file of tensors saved with torch.save.");
+C10_DEFINE_string(output, "", "The dataset file to write.");
+
+int main(int argc, char** argv) {
+  c10::SetUsageMessage(
+      "Convert tensors saved with torch.save into a memory mapped dataset.\n"
+      "Example usage:\n"
+      "./write_mmap_dataset --input=<input.pt> --output=<dataset file>");
+  if (!c10::ParseCommandLineFlags(&argc, &argv)) {
+    std::cerr << "Failed to parse command line flags!" << std::endl;
+    return 1;
+  }
+  if (FLAGS_input.empty() || FLAGS_output.empty()) {
+    std::cerr << c10::UsageMessage() << std::endl;
+    return 1;
+  }
+
+  std::ifstream input(FLAGS_input, std::ios::binary);
+  if (!input) {
+    std::cerr << "Error opening " << FLAGS_input << std::endl;
+    return 1;
+  }
+  std::vector<char> data(
+      (std::istreambuf_iterator<char>(input)),
+      std::istreambuf_iterator<char>());
+  auto columns = torch::pickle_load(data);
+  if (!columns.isGenericDict()) {
+    std::cerr << FLAGS_input << " doesn't hold a dict of columns" << std::endl;
+    return 1;
+  }
+
+  torch::data::datasets::MmapDatasetWriter writer(FLAGS_output);
+  for (const auto& column : columns.toGenericDict()) {
+    const auto name = column.key().toStringRef();
+    const auto& values = column.value();
+    if (values.isTensor()) {
+      writer.add_column(name, values.toTensor());
+    } else if (values.isTensorList()) {
+      writer.add_variable_length_column(name, values.toTensorVector());
+    } else if (values.isList()) {
+      std::vector<at::Tensor> examples;
+      for (const auto& example : values.toListRef()) {
+        examples.push_back(example.toTensor());
+      }
+      writer.add_variable_length_column(name, examples);
+    } else {
+      std::cerr << "Column '" << name << "' is neither a tensor nor a list "
+                << "of tensors" << std::endl;
+      return 1;
+    }
+    std::cout << "Wrote column '" << name << "'" << std::endl;
+  }
+  writer.finish();
+  return 0;
+}
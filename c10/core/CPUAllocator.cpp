@@ -1,6 +1,9 @@
 #include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
 #include <c10/core/DeviceType.h>
 
+#include <cstdlib>
+
 // TODO: rename flags to C10
 C10_DEFINE_bool(
     caffe2_report_cpu_memory_usage,
@@ -226,6 +229,23 @@ at::Allocator* GetDefaultCPUAllocator() {
 
 REGISTER_ALLOCATOR(DeviceType::CPU, &g_cpu_alloc);
 
+// The caching allocator is opt-in. Setting PYTORCH_CPU_ALLOCATOR=caching in
+// the environment selects it at static initialization time, with a higher
+// priority than the default registration above so that registration order
+// across translation units does not matter. Programs can also select it
+// explicitly with SetCPUAllocator(CPUCachingAllocator::get(), 1).
+namespace {
+struct CPUCachingAllocatorSelector {
+  CPUCachingAllocatorSelector() {
+    const char* env = std::getenv("PYTORCH_CPU_ALLOCATOR");
+    if (env && strcmp(env, "caching") == 0) {
+      SetCPUAllocator(CPUCachingAllocator::get(), /*priority=*/1);
+    }
+  }
+};
+static CPUCachingAllocatorSelector g_cpu_caching_allocator_selector;
+} // namespace
+
 #endif /* C10_Mobile */
 
 void ProfiledCPUMemoryReporter::New(void* ptr, size_t nbytes) {
@@ -275,4 +295,44 @@ void ProfiledCPUMemoryReporter::Delete(void* ptr) {
   }
 }
 
+void ProfiledCPUMemoryReporter::CacheUpdate(
+    int64_t cached_bytes_delta,
+    int64_t hits,
+    int64_t misses,
+    int64_t released_blocks) {
+  if (cached_bytes_delta != 0) {
+    int64_t cached = cached_bytes_.fetch_add(
+        cached_bytes_delta, std::memory_order_relaxed) + cached_bytes_delta;
+    int64_t peak = peak_cached_bytes_.load(std::memory_order_relaxed);
+    while (cached > peak &&
+           !peak_cached_bytes_.compare_exchange_weak(
+               peak, cached, std::memory_order_relaxed)) {
+    }
+  }
+  if (hits != 0) {
+    cache_hits_.fetch_add(hits, std::memory_order_relaxed);
+  }
+  if (misses != 0) {
+    cache_misses_.fetch_add(misses, std::memory_order_relaxed);
+  }
+  if (released_blocks != 0) {
+    released_blocks_.fetch_add(released_blocks, std::memory_order_relaxed);
+  }
+}
+
+CPUCacheStats ProfiledCPUMemoryReporter::cacheStats() const {
+  CPUCacheStats stats;
+  stats.cached_bytes = cached_bytes_.load(std::memory_order_relaxed);
+  stats.peak_cached_bytes = peak_cached_bytes_.load(std::memory_order_relaxed);
+  stats.cache_hits = cache_hits_.load(std::memory_order_relaxed);
+  stats.cache_misses = cache_misses_.load(std::memory_order_relaxed);
+  stats.released_blocks = released_blocks_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ProfiledCPUMemoryReporter::resetPeakCacheStats() {
+  peak_cached_bytes_.store(
+      cached_bytes_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
 } // namespace c10
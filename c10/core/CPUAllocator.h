@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <unordered_map>
 
@@ -37,6 +38,21 @@ C10_API void memset_junk(void* data, size_t num);
 C10_API void* alloc_cpu(size_t nbytes);
 C10_API void free_cpu(void* data);
 
+// Summary statistics of the CPU caching allocator (see CPUCachingAllocator.h).
+// All values stay zero while the default CPU allocator is in use.
+struct CPUCacheStats {
+  // SUM: bytes currently held in the free lists (per-thread and global)
+  int64_t cached_bytes = 0;
+  // SUM: peak value of cached_bytes
+  int64_t peak_cached_bytes = 0;
+  // COUNT: allocations served from a free list
+  int64_t cache_hits = 0;
+  // COUNT: allocations that had to go to alloc_cpu()
+  int64_t cache_misses = 0;
+  // COUNT: cached blocks handed back to the system with free_cpu()
+  int64_t released_blocks = 0;
+};
+
 // A simple struct that is used to report C10's memory allocation and
 // deallocation status to the profiler
 class C10_API ProfiledCPUMemoryReporter {
@@ -45,10 +61,26 @@ class C10_API ProfiledCPUMemoryReporter {
   void New(void* ptr, size_t nbytes);
   void Delete(void* ptr);
 
+  // Called by the CPU caching allocator. Counters are accumulated in batches
+  // by the allocator, so callers only see a slightly delayed view of them.
+  void CacheUpdate(
+      int64_t cached_bytes_delta,
+      int64_t hits,
+      int64_t misses,
+      int64_t released_blocks);
+  CPUCacheStats cacheStats() const;
+  void resetPeakCacheStats();
+
  private:
   std::mutex mutex_;
   std::unordered_map<void*, size_t> size_table_;
   size_t allocated_ = 0;
+
+  std::atomic<int64_t> cached_bytes_{0};
+  std::atomic<int64_t> peak_cached_bytes_{0};
+  std::atomic<int64_t> cache_hits_{0};
+  std::atomic<int64_t> cache_misses_{0};
+  std::atomic<int64_t> released_blocks_{0};
 };
 
 C10_API ProfiledCPUMemoryReporter& profiledCPUMemoryReporter();
@@ -0,0 +1,401 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <array>
+#include <mutex>
+#include <vector>
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_thread_cache_mb,
+    16,
+    "Maximum number of megabytes each thread keeps in its private free lists "
+    "when the CPU caching allocator is in use");
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_max_cached_mb,
+    1024,
+    "Maximum number of megabytes kept in the global pool of the CPU caching "
+    "allocator. Negative values disable the limit.");
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+namespace {
+
+// Size classes: 64 bytes, then four classes per power of two up to 64MB.
+constexpr size_t kMinBlockShift = 6;
+constexpr size_t kMaxBlockShift = 26;
+constexpr size_t kClassesPerShift = 4;
+constexpr size_t kNumSizeClasses =
+    (kMaxBlockShift - kMinBlockShift) * kClassesPerShift + 1;
+constexpr uint32_t kNoSizeClass = kNumSizeClasses;
+
+// Every block starts with a header holding its size class, so that the
+// deleter can find the right free list from the data pointer alone. The
+// header takes gAlignment bytes to keep the user pointer aligned.
+constexpr size_t kHeaderSize = gAlignment;
+
+// Upper bound on the number of bytes moved between a thread cache and the
+// global pool in one batch.
+constexpr size_t kTransferBytes = 1024 * 1024;
+constexpr size_t kMaxTransferBlocks = 32;
+
+// Number of allocator events after which a thread publishes its counters.
+constexpr int64_t kStatsFlushInterval = 256;
+
+struct BlockHeader {
+  uint32_t size_class;
+};
+
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "header does not fit");
+
+inline BlockHeader* headerOf(void* base) {
+  return static_cast<BlockHeader*>(base);
+}
+
+inline void* payloadOf(void* base) {
+  return static_cast<char*>(base) + kHeaderSize;
+}
+
+inline void* baseOf(void* payload) {
+  return static_cast<char*>(payload) - kHeaderSize;
+}
+
+inline int floorLog2(size_t n) {
+  int shift = 0;
+  while (n >>= 1) {
+    shift++;
+  }
+  return shift;
+}
+
+uint32_t sizeClass(size_t nbytes) {
+  if (nbytes <= (size_t(1) << kMinBlockShift)) {
+    return 0;
+  }
+  if (nbytes > (size_t(1) << kMaxBlockShift)) {
+    return kNoSizeClass;
+  }
+  size_t shift = floorLog2(nbytes);
+  size_t base = size_t(1) << shift;
+  size_t step = base / kClassesPerShift;
+  size_t sub = (nbytes - base + step - 1) / step;
+  return (shift - kMinBlockShift) * kClassesPerShift + sub;
+}
+
+size_t classSize(uint32_t size_class) {
+  size_t shift = kMinBlockShift + size_class / kClassesPerShift;
+  size_t sub = size_class % kClassesPerShift;
+  size_t base = size_t(1) << shift;
+  return base + sub * (base / kClassesPerShift);
+}
+
+size_t transferBatch(uint32_t size_class) {
+  size_t n = kTransferBytes / classSize(size_class);
+  return std::max<size_t>(1, std::min(n, kMaxTransferBlocks));
+}
+
+void releaseBlock(void* base) {
+  free_cpu(base);
+}
+
+void fillBlock(void* data, size_t nbytes) {
+  CHECK(
+      !FLAGS_caffe2_cpu_allocator_do_zero_fill ||
+      !FLAGS_caffe2_cpu_allocator_do_junk_fill)
+    << "Cannot request both zero-fill and junk-fill at the same time";
+  if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+    memset(data, 0, nbytes);
+  } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+    memset_junk(data, nbytes);
+  }
+}
+
+// Free lists shared by all threads.
+class GlobalPool {
+ public:
+  // Moves up to `max_blocks` blocks of `size_class` into `out`.
+  size_t take(uint32_t size_class, size_t max_blocks, std::vector<void*>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& list = free_lists_[size_class];
+    size_t n = std::min(max_blocks, list.size());
+    out.insert(out.end(), list.end() - n, list.end());
+    list.resize(list.size() - n);
+    cached_bytes_ -= n * classSize(size_class);
+    return n;
+  }
+
+  // Takes ownership of `blocks`. Blocks that do not fit under the global
+  // limit are released to the system; returns their number.
+  size_t give(uint32_t size_class, void* const* blocks, size_t n) {
+    const size_t size = classSize(size_class);
+    const int64_t limit_mb = FLAGS_caffe2_cpu_caching_allocator_max_cached_mb;
+    size_t kept = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto& list = free_lists_[size_class];
+      for (; kept < n; kept++) {
+        if (limit_mb >= 0 &&
+            cached_bytes_ + size > static_cast<size_t>(limit_mb) << 20) {
+          break;
+        }
+        list.push_back(blocks[kept]);
+        cached_bytes_ += size;
+      }
+    }
+    for (size_t i = kept; i < n; i++) {
+      releaseBlock(blocks[i]);
+    }
+    return n - kept;
+  }
+
+  // Releases every cached block; returns the number of bytes released.
+  size_t releaseAll(int64_t* num_blocks) {
+    std::array<std::vector<void*>, kNumSizeClasses> lists;
+    size_t bytes = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      lists.swap(free_lists_);
+      bytes = cached_bytes_;
+      cached_bytes_ = 0;
+    }
+    for (auto& list : lists) {
+      for (void* base : list) {
+        releaseBlock(base);
+      }
+      *num_blocks += list.size();
+    }
+    return bytes;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::array<std::vector<void*>, kNumSizeClasses> free_lists_;
+  size_t cached_bytes_ = 0;
+};
+
+// Leaked on purpose: blocks may be freed by static destructors that run
+// after this translation unit has been torn down.
+GlobalPool& globalPool() {
+  static GlobalPool* pool = new GlobalPool();
+  return *pool;
+}
+
+// Counters that are accumulated locally and periodically published to
+// profiledCPUMemoryReporter().
+struct PendingStats {
+  int64_t cached_bytes_delta = 0;
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t released_blocks = 0;
+  int64_t events = 0;
+
+  void flush() {
+    if (events == 0 && cached_bytes_delta == 0 && released_blocks == 0) {
+      return;
+    }
+    profiledCPUMemoryReporter().CacheUpdate(
+        cached_bytes_delta, hits, misses, released_blocks);
+    *this = PendingStats();
+  }
+
+  void tick() {
+    if (++events >= kStatsFlushInterval) {
+      flush();
+    }
+  }
+};
+
+class ThreadCache {
+ public:
+  ~ThreadCache();
+
+  void* pop(uint32_t size_class) {
+    auto& list = free_lists_[size_class];
+    if (list.empty()) {
+      globalPool().take(size_class, transferBatch(size_class), list);
+      if (list.empty()) {
+        return nullptr;
+      }
+      cached_bytes_ += list.size() * classSize(size_class);
+    }
+    void* base = list.back();
+    list.pop_back();
+    cached_bytes_ -= classSize(size_class);
+    return base;
+  }
+
+  void push(uint32_t size_class, void* base) {
+    auto& list = free_lists_[size_class];
+    list.push_back(base);
+    cached_bytes_ += classSize(size_class);
+    const int64_t limit_mb = FLAGS_caffe2_cpu_caching_allocator_thread_cache_mb;
+    if (cached_bytes_ > static_cast<size_t>(std::max<int64_t>(limit_mb, 0)) << 20) {
+      // Hand the older half of this size class over to the global pool.
+      size_t n = std::max<size_t>(1, list.size() / 2);
+      flushList(size_class, n);
+    }
+  }
+
+  void releaseAll() {
+    for (uint32_t size_class = 0; size_class < kNumSizeClasses; size_class++) {
+      flushList(size_class, free_lists_[size_class].size());
+    }
+  }
+
+  PendingStats stats;
+
+ private:
+  void flushList(uint32_t size_class, size_t n) {
+    auto& list = free_lists_[size_class];
+    if (n == 0) {
+      return;
+    }
+    const size_t size = classSize(size_class);
+    size_t released = globalPool().give(size_class, list.data(), n);
+    list.erase(list.begin(), list.begin() + n);
+    cached_bytes_ -= n * size;
+    stats.cached_bytes_delta -= released * size;
+    stats.released_blocks += released;
+  }
+
+  std::array<std::vector<void*>, kNumSizeClasses> free_lists_;
+  size_t cached_bytes_ = 0;
+};
+
+// Trivially destructible, so it stays readable while (and after) the thread
+// cache itself is being destroyed at thread exit.
+thread_local bool t_cache_destroyed = false;
+
+ThreadCache::~ThreadCache() {
+  t_cache_destroyed = true;
+  releaseAll();
+  stats.flush();
+}
+
+// Returns nullptr once the calling thread has started tearing down its
+// thread-local storage; callers then fall back to the global pool.
+ThreadCache* threadCache() {
+  if (t_cache_destroyed) {
+    return nullptr;
+  }
+  static thread_local ThreadCache cache;
+  return &cache;
+}
+
+void* allocBlock(size_t nbytes) {
+  uint32_t size_class = sizeClass(nbytes);
+  if (size_class == kNoSizeClass) {
+    void* base = alloc_cpu(nbytes + kHeaderSize);
+    headerOf(base)->size_class = kNoSizeClass;
+    return payloadOf(base);
+  }
+
+  ThreadCache* cache = threadCache();
+  PendingStats fallback_stats;
+  PendingStats& stats = cache ? cache->stats : fallback_stats;
+
+  void* base = nullptr;
+  if (cache) {
+    base = cache->pop(size_class);
+  } else {
+    std::vector<void*> blocks;
+    if (globalPool().take(size_class, 1, blocks) == 1) {
+      base = blocks[0];
+    }
+  }
+
+  if (base) {
+    stats.cached_bytes_delta -= classSize(size_class);
+    stats.hits++;
+    fillBlock(payloadOf(base), nbytes);
+  } else {
+    stats.misses++;
+    base = alloc_cpu(classSize(size_class) + kHeaderSize);
+    headerOf(base)->size_class = size_class;
+  }
+
+  if (cache) {
+    stats.tick();
+  } else {
+    stats.flush();
+  }
+  return payloadOf(base);
+}
+
+void freeBlock(void* ptr) {
+  void* base = baseOf(ptr);
+  uint32_t size_class = headerOf(base)->size_class;
+  if (size_class == kNoSizeClass) {
+    releaseBlock(base);
+    return;
+  }
+
+  ThreadCache* cache = threadCache();
+  if (cache) {
+    cache->stats.cached_bytes_delta += classSize(size_class);
+    cache->push(size_class, base);
+    cache->stats.tick();
+  } else {
+    PendingStats stats;
+    size_t released = globalPool().give(size_class, &base, 1);
+    stats.cached_bytes_delta += released ? 0 : classSize(size_class);
+    stats.released_blocks += released;
+    stats.flush();
+  }
+}
+
+struct CPUCachingAllocatorImpl final : at::Allocator {
+  at::DataPtr allocate(size_t nbytes) const override {
+    if (nbytes == 0) {
+      return {nullptr, nullptr, &ReportAndDelete, at::Device(at::DeviceType::CPU)};
+    }
+    void* data = allocBlock(nbytes);
+    profiledCPUMemoryReporter().New(data, nbytes);
+    return {data, data, &ReportAndDelete, at::Device(at::DeviceType::CPU)};
+  }
+
+  static void ReportAndDelete(void* ptr) {
+    if (!ptr) {
+      return;
+    }
+    profiledCPUMemoryReporter().Delete(ptr);
+    freeBlock(ptr);
+  }
+
+  at::DeleterFnPtr raw_deleter() const override {
+    return &ReportAndDelete;
+  }
+};
+
+} // namespace
+
+Allocator* get() {
+  static CPUCachingAllocatorImpl allocator;
+  return &allocator;
+}
+
+void emptyCache() {
+  PendingStats stats;
+  if (ThreadCache* cache = threadCache()) {
+    cache->releaseAll();
+    cache->stats.flush();
+  }
+  size_t bytes = globalPool().releaseAll(&stats.released_blocks);
+  stats.cached_bytes_delta -= bytes;
+  stats.flush();
+}
+
+CPUCacheStats getStats() {
+  if (ThreadCache* cache = threadCache()) {
+    cache->stats.flush();
+  }
+  return profiledCPUMemoryReporter().cacheStats();
+}
+
+size_t roundSize(size_t nbytes) {
+  uint32_t size_class = sizeClass(nbytes);
+  return size_class == kNoSizeClass ? nbytes : classSize(size_class);
+}
+
+} // namespace CPUCachingAllocator
+} // namespace c10
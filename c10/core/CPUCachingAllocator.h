@@ -0,0 +1,49 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/core/CPUAllocator.h>
+
+// Caching allocator for CPU memory.
+//
+// Requested sizes are rounded up to a size class (four classes per power of
+// two, so at most 25% of a block is wasted) and freed blocks are kept on free
+// lists instead of being handed back to the system. Every thread owns a small
+// cache of free lists that is accessed without any locking; when it runs dry
+// or grows past its limit, blocks are moved in batches from / to a global
+// pool protected by a mutex. Blocks larger than the biggest size class
+// bypass the cache entirely.
+//
+// Blocks freed on a different thread than the one that allocated them land
+// in the freeing thread's cache. When a thread exits its cache is flushed to
+// the global pool.
+//
+// The allocator is opt-in: set PYTORCH_CPU_ALLOCATOR=caching in the
+// environment, or call c10::SetCPUAllocator(CPUCachingAllocator::get(), 1)
+// before any tensor is allocated. Cache limits are controlled with the
+// caffe2_cpu_caching_allocator_thread_cache_mb and
+// caffe2_cpu_caching_allocator_max_cached_mb flags; statistics are reported
+// through ProfiledCPUMemoryReporter::cacheStats().
+
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_thread_cache_mb);
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_max_cached_mb);
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+// Returns the process-wide caching allocator instance.
+C10_API Allocator* get();
+
+// Releases all blocks cached in the global pool and in the calling thread's
+// cache. Caches owned by other live threads are left untouched.
+C10_API void emptyCache();
+
+// Convenience accessor for profiledCPUMemoryReporter().cacheStats() that also
+// flushes the calling thread's pending counters first.
+C10_API CPUCacheStats getStats();
+
+// Size that an allocation of `nbytes` is rounded up to, or `nbytes` itself if
+// it is too large to be cached. Exposed for testing.
+C10_API size_t roundSize(size_t nbytes);
+
+} // namespace CPUCachingAllocator
+} // namespace c10
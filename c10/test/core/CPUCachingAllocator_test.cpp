@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <thread>
+#include <vector>
+
+using namespace c10;
+
+TEST(CPUCachingAllocatorTest, RoundSize) {
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1), 64);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(64), 64);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(65), 80);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(128), 128);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1000), 1024);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1025), 1280);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1793), 2048);
+  for (size_t n = 1; n < (1 << 20); n = n * 3 / 2 + 1) {
+    size_t rounded = CPUCachingAllocator::roundSize(n);
+    ASSERT_GE(rounded, n);
+    ASSERT_LE(rounded, std::max<size_t>(64, n + n / 4));
+  }
+  // Too large to be cached.
+  size_t huge = (size_t(1) << 26) + 1;
+  ASSERT_EQ(CPUCachingAllocator::roundSize(huge), huge);
+}
+
+TEST(CPUCachingAllocatorTest, ReusesFreedBlocks) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+
+  void* first = nullptr;
+  {
+    DataPtr ptr = allocator->allocate(1000);
+    ASSERT_NE(ptr.get(), nullptr);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(ptr.get()) % gAlignment, 0);
+    memset(ptr.get(), 1, 1000);
+    first = ptr.get();
+  }
+  auto before = CPUCachingAllocator::getStats();
+  ASSERT_GT(before.cached_bytes, 0);
+  {
+    // Same size class, so the freed block is handed out again.
+    DataPtr ptr = allocator->allocate(1024);
+    ASSERT_EQ(ptr.get(), first);
+  }
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(after.cache_hits, before.cache_hits + 1);
+
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(CPUCachingAllocator::getStats().cached_bytes, 0);
+}
+
+TEST(CPUCachingAllocatorTest, ZeroAndHugeAllocations) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  DataPtr empty = allocator->allocate(0);
+  ASSERT_EQ(empty.get(), nullptr);
+
+  auto before = CPUCachingAllocator::getStats();
+  {
+    DataPtr ptr = allocator->allocate((size_t(1) << 26) + 1);
+    ASSERT_NE(ptr.get(), nullptr);
+  }
+  auto after = CPUCachingAllocator::getStats();
+  ASSERT_EQ(after.cached_bytes, before.cached_bytes);
+}
+
+TEST(CPUCachingAllocatorTest, RawInterface) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  void* ptr = allocator->raw_allocate(4096);
+  ASSERT_NE(ptr, nullptr);
+  allocator->raw_deallocate(ptr);
+}
+
+TEST(CPUCachingAllocatorTest, CrossThreadFree) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  std::vector<DataPtr> ptrs;
+  for (int i = 0; i < 100; i++) {
+    ptrs.push_back(allocator->allocate(64 * (i + 1)));
+  }
+  std::thread t([&]() {
+    ptrs.clear();
+    // Exiting the thread flushes its cache to the global pool.
+  });
+  t.join();
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(CPUCachingAllocator::getStats().cached_bytes, 0);
+}
@@ -17,11 +17,19 @@ class CAFFE2_API FileAdapter final : public ReadAdapterInterface {
   size_t size() const override;
   size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const override;
+  bool supportsConcurrentReads() const override;
   ~FileAdapter();
 
  private:
+#ifdef _WIN32
   std::ifstream file_stream_;
   std::unique_ptr<IStreamAdapter> istream_adapter_;
+#else
+  // Reads use pread, which doesn't move a shared file position, so that
+  // several threads can read at once.
+  int fd_;
+  size_t size_;
+#endif
 };
 
 } // namespace serialize
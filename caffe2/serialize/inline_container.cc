@@ -26,6 +26,10 @@ size_t istream_read_func(void *pOpaque, mz_uint64 file_ofs, void *pBuf, size_t n
   return self->read(file_ofs, static_cast<char*>(pBuf), n);
 }
 
+static void deleteMappedRecord(void* ctx) {
+  delete static_cast<std::shared_ptr<uint8_t>*>(ctx);
+}
+
 static std::string basename(const std::string& name) {
   size_t start = 0;
   for(size_t i = 0; i < name.size(); ++i) {
@@ -181,6 +185,7 @@ static size_t getPadding(
 }
 
 bool PyTorchStreamReader::hasRecord(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   std::string ss = archive_name_plus_slash_ + name;
   mz_zip_reader_locate_file(ar_.get(), ss.c_str(), nullptr, 0);
   bool result = ar_->m_last_error != MZ_ZIP_FILE_NOT_FOUND;
@@ -192,6 +197,7 @@ bool PyTorchStreamReader::hasRecord(const std::string& name) {
 }
 
 std::vector<std::string> PyTorchStreamReader::getAllRecords() {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   mz_uint num_files = mz_zip_reader_get_num_files(ar_.get());
   std::vector<std::string> out;
   char buf[MZ_ZIP_MAX_ARCHIVE_FILENAME_SIZE];
@@ -214,10 +220,39 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
 
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
+  std::unique_lock<std::mutex> guard(reader_lock_);
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  if (auto mapped = in_->mappedData()) {
+    size_t offset = getRecordDataOffset(stat.m_local_header_ofs);
+    if (stat.m_method == 0 && !stat.m_is_encrypted &&
+        offset % kFieldAlignment == 0 &&
+        offset + stat.m_uncomp_size <= in_->size()) {
+      // The DataPtr keeps the mapping alive.
+      auto ctx = new std::shared_ptr<uint8_t>(std::move(mapped));
+      at::DataPtr retval(
+          ctx->get() + offset, ctx, deleteMappedRecord, at::kCPU);
+      return std::make_tuple(std::move(retval), stat.m_uncomp_size);
+    }
+  }
+  if (stat.m_method == 0 && !stat.m_is_encrypted &&
+      in_->supportsConcurrentReads()) {
+    // Copy stored records without holding the lock, so that other threads
+    // can read records at the same time.
+    size_t offset = getRecordDataOffset(stat.m_local_header_ofs);
+    guard.unlock();
+    void* ptr = malloc(stat.m_uncomp_size);
+    at::DataPtr retval(ptr, ptr, free, at::kCPU);
+    in_->read(offset, ptr, stat.m_uncomp_size, "reading file");
+    auto crc = mz_crc32(
+        MZ_CRC32_INIT, static_cast<const uint8_t*>(ptr), stat.m_uncomp_size);
+    if (crc != stat.m_crc32) {
+      CAFFE_THROW("CRC-32 check failed for file ", name);
+    }
+    return std::make_tuple(std::move(retval), stat.m_uncomp_size);
+  }
   void * ptr = malloc(stat.m_uncomp_size);
   mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
   valid("reading file ", name.c_str());
@@ -231,18 +266,23 @@ static int64_t read_le_16(uint8_t* buf) {
 }
 
 size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retrieving file meta-data for ", name.c_str());
+  return getRecordDataOffset(stat.m_local_header_ofs);
+}
+
+size_t PyTorchStreamReader::getRecordDataOffset(uint64_t local_header_offset) {
   uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
   in_->read(
-      stat.m_local_header_ofs,
+      local_header_offset,
       local_header,
       MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
       "reading file header");
   size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
   size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return local_header_offset + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
 }
 
 
@@ -5,6 +5,7 @@
 #include <cstring>
 #include <fstream>
 #include <istream>
+#include <mutex>
 #include <ostream>
 
 #include <c10/core/Allocator.h>
@@ -143,6 +144,13 @@ class CAFFE2_API PyTorchStreamReader final {
   explicit PyTorchStreamReader(std::unique_ptr<ReadAdapterInterface> in);
 
   // return dataptr, size
+  // If the input is memory mapped (see ReadAdapterInterface::mappedData),
+  // records that are stored uncompressed and aligned to kFieldAlignment are
+  // returned as pointers into the mapping instead of copies, without
+  // checking their CRC.
+  // The reader can be used from several threads. If the input supports
+  // concurrent reads, records that are stored uncompressed are read by
+  // several threads at once.
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
   size_t getRecordOffset(const std::string& name);
   bool hasRecord(const std::string& name);
@@ -158,6 +166,9 @@ class CAFFE2_API PyTorchStreamReader final {
   size_t read(uint64_t pos, char* buf, size_t n);
   void valid(const char* what, const char* info = "");
   size_t getRecordID(const std::string& name);
+  // Offset of the data of the record whose local header is at the given
+  // offset.
+  size_t getRecordDataOffset(uint64_t local_header_offset);
 
   friend size_t
   istream_read_func(void* pOpaque, uint64_t file_ofs, void* pBuf, size_t n);
@@ -166,6 +177,9 @@ class CAFFE2_API PyTorchStreamReader final {
   std::string archive_name_plus_slash_;
   std::unique_ptr<ReadAdapterInterface> in_;
   int64_t version_;
+  // Guards ar_, which isn't thread safe, and in_ unless it supports
+  // concurrent reads.
+  std::mutex reader_lock_;
 };
 
 class CAFFE2_API PyTorchStreamWriter final {
@@ -1,10 +1,14 @@
 #include <cstdio>
 #include <string>
 #include <array>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
+#include "caffe2/serialize/file_adapter.h"
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -63,6 +67,84 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, ConcurrentReads) {
+  const std::string file_name = "output_concurrent.zip";
+  const int num_records = 64;
+  std::vector<std::vector<char>> records;
+  {
+    std::ofstream out(file_name, std::ofstream::binary);
+    PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+      out.write(static_cast<const char*>(b), n);
+      return out ? n : 0;
+    });
+    for (int i = 0; i < num_records; ++i) {
+      records.emplace_back(1000 + i, static_cast<char>(i));
+      writer.writeRecord(
+          "key" + std::to_string(i), records[i].data(), records[i].size());
+    }
+    writer.writeEndOfFile();
+  }
+
+  PyTorchStreamReader reader(std::make_unique<FileAdapter>(file_name));
+  std::vector<std::thread> threads;
+  std::vector<int> matches(num_records, 0);
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < num_records; i += 8) {
+        at::DataPtr data_ptr;
+        size_t size;
+        std::tie(data_ptr, size) = reader.getRecord("key" + std::to_string(i));
+        matches[i] = size == records[i].size() &&
+            memcmp(data_ptr.get(), records[i].data(), size) == 0;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (int i = 0; i < num_records; ++i) {
+    ASSERT_TRUE(matches[i]) << "record " << i;
+  }
+  std::remove(file_name.c_str());
+}
+
+#ifndef _WIN32
+TEST(PyTorchStreamWriterAndReader, LoadMmap) {
+  const std::string file_name = "output_mmap.zip";
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  {
+    std::ofstream out(file_name, std::ofstream::binary);
+    PyTorchStreamWriter writer([&](const void* b, size_t n) -> size_t {
+      out.write(static_cast<const char*>(b), n);
+      return out ? n : 0;
+    });
+    writer.writeRecord("key1", data1.data(), data1.size());
+    writer.writeEndOfFile();
+  }
+
+  auto adapter = std::make_unique<MmapAdapter>(file_name);
+  auto mapped = adapter->mappedData();
+  at::DataPtr data_ptr;
+  int64_t size;
+  {
+    PyTorchStreamReader reader(std::move(adapter));
+    std::tie(data_ptr, size) = reader.getRecord("key1");
+    // The record points into the mapping.
+    ASSERT_EQ(
+        static_cast<uint8_t*>(data_ptr.get()),
+        mapped.get() + reader.getRecordOffset("key1"));
+  }
+  mapped.reset();
+  // The record outlives the reader and the adapter.
+  ASSERT_EQ(size, data1.size());
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  std::remove(file_name.c_str());
+}
+#endif
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
@@ -0,0 +1,87 @@
+#include "caffe2/serialize/mmap_adapter.h"
+
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <c10/util/Exception.h>
+
+namespace caffe2 {
+namespace serialize {
+
+MmapAdapter::MmapAdapter(const std::string& file_name, Mode mode) {
+#ifdef _WIN32
+  AT_ERROR("MmapAdapter is not supported on Windows, file path: ", file_name);
+#else
+  int fd = ::open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR(
+        "open file failed, file path: ", file_name, ": ", std::strerror(errno));
+  }
+  struct ::stat file_stat;
+  if (::fstat(fd, &file_stat) == -1) {
+    auto err = errno;
+    ::close(fd);
+    AT_ERROR(
+        "fstat failed, file path: ", file_name, ": ", std::strerror(err));
+  }
+  size_ = file_stat.st_size;
+  if (size_ == 0) {
+    ::close(fd);
+    AT_ERROR("cannot map an empty file, file path: ", file_name);
+  }
+  // A private mapping only needs the file to be open for reading, even if
+  // its pages are writable.
+  int prot = mode == Mode::CopyOnWrite ? PROT_READ | PROT_WRITE : PROT_READ;
+  void* ptr = ::mmap(nullptr, size_, prot, MAP_PRIVATE, fd, 0);
+  auto err = errno;
+  // The mapping keeps the file alive on its own.
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    AT_ERROR("mmap failed, file path: ", file_name, ": ", std::strerror(err));
+  }
+  const size_t size = size_;
+  data_ = std::shared_ptr<uint8_t>(
+      static_cast<uint8_t*>(ptr), [size](uint8_t* p) { ::munmap(p, size); });
+#endif
+}
+
+size_t MmapAdapter::size() const {
+  return size_;
+}
+
+size_t MmapAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  if (pos > size_ || n > size_ - pos) {
+    AT_ERROR(
+        "mmap reader failed: ",
+        what,
+        ", reading ",
+        n,
+        " bytes at offset ",
+        pos,
+        " of a file of ",
+        size_,
+        " bytes.");
+  }
+  std::memcpy(buf, data_.get() + pos, n);
+  return n;
+}
+
+std::shared_ptr<uint8_t> MmapAdapter::mappedData() const {
+  return data_;
+}
+
+bool MmapAdapter::supportsConcurrentReads() const {
+  return true;
+}
+
+MmapAdapter::~MmapAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
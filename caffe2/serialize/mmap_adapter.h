@@ -0,0 +1,42 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// Maps the whole file into memory. PyTorchStreamReader returns the records
+// of such a file that are stored uncompressed and aligned as pointers into
+// the mapping instead of copies, so that loading a model doesn't copy its
+// weights, and processes that load the same file share its pages.
+class CAFFE2_API MmapAdapter final : public ReadAdapterInterface {
+ public:
+  enum class Mode {
+    // Writing to the mapping faults.
+    ReadOnly,
+    // Writing to the mapping creates a private copy of the touched pages.
+    CopyOnWrite,
+  };
+
+  C10_DISABLE_COPY_AND_ASSIGN(MmapAdapter);
+  explicit MmapAdapter(
+      const std::string& file_name,
+      Mode mode = Mode::CopyOnWrite);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  std::shared_ptr<uint8_t> mappedData() const override;
+  bool supportsConcurrentReads() const override;
+  ~MmapAdapter();
+
+ private:
+  std::shared_ptr<uint8_t> data_;
+  size_t size_;
+};
+
+} // namespace serialize
+} // namespace caffe2
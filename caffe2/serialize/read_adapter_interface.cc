@@ -3,6 +3,14 @@
 namespace caffe2 {
 namespace serialize {
 
+std::shared_ptr<uint8_t> ReadAdapterInterface::mappedData() const {
+  return nullptr;
+}
+
+bool ReadAdapterInterface::supportsConcurrentReads() const {
+  return false;
+}
+
 ReadAdapterInterface::~ReadAdapterInterface() {}
 
 } // namespace serialize
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 
 #include "c10/macros/Macros.h"
 
@@ -16,6 +17,12 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // Returns the whole file if the adapter has it mapped into memory, and
+  // nullptr otherwise. The mapping stays valid while any copy of the
+  // returned pointer is alive, even after the adapter is destroyed.
+  virtual std::shared_ptr<uint8_t> mappedData() const;
+  // Whether read can be called from several threads at once.
+  virtual bool supportsConcurrentReads() const;
   virtual ~ReadAdapterInterface();
 };
 
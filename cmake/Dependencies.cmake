@@ -1546,7 +1546,7 @@ if(NOT INTERN_BUILD_MOBILE)
     add_compile_options(-DUSE_GCC_GET_CPUID)
   endif()
 
-  find_package(AVX) # checks AVX and AVX2
+  find_package(AVX) # checks AVX, AVX2 and AVX512
 
   # we don't set -mavx and -mavx2 flags globally, but only for specific files
   # however, we want to enable the AVX codepaths, so we still need to
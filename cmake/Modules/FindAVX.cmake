@@ -25,6 +25,23 @@ SET(AVX2_CODE "
   }
 ")
 
+SET(AVX512_CODE "
+  #include <immintrin.h>
+
+  int main()
+  {
+    __m512i a = _mm512_set1_epi16(0);
+    a = _mm512_abs_epi16(a); // AVX512BW
+    __m512d b = _mm512_set1_pd(0);
+    a = _mm512_cvttpd_epi64(b); // AVX512DQ
+    __m256i c = _mm256_set1_epi32(0);
+    c = _mm256_mask_mov_epi32(c, 0x1, c); // AVX512VL
+    __m512 x = _mm512_set1_ps(0);
+    x = _mm512_fmadd_ps(x, x, x);
+    return 0;
+  }
+")
+
 MACRO(CHECK_SSE lang type flags)
   SET(__FLAG_I 1)
   SET(CMAKE_REQUIRED_FLAGS_SAVE ${CMAKE_REQUIRED_FLAGS})
@@ -59,3 +76,4 @@ CHECK_SSE(C "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
 
 CHECK_SSE(CXX "AVX" " ;-mavx;/arch:AVX")
 CHECK_SSE(CXX "AVX2" " ;-mavx2 -mfma;/arch:AVX2")
+CHECK_SSE(CXX "AVX512" " ;-mavx512f -mavx512bw -mavx512vl -mavx512dq -mfma;/arch:AVX512")
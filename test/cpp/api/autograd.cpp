@@ -1,9 +1,13 @@
 #include <gtest/gtest.h>
 
 #include <torch/torch.h>
+#include <torch/csrc/autograd/engine.h>
 
 #include <test/cpp/api/support.h>
 
+#include <chrono>
+#include <thread>
+
 using namespace torch::autograd;
 
 #define ASSERT_VARIABLE_EQ(a,b) ASSERT_TRUE(torch::allclose((a),(b)))
@@ -126,6 +130,17 @@ TEST(AutogradAPITests, GradUnreachableTest) {
   ASSERT_THROWS_WITH(grad({x * 2}, {x, y}, {}, {}, false, false), "Set allow_unused=True");
 }
 
+TEST(AutogradAPITests, DeepChainTest) {
+  // Long chains of small nodes are run without going through the ready queue.
+  Variable x = torch::randn({3}, torch::requires_grad());
+  auto y = x;
+  for (int i = 0; i < 2000; i++) {
+    y = y * 2 - y;
+  }
+  y.sum().backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::ones({3}));
+}
+
 TEST(AutogradAPITests, RetainGrad) {
   auto input = torch::rand({1, 3}, torch::requires_grad());
   auto h1 = input * 3;
@@ -587,6 +602,91 @@ TEST(CustomAutogradTest, ReentrantPriority) {
   ASSERT_EQ(order.back(), 0);
 }
 
+TEST(CustomAutogradTest, ExecutionOrder) {
+  static std::vector<int64_t> order;
+
+  struct Record : public Function<Record> {
+    static Variable forward(AutogradContext* ctx, Variable x, int64_t id) {
+      ctx->saved_data["id"] = id;
+      return x.clone();
+    }
+
+    static variable_list backward(AutogradContext* ctx, variable_list grad) {
+      order.push_back(ctx->saved_data["id"].toInt());
+      return {grad[0], Variable()};
+    }
+  };
+
+  auto x = torch::randn({2}, torch::requires_grad());
+  auto y = Record::apply(x, 0) + Record::apply(x, 1) + Record::apply(x, 2);
+  y.sum().backward();
+
+  // Ready nodes run from the most recently created one, whether or not they
+  // go through the ready queue.
+  ASSERT_EQ(order, std::vector<int64_t>({2, 1, 0}));
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({2}, 3.));
+}
+
+TEST(CustomAutogradTest, ParallelCPUBackward) {
+  struct Slow : public Function<Slow> {
+    static Variable forward(AutogradContext*, Variable x) {
+      return x.clone();
+    }
+
+    static variable_list backward(AutogradContext*, variable_list grad) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      return grad;
+    }
+  };
+
+  struct Fail : public Function<Fail> {
+    static Variable forward(AutogradContext*, Variable x) {
+      return x.clone();
+    }
+
+    static variable_list backward(AutogradContext*, variable_list grad) {
+      throw std::runtime_error("Simulate error in backward");
+    }
+  };
+
+  // Restores the number of CPU workers when the test ends, even if an
+  // assertion fails.
+  struct NumCpuWorkersGuard {
+    explicit NumCpuWorkersGuard(Engine& engine, size_t num_workers)
+        : engine_(engine), previous_(engine.num_cpu_workers()) {
+      engine_.set_num_cpu_workers(num_workers);
+    }
+    ~NumCpuWorkersGuard() {
+      engine_.set_num_cpu_workers(previous_);
+    }
+    Engine& engine_;
+    size_t previous_;
+  };
+
+  auto& engine = Engine::get_default_engine();
+  NumCpuWorkersGuard guard(engine, 3);
+  engine.reset_cpu_worker_stats();
+
+  auto x = torch::randn({4}, torch::requires_grad());
+  auto y = Slow::apply(x) + Slow::apply(x) +
+      Slow::apply(x) + Slow::apply(x);
+  y.sum().backward();
+  ASSERT_VARIABLE_EQ(x.grad(), torch::full({4}, 4.));
+
+  // Independent branches leave tasks waiting in the ready queue, which are
+  // handed to CPU workers and run at the same time as the calling thread.
+  auto stats = engine.cpu_worker_stats();
+  ASSERT_GT(stats.workers_dispatched, 0);
+  ASSERT_GE(stats.nodes_run, 8);
+  ASSERT_GT(stats.nodes_run_by_workers, 0);
+  ASSERT_LE(stats.nodes_run_by_workers, stats.nodes_run);
+  ASSERT_GE(stats.max_concurrent_nodes, 2);
+
+  // Errors raised on a worker are reported by backward().
+  auto z = Slow::apply(x) + Fail::apply(x) + Slow::apply(x);
+  ASSERT_THROWS_WITH(z.sum().backward(), "Simulate error in backward");
+}
+
 TEST(CustomAutogradTest, Hooks) {
   Variable x = torch::ones({5,5}, torch::requires_grad());
   Variable y = torch::ones({5,5})*4;
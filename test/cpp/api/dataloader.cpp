@@ -9,6 +9,8 @@
 
 #include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <fstream>
 #include <future>
 #include <iostream>
 #include <iterator>
@@ -450,6 +452,159 @@ TEST(DataTest, TensorDatasetConstructsFromInitializerListOfTensors) {
       torch::tensor({0, 0, 1, 0, 0}, torch::kFloat32).allclose(dataset.get(2)));
 }
 
+TEST(DataTest, MmapDatasetReadsWhatWasWritten) {
+  auto tempfile = c10::make_tempfile();
+  const auto images = torch::randn({5, 2, 3});
+  const auto labels = torch::arange(5);
+  std::vector<torch::Tensor> tokens;
+  for (int64_t i = 0; i < 5; ++i) {
+    tokens.push_back(torch::randint(100, {i, 2}, torch::kInt32));
+  }
+  {
+    datasets::MmapDatasetWriter writer(tempfile.name);
+    writer.add_column("images", images);
+    writer.add_column("labels", labels);
+    writer.add_variable_length_column("tokens", tokens);
+    ASSERT_THROWS_WITH(
+        writer.add_column("more", torch::zeros({4})),
+        "Column 'more' has 4 examples, but the dataset has 5");
+    writer.finish();
+  }
+
+  datasets::MmapDataset dataset(tempfile.name);
+  ASSERT_EQ(dataset.size().value(), 5);
+  ASSERT_EQ(
+      dataset.column_names(),
+      std::vector<std::string>({"images", "labels", "tokens"}));
+  for (size_t i = 0; i < 5; ++i) {
+    auto example = dataset.get(i);
+    ASSERT_EQ(example.size(), 3);
+    ASSERT_TRUE(example[0].equal(images[i]));
+    ASSERT_TRUE(example[1].equal(labels[i]));
+    ASSERT_TRUE(example[2].equal(tokens[i]));
+  }
+  // Examples are views into the mapped columns.
+  ASSERT_EQ(
+      dataset.get(3)[0].data_ptr(), dataset.column("images")[3].data_ptr());
+  ASSERT_THROWS_WITH(dataset.get(5), "out of range");
+
+  datasets::MmapDataset selected(tempfile.name, {"tokens", "labels"});
+  auto example = selected.get(4);
+  ASSERT_EQ(example.size(), 2);
+  ASSERT_TRUE(example[0].equal(tokens[4]));
+  ASSERT_TRUE(example[1].equal(labels[4]));
+  ASSERT_THROWS_WITH(
+      datasets::MmapDataset(tempfile.name, {"captions"}),
+      "The dataset has no column 'captions'");
+}
+
+TEST(DataTest, MmapDatasetRejectsUnfinishedFile) {
+  auto tempfile = c10::make_tempfile();
+  {
+    datasets::MmapDatasetWriter writer(tempfile.name);
+    writer.add_column("values", torch::ones({10, 10}));
+  }
+  ASSERT_THROWS_WITH(
+      datasets::MmapDataset(tempfile.name),
+      "is not a dataset written by MmapDatasetWriter");
+
+  // A finished file whose column table claims a rank it can't hold.
+  {
+    datasets::MmapDatasetWriter writer(tempfile.name);
+    writer.add_column("values", torch::ones({10, 10}));
+    writer.finish();
+  }
+  {
+    std::fstream file(
+        tempfile.name, std::ios::in | std::ios::out | std::ios::binary);
+    // The trailer starts with the offset of the table.
+    file.seekg(-24, std::ios::end);
+    uint64_t table_offset = 0;
+    file.read(reinterpret_cast<char*>(&table_offset), sizeof(table_offset));
+    // The rank follows the example count, the column count, the name and
+    // the type, element size and variable-length flag of the column.
+    const uint32_t rank = std::numeric_limits<uint32_t>::max();
+    file.seekp(table_offset + 8 + 4 + 4 + std::strlen("values") + 4 + 4 + 4);
+    file.write(reinterpret_cast<const char*>(&rank), sizeof(rank));
+    ASSERT_TRUE(file.good());
+  }
+  ASSERT_THROWS_WITH(
+      datasets::MmapDataset(tempfile.name),
+      "Invalid rank of column 'values'");
+}
+
+TEST(DataTest, MmapDatasetRejectsCorruptTable) {
+  auto tempfile = c10::make_tempfile();
+  {
+    datasets::MmapDatasetWriter writer(tempfile.name);
+    writer.add_column("values", torch::arange(10).view({5, 2}));
+    writer.add_column("empty", torch::zeros({5, 0}));
+    std::vector<torch::Tensor> tokens;
+    for (int64_t i = 0; i < 5; ++i) {
+      tokens.push_back(torch::full({i}, i, torch::kInt32));
+    }
+    writer.add_variable_length_column("tokens", tokens);
+    writer.finish();
+  }
+  std::vector<char> original;
+  {
+    std::ifstream file(tempfile.name, std::ios::binary);
+    original.assign(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  // The trailer starts with the offset and the size of the table.
+  const size_t trailer = original.size() - 24;
+  uint64_t table_offset = 0;
+  uint64_t table_size = 0;
+  std::memcpy(&table_offset, original.data() + trailer, sizeof(table_offset));
+  std::memcpy(&table_size, original.data() + trailer + 8, sizeof(table_size));
+
+  // Every corruption is either rejected with an error or gives a dataset
+  // whose examples can be read.
+  auto check = [&](const std::vector<char>& bytes) {
+    {
+      std::ofstream file(tempfile.name, std::ios::binary | std::ios::trunc);
+      file.write(bytes.data(), bytes.size());
+    }
+    try {
+      datasets::MmapDataset dataset(tempfile.name);
+      const auto size = std::min<size_t>(dataset.size().value(), 16);
+      for (size_t i = 0; i < size; ++i) {
+        try {
+          dataset.get(i);
+        } catch (const c10::Error&) {
+        }
+      }
+    } catch (const c10::Error&) {
+    }
+  };
+  for (size_t i = table_offset; i < table_offset + table_size; ++i) {
+    for (unsigned char value : {0x00, 0x01, 0x7f, 0x80, 0xff}) {
+      auto bytes = original;
+      bytes[i] = static_cast<char>(value);
+      check(bytes);
+    }
+  }
+  // A truncated table.
+  for (uint64_t size = 0; size < table_size; ++size) {
+    auto bytes = original;
+    std::memcpy(bytes.data() + trailer + 8, &size, sizeof(size));
+    check(bytes);
+  }
+
+  // A number of examples that doesn't fit in a dimension is rejected even
+  // though the empty column takes no bytes for any number of examples.
+  auto bytes = original;
+  const uint64_t count = std::numeric_limits<uint64_t>::max();
+  std::memcpy(bytes.data() + table_offset, &count, sizeof(count));
+  {
+    std::ofstream file(tempfile.name, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+  }
+  ASSERT_THROWS_WITH(
+      datasets::MmapDataset(tempfile.name), "Invalid number of examples");
+}
+
 TEST(DataTest, StackTransformWorksForExample) {
   struct D : public datasets::Dataset<D> {
     Example<> get(size_t index) override {
@@ -485,6 +640,49 @@ TEST(DataTest, StackTransformWorksForTensorExample) {
   ASSERT_TRUE(second.data.allclose(torch::eye(4).slice(/*dim=*/0, 2, 4)));
 }
 
+TEST(DataTest, StackTransformCopiesExamplesIntoBatch) {
+  auto data = torch::randn({8, 3, 5});
+  std::vector<TensorExample> examples;
+  for (int64_t i = 0; i < 8; ++i) {
+    // Alternate between contiguous and non-contiguous examples.
+    examples.emplace_back(i % 2 == 0 ? data[i] : data[i].t().contiguous().t());
+  }
+  transforms::Stack<TensorExample> stack;
+  auto batch = stack.apply_batch(examples).data;
+  ASSERT_EQ(batch.sizes(), data.sizes());
+  ASSERT_TRUE(batch.equal(data));
+  ASSERT_NE(batch.data_ptr(), data.data_ptr());
+
+  transforms::Stack<TensorExample> parallel_stack(
+      /*pin_memory=*/false, /*parallel=*/true);
+  ASSERT_TRUE(parallel_stack.apply_batch(examples).data.equal(data));
+
+  // Examples that need autograd are still stacked with torch::stack.
+  auto weight = torch::ones({5}, torch::requires_grad());
+  auto grad_batch =
+      stack.apply_batch({data[0] * weight, data[1] * weight}).data;
+  grad_batch.sum().backward();
+  ASSERT_TRUE(weight.grad().allclose(data[0].sum(0) + data[1].sum(0)));
+
+  ASSERT_THROWS_WITH(
+      stack.apply_batch({torch::ones({2}), torch::ones({3})}),
+      "stack expects each tensor to be equal size");
+}
+
+TEST(DataTest, ParallelTransformAppliesToEveryExample) {
+  auto d = DummyDataset().map(
+      transforms::Parallel<transforms::Lambda<int, std::string>>(
+          transforms::Lambda<int, std::string>(
+              static_cast<std::string (*)(int)>(std::to_string))));
+  std::vector<std::string> expected;
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < 100; ++i) {
+    expected.push_back(std::to_string(i + 1));
+    indices.push_back(i);
+  }
+  ASSERT_EQ(d.get_batch(indices), expected);
+}
+
 // Template classes cannot be nested in functions.
 template <typename Target>
 struct T : transforms::TensorTransform<Target> {
@@ -2302,4 +2500,93 @@ TEST(DataLoaderTest, CustomPreprocessPolicy) {
       }
     }
   }
-}
\ No newline at end of file
+}
+
+TEST(DataLoaderTest, ChunkDatasetStreamsChunksThroughShuffleWindow) {
+  const size_t batch_size = 4;
+  const size_t piece_size = 3;
+
+  // Streams the chunks of DummyChunkDataReader in pieces of piece_size
+  // examples.
+  struct D : public DummyChunkDataReader {
+    void stream_chunk(
+        size_t chunk_index,
+        const std::function<bool(BatchType)>& consumer) override {
+      BatchType chunk = read_chunk(chunk_index);
+      for (size_t i = 0; i < chunk.size(); i += piece_size) {
+        BatchType piece(
+            chunk.begin() + i,
+            chunk.begin() + std::min(chunk.size(), i + piece_size));
+        if (!consumer(std::move(piece))) {
+          return;
+        }
+      }
+    }
+  };
+
+  const size_t prefetch_counts[] = {1, 2};
+  const size_t shuffle_window_sizes[] = {0, 8};
+  const size_t total_example_count = 35;
+
+  D data_reader;
+  samplers::SequentialSampler sampler(0);
+
+  for (auto prefetch_count : prefetch_counts) {
+    for (auto shuffle_window_size : shuffle_window_sizes) {
+      datasets::SharedBatchDataset<datasets::ChunkDataset<
+          D,
+          samplers::SequentialSampler,
+          samplers::SequentialSampler>>
+          dataset = datasets::make_shared_dataset<datasets::ChunkDataset<
+              D,
+              samplers::SequentialSampler,
+              samplers::SequentialSampler>>(
+              data_reader,
+              sampler,
+              sampler,
+              datasets::ChunkDatasetOptions(prefetch_count, batch_size, 8)
+                  .shuffle_window_size(shuffle_window_size));
+
+      auto data_loader = torch::data::make_data_loader(
+          dataset, DataLoaderOptions(batch_size).workers(0));
+
+      std::vector<int> result;
+      size_t uneven_batch_count = 0;
+      for (auto iterator = data_loader->begin(); iterator != data_loader->end();
+           ++iterator) {
+        DummyChunkDataReader::BatchType& batch = *iterator;
+        if (batch.size() != batch_size) {
+          ++uneven_batch_count;
+        }
+        result.insert(result.end(), batch.begin(), batch.end());
+      }
+
+      // Only the last batch of the epoch can be smaller than the batch size.
+      ASSERT_LE(uneven_batch_count, 1);
+      ASSERT_EQ(result.size(), total_example_count);
+
+      // With a single preloader and no shuffle window, the pieces are batched
+      // in the order they are read.
+      if (prefetch_count == 1 && shuffle_window_size == 0) {
+        for (size_t i = 0; i < total_example_count; ++i) {
+          ASSERT_EQ(result[i], i);
+        }
+      }
+      std::sort(result.begin(), result.end());
+      for (size_t i = 0; i < total_example_count; ++i) {
+        ASSERT_EQ(result[i], i);
+      }
+
+      auto stats = dataset->preloader_stats();
+      ASSERT_EQ(stats.size(), prefetch_count);
+      size_t chunk_count = 0;
+      size_t example_count = 0;
+      for (const auto& preloader_stats : stats) {
+        chunk_count += preloader_stats.chunk_count;
+        example_count += preloader_stats.example_count;
+      }
+      ASSERT_EQ(chunk_count, data_reader.chunk_count());
+      ASSERT_EQ(example_count, total_example_count);
+    }
+  }
+}
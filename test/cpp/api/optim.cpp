@@ -139,6 +139,111 @@ void check_exact_values(
   }
 }
 
+// Checks that parameters whose updates are fused end up with exactly the same
+// values as parameters that are updated one by one, which is the case of the
+// non-contiguous ones: the fused loops evaluate every update in the same order
+// and precision as the tensor ops.
+template <typename OptimizerClass, typename Options>
+void check_fused_matches_unfused(Options options, size_t steps = 3) {
+  torch::manual_seed(0);
+  // The last parameter is large enough to be split between tasks.
+  const std::vector<std::vector<int64_t>> sizes = {
+      {2, 3}, {7, 5}, {300, 200}};
+  std::vector<torch::Tensor> fused;
+  std::vector<torch::Tensor> unfused;
+  for (const auto& size : sizes) {
+    auto parameter = torch::randn(size);
+    fused.push_back(parameter.clone());
+    unfused.push_back(parameter.t().contiguous().t());
+    ASSERT_FALSE(unfused.back().is_contiguous());
+  }
+  OptimizerClass fused_optimizer(fused, options);
+  OptimizerClass unfused_optimizer(unfused, options);
+
+  for (size_t step = 0; step < steps; ++step) {
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      auto grad = torch::randn(sizes[i]);
+      fused[i].grad() = grad.clone();
+      unfused[i].grad() = grad.clone();
+    }
+    fused_optimizer.step();
+    unfused_optimizer.step();
+    for (size_t i = 0; i < sizes.size(); ++i) {
+      ASSERT_TRUE(fused[i].equal(unfused[i]))
+          << "parameter " << i << " differs after step " << step;
+    }
+  }
+}
+
+// The state tensors of `state` that hold one row per parameter row.
+std::vector<torch::Tensor> rowwise_state(OptimizerParamState& state) {
+  if (auto* adam = dynamic_cast<AdamParamState*>(&state)) {
+    return {adam->exp_avg(), adam->exp_avg_sq()};
+  }
+  if (auto* adagrad = dynamic_cast<AdagradParamState*>(&state)) {
+    return {adagrad->sum()};
+  }
+  return {};
+}
+
+// Checks that a parameter updated from sparse gradients ends up with the
+// same values as a parameter updated from the same gradients made dense. The
+// gradients hold every row, and some rows twice, so that lazy updates of the
+// rows they hold match dense ones. A last step with a gradient that omits
+// some rows checks that those rows and their state are left as they are.
+template <typename OptimizerClass, typename Options>
+void check_sparse_matches_dense(Options options, size_t steps = 3) {
+  torch::manual_seed(0);
+  const int64_t rows = 10;
+  auto sparse = torch::randn({rows, 4});
+  auto dense = sparse.clone();
+  OptimizerClass sparse_optimizer(std::vector<torch::Tensor>{sparse}, options);
+  OptimizerClass dense_optimizer(std::vector<torch::Tensor>{dense}, options);
+
+  for (size_t step = 0; step < steps; ++step) {
+    auto indices = torch::cat(
+        {torch::randperm(rows, torch::kLong),
+         torch::randint(rows, {5}, torch::kLong)});
+    auto grad = torch::sparse_coo_tensor(
+        indices.unsqueeze(0), torch::randn({indices.numel(), 4}), {rows, 4});
+    sparse.grad() = grad;
+    dense.grad() = grad.to_dense();
+    sparse_optimizer.step();
+    dense_optimizer.step();
+    ASSERT_TRUE(sparse.allclose(dense, 1e-4, 1e-5))
+        << "parameters differ after step " << step;
+  }
+
+  const int64_t kept = rows / 2;
+  auto omitted_state = [&]() {
+    std::vector<torch::Tensor> state;
+    auto it = sparse_optimizer.state().find(
+        c10::guts::to_string(sparse.unsafeGetTensorImpl()));
+    if (it != sparse_optimizer.state().end()) {
+      for (const auto& s : rowwise_state(*it->second)) {
+        state.push_back(s.slice(0, kept).clone());
+      }
+    }
+    return state;
+  };
+  const auto kept_before = sparse.slice(0, 0, kept).clone();
+  const auto omitted_before = sparse.slice(0, kept).clone();
+  const auto omitted_state_before = omitted_state();
+  sparse.grad() = torch::sparse_coo_tensor(
+      torch::arange(kept, torch::kLong).unsqueeze(0),
+      torch::randn({kept, 4}),
+      {rows, 4});
+  sparse_optimizer.step();
+  ASSERT_FALSE(sparse.slice(0, 0, kept).equal(kept_before));
+  ASSERT_TRUE(sparse.slice(0, kept).equal(omitted_before));
+  const auto omitted_state_after = omitted_state();
+  ASSERT_EQ(omitted_state_after.size(), omitted_state_before.size());
+  for (size_t i = 0; i < omitted_state_after.size(); ++i) {
+    ASSERT_TRUE(omitted_state_after[i].equal(omitted_state_before[i]))
+        << "state " << i << " of omitted rows changed";
+  }
+}
+
 TEST(OptimTest, OptimizerAccessors) {
   auto options = AdagradOptions(1.0);
   std::vector<torch::Tensor> params;
@@ -452,3 +557,46 @@ TEST(OptimTest, AddParameter_LBFGS) {
 
   // REQUIRE this doesn't throw
 }
+
+TEST(OptimTest, FusedStepMatchesUnfused_Adam) {
+  check_fused_matches_unfused<Adam>(
+      AdamOptions(0.1).weight_decay(1e-2).amsgrad(true));
+}
+
+TEST(OptimTest, FusedStepMatchesUnfused_Adagrad) {
+  check_fused_matches_unfused<Adagrad>(
+      AdagradOptions(0.1).weight_decay(1e-2).lr_decay(1e-3));
+}
+
+TEST(OptimTest, FusedStepMatchesUnfused_RMSprop) {
+  check_fused_matches_unfused<RMSprop>(RMSpropOptions(0.01)
+                                           .weight_decay(1e-2)
+                                           .centered(true)
+                                           .momentum(0.9));
+}
+
+TEST(OptimTest, FusedStepMatchesUnfused_SGD) {
+  check_fused_matches_unfused<SGD>(
+      SGDOptions(0.1).weight_decay(1e-2).momentum(0.9).nesterov(true));
+}
+
+TEST(OptimTest, SparseStepMatchesDense_Adam) {
+  check_sparse_matches_dense<Adam>(AdamOptions(0.1));
+}
+
+TEST(OptimTest, SparseStepMatchesDense_Adagrad) {
+  check_sparse_matches_dense<Adagrad>(AdagradOptions(0.1).lr_decay(1e-3));
+}
+
+TEST(OptimTest, SparseStepMatchesDense_SGD) {
+  check_sparse_matches_dense<SGD>(SGDOptions(0.1));
+}
+
+TEST(OptimTest, RowwiseUpdateChecksIndices) {
+  auto weight = torch::zeros({3, 2});
+  ASSERT_THROWS_WITH(
+      at::_rowwise_sgd_(
+          weight, torch::tensor({0, 3}, torch::kLong), torch::ones({2, 2}), 1.0),
+      "index 3 is out of bounds for a weight with 3 rows");
+  ASSERT_TRUE(weight.eq(0).all().item<bool>());
+}
@@ -0,0 +1,173 @@
+#include "test/cpp/jit/test_base.h"
+
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/runtime/planned_executor.h>
+
+namespace torch {
+namespace jit {
+
+void testMemoryPlanning() {
+  auto graph = std::make_shared<Graph>();
+  std::unordered_map<std::string, Value*> vmap;
+  parseIR(
+      R"IR(
+graph(%x : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %a : Tensor = aten::sigmoid(%x)
+  %b : Tensor = aten::add(%a, %a, %one)
+  %c : Tensor = aten::tanh(%b)
+  %v : Tensor = aten::t(%c)
+  %d : Tensor = aten::mul(%b, %v)
+  %e : Tensor = aten::add(%d, %d, %one)
+  return (%e))IR",
+      &*graph,
+      vmap);
+
+  for (const char* name : {"a", "b", "c", "d", "e"}) {
+    ASSERT_TRUE(findOutVariant(vmap[name]->node()));
+  }
+  ASSERT_FALSE(findOutVariant(vmap["v"]->node()));
+
+  std::unordered_map<const Value*, size_t> sizes = {
+      {vmap["a"], 100},
+      {vmap["b"], 200},
+      {vmap["c"], 100},
+      {vmap["d"], 100},
+      {vmap["e"], 100},
+  };
+  MemoryPlan plan = planMemory(graph, sizes);
+
+  // The graph output is not planned.
+  ASSERT_EQ(plan.regions.size(), 4);
+  ASSERT_EQ(plan.regions.count(vmap["e"]), 0);
+  for (const auto& entry : plan.regions) {
+    ASSERT_EQ(entry.second.offset % kMemoryPlanAlignment, 0);
+  }
+  const MemoryRegion& a = plan.regions.at(vmap["a"]);
+  const MemoryRegion& b = plan.regions.at(vmap["b"]);
+  const MemoryRegion& c = plan.regions.at(vmap["c"]);
+  const MemoryRegion& d = plan.regions.at(vmap["d"]);
+  // `b` is alive until `d` is computed, and `c` is kept alive by its view
+  // `v`, so `a` is the only value whose memory can be reused, by `c`.
+  ASSERT_EQ(b.offset, 0);
+  ASSERT_EQ(a.offset, c.offset);
+  ASSERT_NE(c.offset, d.offset);
+  ASSERT_TRUE(d.offset >= b.size);
+  ASSERT_EQ(plan.arena_size, 256 + 128 + 128);
+}
+
+void testPlannedExecutor() {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor, %w1 : Tensor, %w2 : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %dim : int = prim::Constant[value=1]()
+  %h1 : Tensor = aten::mm(%x, %w1)
+  %a1 : Tensor = aten::tanh(%h1)
+  %h2 : Tensor = aten::mm(%a1, %w2)
+  %a2 : Tensor = aten::sigmoid(%h2)
+  %s : Tensor = aten::add(%a2, %h2, %one)
+  %l : Tensor[] = prim::ListConstruct(%s, %a2)
+  %c : Tensor = aten::cat(%l, %dim)
+  %y : Tensor = aten::mul(%c, %c)
+  return (%y, %a1))IR",
+      &*graph);
+
+  auto x = at::randn({8, 16});
+  auto w1 = at::randn({16, 32});
+  auto w2 = at::randn({32, 32});
+
+  Code code(graph, "");
+  PlannedExecutor executor(graph);
+  for (int64_t batch : {8, 8, 8, 4, 4}) {
+    auto input = x.narrow(0, 0, batch);
+    Stack ref_stack = {input, w1, w2};
+    InterpreterState(code).run(ref_stack);
+    Stack stack = {input, w1, w2};
+    executor.run(stack);
+    ASSERT_EQ(stack.size(), 2);
+    ASSERT_TRUE(stack[0].toTensor().equal(ref_stack[0].toTensor()));
+    ASSERT_TRUE(stack[1].toTensor().equal(ref_stack[1].toTensor()));
+  }
+
+  // %h1, %h2, %a2, %s and %c go into the arena; %a1 is returned.
+  ASSERT_EQ(executor.numPlannedValues(), 5);
+  ASSERT_TRUE(executor.arenaSize() > 0);
+  ASSERT_TRUE(executor.arenaSize() < 4 * 8 * (32 * 4 + 64 * 2));
+
+  // Inputs of the same sizes but another dtype or other strides are not run
+  // with the plan made for the previous ones.
+  std::vector<Stack> inputs = {
+      {x.to(at::kDouble), w1.to(at::kDouble), w2.to(at::kDouble)},
+      {x.t().contiguous().t(), w1, w2},
+      {x, w1, w2}};
+  for (const Stack& input : inputs) {
+    Stack ref_stack = input;
+    InterpreterState(code).run(ref_stack);
+    Stack stack = input;
+    executor.run(stack);
+    ASSERT_TRUE(stack[0].toTensor().equal(ref_stack[0].toTensor()));
+    ASSERT_TRUE(stack[1].toTensor().equal(ref_stack[1].toTensor()));
+  }
+
+  // The sizes of the intermediates depend on the value of %sizes too.
+  auto reshape_graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor, %sizes : int[]):
+  %one : int = prim::Constant[value=1]()
+  %y : Tensor = aten::mul(%x, %x)
+  %r : Tensor = aten::reshape(%y, %sizes)
+  %z : Tensor = aten::add(%r, %r, %one)
+  %e : Tensor = aten::exp(%z)
+  return (%e))IR",
+      &*reshape_graph);
+  Code reshape_code(reshape_graph, "");
+  PlannedExecutor reshape_executor(reshape_graph);
+  auto y = at::randn({24});
+  for (const std::vector<int64_t>& sizes :
+       std::vector<std::vector<int64_t>>{{4, 6}, {4, 6}, {6, 4}, {4, 6}}) {
+    Stack ref_stack = {y, c10::List<int64_t>(sizes)};
+    InterpreterState(reshape_code).run(ref_stack);
+    Stack stack = {y, c10::List<int64_t>(sizes)};
+    reshape_executor.run(stack);
+    ASSERT_TRUE(stack[0].toTensor().equal(ref_stack[0].toTensor()));
+  }
+  ASSERT_EQ(reshape_executor.numPlannedValues(), 2);
+
+  // The size of the result of aten::nonzero depends on the values of its
+  // input, so it is not written into the arena.
+  auto nonzero_graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %r : Tensor = aten::relu(%x)
+  %n : Tensor = aten::nonzero(%r)
+  %s : Tensor = aten::add(%n, %n, %one)
+  return (%s))IR",
+      &*nonzero_graph);
+  for (Node* node : nonzero_graph->nodes()) {
+    if (node->kind() == aten::nonzero) {
+      ASSERT_EQ(findOutVariant(node), nullptr);
+    }
+  }
+  Code nonzero_code(nonzero_graph, "");
+  PlannedExecutor nonzero_executor(nonzero_graph);
+  for (double threshold : {0.5, -0.5, 0.5, 2.0}) {
+    auto input = at::randn({16}) - threshold;
+    Stack ref_stack = {input};
+    InterpreterState(nonzero_code).run(ref_stack);
+    Stack stack = {input};
+    nonzero_executor.run(stack);
+    ASSERT_TRUE(stack[0].toTensor().equal(ref_stack[0].toTensor()));
+  }
+  // Only %r goes into the arena.
+  ASSERT_EQ(nonzero_executor.numPlannedValues(), 1);
+}
+
+} // namespace jit
+} // namespace torch
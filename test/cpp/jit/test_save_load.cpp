@@ -1,10 +1,12 @@
 #include <test/cpp/jit/test_base.h>
 #include <test/cpp/jit/test_utils.h>
+#include <cstdio>
 #include <sstream>
 
 #include <torch/csrc/jit/serialization/export.h>
 #include <torch/csrc/jit/serialization/import.h>
 #include <torch/csrc/jit/serialization/import_source.h>
+#include <torch/csrc/jit/serialization/pickle.h>
 #include <torch/torch.h>
 
 #include "caffe2/serialize/istream_adapter.h"
@@ -88,6 +90,34 @@ void testSaveExtraFilesHook() {
   }
 }
 
+void testLoadMmap() {
+#ifndef _WIN32
+  const std::string path = "load_mmap_test.pt";
+  {
+    Module m("__torch__.m");
+    m.register_parameter("weight", torch::arange(1024.), false);
+    m.save(path);
+  }
+  {
+    auto loaded = load_mmap(path);
+    auto weight = loaded.attr("weight").toTensor();
+    ASSERT_TRUE(weight.equal(torch::arange(1024.)));
+    // Copy-on-write: this doesn't change the file.
+    weight.zero_();
+  }
+  {
+    auto loaded = load_mmap(
+        path,
+        c10::nullopt,
+        default_extra_files,
+        caffe2::serialize::MmapAdapter::Mode::ReadOnly);
+    ASSERT_TRUE(
+        loaded.attr("weight").toTensor().equal(torch::arange(1024.)));
+  }
+  std::remove(path.c_str());
+#endif
+}
+
 void testTypeTags() {
   auto list = c10::List<c10::List<int64_t>>();
   list.push_back(c10::List<int64_t>({1, 2, 3}));
@@ -121,5 +151,49 @@ void testTypeTags() {
   }
 }
 
+void testUnpickleLargeContainers() {
+  auto dict = c10::Dict<std::string, at::Tensor>();
+  std::vector<at::Tensor> tensors;
+  for (int64_t i = 0; i < 1000; i++) {
+    dict.insert("layer" + std::to_string(i) + ".weight", torch::full({2}, i));
+    tensors.push_back(torch::full({3}, i));
+  }
+  // Larger than the chunks the Unpickler reads at once.
+  std::string big(200000, 'x');
+  auto value = c10::ivalue::Tuple::create(
+      {dict, c10::List<at::Tensor>(tensors), big});
+
+  std::vector<at::Tensor> tensor_table;
+  auto data = pickle(value, &tensor_table);
+
+  // Read the pickle in place, and through a reader that returns at most 7
+  // bytes per call.
+  size_t pos = 0;
+  auto reader = [&](char* buffer, size_t len) -> size_t {
+    len = std::min({len, data.size() - pos, size_t(7)});
+    std::memcpy(buffer, data.data() + pos, len);
+    pos += len;
+    return len;
+  };
+  for (const auto& loaded :
+       {unpickle(data.data(), data.size(), nullptr, &tensor_table),
+        unpickle(reader, nullptr, &tensor_table)}) {
+    const auto& elements = loaded.toTuple()->elements();
+    auto loaded_dict = elements.at(0).toGenericDict();
+    ASSERT_EQ(loaded_dict.size(), 1000);
+    ASSERT_TRUE(loaded_dict.at("layer999.weight")
+                    .toTensor()
+                    .equal(torch::full({2}, 999)));
+    auto loaded_list = elements.at(1).toTensorList();
+    ASSERT_EQ(loaded_list.size(), 1000);
+    ASSERT_TRUE(loaded_list.get(5).equal(tensors[5]));
+    ASSERT_EQ(elements.at(2).toStringRef(), big);
+  }
+
+  // A truncated pickle is an error, not a read past the end.
+  ASSERT_ANY_THROW(
+      unpickle(data.data(), data.size() - 100000, nullptr, &tensor_table));
+}
+
 } // namespace jit
 } // namespace torch
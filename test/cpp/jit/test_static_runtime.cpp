@@ -0,0 +1,96 @@
+#include "test/cpp/jit/test_base.h"
+
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/irparser.h>
+#include <torch/csrc/jit/runtime/interpreter.h>
+#include <torch/csrc/jit/runtime/static_runtime.h>
+
+namespace torch {
+namespace jit {
+
+void testStaticRuntime() {
+  auto graph = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor, %w : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %h : Tensor = aten::mm(%x, %w)
+  %r : Tensor = aten::relu(%h)
+  %n : Tensor = aten::neg(%h)
+  %l : Tensor[] = prim::ListConstruct(%r, %n)
+  %c : Tensor = aten::cat(%l, %one)
+  %a : Tensor, %b : Tensor = prim::ListUnpack(%l)
+  %s : Tensor = aten::add(%a, %b, %one)
+  %t : (Tensor, Tensor) = prim::TupleConstruct(%c, %s)
+  return (%t, %r))IR",
+      &*graph);
+
+  StaticRuntime runtime(graph);
+  // Only aten::neg has no native kernel.
+  ASSERT_EQ(runtime.numFallbackNodes(), 1);
+
+  Code code(graph, "");
+  for (int i = 0; i < 3; i++) {
+    std::vector<IValue> inputs = {at::randn({4, 8}), at::randn({8, 5})};
+    Stack stack = inputs;
+    InterpreterState(code).run(stack);
+    std::vector<IValue> outputs = runtime.run(inputs);
+    ASSERT_EQ(outputs.size(), 2);
+    const auto& expected = stack[0].toTuple()->elements();
+    const auto& actual = outputs[0].toTuple()->elements();
+    ASSERT_TRUE(actual[0].toTensor().equal(expected[0].toTensor()));
+    ASSERT_TRUE(actual[1].toTensor().equal(expected[1].toTensor()));
+    ASSERT_TRUE(outputs[1].toTensor().equal(stack[1].toTensor()));
+  }
+
+  auto graph_with_loop = std::make_shared<Graph>();
+  parseIR(
+      R"IR(
+graph(%x : Tensor, %n : int):
+  %true : bool = prim::Constant[value=1]()
+  %y : Tensor = prim::Loop(%n, %true, %x)
+    block0(%i : int, %acc : Tensor):
+      %next : Tensor = aten::relu(%acc)
+      -> (%true, %next)
+  return (%y))IR",
+      &*graph_with_loop);
+  ASSERT_THROWS_WITH(StaticRuntime{graph_with_loop}, "control flow");
+}
+
+void testStaticRuntimeModule() {
+  Module m("m");
+  m.register_parameter("conv_weight", at::randn({8, 3, 3, 3}), false);
+  m.register_parameter("bn_weight", at::rand({8}), false);
+  m.register_parameter("bn_bias", at::randn({8}), false);
+  m.register_buffer("bn_mean", at::randn({8}));
+  m.register_buffer("bn_var", at::rand({8}) + 0.5);
+  m.register_parameter("fc_weight", at::randn({10, 8}), false);
+  m.register_parameter("fc_bias", at::randn({10}), false);
+  m.define(R"JIT(
+    def forward(self, x):
+        y = torch.conv2d(x, self.conv_weight, None, [1, 1], [1, 1])
+        y = torch.batch_norm(y, self.bn_weight, self.bn_bias, self.bn_mean,
+                             self.bn_var, False, 0.1, 1e-5, False)
+        y = torch.relu(y)
+        y = torch.max_pool2d(y, [2, 2])
+        y = torch.adaptive_avg_pool2d(y, [1, 1])
+        y = torch.flatten(y, 1)
+        return torch.softmax(torch.linear(y, self.fc_weight, self.fc_bias), 1)
+  )JIT");
+  m.eval();
+
+  StaticRuntime runtime(m);
+  ASSERT_EQ(runtime.graph()->inputs().size(), 1);
+  ASSERT_EQ(runtime.numFallbackNodes(), 0);
+
+  for (int64_t batch : {1, 4}) {
+    auto x = at::randn({batch, 3, 16, 16});
+    auto expected = m.forward({x}).toTensor();
+    std::vector<at::Tensor> outputs = runtime.run(std::vector<at::Tensor>{x});
+    ASSERT_EQ(outputs.size(), 1);
+    ASSERT_TRUE(outputs[0].allclose(expected));
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -39,6 +39,10 @@ namespace jit {
   _(WriteTracking)                     \
   _(Wildcards)                         \
   _(MemoryDAG)                         \
+  _(MemoryPlanning)                    \
+  _(PlannedExecutor)                   \
+  _(StaticRuntime)                     \
+  _(StaticRuntimeModule)               \
   _(IRParser)                          \
   _(ConstantPooling)                   \
   _(THNNConv)                          \
@@ -68,7 +72,9 @@ namespace jit {
   _(ScriptObject)                      \
   _(ExtraFilesHookPreference)          \
   _(SaveExtraFilesHook)                \
+  _(LoadMmap)                          \
   _(TypeTags)                          \
+  _(UnpickleLargeContainers)           \
   _(DCE)                               \
   _(CustomFusionNestedBlocks)          \
   _(ClassDerive)                       \
@@ -36,6 +36,48 @@ TEST(WireSerialize, Base) {
   run("more", {torch::randn({5, 5}), torch::rand({10, 10})});
 }
 
+TEST(WireSerialize, Segments) {
+  std::string payload = "payload";
+  std::vector<at::Tensor> tensors = {
+      torch::randn({1024, 64}), torch::empty({0}), torch::arange(10)};
+  auto serialized = torch::distributed::rpc::wireSerializeSegments(
+      std::vector<char>(payload.begin(), payload.end()), tensors);
+
+  // The data of the large tensor is not in the header, but sent from its
+  // storage. The small ones are copied into the header.
+  EXPECT_LT(serialized.header.size(), 1024);
+  ASSERT_EQ(serialized.segments.size(), 1);
+  EXPECT_EQ(serialized.segments[0].first, tensors[0].storage().data());
+  EXPECT_EQ(serialized.segments[0].second, tensors[0].nbytes());
+  auto sizes = torch::distributed::rpc::wireSegmentSizes(
+      serialized.header.data(), serialized.header.size());
+  ASSERT_EQ(sizes.size(), 1);
+  EXPECT_EQ(sizes[0], serialized.segments[0].second);
+
+  std::vector<at::DataPtr> segments;
+  segments.push_back(at::getCPUAllocator()->allocate(sizes[0]));
+  memcpy(segments[0].get(), serialized.segments[0].first, sizes[0]);
+  void* segmentData = segments[0].get();
+
+  auto deser = torch::distributed::rpc::wireDeserializeSegments(
+      serialized.header.data(),
+      serialized.header.size(),
+      std::move(segments));
+  EXPECT_EQ(std::string(deser.first.begin(), deser.first.end()), payload);
+  ASSERT_EQ(deser.second.size(), tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    EXPECT_TRUE(torch::equal(tensors[i], deser.second[i]));
+  }
+  // The received segment became the storage, without a copy.
+  EXPECT_EQ(deser.second[0].storage().data(), segmentData);
+
+  // Without a threshold every non-empty tensor is sent as a segment.
+  auto allSegments = torch::distributed::rpc::wireSerializeSegments(
+      std::vector<char>(payload.begin(), payload.end()), tensors, 1);
+  EXPECT_EQ(allSegments.segments.size(), 2);
+  EXPECT_EQ(allSegments.segments[1].first, tensors[2].storage().data());
+}
+
 TEST(WireSerialize, RecopySparseTensors) {
   // Take a 1K row of a 1M tensors, and make sure we don't send across 1M rows.
   constexpr size_t k1K = 1024;
@@ -0,0 +1,206 @@
+#include "test/cpp/tensorexpr/test_base.h"
+
+#include "test/cpp/tensorexpr/padded_buffer.h"
+#include "torch/csrc/jit/tensorexpr/buffer.h"
+#include "torch/csrc/jit/tensorexpr/closure_eval.h"
+#include "torch/csrc/jit/tensorexpr/eval.h"
+#include "torch/csrc/jit/tensorexpr/function.h"
+#include "torch/csrc/jit/tensorexpr/ir.h"
+#include "torch/csrc/jit/tensorexpr/ir_simplifier.h"
+#include "torch/csrc/jit/tensorexpr/loopnest.h"
+#include "torch/csrc/jit/tensorexpr/tensor.h"
+
+#include <cmath>
+#include <vector>
+
+namespace torch {
+namespace jit {
+using namespace torch::jit::tensorexpr;
+
+void testClosureEvalDynamicShapeAdd() {
+  KernelScope kernel_scope;
+  auto testWithSize = [](int32_t size) {
+    VarHandle n("n", kInt);
+    Buffer a(BufHandle("a", {n}, kFloat));
+    Buffer b(BufHandle("b", {n}, kFloat));
+    Buffer c(BufHandle("c", {n}, kFloat));
+    VarHandle i("i", kInt);
+    Stmt* s = For::make(i, 0, n, Store::make(c, {i}, a(i) + b(i), 1));
+    std::vector<float> aData(size, 1.0f);
+    std::vector<float> bData(size, 2.0f);
+    std::vector<float> cData(size, 0.0f);
+    ClosureIREvaluator cg(s, a, b, c, n);
+    ASSERT_FALSE(cg.isFallback());
+    cg(aData, bData, cData, size);
+    ExpectAllNear(cData, std::vector<float>(size, 3.0f), 1e-7);
+  };
+  testWithSize(1);
+  testWithSize(16);
+  testWithSize(37);
+  testWithSize(ClosureIREvaluator::kBlockSize * 3 + 5);
+}
+
+void testClosureEvalFuserStyle() {
+  KernelScope kernel_scope;
+  const int M = 13;
+  const int N = 150;
+
+  Buffer a_buf(BufHandle("A", {M, N}, kFloat));
+  Buffer b_buf(BufHandle("B", {N}, kFloat));
+  Tensor* c = Compute(
+      "c", {{M, "m"}, {N, "n"}}, [&](const VarHandle& m, const VarHandle& n) {
+        return sigmoid(a_buf(m, n) * b_buf(n)) +
+            Max::make(a_buf(m, n), 0.0f, true);
+      });
+  Tensor* d = Compute(
+      "d", {{M, "m"}, {N, "n"}}, [&](const VarHandle& m, const VarHandle& n) {
+        return exp(c->call(m, n)) - cast<float>(m * N + n);
+      });
+  LoopNest l({c, d});
+  l.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+
+  PaddedBuffer<float> a_v(M, N);
+  PaddedBuffer<float> b_v(N);
+  for (int m = 0; m < M; m++) {
+    for (int n = 0; n < N; n++) {
+      a_v(m, n) = std::sin(m * N + n);
+    }
+  }
+  for (int n = 0; n < N; n++) {
+    b_v(n) = std::cos(n);
+  }
+  PaddedBuffer<float> c_v(M, N);
+  PaddedBuffer<float> d_v(M, N);
+  PaddedBuffer<float> c_ref(M, N);
+  PaddedBuffer<float> d_ref(M, N);
+
+  ClosureIREvaluator cg(s, a_buf, b_buf, c, d);
+  ASSERT_FALSE(cg.isFallback());
+  cg(a_v, b_v, c_v, d_v);
+  SimpleIREvaluator(s, a_buf, b_buf, c, d)(a_v, b_v, c_ref, d_ref);
+
+  ExpectAllNear(c_v, c_ref, 1e-5);
+  ExpectAllNear(d_v, d_ref, 1e-5);
+}
+
+void testClosureEvalCat() {
+  KernelScope kernel_scope;
+  // The branch that is not taken would read out of bounds, so only the
+  // selected value may be evaluated for each element.
+  const int M = 37;
+  const int N = 90;
+  Buffer a_buf(BufHandle("A", {M}, kInt));
+  Buffer b_buf(BufHandle("B", {N}, kInt));
+  Tensor* c = Compute("c", {{M + N, "i"}}, [&](const VarHandle& i) {
+    return ifThenElse(
+        CompareSelect::make(i, M, kLT), a_buf(i), b_buf(i - M) * 2);
+  });
+  LoopNest l({c});
+  l.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(l.root_stmt());
+
+  std::vector<int> a_v(M);
+  std::vector<int> b_v(N);
+  std::vector<int> c_v(M + N, 0);
+  for (int i = 0; i < M; i++) {
+    a_v[i] = i;
+  }
+  for (int i = 0; i < N; i++) {
+    b_v[i] = 1000 + i;
+  }
+
+  ClosureIREvaluator cg(s, {a_buf, b_buf, c});
+  ASSERT_FALSE(cg.isFallback());
+  cg.call({a_v, b_v, c_v});
+  for (int i = 0; i < M + N; i++) {
+    ASSERT_EQ(c_v[i], i < M ? i : (1000 + i - M) * 2);
+  }
+}
+
+void testClosureEvalReduce() {
+  KernelScope kernel_scope;
+  const int M = 5;
+  const int N = 300;
+
+  Buffer b(BufHandle("b", {M, N}, kFloat));
+  std::vector<float> in(M * N);
+  for (int i = 0; i < M * N; ++i) {
+    in[i] = i % 17;
+  }
+  std::vector<float> out(M, -1.f);
+  std::vector<float> ref(M, -1.f);
+
+  Tensor* c = Reduce("sum", {{M, "m"}}, Sum(), b, {{N, "n"}});
+  LoopNest loop({c});
+  loop.prepareForCodegen();
+  Stmt* s = IRSimplifier::simplify(loop.root_stmt());
+
+  ClosureIREvaluator cg(s, {b, c});
+  ASSERT_FALSE(cg.isFallback());
+  cg.call({in, out});
+  SimpleIREvaluator(s, {b, c}).call({in, ref});
+  ExpectAllNear(out, ref, 1e-5);
+}
+
+void testClosureEvalCond() {
+  KernelScope kernel_scope;
+  const int N = 100;
+  PaddedBuffer<float> a_v(N);
+  Buffer a_buf("a", kFloat, {N});
+  VarHandle index = VarHandle("index", kInt);
+  Stmt* assign_x2 =
+      Store::make(BufHandle(a_buf.data()), {index}, cast<float>(index) * 2, 1);
+  Stmt* assign_x3 =
+      Store::make(BufHandle(a_buf.data()), {index}, cast<float>(index) * 3, 1);
+  ExprHandle even_cond = CompareSelect::make(Mod::make(index, 2), 0, kEQ);
+  Stmt* assign = Cond::make(even_cond, assign_x2, assign_x3);
+  Stmt* for_stmt = For::make(index, 0, N, assign);
+  ClosureIREvaluator(for_stmt, a_buf)(a_v);
+
+  PaddedBuffer<float> a_ref(N);
+  for (int i = 0; i < N; i++) {
+    if (i % 2 == 0) {
+      a_ref(i) = i * 2;
+    } else {
+      a_ref(i) = i * 3;
+    }
+  }
+  ExpectAllNear(a_v, a_ref, 1e-5);
+}
+
+void testClosureEvalFallback() {
+  KernelScope kernel_scope;
+  const int kVectorSize = 8;
+  const int kVectorCount = 16;
+  const int kTotalSize = kVectorSize * kVectorCount;
+
+  Buffer a_buf(BufHandle("A", {ExprHandle(kTotalSize)}, kFloat));
+  Buffer b_buf(BufHandle("B", {ExprHandle(kTotalSize)}, kFloat));
+  VarHandle index = VarHandle("index", kInt);
+  ExprHandle load_a = Load::make(
+      a_buf,
+      {Ramp::make(index * kVectorSize, 1, kVectorSize)},
+      Broadcast::make(1, kVectorSize));
+  Stmt* store_b = Store::make(
+      b_buf,
+      {Ramp::make(index * kVectorSize, 1, kVectorSize)},
+      load_a + load_a,
+      Broadcast::make(1, kVectorSize));
+  Stmt* stmt = For::make(index, 0, kVectorCount, store_b);
+
+  std::vector<float> a_v(kTotalSize);
+  std::vector<float> b_v(kTotalSize, 0.0f);
+  for (int i = 0; i < kTotalSize; i++) {
+    a_v[i] = i;
+  }
+  ClosureIREvaluator cg(stmt, a_buf, b_buf);
+  ASSERT_TRUE(cg.isFallback());
+  cg(a_v, b_v);
+  for (int i = 0; i < kTotalSize; i++) {
+    ASSERT_EQ(b_v[i], 2.0f * i);
+  }
+}
+
+} // namespace jit
+} // namespace torch
@@ -105,5 +105,73 @@ void testKernel_3() {
   }
 }
 
+void testKernelReductions() {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(4:100,100:1)):
+        %1 : int = prim::Constant[value=-1]()
+        %2 : bool = prim::Constant[value=1]()
+        %3 : None = prim::Constant()
+        %4 : int = prim::Constant[value=1]()
+        %5 : Float(4:1,1:1), %6 : Long(4:1,1:1) = aten::max(%0, %1, %2)
+        %7 : Float(4:100,100:1) = aten::sub(%0, %5, %4)
+        %8 : Float() = aten::sum(%7, %3)
+        return (%5, %8))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  auto a = at::rand({4, 100}, TensorOptions(kCPU).dtype(at::kFloat));
+  auto refMax = std::get<0>(a.max(-1, true));
+  auto refSum = (a - refMax).sum();
+  TensorExprKernel k(graph);
+  std::vector<at::Tensor> inputs = {a};
+  std::vector<IValue> stack = fmap<IValue>(inputs);
+  k.run(stack);
+  auto max = stack[0].toTensor();
+  auto sum = stack[1].toTensor();
+  ASSERT_EQ(max.sizes(), refMax.sizes());
+  for (size_t i = 0; i < 4; i++) {
+    CHECK_EQ(((float*)max.data_ptr())[i], ((float*)refMax.data_ptr())[i]);
+  }
+  ASSERT_EQ(sum.dim(), 0);
+  ASSERT_NEAR(sum.item<float>(), refSum.item<float>(), 1e-3);
+}
+
+void testKernelSoftmax() {
+  KernelScope kernel_scope;
+
+  const auto graph_string = R"IR(
+      graph(%0 : Float(8:130,130:1)):
+        %1 : int = prim::Constant[value=1]()
+        %2 : int = prim::Constant[value=0]()
+        %3 : None = prim::Constant()
+        %4 : Float(8:130,130:1) = aten::softmax(%0, %1, %3)
+        %5 : Float(8:130,130:1) = aten::log_softmax(%0, %2, %3)
+        return (%4, %5))IR";
+  auto graph = std::make_shared<Graph>();
+  parseIR(graph_string, &*graph);
+
+  auto a = at::randn({8, 130}, TensorOptions(kCPU).dtype(at::kFloat)) * 10;
+  auto refSoftmax = at::softmax(a, 1);
+  auto refLogSoftmax = at::log_softmax(a, 0);
+  TensorExprKernel k(graph);
+  std::vector<at::Tensor> inputs = {a};
+  std::vector<IValue> stack = fmap<IValue>(inputs);
+  k.run(stack);
+  auto softmax = stack[0].toTensor();
+  auto logSoftmax = stack[1].toTensor();
+  for (size_t i = 0; i < 8 * 130; i++) {
+    ASSERT_NEAR(
+        ((float*)softmax.data_ptr())[i],
+        ((float*)refSoftmax.data_ptr())[i],
+        1e-5);
+    ASSERT_NEAR(
+        ((float*)logSoftmax.data_ptr())[i],
+        ((float*)refLogSoftmax.data_ptr())[i],
+        1e-4);
+  }
+}
+
 } // namespace jit
 } // namespace torch
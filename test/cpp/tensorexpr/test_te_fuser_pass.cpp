@@ -62,5 +62,31 @@ void testFuserPass_2() {
       ->run(*g);
 }
 
+void testFuserPass_3() {
+  KernelScope kernel_scope;
+  const auto graph_string = R"IR(
+    graph(%0 : Float(8:128,128:1),
+          %1 : Float(128:1)):
+      %12 : int = prim::Constant[value=1]()
+      %13 : int = prim::Constant[value=-1]()
+      %14 : None = prim::Constant()
+      %a : Float(8:128,128:1) = aten::add(%0, %1, %12)
+      %b : Float(8:128,128:1) = aten::softmax(%a, %13, %14)
+      %c : Float(8:128,128:1) = aten::mul(%b, %0)
+      return (%c))IR";
+  auto g = std::make_shared<Graph>();
+  torch::jit::parseIR(graph_string, g.get());
+
+  g->lint();
+  FuseTensorExprs(g);
+
+  // The softmax is fused together with its producer and its consumer.
+  testing::FileCheck()
+      .check("tensorexpr::Group_0")
+      ->check_not("tensorexpr::Group_1")
+      ->check("aten::softmax")
+      ->run(*g);
+}
+
 } // namespace jit
 } // namespace torch
@@ -81,6 +81,12 @@ namespace jit {
   _(Cond01)                                 \
   _(IfThenElse01)                           \
   _(IfThenElse02)                           \
+  _(ClosureEvalDynamicShapeAdd)             \
+  _(ClosureEvalFuserStyle)                  \
+  _(ClosureEvalCat)                         \
+  _(ClosureEvalReduce)                      \
+  _(ClosureEvalCond)                        \
+  _(ClosureEvalFallback)                    \
   _(ATen_cast_Float)                        \
   _(ATennegInt)                             \
   _(ATennegFloat)                           \
@@ -191,8 +197,11 @@ namespace jit {
   _(Kernel_1)                               \
   _(Kernel_2)                               \
   _(Kernel_3)                               \
+  _(KernelReductions)                       \
+  _(KernelSoftmax)                          \
   _(FuserPass_1)                            \
-  _(FuserPass_2)
+  _(FuserPass_2)                            \
+  _(FuserPass_3)
 
 #define TH_FORALL_TENSOREXPR_TESTS_LLVM(_) \
   _(LLVMByteImmTest)                       \
@@ -273,6 +273,22 @@ class TCPStoreTest(TestCase, StoreTestBase):
             store1 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
             store2 = c10d.TCPStore(addr, port, 1, True)  # noqa: F841
 
+    def test_compare_set(self):
+        store = self._create_store()
+        self.assertEqual(b"", store.compare_set("key", "a", "b"))
+        self.assertEqual(b"a", store.compare_set("key", "", "a"))
+        self.assertEqual(b"a", store.compare_set("key", "x", "b"))
+        self.assertEqual(b"b", store.compare_set("key", "a", "b"))
+        self.assertEqual(b"b", store.get("key"))
+
+    def test_multi_get_multi_set(self):
+        store = self._create_store()
+        keys = ["key{}".format(i) for i in range(10)]
+        values = ["value{}".format(i) for i in range(10)]
+        store.multi_set(keys, values)
+        self.assertEqual([v.encode() for v in values], store.multi_get(keys))
+        self.assertEqual([], store.multi_get([]))
+
 
 class PrefixTCPStoreTest(TestCase, StoreTestBase):
     def setUp(self):
@@ -1459,6 +1475,139 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
         inputs = [torch.tensor([i + self.rank]).cuda() for i in range(1000)]
         self._test_reduce_stress(inputs)
 
+    def test_reduce_scatter_checks(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        t1 = torch.zeros([1], dtype=torch.float32)
+        t2 = torch.zeros([1], dtype=torch.float64)
+        t3 = torch.zeros([2], dtype=torch.float32)
+
+        with self.assertRaisesRegex(ValueError, "requires a single-element output tensor list"):
+            pg.reduce_scatter([], [[t1] * self.world_size])
+
+        with self.assertRaisesRegex(ValueError, "requires a single-element input list"):
+            pg.reduce_scatter([t1], [])
+
+        with self.assertRaisesRegex(ValueError, "Incorrect input list size"):
+            pg.reduce_scatter([t1], [[t1] * (self.world_size + 1)])
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.reduce_scatter([t1], [[t2] * self.world_size])
+
+        with self.assertRaisesRegex(ValueError, "same number of elements"):
+            pg.reduce_scatter([t1], [[t3] * self.world_size])
+
+    def test_reduce_scatter_basics(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # The input for rank i has i + 1 elements, so the chunks of the ring
+        # have different sizes, and the one for rank 0 in the list below
+        # is empty.
+        for sizes in [[i + 1 for i in range(self.world_size)],
+                      [i for i in range(self.world_size)]]:
+            for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+                inputs = [input.repeat(size) for size in sizes]
+                tmp = [torch.zeros_like(inputs[self.rank])]
+                opts = c10d.ReduceScatterOptions()
+                opts.reduceOp = op
+                pg.reduce_scatter(tmp, [inputs], opts).wait()
+                # TODO(#38095): Replace assertEqualIgnoreType. See issue #38095
+                self.assertEqualIgnoreType(output.repeat(sizes[self.rank]), tmp[0])
+
+    def test_reduce_scatter_stress(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts(threads=8))
+        work_handles = []
+        outputs = []
+        for i in range(100):
+            inputs = [torch.tensor([i + self.rank + j]) for j in range(self.world_size)]
+            output = torch.tensor([-1])
+            outputs.append(output)
+            work_handles.append(pg.reduce_scatter([output], [inputs]))
+
+        for i, work_handle in enumerate(work_handles):
+            work_handle.wait()
+            self.assertEqual(
+                torch.tensor([
+                    (i + self.rank) * self.world_size +
+                    (self.world_size * (self.world_size - 1) // 2)
+                ]),
+                outputs[i],
+                msg=("Mismatch in iteration %d" % i),
+            )
+
+    def test_alltoall_checks(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        t1 = torch.zeros([self.world_size], dtype=torch.float32)
+        t2 = torch.zeros([self.world_size], dtype=torch.float64)
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.alltoall_base(t1, t2, [], [])
+
+        with self.assertRaisesRegex(ValueError, "requires contiguous"):
+            pg.alltoall_base(t1, torch.zeros([self.world_size, 2]).t(), [], [])
+
+        with self.assertRaisesRegex(RuntimeError, "does not divide equally"):
+            pg.alltoall_base(t1, torch.zeros([self.world_size + 1]), [], [])
+
+        with self.assertRaisesRegex(RuntimeError, "not equal to group size"):
+            pg.alltoall_base(t1, t1, [], [self.world_size])
+
+        with self.assertRaisesRegex(ValueError, "number of input tensors"):
+            pg.alltoall([t1] * self.world_size, [t1])
+
+        with self.assertRaisesRegex(ValueError, "invalid tensor type"):
+            pg.alltoall([t1] * self.world_size, [t2] * self.world_size)
+
+    def test_alltoall_basics(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
+
+        # Equal splits.
+        input = torch.arange(self.world_size * 2).view(-1, 2) + self.rank * 100
+        output = torch.empty_like(input)
+        pg.alltoall_base(output, input, [], []).wait()
+        expected = torch.stack(
+            [torch.tensor([2 * self.rank, 2 * self.rank + 1]) + i * 100
+             for i in range(self.world_size)])
+        self.assertEqual(expected, output)
+
+        # Uneven splits: rank i sends i + j + 1 rows to rank j, and
+        # nothing to itself.
+        def rows(src, dst):
+            return 0 if src == dst else src + dst + 1
+
+        input_splits = [rows(self.rank, j) for j in range(self.world_size)]
+        output_splits = [rows(i, self.rank) for i in range(self.world_size)]
+        input = torch.cat([
+            torch.full([size, 3], self.rank * 10 + j)
+            for j, size in enumerate(input_splits)
+        ])
+        output = torch.full([sum(output_splits), 3], -1)
+        pg.alltoall_base(output, input, output_splits, input_splits).wait()
+        expected = torch.cat([
+            torch.full([size, 3], i * 10 + self.rank)
+            for i, size in enumerate(output_splits)
+        ])
+        self.assertEqual(expected, output)
+
+        # Tensor lists.
+        inputs = [
+            torch.full([self.rank + 1, j + 1], float(self.rank))
+            for j in range(self.world_size)
+        ]
+        outputs = [
+            torch.empty([i + 1, self.rank + 1])
+            for i in range(self.world_size)
+        ]
+        pg.alltoall(outputs, inputs).wait()
+        for i, output in enumerate(outputs):
+            self.assertEqual(torch.full([i + 1, self.rank + 1], float(i)), output)
+
     def test_send_recv_all_to_all(self):
         store = c10d.FileStore(self.file_name, self.world_size)
         pg = c10d.ProcessGroupGloo(store, self.rank, self.world_size, self.opts())
@@ -1554,6 +1703,63 @@ class ProcessGroupGlooTest(MultiProcessTestCase):
                 self.assertEqual(torch.full([10, 10], float(self.world_size)), tensor)
             del pg
 
+    def _create_hierarchical_process_group(self, store, local_size, chunk_size):
+        # Emulate world_size / local_size machines with local_size processes
+        # each, where the process with the lowest rank is the leader.
+        global_group = c10d.ProcessGroupGloo(
+            c10d.PrefixStore("global", store), self.rank, self.world_size, self.opts())
+        inter_node_group = None
+        if self.rank % local_size == 0 and self.world_size > local_size:
+            inter_node_group = c10d.ProcessGroupGloo(
+                c10d.PrefixStore("inter_node", store),
+                self.rank // local_size,
+                self.world_size // local_size,
+                self.opts())
+        return c10d._hierarchical_process_group(
+            c10d.PrefixStore("hierarchical", store),
+            self.rank,
+            self.world_size,
+            local_size,
+            global_group,
+            inter_node_group,
+            chunk_size=chunk_size)
+
+    def test_hierarchical_allreduce(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        for local_size in [1, 2, self.world_size]:
+            # A chunk size of 64 bytes reduces the tensors below in a
+            # number of chunks, the last of which is partial.
+            pg = self._create_hierarchical_process_group(
+                c10d.PrefixStore(str(local_size), store), local_size, 64)
+            for (op, input, output) in simple_reduce_tests(self.rank, self.world_size):
+                tensor = input.repeat(37)
+                pg.allreduce(tensor, op).wait()
+                # TODO(#38095): Replace assertEqualIgnoreType. See issue #38095
+                self.assertEqualIgnoreType(output.repeat(37), tensor)
+
+            # Multiple outstanding operations run in order.
+            tensors = [torch.full([100], float(self.rank + i)) for i in range(10)]
+            work = [pg.allreduce(tensor) for tensor in tensors]
+            pg.barrier().wait()
+            for i, tensor in enumerate(tensors):
+                self.assertTrue(work[i].is_completed())
+                expected = i * self.world_size + self.world_size * (self.world_size - 1) / 2
+                self.assertEqual(torch.full([100], float(expected)), tensor)
+            del pg
+
+    def test_hierarchical_forwards_to_global_group(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        pg = self._create_hierarchical_process_group(store, 2, 1024)
+
+        # Non-contiguous tensors are allreduced by the global group.
+        tensor = torch.full([4, 4], float(self.rank)).t()
+        pg.allreduce(tensor).wait()
+        self.assertEqual(torch.full([4, 4], float(self.world_size * (self.world_size - 1) / 2)), tensor)
+
+        tensor = torch.full([10], float(self.rank))
+        pg.broadcast(tensor, root=1).wait()
+        self.assertEqual(torch.full([10], 1.), tensor)
+
 
 @requires_nccl()
 class ProcessGroupNCCLTest(TestCase):
@@ -2032,6 +2238,48 @@ class DistributedDataParallelTest(MultiProcessTestCase):
     def test_gloo_backend_cpu_module(self):
         self._test_gloo_backend([torch.device('cpu')], [])
 
+    @requires_gloo()
+    def test_gloo_builtin_comm_hooks(self):
+        store = c10d.FileStore(self.file_name, self.world_size)
+        options = c10d.ProcessGroupGloo.Options()
+        options.devices = [c10d.ProcessGroupGloo.create_device(interface=LOOPBACK)]
+        process_group = c10d.ProcessGroupGloo(store, self.rank, self.world_size, options)
+
+        torch.manual_seed(self.rank)
+        input = torch.randn(4, 32)
+
+        def ddp_grad(comm_hook_type, **kwargs):
+            torch.manual_seed(0)
+            ddp_model = DistributedDataParallel(
+                nn.Linear(32, 32), process_group=process_group)
+            if comm_hook_type is not None:
+                ddp_model._register_builtin_comm_hook(comm_hook_type, **kwargs)
+            ddp_model(input).sum().backward()
+            return ddp_model.module.weight.grad
+
+        expected = ddp_grad(None)
+        # Compression that does not lose anything matches plain allreduce.
+        self.assertEqual(ddp_grad('fp16'), expected, atol=1e-2, rtol=1e-2)
+        self.assertEqual(ddp_grad('topk', ratio=1.0), expected)
+
+        # The weight and bias gradients fill a 1056 element bucket, which
+        # PowerSGD views as a 33x32 matrix. As the loss is a sum, all the
+        # rows of the weight gradient are equal and the matrix has rank 2,
+        # so a rank 2 approximation is exact. (33 + 32) * 2 is well below
+        # 1056, so the bucket is compressed rather than allreduced as is.
+        self.assertEqual(ddp_grad('powersgd', rank=2), expected, atol=1e-3, rtol=1e-3)
+        # A rank 1 approximation loses part of the gradient, which shows
+        # that the compressed path ran.
+        self.assertFalse(torch.allclose(ddp_grad('powersgd', rank=1), expected, atol=1e-3, rtol=1e-3))
+
+        # Lossy compression still yields the same gradient on every process.
+        for comm_hook_type, kwargs in [('topk', {'ratio': 0.1}), ('powersgd', {'rank': 1})]:
+            grad = ddp_grad(comm_hook_type, **kwargs)
+            self.assertTrue(torch.isfinite(grad).all())
+            grads = [torch.empty_like(grad) for _ in range(self.world_size)]
+            process_group.allgather([grads], [grad]).wait()
+            self.assertEqual(grads[0], grads[1])
+
     @requires_gloo()
     @skip_if_not_multigpu
     def test_gloo_backend_1gpu_module_device_ids_integer_list(self):
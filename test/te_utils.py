@@ -39,3 +39,7 @@ class LLVMCodeGenExecuted(ExecutionCounter):
 class SimpleIREvalExecuted(ExecutionCounter):
     def __init__(self):
         super(SimpleIREvalExecuted, self).__init__("simple_ir_eval_executed")
+
+class ClosureIREvalExecuted(ExecutionCounter):
+    def __init__(self):
+        super(ClosureIREvalExecuted, self).__init__("closure_ir_eval_executed")
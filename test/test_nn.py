@@ -9232,6 +9232,46 @@ class TestNNDeviceType(NNTestCase):
         output.sum().backward()
         self.assertEqualTypeString(output, input)
 
+        # As on CPU for BFloat16, the statistics are returned in float.
+        _, mean, rstd = torch.native_layer_norm(input, m.weight, m.bias, 6, 6, 1e-5)
+        self.assertEqual(mean.dtype, torch.float)
+        self.assertEqual(rstd.dtype, torch.float)
+
+    def _test_LayerNorm_cpu_bfloat16(self, device):
+        # BFloat16 layer norm computes in float, so it matches float layer norm
+        # on the same inputs up to the rounding of its inputs and outputs.
+        for shape, normalized_shape in [((4, 7), (7,)), ((2, 3, 40), (3, 40)), ((8, 1000), (1000,))]:
+            x = torch.empty(*shape, device=device).uniform_(-10, 10).bfloat16()
+            ln = nn.LayerNorm(normalized_shape).to(device, torch.bfloat16)
+            ln.weight.data.uniform_(0.5, 2)
+            ln.bias.data.uniform_(-1, 1)
+            ln_ref = deepcopy(ln).float()
+
+            x_bf16 = x.clone().requires_grad_()
+            x_ref = x.float().requires_grad_()
+            output = ln(x_bf16)
+            output_ref = ln_ref(x_ref)
+            self.assertEqual(output.dtype, torch.bfloat16)
+            self.assertEqual(output.float(), output_ref, atol=5e-2, rtol=1e-2)
+
+            grad = torch.randn(*shape, device=device).bfloat16()
+            output.backward(grad)
+            output_ref.backward(grad.float())
+            self.assertEqual(x_bf16.grad.dtype, torch.bfloat16)
+            self.assertEqual(x_bf16.grad.float(), x_ref.grad, atol=5e-2, rtol=2e-2)
+            self.assertEqual(ln.weight.grad.float(), ln_ref.weight.grad, atol=1e-1, rtol=2e-2)
+            self.assertEqual(ln.bias.grad.float(), ln_ref.bias.grad, atol=1e-1, rtol=2e-2)
+
+            # The statistics are returned in float.
+            _, mean, rstd = torch.native_layer_norm(
+                x, ln.weight, ln.bias, x.numel() // ln.weight.numel(), ln.weight.numel(), 1e-5)
+            _, mean_ref, rstd_ref = torch.native_layer_norm(
+                x.float(), ln_ref.weight, ln_ref.bias, x.numel() // ln.weight.numel(), ln.weight.numel(), 1e-5)
+            self.assertEqual(mean.dtype, torch.float)
+            self.assertEqual(rstd.dtype, torch.float)
+            self.assertEqual(mean, mean_ref, atol=1e-4, rtol=1e-4)
+            self.assertEqual(rstd, rstd_ref, atol=1e-4, rtol=1e-4)
+
     def _test_GroupNorm_general(self, device, dtype=torch.float):
         good_shape_g = {
             (1, 2, 3, 4): 2,
@@ -9373,6 +9413,9 @@ class TestNNDeviceType(NNTestCase):
         if self.device_type == 'cuda' and TEST_WITH_ROCM:
             self._test_LayerNorm_general(device, dtype=torch.bfloat16)
 
+        if self.device_type == 'cpu':
+            self._test_LayerNorm_cpu_bfloat16(device)
+
         if self.device_type == 'cuda':
             self._test_LayerNorm_cuda_half(device)
 
@@ -17907,6 +17907,18 @@ class TestDevicePrecision(TestCase):
 
         self.assertEqual(out_cpu, out_gpu, atol=1e-2, rtol=0)
 
+    @onlyCPU
+    def test_sum_bfloat16_rounds_once(self, device):
+        # Sums of ones are exact in float whatever the order, so a BFloat16
+        # sum that accumulates in float must match it rounded once, also when
+        # an output element is reduced over several inner loops or threads.
+        x = torch.ones(1000, 4, 300, dtype=torch.bfloat16, device=device)
+        for t in (x, x.permute(2, 1, 0)):
+            self.assertEqual(t.sum(), t.float().sum().bfloat16(), atol=0, rtol=0)
+            for dims in ((0, 2), (0,), (2,), (0, 1)):
+                self.assertEqual(t.sum(dim=dims), t.float().sum(dim=dims).bfloat16(),
+                                 atol=0, rtol=0)
+
     @skipCUDAIfRocm
     @dtypes(torch.double)
     def test_sum_noncontig(self, device, dtype):
@@ -23,7 +23,9 @@ struct DataLoaderOptions {
   TORCH_ARG(size_t, workers) = 0;
 
   /// The maximum number of jobs to enqueue for fetching by worker threads.
-  /// Defaults to two times the number of worker threads.
+  /// Defaults to two times the number of worker threads. This is the prefetch
+  /// depth: at most this many batches are being loaded or are waiting to be
+  /// consumed at any time, which bounds the memory the DataLoader holds.
   TORCH_ARG(optional<size_t>, max_jobs);
 
   /// An optional limit on the time to wait for the next batch.
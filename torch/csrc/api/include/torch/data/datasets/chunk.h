@@ -9,6 +9,13 @@
 
 #include <torch/serialize.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <random>
+
 namespace torch {
 namespace data {
 namespace datasets {
@@ -30,6 +37,20 @@ class ChunkDataReader {
   /// Read an entire chunk.
   virtual ChunkType read_chunk(size_t chunk_index) = 0;
 
+  /// Read a chunk incrementally, passing its examples to `consumer` in one or
+  /// more pieces as soon as they are read. When `consumer` returns false, no
+  /// more examples are needed and the rest of the chunk should be skipped.
+  ///
+  /// Readers of large chunks can override this so that the chunk dataset
+  /// batches the beginning of a chunk while the rest is still being read, and
+  /// only ever holds a few pieces of it in memory. The default implementation
+  /// passes the entire chunk as a single piece.
+  virtual void stream_chunk(
+      size_t chunk_index,
+      const std::function<bool(ChunkType)>& consumer) {
+    consumer(read_chunk(chunk_index));
+  }
+
   /// Returns the number of chunks available in this reader.
   virtual size_t chunk_count() = 0;
 
@@ -38,11 +59,16 @@ class ChunkDataReader {
 };
 
 namespace detail {
-/// BatchDataBuffer manages a queue of UnwrappedBatchData. After a new chunk is
-/// loaded, BatchDataBuffer splits it into small batches and push them into the
-/// queue. When get_batch is called from data loader, it pops cached batches and
-/// return. If the cache is empty, it either waits to load more chunks or return
-/// null if all chunks are loaded.
+/// BatchDataBuffer manages a queue of UnwrappedBatchData. Preloaders split the
+/// chunk data they load into batches and push them into the queue. When
+/// get_batch is called from data loader, it pops cached batches and return. If
+/// the cache is empty, it either waits to load more chunks or return null if
+/// all chunks are loaded.
+///
+/// The queue lock is only held to move whole batches in and out of the queue.
+/// Examples are sampled and moved into batches by the preloaders before they
+/// take it, and each preloader keeps the examples that don't fill a whole
+/// batch in a partial batch of its own until its next chunk completes it.
 template <
     typename UnwrappedBatch,
     typename ExampleSampler = samplers::RandomSampler>
@@ -90,9 +116,40 @@ class BatchDataBuffer {
     return batch.batch_data;
   }
 
-  /// Push preloaded chunks to batch queue. Called from the ChunkDataset worker
-  /// threads.
-  void add_chunk_data(UnwrappedBatchType data) {
+  /// Split preloaded chunk data into batches and push them to the batch queue.
+  /// Called from the ChunkDataset worker threads. `partial` is the partial
+  /// batch of the calling worker: it is filled first, and is left with the
+  /// examples that don't fill a whole batch. Returns false if the buffer was
+  /// stopped, in which case no more data is needed.
+  bool add_chunk_data(UnwrappedBatchType data, UnwrappedBatchType& partial) {
+    const auto data_size = data.size();
+    BatchRequestType indices;
+    {
+      std::lock_guard<std::mutex> lock(sampler_mutex_);
+      example_sampler_.reset(data_size);
+      auto example_indices = example_sampler_.next(data_size);
+      AT_ASSERT(
+          example_indices && example_indices.value().size() == data_size);
+      indices = std::move(example_indices.value());
+    }
+
+    std::vector<UnwrappedBatchType> batches;
+    for (size_t i : indices) {
+      TORCH_CHECK(i < data_size, "Index out of range");
+      if (partial.empty()) {
+        // Allocate the batch memory ahead of time.
+        partial.reserve(batch_size_);
+      }
+      partial.emplace_back(std::move(data[i]));
+      if (partial.size() == batch_size_) {
+        batches.emplace_back(std::move(partial));
+        partial = UnwrappedBatchType();
+      }
+    }
+    if (batches.empty()) {
+      return true;
+    }
+
     std::unique_lock<std::mutex> lock(queue_mutex_);
     cv_write_.wait(lock, [this] {
       // stop loading if we have preloaded enough data.
@@ -102,53 +159,15 @@ class BatchDataBuffer {
     if (stop_) {
       // When stop_ is true, it means no further chunk loading is necessary.
       // Return without any further processing.
-      return;
-    }
-
-    auto data_size = data.size();
-    auto remaining_size = data_size;
-    example_sampler_.reset(data_size);
-
-    auto fill_batch = [&](size_t example_count, UnwrappedBatchType& batch) {
-      auto batch_example_indices = this->example_sampler_.next(example_count);
-      AT_ASSERT(
-          batch_example_indices &&
-          batch_example_indices.value().size() == example_count);
-      BatchRequestType& indices = batch_example_indices.value();
-      for (size_t i : indices) {
-        TORCH_CHECK(i < data_size, "Index out of range");
-        batch.emplace_back(std::move(data[i]));
-      }
-      remaining_size -= example_count;
-    };
-
-    if (!batch_queue_.empty()) {
-      // if the queue has existing data, and the last batch doesn't have enough
-      // examples to fill a batch_size batch, add more example to this batch first.
-      auto& batch = batch_queue_.back();
-      size_t current_count = batch.batch_data.size();
-      if (current_count < batch_size_) {
-        auto example_count =
-            std::min(remaining_size, batch_size_ - current_count);
-        fill_batch(example_count, batch.batch_data);
-      }
+      return false;
     }
-
-    // If we still have data remaining after filling the last pushed batch, add
-    // them to the queue too.
-    while (remaining_size > 0) {
-      UnwrappedBatchType current_batch;
-
-      // Allocate the batch memory ahead of time.
-      current_batch.reserve(batch_size_);
-
-      auto example_count = std::min(remaining_size, batch_size_);
-      fill_batch(example_count, current_batch);
-      batch_queue_.emplace(std::move(current_batch));
+    for (auto& batch : batches) {
+      batch_queue_.emplace(std::move(batch));
     }
-    total_example_count_in_queue_ += data_size;
+    total_example_count_in_queue_ += batches.size() * batch_size_;
     lock.unlock();
     cv_read_.notify_all();
+    return true;
   }
 
   /// Push exceptions thrown during preloading into batch queue. Called from
@@ -173,6 +192,47 @@ class BatchDataBuffer {
     cv_read_.notify_all();
   }
 
+  /// Hand over the partial batch of a worker that has no more chunks to load.
+  /// The partial batches of all workers are merged, so that only the batch
+  /// pushed by `finish()` can be smaller than the batch size.
+  void flush(UnwrappedBatchType partial) {
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    if (stop_) {
+      return;
+    }
+    bool pushed = false;
+    for (auto& example : partial) {
+      if (pending_.empty()) {
+        pending_.reserve(batch_size_);
+      }
+      pending_.emplace_back(std::move(example));
+      if (pending_.size() == batch_size_) {
+        batch_queue_.emplace(std::move(pending_));
+        pending_ = UnwrappedBatchType();
+        total_example_count_in_queue_ += batch_size_;
+        pushed = true;
+      }
+    }
+    lock.unlock();
+    if (pushed) {
+      cv_read_.notify_all();
+    }
+  }
+
+  /// Push the last batch of the epoch, which holds the examples left over by
+  /// `flush()`, and stop. Called once all workers have flushed.
+  void finish() {
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex_);
+      if (!stop_ && !pending_.empty()) {
+        total_example_count_in_queue_ += pending_.size();
+        batch_queue_.emplace(std::move(pending_));
+        pending_ = UnwrappedBatchType();
+      }
+    }
+    stop();
+  }
+
   void stop(){
     {
       // Hold the lock before changing stop_ to prevent a race condition which can
@@ -222,12 +282,18 @@ class BatchDataBuffer {
   /// local cache to store example batches from loaded chunk
   std::queue<UnwrappedBatchData> batch_queue_;
 
+  /// examples flushed by the workers that don't fill a whole batch yet.
+  UnwrappedBatchType pending_;
+
   // sync batch_queue_ update.
   std::mutex queue_mutex_;
 
   std::condition_variable cv_read_;
   std::condition_variable cv_write_;
 
+  // sync example_sampler_ access, which is shared by all workers.
+  std::mutex sampler_mutex_;
+
   ExampleSampler& example_sampler_;
 
   // configurable maximun number of elements the queue can hold at one time.
@@ -241,6 +307,60 @@ class BatchDataBuffer {
   // the program to hang. This boolean is used to break this waiting condition.
   bool stop_ = false;
 };
+
+/// ShuffleWindow holds up to `capacity` examples and hands them out in random
+/// order. Every example that is pushed once the window is full evicts a random
+/// one, so examples of consecutive chunks are mixed while memory stays bounded
+/// by the window. A window of capacity 0 hands out examples in the order they
+/// are pushed.
+template <typename UnwrappedBatch>
+class ShuffleWindow {
+ public:
+  ShuffleWindow(size_t capacity, uint64_t seed)
+      : capacity_(capacity), generator_(seed) {}
+
+  /// Add the examples of `data` to the window, and return the examples that
+  /// were evicted to make room for them.
+  UnwrappedBatch push(UnwrappedBatch data) {
+    if (capacity_ == 0) {
+      return data;
+    }
+    UnwrappedBatch evicted;
+    for (auto& example : data) {
+      if (window_.size() < capacity_) {
+        window_.emplace_back(std::move(example));
+      } else {
+        std::uniform_int_distribution<size_t> index(0, capacity_ - 1);
+        auto& slot = window_[index(generator_)];
+        evicted.emplace_back(std::move(slot));
+        slot = std::move(example);
+      }
+    }
+    return evicted;
+  }
+
+  /// Return the examples left in the window in random order, and empty it.
+  UnwrappedBatch drain() {
+    std::shuffle(window_.begin(), window_.end(), generator_);
+    UnwrappedBatch examples = std::move(window_);
+    window_ = UnwrappedBatch();
+    return examples;
+  }
+
+ private:
+  size_t capacity_;
+  std::mt19937_64 generator_;
+  UnwrappedBatch window_;
+};
+
+/// Counters of the work done by a ChunkDataset preloader, which are updated by
+/// the preloader while the main thread reads them.
+struct PreloaderCounters {
+  std::atomic<size_t> chunk_count{0};
+  std::atomic<size_t> example_count{0};
+  std::atomic<int64_t> read_nanoseconds{0};
+  std::atomic<int64_t> wait_nanoseconds{0};
+};
 } // namespace detail
 
 /// Options to configure a `ChunkDataset`.
@@ -292,6 +412,42 @@ struct ChunkDatasetOptions {
   // penalty when this value is greater than 1, as we need to do extra merge
   // between multiple chunks before performing example sampling.
   TORCH_ARG(size_t, cross_chunk_shuffle_count) = 1;
+
+  // The number of examples each preloader holds back to shuffle examples
+  // across chunks. Default to 0 meaning no shuffle window. When it is equal to
+  // n (n > 0), the examples a preloader loads go through a window of n
+  // examples, from which a random one is evicted for every new example. Unlike
+  // cross_chunk_shuffle_count, this mixes examples of any number of
+  // consecutive chunks and of the pieces of streamed chunks, while holding at
+  // most n examples per preloader.
+  TORCH_ARG(size_t, shuffle_window_size) = 0;
+};
+
+/// Statistics of the chunks loaded by one preloader thread of a
+/// `ChunkDataset` since the last call to `reset()`.
+struct ChunkPreloaderStats {
+  /// The number of chunks read.
+  size_t chunk_count = 0;
+
+  /// The number of examples read.
+  size_t example_count = 0;
+
+  /// The time spent in the chunk reader.
+  std::chrono::nanoseconds read_time{0};
+
+  /// The time spent waiting for room in the batch buffer, i.e. waiting for
+  /// batches to be consumed.
+  std::chrono::nanoseconds wait_time{0};
+
+  /// The number of examples read per second spent in the chunk reader.
+  double examples_per_second() const {
+    if (read_time.count() == 0) {
+      return 0;
+    }
+    return example_count /
+        std::chrono::duration_cast<std::chrono::duration<double>>(read_time)
+            .count();
+  }
 };
 
 /// A stateful dataset that support hierarchical sampling and prefetching of
@@ -302,6 +458,11 @@ struct ChunkDatasetOptions {
 /// while the `ExampleSampler` determins the order of Examples that are returned
 /// in each `get_batch` call. The hierarchical sampling approach used here is
 /// inspired by this paper http://martin.zinkevich.org/publications/nips2010.pdf
+///
+/// Chunks are read through `ChunkDataReader::stream_chunk`, and the
+/// `ExampleSampler` orders the examples of each piece it yields. Chunks are
+/// read whole when a preprocessing policy or cross-chunk shuffling needs all
+/// of their examples at once.
 template <
     typename ChunkReader,
     typename ChunkSampler = samplers::RandomSampler,
@@ -394,8 +555,19 @@ class ChunkDataset final
 
     AT_ASSERT(running_preloaders_ == 0);
     running_preloaders_ = options_.preloader_count();
+    preloader_counters_ =
+        std::vector<detail::PreloaderCounters>(options_.preloader_count());
     for (size_t i = 0; i < options_.preloader_count(); ++i) {
-      preload_threads_.emplace_back([this, i]() { this->preloader(i); });
+      // Seed the shuffle windows from the default generator, so that
+      // torch::manual_seed makes them reproducible.
+      uint64_t seed = 0;
+      if (options_.shuffle_window_size() > 0) {
+        seed = torch::randint(
+                   std::numeric_limits<int64_t>::max(), {1}, torch::kInt64)
+                   .item<int64_t>();
+      }
+      preload_threads_.emplace_back(
+          [this, i, seed]() { this->preloader(i, seed); });
     }
   }
 
@@ -421,9 +593,49 @@ class ChunkDataset final
     load_checkpoint_ = true;
   }
 
+  /// Returns the statistics of each preloader thread since the last call to
+  /// `reset()`. A preloader whose `read_time` is small compared to its
+  /// `wait_time` is ahead of the consumer of the batches.
+  std::vector<ChunkPreloaderStats> preloader_stats() const {
+    std::vector<ChunkPreloaderStats> stats(preloader_counters_.size());
+    for (size_t i = 0; i < stats.size(); ++i) {
+      const auto& counters = preloader_counters_[i];
+      stats[i].chunk_count = counters.chunk_count.load();
+      stats[i].example_count = counters.example_count.load();
+      stats[i].read_time =
+          std::chrono::nanoseconds(counters.read_nanoseconds.load());
+      stats[i].wait_time =
+          std::chrono::nanoseconds(counters.wait_nanoseconds.load());
+    }
+    return stats;
+  }
+
  private:
   /// running on worker thread to preload chunk data.
-  void preloader(size_t id) {
+  void preloader(size_t id, uint64_t seed) {
+    using clock = std::chrono::steady_clock;
+    auto& counters = preloader_counters_[id];
+    UnwrappedBatchType partial;
+    detail::ShuffleWindow<UnwrappedBatchType> window(
+        options_.shuffle_window_size(), seed);
+
+    // Hands loaded examples to the batch buffer, returns false if they are no
+    // longer needed.
+    auto add_examples = [&](UnwrappedBatchType data) {
+      data = window.push(std::move(data));
+      if (data.empty()) {
+        return true;
+      }
+      const auto start = clock::now();
+      const bool added =
+          batch_buffer_->add_chunk_data(std::move(data), partial);
+      counters.wait_nanoseconds +=
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              clock::now() - start)
+              .count();
+      return added;
+    };
+
     while (!quit_worker_.load()) {
       try {
         std::vector<size_t> chunk_idx;
@@ -435,27 +647,54 @@ class ChunkDataset final
             break;
           }
         }
-        UnwrappedBatchType data = chunk_reader_.read_chunk(chunk_idx[0]);
-        for (size_t i = 1; i < chunk_idx.size(); ++i) {
-          auto chunk_data = chunk_reader_.read_chunk(chunk_idx[i]);
-          std::move(
-              chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
-        }
-        if (preprocessing_policy_) {
-          preprocessing_policy_(data);
-        }
-        if (!data.empty()) { // skip empty chunks.
-          batch_buffer_->add_chunk_data(std::move(data));
+        const auto start = clock::now();
+        const auto wait_start = counters.wait_nanoseconds.load();
+        if (preprocessing_policy_ || chunk_idx.size() > 1) {
+          UnwrappedBatchType data = chunk_reader_.read_chunk(chunk_idx[0]);
+          for (size_t i = 1; i < chunk_idx.size(); ++i) {
+            auto chunk_data = chunk_reader_.read_chunk(chunk_idx[i]);
+            std::move(
+                chunk_data.begin(), chunk_data.end(), std::back_inserter(data));
+          }
+          if (preprocessing_policy_) {
+            preprocessing_policy_(data);
+          }
+          counters.example_count += data.size();
+          if (!data.empty()) { // skip empty chunks.
+            add_examples(std::move(data));
+          }
+        } else {
+          chunk_reader_.stream_chunk(
+              chunk_idx[0], [&](UnwrappedBatchType data) {
+                counters.example_count += data.size();
+                if (quit_worker_.load()) {
+                  return false;
+                }
+                return data.empty() || add_examples(std::move(data));
+              });
         }
+        counters.chunk_count += chunk_idx.size();
+        // Time spent handing examples to the batch buffer is not reading.
+        counters.read_nanoseconds +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock::now() - start)
+                .count() -
+            (counters.wait_nanoseconds.load() - wait_start);
       } catch (...) {
         batch_buffer_->add_chunk_data(std::current_exception());
       }
     }
+    if (!quit_worker_.load()) {
+      auto examples = window.drain();
+      if (!examples.empty()) {
+        batch_buffer_->add_chunk_data(std::move(examples), partial);
+      }
+      batch_buffer_->flush(std::move(partial));
+    }
     AT_ASSERT(running_preloaders_.load() > 0);
-    --running_preloaders_;
-    if (running_preloaders_.load() == 0) {
+    if (--running_preloaders_ == 0) {
       // all preloaders are completed, so we can notify the batch_buffer.
-      batch_buffer_->stop();
+      batch_buffer_->finish();
     }
   }
 
@@ -513,6 +752,9 @@ class ChunkDataset final
   // mutex to synchronize chunk sampler next() call.
   mutable std::mutex chunk_index_guard_;
 
+  // statistics of each preloader since the last reset.
+  std::vector<detail::PreloaderCounters> preloader_counters_;
+
   // boolean value to indicate whether we need to load the checkpoint for chunk_sampler_.
   bool load_checkpoint_;
 };
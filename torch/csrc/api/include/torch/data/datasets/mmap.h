@@ -0,0 +1,119 @@
+#pragma once
+
+#include <torch/data/datasets/base.h>
+#include <torch/types.h>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+/// A dataset stored in the columnar file format written by
+/// `MmapDatasetWriter`.
+///
+/// The file is mapped into memory and every column is exposed as a tensor
+/// that points into the mapping, so examples are views into the file: getting
+/// an example costs at most the page faults of its bytes, and processes that
+/// read the same file share its pages through the page cache. A column either
+/// holds examples of the same shape, stored with a fixed stride, or examples
+/// that differ in the size of their first dimension, which are located
+/// through an index of offsets.
+///
+/// Examples are the vector of the values of each column. Writing to them
+/// writes to private copies of the mapped pages, never to the file.
+class TORCH_API MmapDataset : public Dataset<MmapDataset, std::vector<Tensor>> {
+ public:
+  /// Maps the dataset stored at `path`. `columns` selects the columns of the
+  /// examples, in order. By default, examples hold all columns in the order
+  /// they were written.
+  explicit MmapDataset(
+      const std::string& path,
+      const std::vector<std::string>& columns = {});
+
+  /// Returns the values of the selected columns for the example at `index`.
+  std::vector<Tensor> get(size_t index) override;
+
+  /// Returns the size of the dataset.
+  optional<size_t> size() const override;
+
+  /// Returns the names of the columns of the examples.
+  const std::vector<std::string>& column_names() const noexcept;
+
+  /// Returns the values of the column `name` for all examples. These are
+  /// stacked along the first dimension for a column of fixed-size examples,
+  /// and concatenated along it for a column of variable-length examples.
+  const Tensor& column(const std::string& name) const;
+
+ private:
+  struct Column {
+    std::string name;
+    Tensor values;
+    /// For variable-length columns, `offsets[i]` is the index of the first
+    /// row of example `i` in `values`, and `offsets[size]` is their number.
+    Tensor offsets;
+  };
+
+  const Column& find_column(const std::string& name) const;
+
+  std::vector<Column> columns_;
+  std::vector<std::string> column_names_;
+  std::vector<size_t> selected_;
+  size_t size_ = 0;
+};
+
+/// Writes datasets in the format read by `MmapDataset`.
+///
+/// Columns are written one after the other, and all of them must have the
+/// same number of examples. The dataset can only be read once `finish()` has
+/// been called.
+class TORCH_API MmapDatasetWriter {
+ public:
+  /// Creates the file at `path`, replacing any existing file.
+  explicit MmapDatasetWriter(const std::string& path);
+
+  /// Writes a column whose examples are the slices of `values` along its
+  /// first dimension.
+  void add_column(const std::string& name, const Tensor& values);
+
+  /// Writes a column of examples that may differ in the size of their first
+  /// dimension. All of them must have the same dtype and other dimensions.
+  void add_variable_length_column(
+      const std::string& name,
+      const std::vector<Tensor>& examples);
+
+  /// Writes the table of columns and closes the file.
+  void finish();
+
+ private:
+  void check_tensor(const std::string& name, const Tensor& values) const;
+  void add_example_count(const std::string& name, size_t example_count);
+  void describe_column(
+      const std::string& name,
+      ScalarType type,
+      bool variable_length,
+      IntArrayRef sizes,
+      uint64_t values_offset,
+      uint64_t values_size,
+      uint64_t offsets_offset);
+  /// Pads the file to the alignment of values, and returns its size.
+  uint64_t align();
+  void write(const void* data, size_t size);
+
+  std::string path_;
+  std::ofstream stream_;
+  uint64_t position_ = 0;
+  optional<size_t> example_count_;
+  /// The serialized description of each column written so far.
+  std::string table_;
+  std::vector<std::string> names_;
+  bool finished_ = false;
+};
+} // namespace datasets
+} // namespace data
+} // namespace torch
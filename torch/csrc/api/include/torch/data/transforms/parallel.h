@@ -0,0 +1,61 @@
+#pragma once
+
+#include <torch/data/transforms/base.h>
+
+#include <ATen/Parallel.h>
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace transforms {
+
+/// A `BatchTransform` that applies an example-level `Transform` to all
+/// examples of a batch in parallel, on the intra-op thread pool (see
+/// `torch::set_num_threads()`). The transform's `apply()` must be safe to call
+/// from several threads at once, and its output type must be default
+/// constructible.
+///
+/// \rst
+/// .. code-block:: cpp
+///   using namespace torch::data;
+///
+///   auto dataset = datasets::MNIST("path/to/mnist")
+///     .map(transforms::Parallel<transforms::Normalize<>>(
+///         transforms::Normalize<>(0.1307, 0.3081)))
+///     .map(transforms::Stack<>());
+/// \endrst
+template <typename TransformType>
+class Parallel : public BatchTransform<
+                     std::vector<typename TransformType::InputType>,
+                     std::vector<typename TransformType::OutputType>> {
+ public:
+  using InputBatchType = std::vector<typename TransformType::InputType>;
+  using OutputBatchType = std::vector<typename TransformType::OutputType>;
+
+  /// Constructs the `Parallel` transform from the example-level `transform`.
+  /// Every thread transforms at least `grain_size` examples at a time.
+  explicit Parallel(TransformType transform, size_t grain_size = 1)
+      : transform_(std::move(transform)), grain_size_(grain_size) {}
+
+  /// Applies the transform to every example of the `input_batch`.
+  OutputBatchType apply_batch(InputBatchType input_batch) override {
+    OutputBatchType output_batch(input_batch.size());
+    at::parallel_for(
+        0, input_batch.size(), grain_size_, [&](int64_t begin, int64_t end) {
+          for (int64_t i = begin; i < end; ++i) {
+            output_batch[i] = transform_.apply(std::move(input_batch[i]));
+          }
+        });
+    return output_batch;
+  }
+
+ private:
+  TransformType transform_;
+  size_t grain_size_;
+};
+} // namespace transforms
+} // namespace data
+} // namespace torch
@@ -4,20 +4,87 @@
 #include <torch/data/transforms/collate.h>
 #include <torch/types.h>
 
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cstring>
 #include <utility>
 #include <vector>
 
 namespace torch {
 namespace data {
 namespace transforms {
+namespace detail {
+/// Stacks `tensors` into a new tensor with a leading batch dimension, like
+/// `torch::stack`. When all of them are dense CPU tensors of the same size and
+/// dtype that don't require grad, which is the common case for examples, the
+/// batch tensor is allocated up front and every example is copied straight
+/// into its row. If `parallel` is true, the rows are copied on the intra-op
+/// thread pool.
+inline Tensor stack(
+    std::vector<Tensor> tensors,
+    bool pin_memory,
+    bool parallel) {
+  TORCH_CHECK(!tensors.empty(), "Stack expects a non-empty batch");
+  const auto& first = tensors.front();
+  bool direct = first.layout() == kStrided && first.device().is_cpu() &&
+      !first.is_quantized();
+  for (const auto& tensor : tensors) {
+    direct = direct && tensor.layout() == kStrided &&
+        tensor.device().is_cpu() && tensor.dtype() == first.dtype() &&
+        tensor.sizes() == first.sizes() && !tensor.requires_grad();
+  }
+  if (!direct) {
+    auto batch = torch::stack(tensors);
+    return pin_memory ? batch.pin_memory() : batch;
+  }
+
+  std::vector<int64_t> sizes;
+  sizes.reserve(first.dim() + 1);
+  sizes.push_back(tensors.size());
+  sizes.insert(sizes.end(), first.sizes().begin(), first.sizes().end());
+  auto batch = torch::empty(sizes, first.options().pinned_memory(pin_memory));
+  const size_t nbytes = first.numel() * first.element_size();
+  if (nbytes == 0) {
+    return batch;
+  }
+  auto batch_data = static_cast<char*>(batch.data_ptr());
+  auto copy_rows = [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      if (tensors[i].is_contiguous()) {
+        std::memcpy(batch_data + i * nbytes, tensors[i].data_ptr(), nbytes);
+      } else {
+        batch[i].copy_(tensors[i]);
+      }
+    }
+  };
+  if (parallel) {
+    const int64_t grain_size =
+        std::max<int64_t>(1, at::internal::GRAIN_SIZE / nbytes);
+    at::parallel_for(0, tensors.size(), grain_size, copy_rows);
+  } else {
+    copy_rows(0, tensors.size());
+  }
+  return batch;
+}
+} // namespace detail
 
 template <typename T = Example<>>
 struct Stack;
 
 /// A `Collation` for `Example<Tensor, Tensor>` types that stacks all data
 /// tensors into one tensor, and all target (label) tensors into one tensor.
+/// If `pin_memory` is true, the batch is allocated in pinned memory, so that
+/// it can be copied to a CUDA device asynchronously. If `parallel` is true,
+/// the examples are copied into the batch on the intra-op thread pool. This is
+/// off by default, because collation usually runs on the `DataLoader`'s worker
+/// threads, which already run in parallel and would otherwise all contend for
+/// the one intra-op pool.
 template <>
 struct Stack<Example<>> : public Collation<Example<>> {
+  explicit Stack(bool pin_memory = false, bool parallel = false)
+      : pin_memory_(pin_memory), parallel_(parallel) {}
+
   Example<> apply_batch(std::vector<Example<>> examples) override {
     std::vector<torch::Tensor> data, targets;
     data.reserve(examples.size());
@@ -26,23 +93,36 @@ struct Stack<Example<>> : public Collation<Example<>> {
       data.push_back(std::move(example.data));
       targets.push_back(std::move(example.target));
     }
-    return {torch::stack(data), torch::stack(targets)};
+    return {detail::stack(std::move(data), pin_memory_, parallel_),
+            detail::stack(std::move(targets), pin_memory_, parallel_)};
   }
+
+ private:
+  bool pin_memory_;
+  bool parallel_;
 };
 
 /// A `Collation` for `Example<Tensor, NoTarget>` types that stacks all data
-/// tensors into one tensor.
+/// tensors into one tensor. `pin_memory` and `parallel` are as for
+/// `Stack<Example<>>`.
 template <>
 struct Stack<TensorExample>
     : public Collation<Example<Tensor, example::NoTarget>> {
+  explicit Stack(bool pin_memory = false, bool parallel = false)
+      : pin_memory_(pin_memory), parallel_(parallel) {}
+
   TensorExample apply_batch(std::vector<TensorExample> examples) override {
     std::vector<torch::Tensor> data;
     data.reserve(examples.size());
     for (auto& example : examples) {
       data.push_back(std::move(example.data));
     }
-    return torch::stack(data);
+    return detail::stack(std::move(data), pin_memory_, parallel_);
   }
+
+ private:
+  bool pin_memory_;
+  bool parallel_;
 };
 } // namespace transforms
 } // namespace data
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <torch/types.h>
+
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace torch {
+namespace optim {
+namespace detail {
+
+// Optimizers update the parameters of a group whose tensors allow it with a
+// single fused kernel, which runs the whole update of many parameters in one
+// pass over their elements on the intra-op thread pool, instead of launching
+// a few operators per parameter. Other parameters are updated one by one.
+
+/// Returns true if the parameters of a group can be updated by fused kernels.
+/// This is not the case if a parameter appears more than once, since it is
+/// then updated twice in a row.
+inline bool can_fuse_params(const std::vector<Tensor>& params) {
+  std::unordered_set<const c10::TensorImpl*> seen;
+  for (const auto& param : params) {
+    if (!seen.insert(param.unsafeGetTensorImpl()).second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if the update of `param` can be fused, given the gradient and
+/// the state `tensors` it reads and writes: all of them are dense, contiguous
+/// CPU tensors of the same size and floating point dtype.
+inline bool can_fuse(const Tensor& param, TensorList tensors) {
+  const auto dtype = param.scalar_type();
+  if (!param.device().is_cpu() || param.layout() != kStrided ||
+      !param.is_contiguous() || (dtype != kFloat && dtype != kDouble)) {
+    return false;
+  }
+  for (const auto& tensor : tensors) {
+    if (!tensor.defined() || !tensor.device().is_cpu() ||
+        tensor.layout() != kStrided || !tensor.is_contiguous() ||
+        tensor.scalar_type() != dtype || tensor.sizes() != param.sizes()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if `param` can be updated from the sparse gradient `grad` by
+/// the row-wise ATen optimizer kernels, which update the rows of `param` and
+/// of its `states` selected by the indices of `grad`.
+inline bool can_update_rows(
+    const Tensor& param,
+    const Tensor& grad,
+    TensorList states) {
+  return grad.is_sparse() && grad.sparse_dim() == 1 &&
+      grad.dense_dim() == param.dim() - 1 &&
+      grad.scalar_type() == param.scalar_type() && can_fuse(param, states);
+}
+
+/// Calls `kernel(param, begin, end)` on ranges of the elements of the fused
+/// parameters `params`, which together cover all of them, from the intra-op
+/// thread pool. Every element of `params` holds the parameter it updates in
+/// its `param` member. Large parameters are split and the ranges of small
+/// ones are grouped, so that every task updates about `GRAIN_SIZE` elements.
+template <typename FusedParam, typename Kernel>
+void parallel_for_elements(
+    const std::vector<FusedParam>& params,
+    const Kernel& kernel) {
+  struct Range {
+    size_t index;
+    int64_t begin;
+    int64_t end;
+  };
+  std::vector<Range> ranges;
+  // The ranges of task `t` are ranges[task_starts[t]:task_starts[t + 1]].
+  std::vector<size_t> task_starts = {0};
+  int64_t task_size = 0;
+  for (size_t index = 0; index < params.size(); ++index) {
+    const auto numel = params[index].param.numel();
+    int64_t begin = 0;
+    while (begin < numel) {
+      const auto end =
+          std::min(numel, begin + at::internal::GRAIN_SIZE - task_size);
+      ranges.push_back({index, begin, end});
+      task_size += end - begin;
+      begin = end;
+      if (task_size == at::internal::GRAIN_SIZE) {
+        task_starts.push_back(ranges.size());
+        task_size = 0;
+      }
+    }
+  }
+  if (task_size > 0) {
+    task_starts.push_back(ranges.size());
+  }
+
+  at::parallel_for(
+      0, task_starts.size() - 1, 1, [&](int64_t begin, int64_t end) {
+        for (int64_t task = begin; task < end; ++task) {
+          for (size_t i = task_starts[task]; i < task_starts[task + 1]; ++i) {
+            kernel(params[ranges[i].index], ranges[i].begin, ranges[i].end);
+          }
+        }
+      });
+}
+
+/// Bumps the versions of tensors written by a fused kernel, as the in-place
+/// operators it replaces would have.
+inline void bump_versions(TensorList tensors) {
+  for (const auto& tensor : tensors) {
+    if (tensor.defined()) {
+      tensor.unsafeGetTensorImpl()->bump_version();
+    }
+  }
+}
+
+} // namespace detail
+} // namespace optim
+} // namespace torch
@@ -0,0 +1,494 @@
+#include <torch/data/datasets/mmap.h>
+
+#include <torch/types.h>
+
+#include <caffe2/serialize/mmap_adapter.h>
+#include <c10/util/Exception.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace data {
+namespace datasets {
+namespace {
+// A dataset file is laid out as follows, in native byte order:
+//
+//   header:   magic, version and byte order mark, padded to kHeaderSize
+//   columns:  the values of each column, and the offsets of each
+//             variable-length column, each aligned to kAlignment
+//   table:    the number of examples, and the description of each column
+//   trailer:  the offset and size of the table, and the magic again
+//
+// Aligning the values lets them be used in place as tensors of any dtype.
+constexpr char kMagic[8] = {'P', 'T', 'M', 'M', 'A', 'P', 'D', 'S'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kByteOrderMark = 0x01020304;
+constexpr uint64_t kAlignment = 64;
+constexpr size_t kHeaderSize = 64;
+constexpr size_t kTrailerSize = 2 * sizeof(uint64_t) + sizeof(kMagic);
+
+template <typename T>
+void append(std::string& buffer, T value) {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void append(std::string& buffer, const std::string& value) {
+  append(buffer, static_cast<uint32_t>(value.size()));
+  buffer.append(value);
+}
+
+template <typename T>
+T load(const uint8_t* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+// Reads the table of columns, checking that it doesn't read past its end.
+class TableReader {
+ public:
+  TableReader(const uint8_t* data, size_t size, const std::string& path)
+      : data_(data), size_(size), path_(path) {}
+
+  template <typename T>
+  T read() {
+    require(sizeof(T));
+    const auto value = load<T>(data_ + position_);
+    position_ += sizeof(T);
+    return value;
+  }
+
+  std::string read_string() {
+    const auto size = read<uint32_t>();
+    require(size);
+    std::string value(reinterpret_cast<const char*>(data_ + position_), size);
+    position_ += size;
+    return value;
+  }
+
+  // The number of bytes left to read.
+  size_t remaining() const {
+    return size_ - position_;
+  }
+
+ private:
+  void require(size_t size) {
+    TORCH_CHECK(
+        size <= size_ - position_,
+        "Unexpected end of the column table of the dataset at ",
+        path_);
+  }
+
+  const uint8_t* data_;
+  size_t size_;
+  size_t position_ = 0;
+  const std::string& path_;
+};
+
+// Checks that `size` bytes at `offset` lie within a file of `file_size`
+// bytes, and are aligned for elements of `alignment` bytes.
+void check_range(
+    uint64_t offset,
+    uint64_t size,
+    uint64_t file_size,
+    size_t alignment,
+    const std::string& what,
+    const std::string& path) {
+  TORCH_CHECK(
+      offset <= file_size && size <= file_size - offset &&
+          offset % alignment == 0,
+      "Invalid location of ",
+      what,
+      " in the dataset at ",
+      path);
+}
+
+// Checks that `size` bytes hold exactly `rows` rows of `row_size` bytes.
+void check_rows(
+    uint64_t size,
+    uint64_t row_size,
+    uint64_t rows,
+    const std::string& name,
+    const std::string& path) {
+  const bool valid = row_size == 0
+      ? size == 0
+      : size % row_size == 0 && size / row_size == rows;
+  TORCH_CHECK(
+      valid,
+      "Size of column '",
+      name,
+      "' doesn't match its number of rows in the dataset at ",
+      path);
+}
+
+// Returns a tensor over `sizes` elements of `type` at `offset` in the
+// mapping, which keeps the mapping alive.
+Tensor from_mapping(
+    const std::shared_ptr<uint8_t>& mapping,
+    uint64_t offset,
+    IntArrayRef sizes,
+    ScalarType type) {
+  return torch::from_blob(
+      mapping.get() + offset,
+      sizes,
+      [mapping](void*) {},
+      torch::dtype(type));
+}
+} // namespace
+
+MmapDataset::MmapDataset(
+    const std::string& path,
+    const std::vector<std::string>& columns) {
+  caffe2::serialize::MmapAdapter file(path);
+  const auto mapping = file.mappedData();
+  const uint8_t* data = mapping.get();
+  const uint64_t file_size = file.size();
+
+  TORCH_CHECK(
+      file_size >= kHeaderSize + kTrailerSize &&
+          std::memcmp(data, kMagic, sizeof(kMagic)) == 0 &&
+          std::memcmp(
+              data + file_size - sizeof(kMagic), kMagic, sizeof(kMagic)) == 0,
+      "The file at ",
+      path,
+      " is not a dataset written by MmapDatasetWriter");
+  const auto version = load<uint32_t>(data + sizeof(kMagic));
+  TORCH_CHECK(
+      version == kVersion,
+      "Unsupported version ",
+      version,
+      " of the dataset at ",
+      path);
+  TORCH_CHECK(
+      load<uint32_t>(data + sizeof(kMagic) + sizeof(uint32_t)) ==
+          kByteOrderMark,
+      "The dataset at ",
+      path,
+      " was written on a machine with a different byte order");
+
+  const uint8_t* trailer = data + file_size - kTrailerSize;
+  const auto table_offset = load<uint64_t>(trailer);
+  const auto table_size = load<uint64_t>(trailer + sizeof(uint64_t));
+  check_range(table_offset, table_size, file_size, 1, "the table", path);
+
+  TableReader table(data + table_offset, table_size, path);
+  size_ = table.read<uint64_t>();
+  // The number of examples sizes the first dimension of the columns.
+  TORCH_CHECK(
+      size_ <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max()),
+      "Invalid number of examples in the dataset at ",
+      path);
+  const auto column_count = table.read<uint32_t>();
+  columns_.reserve(column_count);
+  for (uint32_t i = 0; i < column_count; ++i) {
+    Column column;
+    column.name = table.read_string();
+    const auto type = table.read<int32_t>();
+    const auto element_size = table.read<uint32_t>();
+    const auto variable_length = table.read<uint32_t>() != 0;
+    // The shape of the examples, without the variable first dimension of
+    // variable-length examples.
+    const auto rank = table.read<uint32_t>();
+    // Every dimension takes 8 bytes of the table, so a rank that doesn't fit
+    // in what is left of it is corrupt and mustn't size the allocation.
+    TORCH_CHECK(
+        rank <= table.remaining() / sizeof(int64_t),
+        "Invalid rank of column '",
+        column.name,
+        "' in the dataset at ",
+        path);
+    std::vector<int64_t> sizes(static_cast<size_t>(rank) + 1);
+    uint64_t row_size = element_size;
+    for (size_t d = 1; d < sizes.size(); ++d) {
+      sizes[d] = table.read<int64_t>();
+      TORCH_CHECK(
+          sizes[d] >= 0 &&
+              (sizes[d] == 0 ||
+               row_size <= std::numeric_limits<uint64_t>::max() / sizes[d]),
+          "Invalid shape of column '",
+          column.name,
+          "' in the dataset at ",
+          path);
+      row_size *= sizes[d];
+    }
+    const auto values_offset = table.read<uint64_t>();
+    const auto values_size = table.read<uint64_t>();
+    const auto offsets_offset = table.read<uint64_t>();
+
+    TORCH_CHECK(
+        type >= 0 && type < static_cast<int32_t>(ScalarType::NumOptions) &&
+            c10::elementSize(static_cast<ScalarType>(type)) == element_size,
+        "Unsupported dtype of column '",
+        column.name,
+        "' in the dataset at ",
+        path);
+    const auto dtype = static_cast<ScalarType>(type);
+    check_range(
+        values_offset,
+        values_size,
+        file_size,
+        element_size,
+        "column '" + column.name + "'",
+        path);
+
+    if (variable_length) {
+      TORCH_CHECK(
+          size_ < file_size / sizeof(int64_t),
+          "Invalid number of examples in the dataset at ",
+          path);
+      check_range(
+          offsets_offset,
+          (size_ + 1) * sizeof(int64_t),
+          file_size,
+          sizeof(int64_t),
+          "the offsets of column '" + column.name + "'",
+          path);
+      column.offsets = from_mapping(
+          mapping, offsets_offset, {static_cast<int64_t>(size_ + 1)}, kLong);
+      const auto* offsets = column.offsets.data_ptr<int64_t>();
+      TORCH_CHECK(
+          offsets[0] == 0 && offsets[size_] >= 0,
+          "Invalid offsets of column '",
+          column.name,
+          "' in the dataset at ",
+          path);
+      sizes[0] = offsets[size_];
+    } else {
+      sizes[0] = size_;
+    }
+    check_rows(values_size, row_size, sizes[0], column.name, path);
+    column.values = from_mapping(mapping, values_offset, sizes, dtype);
+    columns_.push_back(std::move(column));
+  }
+
+  if (columns.empty()) {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      selected_.push_back(i);
+      column_names_.push_back(columns_[i].name);
+    }
+  } else {
+    for (const auto& name : columns) {
+      selected_.push_back(&find_column(name) - columns_.data());
+    }
+    column_names_ = columns;
+  }
+}
+
+std::vector<Tensor> MmapDataset::get(size_t index) {
+  TORCH_CHECK(
+      index < size_,
+      "Index ",
+      index,
+      " is out of range for a dataset of ",
+      size_,
+      " examples");
+  std::vector<Tensor> example;
+  example.reserve(selected_.size());
+  for (size_t i : selected_) {
+    const auto& column = columns_[i];
+    if (!column.offsets.defined()) {
+      example.push_back(column.values[index]);
+      continue;
+    }
+    const auto* offsets = column.offsets.data_ptr<int64_t>();
+    const auto begin = offsets[index];
+    const auto end = offsets[index + 1];
+    TORCH_CHECK(
+        begin >= 0 && begin <= end && end <= column.values.size(0),
+        "Invalid offsets of example ",
+        index,
+        " in column '",
+        column.name,
+        "'");
+    example.push_back(column.values.slice(/*dim=*/0, begin, end));
+  }
+  return example;
+}
+
+optional<size_t> MmapDataset::size() const {
+  return size_;
+}
+
+const std::vector<std::string>& MmapDataset::column_names() const noexcept {
+  return column_names_;
+}
+
+const Tensor& MmapDataset::column(const std::string& name) const {
+  return find_column(name).values;
+}
+
+const MmapDataset::Column& MmapDataset::find_column(
+    const std::string& name) const {
+  auto it = std::find_if(
+      columns_.begin(), columns_.end(), [&](const Column& column) {
+        return column.name == name;
+      });
+  TORCH_CHECK(it != columns_.end(), "The dataset has no column '", name, "'");
+  return *it;
+}
+
+MmapDatasetWriter::MmapDatasetWriter(const std::string& path)
+    : path_(path), stream_(path, std::ios::binary | std::ios::trunc) {
+  TORCH_CHECK(stream_, "Error opening dataset file for writing at ", path);
+  std::string header(kMagic, sizeof(kMagic));
+  append(header, kVersion);
+  append(header, kByteOrderMark);
+  header.resize(kHeaderSize, '\0');
+  write(header.data(), header.size());
+}
+
+void MmapDatasetWriter::add_column(
+    const std::string& name,
+    const Tensor& values) {
+  TORCH_CHECK(
+      values.dim() > 0,
+      "The values of column '",
+      name,
+      "' need a first dimension of examples");
+  check_tensor(name, values);
+  add_example_count(name, values.size(0));
+
+  const auto contiguous = values.to(kCPU).contiguous();
+  const auto offset = align();
+  write(contiguous.data_ptr(), contiguous.nbytes());
+  describe_column(
+      name,
+      contiguous.scalar_type(),
+      /*variable_length=*/false,
+      contiguous.sizes().slice(1),
+      offset,
+      contiguous.nbytes(),
+      /*offsets_offset=*/0);
+}
+
+void MmapDatasetWriter::add_variable_length_column(
+    const std::string& name,
+    const std::vector<Tensor>& examples) {
+  TORCH_CHECK(!examples.empty(), "Column '", name, "' has no examples");
+  const auto& first = examples.front();
+  for (const auto& example : examples) {
+    check_tensor(name, example);
+    TORCH_CHECK(
+        example.dim() > 0 && example.scalar_type() == first.scalar_type() &&
+            example.sizes().slice(1) == first.sizes().slice(1),
+        "The examples of column '",
+        name,
+        "' must have the same dtype and the same sizes except for the first "
+        "dimension");
+  }
+  add_example_count(name, examples.size());
+
+  std::vector<int64_t> offsets(examples.size() + 1, 0);
+  const auto values_offset = align();
+  for (size_t i = 0; i < examples.size(); ++i) {
+    const auto contiguous = examples[i].to(kCPU).contiguous();
+    write(contiguous.data_ptr(), contiguous.nbytes());
+    offsets[i + 1] = offsets[i] + contiguous.size(0);
+  }
+  const auto values_size = position_ - values_offset;
+  const auto offsets_offset = align();
+  write(offsets.data(), offsets.size() * sizeof(int64_t));
+  describe_column(
+      name,
+      first.scalar_type(),
+      /*variable_length=*/true,
+      first.sizes().slice(1),
+      values_offset,
+      values_size,
+      offsets_offset);
+}
+
+void MmapDatasetWriter::finish() {
+  TORCH_CHECK(!finished_, "The dataset at ", path_, " is already finished");
+  std::string table;
+  append(table, static_cast<uint64_t>(example_count_.value_or(0)));
+  append(table, static_cast<uint32_t>(names_.size()));
+  table += table_;
+  const auto table_offset = align();
+  write(table.data(), table.size());
+
+  std::string trailer;
+  append(trailer, table_offset);
+  append(trailer, static_cast<uint64_t>(table.size()));
+  trailer.append(kMagic, sizeof(kMagic));
+  write(trailer.data(), trailer.size());
+  stream_.close();
+  TORCH_CHECK(stream_, "Error writing the dataset at ", path_);
+  finished_ = true;
+}
+
+void MmapDatasetWriter::check_tensor(
+    const std::string& name,
+    const Tensor& values) const {
+  TORCH_CHECK(!finished_, "The dataset at ", path_, " is already finished");
+  TORCH_CHECK(
+      values.layout() == kStrided && !values.is_quantized(),
+      "The values of column '",
+      name,
+      "' must be dense, non-quantized tensors");
+}
+
+void MmapDatasetWriter::add_example_count(
+    const std::string& name,
+    size_t example_count) {
+  TORCH_CHECK(
+      std::find(names_.begin(), names_.end(), name) == names_.end(),
+      "The dataset already has a column '",
+      name,
+      "'");
+  TORCH_CHECK(
+      !example_count_ || *example_count_ == example_count,
+      "Column '",
+      name,
+      "' has ",
+      example_count,
+      " examples, but the dataset has ",
+      example_count_.value_or(0));
+  example_count_ = example_count;
+  names_.push_back(name);
+}
+
+void MmapDatasetWriter::describe_column(
+    const std::string& name,
+    ScalarType type,
+    bool variable_length,
+    IntArrayRef sizes,
+    uint64_t values_offset,
+    uint64_t values_size,
+    uint64_t offsets_offset) {
+  append(table_, name);
+  append(table_, static_cast<int32_t>(type));
+  append(table_, static_cast<uint32_t>(c10::elementSize(type)));
+  append(table_, static_cast<uint32_t>(variable_length));
+  append(table_, static_cast<uint32_t>(sizes.size()));
+  for (auto size : sizes) {
+    append(table_, static_cast<int64_t>(size));
+  }
+  append(table_, values_offset);
+  append(table_, values_size);
+  append(table_, offsets_offset);
+}
+
+uint64_t MmapDatasetWriter::align() {
+  static const char kPadding[kAlignment] = {};
+  write(kPadding, (kAlignment - position_ % kAlignment) % kAlignment);
+  return position_;
+}
+
+void MmapDatasetWriter::write(const void* data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  stream_.write(static_cast<const char*>(data), size);
+  TORCH_CHECK(stream_, "Error writing the dataset at ", path_);
+  position_ += size;
+}
+} // namespace datasets
+} // namespace data
+} // namespace torch
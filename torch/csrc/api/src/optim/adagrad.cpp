@@ -3,14 +3,58 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/serialize/archive.h>
 #include <torch/utils.h>
+#include <torch/optim/detail/fused.h>
 #include <torch/optim/serialize.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 
+#include <cmath>
 #include <functional>
 
 namespace torch {
 namespace optim {
+namespace {
+struct AdagradFusedParam {
+  Tensor param;
+  Tensor grad;
+  Tensor sum;
+  double clr;
+};
+
+// Does the same as the per-parameter update of dense gradients in
+// Adagrad::step, in one pass.
+void adagrad_fused_step(
+    const std::vector<AdagradFusedParam>& params,
+    const AdagradOptions& options) {
+  detail::parallel_for_elements(
+      params,
+      [&](const AdagradFusedParam& fused, int64_t begin, int64_t end) {
+        AT_DISPATCH_FLOATING_TYPES(
+            fused.param.scalar_type(), "adagrad_fused_step", [&] {
+              auto* param = fused.param.data_ptr<scalar_t>();
+              const auto* grad = fused.grad.data_ptr<scalar_t>();
+              auto* sum = fused.sum.data_ptr<scalar_t>();
+              const auto weight_decay =
+                  static_cast<scalar_t>(options.weight_decay());
+              const auto eps = static_cast<scalar_t>(options.eps());
+              const auto neg_clr = static_cast<scalar_t>(-fused.clr);
+              for (int64_t i = begin; i < end; ++i) {
+                auto g = grad[i];
+                if (weight_decay != 0) {
+                  g = g + weight_decay * param[i];
+                }
+                const auto s = sum[i] + g * g;
+                sum[i] = s;
+                param[i] = param[i] + neg_clr * g / (std::sqrt(s) + eps);
+              }
+            });
+      });
+  for (const auto& fused : params) {
+    detail::bump_versions({fused.param, fused.sum});
+  }
+}
+} // namespace
 
 AdagradOptions::AdagradOptions(double lr) : lr_(lr) {}
 
@@ -63,6 +107,9 @@ Tensor Adagrad::step(LossClosure closure) {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdagradOptions&>(group.options());
+    const bool fuse = detail::can_fuse_params(group.params());
+    std::vector<AdagradFusedParam> fused_params;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -70,19 +117,34 @@ Tensor Adagrad::step(LossClosure closure) {
       auto grad = p.grad();
       TORCH_INTERNAL_ASSERT(state_[c10::guts::to_string(p.unsafeGetTensorImpl())] != nullptr, "state found NULL for the Tensor ", p);
       auto& state = static_cast<AdagradParamState&>(*state_[c10::guts::to_string(p.unsafeGetTensorImpl())]);
-      auto& options = static_cast<AdagradOptions&>(group.options());
 
       state.step(state.step() + 1);
 
+      const auto clr = options.lr() /
+          (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
+
+      if (fuse && detail::can_fuse(p, {grad, state.sum()})) {
+        fused_params.push_back({p, grad, state.sum(), clr});
+        continue;
+      }
+
       if (options.weight_decay() != 0) {
         TORCH_CHECK(!p.grad().is_sparse(), "weight_decay option is not compatible with sparse gradients");
         grad = grad.add(p, options.weight_decay());
       }
-      const auto clr = options.lr() /
-          (1 + static_cast<double>(state.step() - 1) * options.lr_decay());
 
       if (grad.is_sparse()) {
         grad = grad.coalesce();
+        if (detail::can_update_rows(p, grad, {state.sum()})) {
+          at::_rowwise_adagrad_(
+              p,
+              state.sum(),
+              grad._indices()[0],
+              grad._values().contiguous(),
+              clr,
+              options.eps());
+          continue;
+        }
         auto grad_indices = grad._indices();
         auto grad_values = grad._values();
         auto size = grad.sizes();
@@ -105,6 +167,7 @@ Tensor Adagrad::step(LossClosure closure) {
         p.addcdiv_(grad, std, -clr);
       }
     }
+    adagrad_fused_step(fused_params, options);
   }
   return loss;
 }
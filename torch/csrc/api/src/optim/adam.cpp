@@ -2,16 +2,83 @@
 
 #include <torch/csrc/autograd/variable.h>
 #include <torch/nn/module.h>
+#include <torch/optim/detail/fused.h>
 #include <torch/serialize/archive.h>
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 
 #include <cmath>
 #include <functional>
 
 namespace torch {
 namespace optim {
+namespace {
+struct AdamFusedParam {
+  Tensor param;
+  Tensor grad;
+  Tensor exp_avg;
+  Tensor exp_avg_sq;
+  Tensor max_exp_avg_sq;
+  double step_size;
+  double bias_correction2_sqrt;
+};
+
+// Does the same as the per-parameter update in Adam::step, in one pass.
+void adam_fused_step(
+    const std::vector<AdamFusedParam>& params,
+    const AdamOptions& options) {
+  const auto beta1 = std::get<0>(options.betas());
+  const auto beta2 = std::get<1>(options.betas());
+  detail::parallel_for_elements(
+      params, [&](const AdamFusedParam& fused, int64_t begin, int64_t end) {
+        AT_DISPATCH_FLOATING_TYPES(
+            fused.param.scalar_type(), "adam_fused_step", [&] {
+              auto* param = fused.param.data_ptr<scalar_t>();
+              const auto* grad = fused.grad.data_ptr<scalar_t>();
+              auto* exp_avg = fused.exp_avg.data_ptr<scalar_t>();
+              auto* exp_avg_sq = fused.exp_avg_sq.data_ptr<scalar_t>();
+              auto* max_exp_avg_sq = options.amsgrad()
+                  ? fused.max_exp_avg_sq.data_ptr<scalar_t>()
+                  : nullptr;
+              const auto weight_decay =
+                  static_cast<scalar_t>(options.weight_decay());
+              const auto b1 = static_cast<scalar_t>(beta1);
+              const auto b2 = static_cast<scalar_t>(beta2);
+              const auto one_minus_b1 = static_cast<scalar_t>(1 - beta1);
+              const auto one_minus_b2 = static_cast<scalar_t>(1 - beta2);
+              const auto eps = static_cast<scalar_t>(options.eps());
+              const auto bias_correction2_sqrt =
+                  static_cast<scalar_t>(fused.bias_correction2_sqrt);
+              const auto neg_step_size =
+                  static_cast<scalar_t>(-fused.step_size);
+              for (int64_t i = begin; i < end; ++i) {
+                auto g = grad[i];
+                if (weight_decay != 0) {
+                  g = g + weight_decay * param[i];
+                }
+                const auto m = exp_avg[i] * b1 + one_minus_b1 * g;
+                auto v = exp_avg_sq[i] * b2 + one_minus_b2 * g * g;
+                exp_avg[i] = m;
+                exp_avg_sq[i] = v;
+                if (max_exp_avg_sq != nullptr) {
+                  // Propagates NaN like torch::max.
+                  const auto max = max_exp_avg_sq[i];
+                  v = (max > v || std::isnan(max)) ? max : v;
+                  max_exp_avg_sq[i] = v;
+                }
+                const auto denom = std::sqrt(v) / bias_correction2_sqrt + eps;
+                param[i] = param[i] + neg_step_size * m / denom;
+              }
+            });
+      });
+  for (const auto& fused : params) {
+    detail::bump_versions(
+        {fused.param, fused.exp_avg, fused.exp_avg_sq, fused.max_exp_avg_sq});
+  }
+}
+} // namespace
 
 AdamOptions::AdamOptions(double lr) : lr_(lr) {}
 
@@ -69,14 +136,21 @@ Tensor Adam::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<AdamOptions&>(group.options());
+    const bool fuse = detail::can_fuse_params(group.params());
+    std::vector<AdamFusedParam> fused_params;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
       auto grad = p.grad();
-      TORCH_CHECK(!grad.is_sparse(), "Adam does not support sparse gradients"/*, please consider SparseAdam instead*/);
+      TORCH_CHECK(!grad.is_sparse() ||
+                  (detail::can_update_rows(p, grad, {}) &&
+                   options.weight_decay() == 0 && !options.amsgrad()),
+                  "Adam supports sparse gradients only for contiguous CPU parameters, "
+                  "with gradients that are sparse along their first dimension and "
+                  "without weight_decay and amsgrad");
       auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<AdamOptions&>(group.options());
 
       // State initialization
       if(param_state == state_.end()) {
@@ -105,6 +179,36 @@ Tensor Adam::step(LossClosure closure)  {
       auto bias_correction1 = 1 - std::pow(beta1, state.step());
       auto bias_correction2 = 1 - std::pow(beta2, state.step());
 
+      if (grad.is_sparse()) {
+        // Like torch.optim.SparseAdam, only updates the rows of the parameter
+        // and of the moments that the gradient holds.
+        grad = grad.coalesce();
+        at::_rowwise_adam_(
+            p,
+            exp_avg,
+            exp_avg_sq,
+            grad._indices()[0],
+            grad._values().contiguous(),
+            options.lr() * std::sqrt(bias_correction2) / bias_correction1,
+            beta1,
+            beta2,
+            options.eps());
+        continue;
+      }
+
+      if (fuse && detail::can_fuse(p, {grad, exp_avg, exp_avg_sq}) &&
+          (!options.amsgrad() || detail::can_fuse(p, {max_exp_avg_sq}))) {
+        fused_params.push_back(
+            {p,
+             grad,
+             exp_avg,
+             exp_avg_sq,
+             max_exp_avg_sq,
+             options.lr() / bias_correction1,
+             std::sqrt(bias_correction2)});
+        continue;
+      }
+
       if(options.weight_decay() != 0) {
         grad = grad.add(p, options.weight_decay());
       }
@@ -126,6 +230,7 @@ Tensor Adam::step(LossClosure closure)  {
       auto step_size = options.lr() / bias_correction1;
       p.addcdiv_(exp_avg, denom, -step_size);
     }
+    adam_fused_step(fused_params, options);
   }
   return loss;
 }
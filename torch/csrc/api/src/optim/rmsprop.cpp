@@ -3,13 +3,84 @@
 #include <torch/csrc/autograd/variable.h>
 #include <torch/serialize/archive.h>
 #include <torch/utils.h>
+#include <torch/optim/detail/fused.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 
+#include <cmath>
 #include <functional>
 
 namespace torch {
 namespace optim {
+namespace {
+struct RMSpropFusedParam {
+  Tensor param;
+  Tensor grad;
+  Tensor square_avg;
+  Tensor momentum_buffer;
+  Tensor grad_avg;
+};
+
+// Does the same as the per-parameter update in RMSprop::step, in one pass.
+void rmsprop_fused_step(
+    const std::vector<RMSpropFusedParam>& params,
+    const RMSpropOptions& options) {
+  const bool momentum = options.momentum() > 0;
+  const bool centered = options.centered();
+  detail::parallel_for_elements(
+      params,
+      [&](const RMSpropFusedParam& fused, int64_t begin, int64_t end) {
+        AT_DISPATCH_FLOATING_TYPES(
+            fused.param.scalar_type(), "rmsprop_fused_step", [&] {
+              auto* param = fused.param.data_ptr<scalar_t>();
+              const auto* grad = fused.grad.data_ptr<scalar_t>();
+              auto* square_avg = fused.square_avg.data_ptr<scalar_t>();
+              auto* buf = momentum
+                  ? fused.momentum_buffer.data_ptr<scalar_t>()
+                  : nullptr;
+              auto* grad_avg =
+                  centered ? fused.grad_avg.data_ptr<scalar_t>() : nullptr;
+              const auto weight_decay =
+                  static_cast<scalar_t>(options.weight_decay());
+              const auto alpha = static_cast<scalar_t>(options.alpha());
+              const auto one_minus_alpha =
+                  static_cast<scalar_t>(1 - options.alpha());
+              const auto eps = static_cast<scalar_t>(options.eps());
+              const auto momentum_factor =
+                  static_cast<scalar_t>(options.momentum());
+              const auto neg_lr = static_cast<scalar_t>(-options.lr());
+              for (int64_t i = begin; i < end; ++i) {
+                auto g = grad[i];
+                if (weight_decay != 0) {
+                  g = g + weight_decay * param[i];
+                }
+                const auto sq = square_avg[i] * alpha + one_minus_alpha * g * g;
+                square_avg[i] = sq;
+                scalar_t avg;
+                if (centered) {
+                  const auto ga = grad_avg[i] * alpha + one_minus_alpha * g;
+                  grad_avg[i] = ga;
+                  avg = std::sqrt(sq - ga * ga) + eps;
+                } else {
+                  avg = std::sqrt(sq) + eps;
+                }
+                if (momentum) {
+                  const auto b = buf[i] * momentum_factor + g / avg;
+                  buf[i] = b;
+                  param[i] = param[i] + neg_lr * b;
+                } else {
+                  param[i] = param[i] + neg_lr * g / avg;
+                }
+              }
+            });
+      });
+  for (const auto& fused : params) {
+    detail::bump_versions(
+        {fused.param, fused.square_avg, fused.momentum_buffer, fused.grad_avg});
+  }
+}
+} // namespace
 
 RMSpropOptions::RMSpropOptions(double lr) : lr_(lr) {}
 
@@ -71,6 +142,9 @@ Tensor RMSprop::step(LossClosure closure)  {
     loss = closure();
   }
   for (auto& group : param_groups_) {
+    auto& options = static_cast<RMSpropOptions&>(group.options());
+    const bool fuse = detail::can_fuse_params(group.params());
+    std::vector<RMSpropFusedParam> fused_params;
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
@@ -78,7 +152,6 @@ Tensor RMSprop::step(LossClosure closure)  {
       auto grad = p.grad();
       TORCH_CHECK(!grad.is_sparse(), "RMSprop does not support sparse gradients");
       auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
-      auto& options = static_cast<RMSpropOptions&>(group.options());
 
       // State initialization
       if (param_state == state_.end()) {
@@ -100,6 +173,15 @@ Tensor RMSprop::step(LossClosure closure)  {
 
       state.step(state.step() + 1);
 
+      if (fuse && detail::can_fuse(p, {grad, square_avg}) &&
+          (options.momentum() <= 0 ||
+           detail::can_fuse(p, {state.momentum_buffer()})) &&
+          (!options.centered() || detail::can_fuse(p, {state.grad_avg()}))) {
+        fused_params.push_back(
+            {p, grad, square_avg, state.momentum_buffer(), state.grad_avg()});
+        continue;
+      }
+
       if (options.weight_decay() != 0) {
         grad = grad.add(p, options.weight_decay());
       }
@@ -125,6 +207,7 @@ Tensor RMSprop::step(LossClosure closure)  {
         p.addcdiv_(grad, avg, -options.lr());
       }
     }
+    rmsprop_fused_step(fused_params, options);
   }
   return loss;
 }
@@ -2,17 +2,70 @@
 
 #include <torch/csrc/autograd/variable.h>
 #include <torch/nn/pimpl.h>
+#include <torch/optim/detail/fused.h>
 #include <torch/optim/optimizer.h>
 #include <torch/optim/serialize.h>
 #include <torch/types.h>
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Dispatch.h>
 
 #include <functional>
 
 namespace torch {
 namespace optim {
+namespace {
+struct SGDFusedParam {
+  Tensor param;
+  Tensor grad;
+  Tensor momentum_buffer;
+  // Whether momentum_buffer is new, and is initialized with the gradient.
+  bool initialize_momentum_buffer;
+};
+
+// Does the same as the per-parameter update in SGD::step, in one pass.
+void sgd_fused_step(
+    const std::vector<SGDFusedParam>& params,
+    const SGDOptions& options) {
+  detail::parallel_for_elements(
+      params, [&](const SGDFusedParam& fused, int64_t begin, int64_t end) {
+        AT_DISPATCH_FLOATING_TYPES(
+            fused.param.scalar_type(), "sgd_fused_step", [&] {
+              auto* param = fused.param.data_ptr<scalar_t>();
+              const auto* grad = fused.grad.data_ptr<scalar_t>();
+              auto* buf = options.momentum() != 0
+                  ? fused.momentum_buffer.data_ptr<scalar_t>()
+                  : nullptr;
+              const bool initialize = fused.initialize_momentum_buffer;
+              const bool nesterov = options.nesterov();
+              const auto weight_decay =
+                  static_cast<scalar_t>(options.weight_decay());
+              const auto momentum = static_cast<scalar_t>(options.momentum());
+              const auto one_minus_dampening =
+                  static_cast<scalar_t>(1 - options.dampening());
+              const auto neg_lr = static_cast<scalar_t>(-1 * options.lr());
+              for (int64_t i = begin; i < end; ++i) {
+                auto d_p = grad[i];
+                if (weight_decay != 0) {
+                  d_p = d_p + weight_decay * param[i];
+                }
+                if (buf != nullptr) {
+                  const auto b = initialize
+                      ? d_p
+                      : buf[i] * momentum + one_minus_dampening * d_p;
+                  buf[i] = b;
+                  d_p = nesterov ? d_p + momentum * b : b;
+                }
+                param[i] = param[i] + neg_lr * d_p;
+              }
+            });
+      });
+  for (const auto& fused : params) {
+    detail::bump_versions({fused.param, fused.momentum_buffer});
+  }
+}
+} // namespace
 
 SGDOptions::SGDOptions(double lr) : lr_(lr) {}
 
@@ -65,11 +118,39 @@ Tensor SGD::step(LossClosure closure)  {
     auto momentum = options.momentum();
     auto dampening = options.dampening();
     auto nesterov = options.nesterov();
+    const bool fuse = detail::can_fuse_params(group.params());
+    std::vector<SGDFusedParam> fused_params;
 
     for (auto& p : group.params()) {
       if (!p.grad().defined()) {
         continue;
       }
+      if (momentum == 0 && weight_decay == 0 &&
+          detail::can_update_rows(p, p.grad(), {})) {
+        const auto grad = p.grad().coalesce();
+        at::_rowwise_sgd_(
+            p, grad._indices()[0], grad._values().contiguous(), options.lr());
+        continue;
+      }
+      if (fuse && detail::can_fuse(p, {p.grad()})) {
+        if (momentum == 0) {
+          fused_params.push_back({p, p.grad(), Tensor(), false});
+          continue;
+        }
+        auto param_state = state_.find(c10::guts::to_string(p.unsafeGetTensorImpl()));
+        if (param_state == state_.end()) {
+          auto state = std::make_unique<SGDParamState>();
+          state->momentum_buffer(torch::empty_like(p.grad()));
+          fused_params.push_back({p, p.grad(), state->momentum_buffer(), true});
+          state_[c10::guts::to_string(p.unsafeGetTensorImpl())] = std::move(state);
+          continue;
+        }
+        auto& buf = static_cast<SGDParamState&>(*param_state->second).momentum_buffer();
+        if (detail::can_fuse(p, {buf})) {
+          fused_params.push_back({p, p.grad(), buf, false});
+          continue;
+        }
+      }
       auto d_p = p.grad().data();
       if (weight_decay != 0) {
         d_p = d_p.add(p.data(), weight_decay);
@@ -94,6 +175,7 @@ Tensor SGD::step(LossClosure closure)  {
       }
       p.data().add_(d_p, -1 * options.lr());
     }
+    sgd_fused_step(fused_params, options);
   }
   return loss;
 }
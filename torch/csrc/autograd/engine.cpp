@@ -18,9 +18,11 @@
 #include <c10/util/Optional.h>
 #include <c10/core/StreamGuard.h>
 
+#include <algorithm>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
+#include <cstdlib>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -156,10 +158,47 @@ static thread_local std::shared_ptr<ReadyQueue> local_ready_queue = nullptr;
 // the leaf streams with the default streams is sufficient to implement
 // the historic behavior.
 
+// Note [Parallel CPU backward]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// By default all CPU nodes of a GraphTask are run by the thread that called
+// backward(), one after another, even if they sit on independent branches of
+// the graph. When Engine::set_num_cpu_workers(n) was called with n > 0, the
+// thread driving a GraphTask owned by the CPU starts up to n CPU workers from
+// an engine-wide pool whenever it leaves tasks waiting in the GraphTask's
+// cpu_ready_queue_. CPU workers pop tasks from that queue with try_pop() and
+// run them exactly like thread_main does, until the queue is empty. They
+// never wait on the queue, so a worker can never be left sleeping on a queue
+// that nobody will push to again. The ReadyQueue already supports several
+// consumers, as reentrant backward threads share their parent's queue, and
+// evaluate_function already synchronizes on the GraphTask mutex.
+//
+// A few rules keep the existing semantics intact:
+//  - Only GraphTasks owned by the CPU get workers. The CPU queue of a
+//    reentrant GraphTask started from a device thread is that device's queue.
+//  - Devices are not touched: tasks for devices still go to device threads,
+//    and streams are set per node by evaluate_function.
+//  - A CPU worker runs with worker_device == NO_DEVICE. A backward() called
+//    by a node it runs is therefore a new, non-reentrant backward on the
+//    worker's own ready queue, and the worker does not block the queue it
+//    was draining.
+//  - Because worker_device differs from the owner, a worker that completes a
+//    GraphTask wakes up the owning thread with an empty NodeTask, as device
+//    threads do. Empty NodeTasks are meant for the threads blocked in pop(),
+//    so a worker that pops one pushes it back and stops.
+//  - Workers do not run tasks inline, see Note [Inline execution of ready
+//    tasks]; whatever they make ready goes through the queue.
+//
+// Engine::cpu_worker_stats() reports how many nodes were run by workers and
+// the largest number of nodes of one GraphTask that ran at the same time.
+
+static void update_max(std::atomic<uint64_t>& max, uint64_t value) {
+  auto current = max.load();
+  while (value > current && !max.compare_exchange_weak(current, value)) {}
+}
+
 int NodeTask::getReentrantDepth() const {
-  std::shared_ptr<GraphTask> graph_task = base_.lock();
-  if (graph_task) {
-    return graph_task->reentrant_depth_;
+  if (!base_.expired()) {
+    return reentrant_depth_;
   } else {
     // The graph task is no longer valid indicating an error. As a result, we
     // try to move this to the front of the queue to ensure the autograd
@@ -178,6 +217,7 @@ auto ReadyQueue::push(NodeTask item, bool incrementOutstandingTasks) -> void {
       ++graph_task->outstanding_tasks_;
     }
     heap_.push(std::move(item));
+    size_.store(heap_.size(), std::memory_order_release);
   }
   not_empty_.notify_one();
 }
@@ -186,14 +226,13 @@ auto ReadyQueue::pushShutdownTask() -> void {
   {
     std::lock_guard<std::mutex> lock(mutex_);
     heap_.push(NodeTask({}, nullptr, InputBuffer(0), true));
+    size_.store(heap_.size(), std::memory_order_release);
   }
   not_empty_.notify_one();
 }
 
 size_t ReadyQueue::size() const {
-  // Lock mutex for accesses to heap_
-  std::unique_lock<std::mutex> lock(mutex_);
-  return heap_.size();
+  return size_.load(std::memory_order_acquire);
 }
 
 auto ReadyQueue::pop() -> NodeTask {
@@ -202,16 +241,42 @@ auto ReadyQueue::pop() -> NodeTask {
   not_empty_.wait(lock, [this]{ return !heap_.empty(); });
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  size_.store(heap_.size(), std::memory_order_release);
+  return task;
+}
+
+auto ReadyQueue::try_pop() -> c10::optional<NodeTask> {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (heap_.empty()) {
+    return c10::nullopt;
+  }
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+  auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
+  size_.store(heap_.size(), std::memory_order_release);
   return task;
 }
 
 bool ReadyQueue::empty() const {
-  // Lock mutex for accesses to heap_
-  std::unique_lock<std::mutex> lock(mutex_);
-  return heap_.empty();
+  return size() == 0;
 }
 
-Engine::Engine() : max_recursion_depth_(MAX_DEPTH), non_reentrant_device_thread_count_(0) {}
+static size_t default_num_cpu_workers() {
+  const char* env = std::getenv("PYTORCH_AUTOGRAD_CPU_WORKERS");
+  if (env == nullptr) {
+    return 0;
+  }
+  int num_workers = std::atoi(env);
+  if (num_workers < 0) {
+    LOG(WARNING) << "Ignoring invalid value for PYTORCH_AUTOGRAD_CPU_WORKERS: " << env;
+    return 0;
+  }
+  return num_workers;
+}
+
+Engine::Engine()
+    : max_recursion_depth_(MAX_DEPTH),
+      num_cpu_workers_(default_num_cpu_workers()),
+      non_reentrant_device_thread_count_(0) {}
 
 // Send shutdown tasks to all device_ready_queues_ if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest priority
@@ -238,6 +303,8 @@ Engine::~Engine() {
 }
 
 void Engine::release_workers() {
+  // The CPU worker threads are gone as well, don't try to join them.
+  cpu_worker_pool_.release();
   std::unique_lock<std::mutex> lk(non_reentrant_device_thread_mutex_);
   non_reentrant_device_thread_count_.store(0);
   non_reentrant_device_thread_condvar_.notify_one();
@@ -344,6 +411,9 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
 
   // local_ready_queue should already been initialized when we get into thread_main
   TORCH_INTERNAL_ASSERT(local_ready_queue != nullptr);
+  // A task made ready by the previous task that is run next without going
+  // through local_ready_queue. See Note [Inline execution of ready tasks]
+  c10::optional<NodeTask> inline_task;
   while (graph_task == nullptr || !graph_task->future_result_->completed()) {
     // local_graph_task represents the graph_task we retrieve from the queue.
     // The outer graph_task represents the overall graph_task we need to execute
@@ -353,7 +423,8 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
       // Scope this block of execution since NodeTask is not needed after this
       // block and can be deallocated (release any references to grad tensors
       // as part of inputs_).
-      NodeTask task = local_ready_queue->pop();
+      NodeTask task = inline_task ? std::move(*inline_task) : local_ready_queue->pop();
+      inline_task.reset();
       // This will only work if the worker is running a non backward task
       // TODO Needs to be fixed this to work in all cases
       if (task.isShutdownTask_) {
@@ -369,42 +440,180 @@ auto Engine::thread_main(const std::shared_ptr<GraphTask>& graph_task) -> void {
 
       if (task.fn_ && !local_graph_task->has_error_.load()) {
         AutoGradMode grad_mode(local_graph_task->grad_mode_);
+        // Only track concurrency if CPU workers may run nodes of this
+        // GraphTask. See Note [Parallel CPU backward]
+        const bool track_cpu_nodes = worker_device == CPU_DEVICE &&
+            num_cpu_workers_.load(std::memory_order_relaxed) > 0;
+        if (track_cpu_nodes) {
+          ++cpu_nodes_run_;
+          update_max(max_concurrent_cpu_nodes_, ++local_graph_task->running_cpu_nodes_);
+        }
         try {
           // The guard sets the thread_local current_graph_task on construction
           // and restores it on exit. The current_graph_task variable helps
           // queue_callback() to find the target GraphTask to append final
           // callbacks.
           GraphTaskGuard guard(local_graph_task);
-          evaluate_function(local_graph_task, task.fn_.get(), task.inputs_, local_graph_task->cpu_ready_queue_);
+          evaluate_function(
+              local_graph_task,
+              task.fn_.get(),
+              task.inputs_,
+              local_graph_task->cpu_ready_queue_,
+              &inline_task);
         } catch (std::exception& e) {
           thread_on_exception(local_graph_task, task.fn_, e);
         }
+        if (track_cpu_nodes) {
+          --local_graph_task->running_cpu_nodes_;
+          maybe_dispatch_cpu_workers(local_graph_task);
+        }
       }
     }
 
-    // Decrement the outstanding tasks.
-    --local_graph_task->outstanding_tasks_;
+    finish_node_task(local_graph_task);
+  }
 
-    // Check if we've completed execution.
-    if (local_graph_task->completed()) {
-      local_graph_task->mark_as_completed_and_run_post_processing();
+  // A reentrant backward can finish while the task it ran last (which may
+  // belong to an outer GraphTask sharing this ready queue) made another task
+  // ready. Hand it back to the queue; it is already counted in
+  // outstanding_tasks_.
+  if (inline_task) {
+    local_ready_queue->push(
+        std::move(*inline_task), /* incrementOutstandingTasks */ false);
+  }
+}
 
-      auto base_owner = local_graph_task->owner_;
-      // The current worker thread finish the graph_task, but the owning thread
-      // of the graph_task might be sleeping on pop() if it does not have work.
-      // So we need to send a dummy function task to the owning thread just to
-      // ensure that it's not sleeping, so that we can exit the thread_main.
-      // If it has work, it might see that graph_task->outstanding_tasks_ == 0
-      // before it gets to the task, but it's a no-op anyway.
-      //
-      // NB: This is not necessary if the current thread is the owning thread.
-      if (worker_device != base_owner) {
-        // Synchronize outstanding_tasks_ with queue mutex
-        std::atomic_thread_fence(std::memory_order_release);
-        ready_queue_by_index(local_graph_task->cpu_ready_queue_, base_owner)
-            ->push(NodeTask(local_graph_task, nullptr, InputBuffer(0)));
+void Engine::finish_node_task(const std::shared_ptr<GraphTask>& graph_task) {
+  // Decrement the outstanding tasks.
+  --graph_task->outstanding_tasks_;
+
+  // Check if we've completed execution.
+  if (graph_task->completed()) {
+    graph_task->mark_as_completed_and_run_post_processing();
+
+    auto base_owner = graph_task->owner_;
+    // The current worker thread finish the graph_task, but the owning thread
+    // of the graph_task might be sleeping on pop() if it does not have work.
+    // So we need to send a dummy function task to the owning thread just to
+    // ensure that it's not sleeping, so that we can exit the thread_main.
+    // If it has work, it might see that graph_task->outstanding_tasks_ == 0
+    // before it gets to the task, but it's a no-op anyway.
+    //
+    // NB: This is not necessary if the current thread is the owning thread.
+    if (worker_device != base_owner) {
+      // Synchronize outstanding_tasks_ with queue mutex
+      std::atomic_thread_fence(std::memory_order_release);
+      ready_queue_by_index(graph_task->cpu_ready_queue_, base_owner)
+          ->push(NodeTask(graph_task, nullptr, InputBuffer(0)));
+    }
+  }
+}
+
+void Engine::set_num_cpu_workers(size_t num_workers) {
+  num_cpu_workers_.store(num_workers);
+}
+
+size_t Engine::num_cpu_workers() const {
+  return num_cpu_workers_.load();
+}
+
+auto Engine::cpu_worker_stats() const -> CPUWorkerStats {
+  CPUWorkerStats stats;
+  stats.nodes_run = cpu_nodes_run_.load();
+  stats.nodes_run_by_workers = cpu_nodes_run_by_workers_.load();
+  stats.workers_dispatched = cpu_workers_dispatched_.load();
+  stats.max_concurrent_nodes = max_concurrent_cpu_nodes_.load();
+  return stats;
+}
+
+void Engine::reset_cpu_worker_stats() {
+  cpu_nodes_run_ = 0;
+  cpu_nodes_run_by_workers_ = 0;
+  cpu_workers_dispatched_ = 0;
+  max_concurrent_cpu_nodes_ = 0;
+}
+
+void Engine::maybe_dispatch_cpu_workers(const std::shared_ptr<GraphTask>& graph_task) {
+  const size_t max_workers = num_cpu_workers_.load(std::memory_order_relaxed);
+  if (max_workers == 0 || graph_task->owner_ != CPU_DEVICE) {
+    return;
+  }
+  const auto& queue = graph_task->cpu_ready_queue_;
+  if (queue->empty()) {
+    return;
+  }
+  std::call_once(cpu_worker_pool_flag_, [this, max_workers] {
+    cpu_worker_pool_ = make_unique<c10::ThreadPool>(
+        max_workers, /* numa_node_id */ -1, [] { at::init_num_threads(); });
+  });
+  const size_t limit = std::min(max_workers, cpu_worker_pool_->size());
+  // Start at most one worker per waiting task, up to the limit.
+  size_t to_start = queue->size();
+  size_t num_workers = graph_task->num_cpu_workers_.load();
+  while (to_start > 0 && num_workers < limit) {
+    if (!graph_task->num_cpu_workers_.compare_exchange_weak(num_workers, num_workers + 1)) {
+      continue;
+    }
+    ++cpu_workers_dispatched_;
+    std::weak_ptr<GraphTask> weak_graph_task = graph_task;
+    cpu_worker_pool_->run([this, queue, weak_graph_task] {
+      cpu_worker_main(queue, weak_graph_task);
+    });
+    ++num_workers;
+    --to_start;
+  }
+}
+
+void Engine::cpu_worker_main(
+    std::shared_ptr<ReadyQueue> ready_queue,
+    std::weak_ptr<GraphTask> graph_task) {
+  // CPU workers are not the owner of any GraphTask they run nodes for.
+  // See Note [Parallel CPU backward]
+  TORCH_INTERNAL_ASSERT(worker_device == NO_DEVICE);
+  while (true) {
+    std::shared_ptr<GraphTask> local_graph_task;
+    {
+      auto maybe_task = ready_queue->try_pop();
+      if (!maybe_task) {
+        break;
+      }
+      NodeTask task = std::move(*maybe_task);
+      if (!task.fn_) {
+        // An empty NodeTask wakes up the thread driving a GraphTask; leave it
+        // to that thread. It is already counted in outstanding_tasks_.
+        ready_queue->push(std::move(task), /* incrementOutstandingTasks */ false);
+        break;
+      }
+
+      if (!(local_graph_task = task.base_.lock())) {
+        continue;
+      }
+
+      if (!local_graph_task->has_error_.load()) {
+        AutoGradMode grad_mode(local_graph_task->grad_mode_);
+        ++cpu_nodes_run_;
+        ++cpu_nodes_run_by_workers_;
+        update_max(max_concurrent_cpu_nodes_, ++local_graph_task->running_cpu_nodes_);
+        try {
+          GraphTaskGuard guard(local_graph_task);
+          evaluate_function(
+              local_graph_task,
+              task.fn_.get(),
+              task.inputs_,
+              local_graph_task->cpu_ready_queue_);
+        } catch (std::exception& e) {
+          thread_on_exception(local_graph_task, task.fn_, e);
+        }
+        --local_graph_task->running_cpu_nodes_;
+        maybe_dispatch_cpu_workers(local_graph_task);
       }
     }
+
+    finish_node_task(local_graph_task);
+  }
+
+  if (auto owner_graph_task = graph_task.lock()) {
+    --owner_graph_task->num_cpu_workers_;
   }
 }
 
@@ -690,11 +899,23 @@ static variable_list call_function(
   return outputs;
 }
 
+// Note [Inline execution of ready tasks]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// Backward graphs made of many small nodes spend a large part of their time
+// pushing each task to a ReadyQueue only for the same thread to pop it right
+// back. When evaluating a function makes tasks ready that would go to the
+// ready queue of the current thread, and that queue is empty, the one that
+// the queue would return first (the highest sequence number, as all of them
+// belong to the same GraphTask) is handed back to thread_main to run next
+// instead. Since the queue is empty, no task that the queue would have
+// ordered before it is skipped. The other ready tasks are pushed as usual.
+// The inline task counts towards outstanding_tasks_ just like a queued one.
 void Engine::evaluate_function(
     std::shared_ptr<GraphTask>& graph_task,
     Node* func,
     InputBuffer& inputs,
-    const std::shared_ptr<ReadyQueue>& cpu_ready_queue) {
+    const std::shared_ptr<ReadyQueue>& cpu_ready_queue,
+    c10::optional<NodeTask>* inline_task) {
   // If exec_info_ is not empty, we have to instrument the execution
   auto& exec_info_ = graph_task->exec_info_;
   if (!exec_info_.empty()) {
@@ -751,6 +972,24 @@ void Engine::evaluate_function(
     }
   }
 
+  // Only run a task inline if nothing is waiting in the queue it would go to.
+  const bool can_inline = inline_task && local_ready_queue->empty();
+  auto push_ready = [&](InputBuffer&& input_buffer, std::shared_ptr<Node> next_fn) {
+    auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
+    NodeTask task(graph_task, std::move(next_fn), std::move(input_buffer));
+    if (can_inline && queue == local_ready_queue) {
+      if (!inline_task->has_value()) {
+        ++graph_task->outstanding_tasks_;
+        *inline_task = std::move(task);
+        return;
+      }
+      if ((*inline_task)->fn_->sequence_nr() < task.fn_->sequence_nr()) {
+        std::swap(**inline_task, task);
+      }
+    }
+    queue->push(std::move(task));
+  };
+
   // Lock mutex for the accesses to GraphTask dependencies_, not_ready_ and cpu_ready_queue_ below
   std::lock_guard<std::mutex> lock(graph_task->mutex_);
   for (int i = 0; i < num_outputs; ++i) {
@@ -793,9 +1032,7 @@ void Engine::evaluate_function(
                        opt_next_stream);
 
       if (is_ready) {
-        auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
-            NodeTask(graph_task, next.function, std::move(input_buffer)));
+        push_ready(std::move(input_buffer), next.function);
       } else {
         not_ready.emplace(next.function.get(), std::move(input_buffer));
       }
@@ -810,9 +1047,7 @@ void Engine::evaluate_function(
                        opt_parent_stream,
                        opt_next_stream);
       if (is_ready) {
-        auto queue = ready_queue(cpu_ready_queue, input_buffer.device());
-        queue->push(
-            NodeTask(graph_task, next.function, std::move(input_buffer)));
+        push_ready(std::move(input_buffer), next.function);
         not_ready.erase(not_ready_it);
       }
     }
@@ -11,7 +11,10 @@
 #include <torch/csrc/autograd/functions/basic_ops.h>
 #include <torch/csrc/autograd/input_buffer.h>
 #include <torch/csrc/utils/future.h>
+#include <c10/core/thread_pool.h>
+#include <c10/util/Optional.h>
 
+#include <atomic>
 #include <deque>
 #include <exception>
 #include <functional>
@@ -161,6 +164,12 @@ struct GraphTask: std::enable_shared_from_this<GraphTask> {
   // mutex_ as the two are protecting different data structures.
   std::mutex final_callbacks_lock_;
 
+  // Number of CPU workers currently draining cpu_ready_queue_ for this
+  // GraphTask, and number of its nodes running at the same time. Only used
+  // when parallel CPU backward is enabled. See Note [Parallel CPU backward]
+  std::atomic<size_t> num_cpu_workers_{0};
+  std::atomic<size_t> running_cpu_nodes_{0};
+
   GraphTask(
       bool keep_graph,
       bool grad_mode,
@@ -201,6 +210,9 @@ struct NodeTask {
   // When worker receives a task with isShutdownTask = true, it will immediately
   // exit. The engine sends a shutdown task to every queue upon its destruction.
   bool isShutdownTask_;
+  // The reentrant depth of the GraphTask, read once when the task is created
+  // so that ordering tasks in the ReadyQueue does not have to lock base_.
+  int reentrant_depth_;
 
   int getReentrantDepth() const;
 
@@ -212,7 +224,10 @@ struct NodeTask {
       : base_(base),
         fn_(std::move(fn)),
         inputs_(std::move(inputs)),
-        isShutdownTask_(isShutdownTask) {}
+        isShutdownTask_(isShutdownTask) {
+    auto graph_task = base_.lock();
+    reentrant_depth_ = graph_task ? graph_task->reentrant_depth_ : 0;
+  }
 };
 
 
@@ -242,6 +257,9 @@ struct ReadyQueue {
   mutable std::mutex mutex_;
 
   std::priority_queue<NodeTask, std::vector<NodeTask>, CompareNodeTaskTime> heap_;
+  // Number of tasks in heap_, so that empty() and size() do not need to take
+  // mutex_. Only updated while holding mutex_.
+  std::atomic<size_t> size_{0};
 
  public:
   // incrementOutstandingTasks indicates whether or not we should increment
@@ -251,6 +269,8 @@ struct ReadyQueue {
   void push(NodeTask item, bool incrementOutstandingTasks = true);
   void pushShutdownTask();
   NodeTask pop();
+  // Like pop(), but returns nullopt instead of waiting if the queue is empty.
+  c10::optional<NodeTask> try_pop();
   bool empty() const;
   size_t size() const;
 };
@@ -290,12 +310,18 @@ struct TORCH_API Engine {
   }
 
   // We pass cpu_ready_queue to evaluate_function, so that it knows
-  // the correct ready queue to push to after a NodeTask is ready
+  // the correct ready queue to push to after a NodeTask is ready.
+  //
+  // If inline_task is given, one of the NodeTasks made ready by func that
+  // would be pushed to the ready queue of the current thread may instead be
+  // stored there, to be run next by the caller without going through the
+  // queue. See Note [Inline execution of ready tasks]
   void evaluate_function(
       std::shared_ptr<GraphTask>& graph_task,
       Node* func,
       InputBuffer& inputs,
-      const std::shared_ptr<ReadyQueue>& cpu_ready_queue);
+      const std::shared_ptr<ReadyQueue>& cpu_ready_queue,
+      c10::optional<NodeTask>* inline_task = nullptr);
 
   void initialize_device_threads_pool();
   virtual void thread_on_exception(
@@ -312,6 +338,29 @@ struct TORCH_API Engine {
   // Should be called after fork to notify that worker threads are gone
   void release_workers();
 
+  // Sets the number of extra threads that may run ready CPU nodes of a single
+  // GraphTask next to the thread driving it; 0 (the default, unless set with
+  // PYTORCH_AUTOGRAD_CPU_WORKERS) disables parallel CPU backward. The worker
+  // pool is created with the value set when it is first needed; setting a
+  // larger value afterwards does not grow it.
+  // See Note [Parallel CPU backward]
+  void set_num_cpu_workers(size_t num_workers);
+  size_t num_cpu_workers() const;
+
+  struct CPUWorkerStats {
+    // CPU nodes run while parallel CPU backward was enabled, and how many of
+    // them were run by CPU workers rather than by the thread driving the
+    // backward pass.
+    uint64_t nodes_run = 0;
+    uint64_t nodes_run_by_workers = 0;
+    // Number of times a CPU worker was started for a GraphTask.
+    uint64_t workers_dispatched = 0;
+    // Largest number of nodes of one GraphTask that were running at once.
+    uint64_t max_concurrent_nodes = 0;
+  };
+  CPUWorkerStats cpu_worker_stats() const;
+  void reset_cpu_worker_stats();
+
   // Initializes a device thread for the autograd engine.
   virtual void thread_init(
       int device,
@@ -341,6 +390,15 @@ struct TORCH_API Engine {
   virtual void thread_main(const std::shared_ptr<GraphTask>& task);
   void reentrant_thread_init();
   void add_thread_pool_task(const std::weak_ptr<GraphTask>& graph_task);
+  // Decrements the outstanding tasks of graph_task after one of its NodeTasks
+  // was processed, and completes it if it was the last one.
+  void finish_node_task(const std::shared_ptr<GraphTask>& graph_task);
+  // Starts CPU workers for graph_task if its CPU ready queue has tasks waiting
+  // and it has fewer workers than allowed. See Note [Parallel CPU backward]
+  void maybe_dispatch_cpu_workers(const std::shared_ptr<GraphTask>& graph_task);
+  void cpu_worker_main(
+      std::shared_ptr<ReadyQueue> ready_queue,
+      std::weak_ptr<GraphTask> graph_task);
 
   // Ensures device_ready_queues_ are initialized only once
   std::once_flag start_device_threads_flag_;
@@ -378,6 +436,17 @@ struct TORCH_API Engine {
  std::shared_ptr<ThreadPoolShared> thread_pool_shared_;
 
 private:
+  // See Note [Parallel CPU backward]
+  std::atomic<size_t> num_cpu_workers_;
+  // Updated by the CPU workers, so declared before the pool, which joins them
+  // when it is destroyed.
+  std::atomic<uint64_t> cpu_nodes_run_{0};
+  std::atomic<uint64_t> cpu_nodes_run_by_workers_{0};
+  std::atomic<uint64_t> cpu_workers_dispatched_{0};
+  std::atomic<uint64_t> max_concurrent_cpu_nodes_{0};
+  std::once_flag cpu_worker_pool_flag_;
+  std::unique_ptr<c10::ThreadPool> cpu_worker_pool_;
+
   // Number of non-reentrant threads
   std::atomic<uint32_t> non_reentrant_device_thread_count_;
   // Destructor will wait for non-reentrant threads to finish
@@ -2,6 +2,7 @@
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/utils/pybind.h>
+#include <torch/csrc/autograd/engine.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <ATen/autocast_mode.h>
 #include <torch/csrc/autograd/profiler.h>
@@ -61,6 +62,25 @@ PyObject* THPAutograd_initExtension(PyObject* _unused, PyObject *unused) {
     at::enableRecordFunction(enable);
   });
 
+  m.def("_set_num_cpu_workers", [](size_t num_workers) {
+    torch::autograd::Engine::get_default_engine().set_num_cpu_workers(num_workers);
+  });
+  m.def("_get_num_cpu_workers", []() {
+    return torch::autograd::Engine::get_default_engine().num_cpu_workers();
+  });
+  m.def("_cpu_worker_stats", []() {
+    auto stats = torch::autograd::Engine::get_default_engine().cpu_worker_stats();
+    py::dict result;
+    result["nodes_run"] = stats.nodes_run;
+    result["nodes_run_by_workers"] = stats.nodes_run_by_workers;
+    result["workers_dispatched"] = stats.workers_dispatched;
+    result["max_concurrent_nodes"] = stats.max_concurrent_nodes;
+    return result;
+  });
+  m.def("_reset_cpu_worker_stats", []() {
+    torch::autograd::Engine::get_default_engine().reset_cpu_worker_stats();
+  });
+
   Py_RETURN_TRUE;
 }
 
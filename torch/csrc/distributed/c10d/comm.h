@@ -3,6 +3,7 @@
 #include <memory>
 
 #include <ATen/ATen.h>
+#include <ATen/core/ivalue.h>
 #include <c10d/ProcessGroup.hpp>
 
 namespace c10d {
@@ -13,4 +14,50 @@ void broadcast_coalesced(
     at::TensorList tensors,
     size_t buffer_size);
 
+// The flattened contents of one DDP bucket, one tensor per model replica,
+// as passed to a communication hook. The index identifies the bucket, so
+// that hooks can keep state (e.g. error feedback) per bucket across
+// iterations. It is stable until the buckets are rebuilt.
+class GradBucket {
+ public:
+  GradBucket(size_t index, std::vector<at::Tensor> tensors)
+      : index_(index), tensors_(std::move(tensors)) {}
+
+  size_t getIndex() const {
+    return index_;
+  }
+
+  const std::vector<at::Tensor>& getTensors() const {
+    return tensors_;
+  }
+
+ private:
+  size_t index_;
+  std::vector<at::Tensor> tensors_;
+};
+
+// A communication hook replaces the allreduce of the contents of a bucket
+// in the Reducer. It is called when the bucket is ready, in the same order
+// on every process, and has to start all the collectives it needs before it
+// returns, so that the collectives of different buckets are issued in the
+// same order everywhere. The hook returns a Future whose value holds the
+// reduced tensors, one per replica, which the Reducer waits for at the end
+// of the backward pass. Like allreduce, the reduced tensors must hold the
+// sum over all processes of the bucket contents; the Reducer divides the
+// gradients by the number of processes before they are put in a bucket.
+class CommHookInterface {
+ public:
+  virtual ~CommHookInterface() = default;
+
+  virtual c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) = 0;
+
+  // Returns the reduced tensors from the value of the Future returned by
+  // runHook.
+  virtual std::vector<at::Tensor> parseHookResult(
+      const c10::IValue& result) {
+    return result.toTensorVector();
+  }
+};
+
 } // namespace c10d
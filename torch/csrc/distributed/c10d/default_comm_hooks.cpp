@@ -0,0 +1,214 @@
+#include <torch/csrc/distributed/c10d/default_comm_hooks.h>
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+
+#include <ATen/CPUGeneratorImpl.h>
+#include <c10/util/Exception.h>
+
+namespace c10d {
+namespace {
+
+using c10::ivalue::Future;
+
+// Returns a Future that completes once all of `futures` have completed. It
+// is set to the first error if any of them fails.
+c10::intrusive_ptr<Future> collectAll(
+    const std::vector<c10::intrusive_ptr<Future>>& futures) {
+  struct State {
+    std::mutex mutex;
+    size_t remaining;
+    c10::optional<std::string> error;
+  };
+  auto result = c10::make_intrusive<Future>(c10::NoneType::get());
+  auto state = std::make_shared<State>();
+  state->remaining = futures.size();
+  for (const auto& future : futures) {
+    future->addCallback([result, state, future]() {
+      std::unique_lock<std::mutex> lock(state->mutex);
+      if (future->hasError() && !state->error) {
+        state->error = future->error()->what();
+      }
+      if (--state->remaining > 0) {
+        return;
+      }
+      lock.unlock();
+      if (state->error) {
+        result->setError(*state->error);
+      } else {
+        result->markCompleted();
+      }
+    });
+  }
+  return result;
+}
+
+// Makes the columns of `matrix` orthonormal (Gram-Schmidt), in place.
+void orthogonalize(at::Tensor& matrix, double eps = 1e-8) {
+  const auto num_cols = matrix.size(1);
+  for (int64_t i = 0; i < num_cols; i++) {
+    auto col = matrix.select(1, i);
+    col.div_(col.norm() + eps);
+    if (i + 1 < num_cols) {
+      auto rest = matrix.narrow(1, i + 1, num_cols - i - 1);
+      rest.sub_(col.unsqueeze(1) * col.matmul(rest));
+    }
+  }
+}
+
+c10::intrusive_ptr<Future> allreduceBucket(
+    const std::shared_ptr<ProcessGroup>& process_group,
+    const GradBucket& bucket) {
+  std::vector<at::Tensor> tensors = bucket.getTensors();
+  auto work = process_group->allreduce(tensors);
+  return work->getFuture()->then(
+      [tensors, work]() -> c10::IValue { return tensors; },
+      c10::ListType::ofTensors());
+}
+
+} // namespace
+
+c10::intrusive_ptr<Future> FP16CompressHook::runHook(
+    const GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  std::vector<at::Tensor> compressed;
+  compressed.reserve(tensors.size());
+  for (const auto& tensor : tensors) {
+    compressed.push_back(tensor.to(at::kHalf));
+  }
+  auto work = process_group_->allreduce(compressed);
+  return work->getFuture()->then(
+      [tensors, compressed, work]() -> c10::IValue {
+        for (size_t i = 0; i < tensors.size(); i++) {
+          tensors[i].copy_(compressed[i]);
+        }
+        return tensors;
+      },
+      c10::ListType::ofTensors());
+}
+
+TopKCompressHook::TopKCompressHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    double ratio)
+    : process_group_(std::move(process_group)), ratio_(ratio) {
+  TORCH_CHECK(
+      ratio_ > 0 && ratio_ <= 1,
+      "Expected the top-k ratio to be in (0, 1], but got ",
+      ratio_);
+}
+
+c10::intrusive_ptr<Future> TopKCompressHook::runHook(
+    const GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "TopKCompressHook only supports a single model replica per process.");
+  auto tensor = tensors[0];
+  const auto numel = tensor.numel();
+
+  // Add the current contents to what was left out in previous iterations.
+  auto& residual = residuals_[bucket.getIndex()];
+  if (!residual.defined() || residual.numel() != numel) {
+    residual = at::zeros_like(tensor);
+  }
+  residual.add_(tensor);
+
+  const auto k = std::min<int64_t>(
+      numel, std::max<int64_t>(1, std::ceil(ratio_ * numel)));
+  auto indices = std::get<1>(residual.abs().topk(k, 0, true, false));
+  auto values = residual.index_select(0, indices);
+  residual.index_fill_(0, indices, 0);
+
+  // Every process selects k elements of a bucket of the same size, so all
+  // the gathered tensors have the same size as well.
+  const auto world_size = process_group_->getSize();
+  std::vector<std::vector<at::Tensor>> gathered_values(1);
+  std::vector<std::vector<at::Tensor>> gathered_indices(1);
+  for (int i = 0; i < world_size; i++) {
+    gathered_values[0].push_back(at::empty_like(values));
+    gathered_indices[0].push_back(at::empty_like(indices));
+  }
+  std::vector<at::Tensor> values_input = {values};
+  std::vector<at::Tensor> indices_input = {indices};
+  auto values_work = process_group_->allgather(gathered_values, values_input);
+  auto indices_work =
+      process_group_->allgather(gathered_indices, indices_input);
+
+  return collectAll({values_work->getFuture(), indices_work->getFuture()})
+      ->then(
+          [tensor,
+           gathered_values,
+           gathered_indices,
+           values_work,
+           indices_work]() -> c10::IValue {
+            tensor.zero_();
+            for (size_t i = 0; i < gathered_values[0].size(); i++) {
+              tensor.index_add_(
+                  0, gathered_indices[0][i], gathered_values[0][i]);
+            }
+            return std::vector<at::Tensor>{tensor};
+          },
+          c10::ListType::ofTensors());
+}
+
+PowerSGDHook::PowerSGDHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t rank,
+    uint64_t seed)
+    : process_group_(std::move(process_group)), rank_(rank), seed_(seed) {
+  TORCH_CHECK(rank_ > 0, "Expected a positive PowerSGD rank, but got ", rank_);
+}
+
+c10::intrusive_ptr<Future> PowerSGDHook::runHook(const GradBucket& bucket) {
+  const auto& tensors = bucket.getTensors();
+  TORCH_CHECK(
+      tensors.size() == 1,
+      "PowerSGDHook only supports a single model replica per process.");
+  auto tensor = tensors[0];
+  const auto numel = tensor.numel();
+  const auto rows =
+      static_cast<int64_t>(std::ceil(std::sqrt(static_cast<double>(numel))));
+  const auto cols = rows == 0 ? 0 : (numel + rows - 1) / rows;
+  const auto scalar_type = tensor.scalar_type();
+  if ((rows + cols) * rank_ >= numel ||
+      (scalar_type != at::kFloat && scalar_type != at::kDouble)) {
+    return allreduceBucket(process_group_, bucket);
+  }
+
+  auto& state = states_[bucket.getIndex()];
+  if (!state.error.defined() || state.error.numel() != rows * cols ||
+      state.error.scalar_type() != scalar_type) {
+    state.error = at::zeros({rows, cols}, tensor.options());
+    auto generator = at::detail::createCPUGenerator(seed_ + bucket.getIndex());
+    state.q = at::randn(
+                  {cols, rank_},
+                  generator,
+                  tensor.options().device(at::kCPU))
+                  .to(tensor.device());
+  }
+
+  // M = contents + error, as a rows x cols matrix.
+  auto matrix = state.error;
+  matrix.view({-1}).narrow(0, 0, numel).add_(tensor.view({-1}));
+
+  std::vector<at::Tensor> p = {matrix.mm(state.q)};
+  process_group_->allreduce(p)->wait();
+  orthogonalize(p[0]);
+
+  std::vector<at::Tensor> q = {matrix.t().mm(p[0])};
+  // What this process does not get across is fed back next iteration.
+  matrix.sub_(p[0].mm(q[0].t()));
+  state.q = q[0];
+
+  auto work = process_group_->allreduce(q);
+  return work->getFuture()->then(
+      [tensor, p, q, numel, work]() -> c10::IValue {
+        auto approximation = p[0].mm(q[0].t());
+        tensor.view({-1}).copy_(approximation.view({-1}).narrow(0, 0, numel));
+        return std::vector<at::Tensor>{tensor};
+      },
+      c10::ListType::ofTensors());
+}
+
+} // namespace c10d
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+
+#include <c10d/ProcessGroup.hpp>
+#include <torch/csrc/distributed/c10d/comm.h>
+
+namespace c10d {
+
+// Built-in communication hooks for the Reducer that trade accuracy of the
+// gradient reduction for less communication. See CommHookInterface.
+//
+// The hooks that keep state per bucket (error feedback, warm start) expect
+// a single model replica per process.
+
+// Casts the bucket contents to half precision, allreduces them and casts
+// the result back, halving the communication of float32 gradients.
+class FP16CompressHook : public CommHookInterface {
+ public:
+  explicit FP16CompressHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// Only communicates the ceil(ratio * numel) elements of the bucket with the
+// largest magnitude, as values and indices gathered from all processes.
+// The elements that are left out are kept and added to the bucket contents
+// in the next iteration (error feedback), so that every gradient update is
+// applied eventually.
+class TopKCompressHook : public CommHookInterface {
+ public:
+  TopKCompressHook(std::shared_ptr<ProcessGroup> process_group, double ratio);
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+  const double ratio_;
+  // Error feedback per bucket index.
+  std::unordered_map<size_t, at::Tensor> residuals_;
+};
+
+// PowerSGD (Vogels et al., 2019): the bucket contents, viewed as a matrix M
+// of about sqrt(numel) x sqrt(numel) elements, are approximated by P * Q^T,
+// where P and Q only have `rank` columns. P = M * Q and Q = M^T * P are
+// allreduced one after another, with P orthogonalized in between. Q is
+// reused as the starting point of the next iteration, and the difference
+// between M and its approximation is fed back into the next iteration.
+//
+// The allreduce of P is waited for before runHook returns, as computing Q
+// depends on it and every collective has to be started in bucket order.
+// Buckets that would not get smaller, and buckets that are not float or
+// double, are allreduced as is.
+class PowerSGDHook : public CommHookInterface {
+ public:
+  // Q is initialized from a generator seeded with `seed` and the bucket
+  // index, so that it is the same on every process.
+  PowerSGDHook(
+      std::shared_ptr<ProcessGroup> process_group,
+      int64_t rank,
+      uint64_t seed = 0);
+
+  c10::intrusive_ptr<c10::ivalue::Future> runHook(
+      const GradBucket& bucket) override;
+
+ private:
+  struct State {
+    // Bucket contents of the previous iterations that were not communicated,
+    // as a rows x cols matrix (zero padded).
+    at::Tensor error;
+    // Allreduced Q of the previous iteration, cols x rank.
+    at::Tensor q;
+  };
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  const int64_t rank_;
+  const uint64_t seed_;
+  std::unordered_map<size_t, State> states_;
+};
+
+} // namespace c10d
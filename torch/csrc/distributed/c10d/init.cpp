@@ -17,13 +17,16 @@
 #endif
 
 #include <c10d/PrefixStore.hpp>
+#include <c10d/ProcessGroupHierarchical.hpp>
 #include <c10d/ProcessGroupRoundRobin.hpp>
 #include <c10d/TCPStore.hpp>
 #include <pybind11/chrono.h>
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/comm.h>
+#include <torch/csrc/distributed/c10d/default_comm_hooks.h>
 #include <torch/csrc/distributed/c10d/reducer.h>
+#include <torch/csrc/utils/memory.h>
 #include <torch/csrc/utils/object_ptr.h>
 #include <torch/csrc/utils/pybind.h>
 
@@ -141,7 +144,43 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
-      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
+      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats)
+      .def(
+          "_register_fp16_compress_hook",
+          [](::c10d::Reducer& reducer,
+             std::shared_ptr<::c10d::ProcessGroup> process_group) {
+            reducer.register_comm_hook(
+                torch::make_unique<::c10d::FP16CompressHook>(
+                    std::move(process_group)));
+          },
+          py::arg("process_group"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_register_topk_compress_hook",
+          [](::c10d::Reducer& reducer,
+             std::shared_ptr<::c10d::ProcessGroup> process_group,
+             double ratio) {
+            reducer.register_comm_hook(
+                torch::make_unique<::c10d::TopKCompressHook>(
+                    std::move(process_group), ratio));
+          },
+          py::arg("process_group"),
+          py::arg("ratio"),
+          py::call_guard<py::gil_scoped_release>())
+      .def(
+          "_register_powersgd_hook",
+          [](::c10d::Reducer& reducer,
+             std::shared_ptr<::c10d::ProcessGroup> process_group,
+             int64_t rank,
+             uint64_t seed) {
+            reducer.register_comm_hook(
+                torch::make_unique<::c10d::PowerSGDHook>(
+                    std::move(process_group), rank, seed));
+          },
+          py::arg("process_group"),
+          py::arg("rank"),
+          py::arg("seed") = 0,
+          py::call_guard<py::gil_scoped_release>());
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class for available reduction operations: ``SUM``, ``PRODUCT``,
@@ -238,6 +277,55 @@ They are used in specifying strategies for reduction collectives, e.g.,
               "add",
               &::c10d::Store::add,
               py::call_guard<py::gil_scoped_release>())
+          .def(
+              "compare_set",
+              [](::c10d::Store& store,
+                 const std::string& key,
+                 const std::string& expected_value,
+                 const std::string& desired_value) -> py::bytes {
+                std::vector<uint8_t> value;
+                {
+                  py::gil_scoped_release release;
+                  value = store.compareSet(
+                      key,
+                      std::vector<uint8_t>(
+                          expected_value.begin(), expected_value.end()),
+                      std::vector<uint8_t>(
+                          desired_value.begin(), desired_value.end()));
+                }
+                return py::bytes(
+                    reinterpret_cast<char*>(value.data()), value.size());
+              })
+          .def(
+              "multi_get",
+              [](::c10d::Store& store, const std::vector<std::string>& keys) {
+                std::vector<std::vector<uint8_t>> values;
+                {
+                  py::gil_scoped_release release;
+                  values = store.multiGet(keys);
+                }
+                std::vector<py::bytes> result;
+                result.reserve(values.size());
+                for (const auto& value : values) {
+                  result.emplace_back(
+                      reinterpret_cast<const char*>(value.data()),
+                      value.size());
+                }
+                return result;
+              })
+          .def(
+              "multi_set",
+              [](::c10d::Store& store,
+                 const std::vector<std::string>& keys,
+                 const std::vector<std::string>& values) {
+                std::vector<std::vector<uint8_t>> values_;
+                values_.reserve(values.size());
+                for (const auto& value : values) {
+                  values_.emplace_back(value.begin(), value.end());
+                }
+                store.multiSet(keys, values_);
+              },
+              py::call_guard<py::gil_scoped_release>())
           .def(
               "set_timeout",
               &::c10d::Store::setTimeout,
@@ -558,6 +646,35 @@ They are used in specifying strategies for reduction collectives, e.g.,
       py::arg("process_groups"),
       py::call_guard<py::gil_scoped_release>());
 
+  module.def(
+      "_hierarchical_process_group",
+      [](const std::shared_ptr<::c10d::Store>& store,
+         int rank,
+         int size,
+         int localSize,
+         std::shared_ptr<::c10d::ProcessGroup> globalGroup,
+         std::shared_ptr<::c10d::ProcessGroup> interNodeGroup,
+         size_t chunkSize,
+         std::chrono::milliseconds timeout)
+          -> std::shared_ptr<::c10d::ProcessGroup> {
+        ::c10d::ProcessGroupHierarchical::Options options(localSize);
+        options.chunkSize = chunkSize;
+        options.timeout = timeout;
+        options.globalGroup = std::move(globalGroup);
+        options.interNodeGroup = std::move(interNodeGroup);
+        return std::make_shared<::c10d::ProcessGroupHierarchical>(
+            store, rank, size, std::move(options));
+      },
+      py::arg("store"),
+      py::arg("rank"),
+      py::arg("size"),
+      py::arg("local_size"),
+      py::arg("global_group"),
+      py::arg("inter_node_group") = nullptr,
+      py::arg("chunk_size") = 4 * 1024 * 1024,
+      py::arg("timeout") = ::c10d::kProcessGroupDefaultTimeout,
+      py::call_guard<py::gil_scoped_release>());
+
 #ifdef USE_C10D_GLOO
   auto processGroupGloo = shared_ptr_class_<::c10d::ProcessGroupGloo>(
       module, "ProcessGroupGloo", processGroup);
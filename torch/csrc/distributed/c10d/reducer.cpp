@@ -540,10 +540,30 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
-    bucket.work = process_group_->allreduce(tensors);
+    if (comm_hook_ && !bucket.expect_sparse_gradient) {
+      bucket.future_work =
+          comm_hook_->runHook(GradBucket(next_bucket_, std::move(tensors)));
+    } else {
+      bucket.work = process_group_->allreduce(tensors);
+    }
   }
 }
 
+void Reducer::register_comm_hook(std::unique_ptr<CommHookInterface> iface) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  TORCH_CHECK(
+      comm_hook_ == nullptr,
+      "register_comm_hook can only be called once.");
+  TORCH_CHECK(
+      !expect_autograd_hooks_ && !require_finalize_,
+      "register_comm_hook must be called before the backward pass.");
+  TORCH_CHECK(
+      replicas_.size() == 1,
+      "Communication hooks are only supported with a single model replica "
+      "per process.");
+  comm_hook_ = std::move(iface);
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   std::lock_guard<std::mutex> lock(mutex_);
@@ -880,8 +900,26 @@ void Reducer::finalize_backward() {
 
   // Wait for asynchronous reduction to complete and unflatten contents.
   for (auto& bucket : buckets_) {
-    TORCH_INTERNAL_ASSERT(bucket.work);
-    bucket.work->wait();
+    if (bucket.future_work) {
+      bucket.future_work->wait();
+      if (bucket.future_work->hasError()) {
+        throw *bucket.future_work->error();
+      }
+      auto results = comm_hook_->parseHookResult(bucket.future_work->value());
+      bucket.future_work.reset();
+      TORCH_INTERNAL_ASSERT(results.size() == bucket.replicas.size());
+      for (size_t i = 0; i < results.size(); i++) {
+        auto& contents = bucket.replicas[i].contents;
+        // The bucket views point into contents, so copy the result there
+        // unless the hook reduced contents in place.
+        if (!results[i].is_same(contents)) {
+          contents.copy_(results[i]);
+        }
+      }
+    } else {
+      TORCH_INTERNAL_ASSERT(bucket.work);
+      bucket.work->wait();
+    }
     if (!bucket.expect_sparse_gradient) {
       // We don't need to finalize the sparse bucket since the sparse grad and
       // the bucket essentially point to the same storage. As a result, once
@@ -11,6 +11,7 @@
 #include <torch/csrc/autograd/function.h>
 #include <torch/csrc/autograd/variable.h>
 #include <torch/csrc/distributed/autograd/context/context.h>
+#include <torch/csrc/distributed/c10d/comm.h>
 
 namespace c10d {
 
@@ -52,6 +53,11 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Registers a hook that replaces the allreduce of dense buckets, e.g. to
+  // compress their contents. See CommHookInterface. Can only be called once,
+  // before the first backward pass, and only with a single model replica.
+  void register_comm_hook(std::unique_ptr<CommHookInterface> iface);
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -97,6 +103,10 @@ class Reducer {
   // Work handle for allreduce on local_used_maps_
   std::shared_ptr<c10d::ProcessGroup::Work> local_used_work_;
 
+  // Communication hook that is run instead of allreduce for dense buckets,
+  // if registered.
+  std::unique_ptr<CommHookInterface> comm_hook_;
+
   void verify_replicas_within_process();
 
   void verify_replica0_across_processes();
@@ -195,6 +205,10 @@ class Reducer {
     // Keep work handle around when this set of buckets is being reduced.
     std::shared_ptr<c10d::ProcessGroup::Work> work;
 
+    // Future returned by the communication hook, used instead of `work` if
+    // a hook is registered.
+    c10::intrusive_ptr<c10::ivalue::Future> future_work;
+
     // If this bucket should expect a single sparse gradient.
     // Implies: replicas[i].variables.size() == 1.
     bool expect_sparse_gradient = false;
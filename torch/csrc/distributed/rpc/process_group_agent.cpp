@@ -392,12 +392,14 @@ std::shared_ptr<FutureMessage> ProcessGroupAgent::send(
 }
 
 void ProcessGroupAgent::handleSend(const SendWork& work) {
-  auto serializedPayload = std::make_unique<std::string>(std::move(
-      wireSerialize(work.message_.payload(), work.message_.tensors())));
+  // The tensors below keep the serialized message, and the storages its
+  // segments point into, alive until the sends complete.
+  auto serialized = std::make_shared<WireSegments>(
+      wireSerializeSegments(work.message_.payload(), work.message_.tensors()));
 
   std::vector<torch::Tensor> preamble = {torch::tensor(
       {(int64_t)pg_->getRank(),
-       (int64_t)serializedPayload->length(),
+       (int64_t)serialized->header.length(),
        (int64_t)work.message_.type(),
        (int64_t)work.message_.id()},
       {torch::kInt64})};
@@ -407,23 +409,35 @@ void ProcessGroupAgent::handleSend(const SendWork& work) {
   std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
   const auto dst = work.to_.id_;
 
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
-  auto serializedPayloadData = const_cast<char*>(serializedPayload->data());
-  auto serializedPayloadSize = serializedPayload->size();
-  std::string* deleteWhenDone = serializedPayload.release();
-  std::vector<torch::Tensor> payload = {torch::from_blob(
-      reinterpret_cast<void*>(serializedPayloadData),
-      serializedPayloadSize,
-      [deleteWhenDone](void*) { delete deleteWhenDone; },
-      {torch::kChar})};
-  pendingSends.reserve(2);
+  auto fromBlob = [&serialized](const char* data, size_t size) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+    return std::vector<torch::Tensor>{torch::from_blob(
+        const_cast<char*>(data),
+        {(int64_t)size},
+        [serialized](void*) {},
+        {torch::kChar})};
+  };
+  std::vector<std::vector<torch::Tensor>> payloads;
+  payloads.reserve(1 + serialized->segments.size());
+  payloads.push_back(
+      fromBlob(serialized->header.data(), serialized->header.size()));
+  // Small tensor sections are already in the header. Empty segments are not
+  // sent, the receiver knows their size from the header.
+  for (const auto& segment : serialized->segments) {
+    if (segment.second != 0) {
+      payloads.push_back(fromBlob(segment.first, segment.second));
+    }
+  }
+  pendingSends.reserve(1 + payloads.size());
 
   sendCounts_.increment(dst);
 
   {
     std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
     pendingSends.emplace_back(pg_->send(preamble, dst, dst /* channelTag */));
-    pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    for (auto& payload : payloads) {
+      pendingSends.emplace_back(pg_->send(payload, dst, dst /* channelTag */));
+    }
   }
   // Write pendingSends to a global map so that they can be interrupted by
   // ::shutdown().
@@ -460,9 +474,21 @@ void ProcessGroupAgent::sendToSelf(Message&& message) {
         // data outlives the scope of this function. It's shared_ptr<> due
         // to c++11 lambda capture limitations with unique_ptr<>.
         std::unique_ptr<std::string> payload;
+        auto segments = std::make_shared<std::vector<at::DataPtr>>();
         try {
-          payload = std::make_unique<std::string>(
-              wireSerialize(message.payload(), message.tensors()));
+          auto serialized =
+              wireSerializeSegments(message.payload(), message.tensors());
+          payload =
+              std::make_unique<std::string>(std::move(serialized.header));
+          // The receiving side owns its copy of the tensor data, as it
+          // would when receiving from another worker.
+          for (const auto& segment : serialized.segments) {
+            segments->push_back(
+                at::getCPUAllocator()->allocate(segment.second));
+            if (segment.second != 0) {
+              memcpy(segments->back().get(), segment.first, segment.second);
+            }
+          }
           // only increment sendCounts when the message is indeed added into
           // local recv.
           sendCounts_.increment(pg_->getRank());
@@ -481,7 +507,8 @@ void ProcessGroupAgent::sendToSelf(Message&& message) {
                 (void*)data,
                 len,
                 [delete_when_done](void*) { delete delete_when_done; },
-                {torch::kChar})));
+                {torch::kChar}),
+            std::move(segments)));
       },
       std::move(message)));
 }
@@ -514,7 +541,8 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 
 bool ProcessGroupAgent::handleRecv(RecvWork& work) {
   torch::Tensor& payload = work.payload_;
-  auto data = wireDeserialize(payload.storage().data(), payload.numel());
+  auto data = wireDeserializeSegments(
+      payload.storage().data(), payload.numel(), std::move(*work.segments_));
   Message message(
       std::move(data.first), std::move(data.second), work.type_, work.id_);
   if (message.isRequest()) {
@@ -737,20 +765,44 @@ void ProcessGroupAgent::listenLoopInternal() {
     MessageType type = MessageType(preamble_items[2]);
     int64_t id = preamble_items[3];
 
+    // Returns false if the receive was aborted.
+    auto recvFromSrc = [&](std::vector<torch::Tensor>& tensors) {
+      work = pg_->recv(tensors, srcRank, pg_->getRank());
+      {
+        // Write class variable so it can be aborted by shutdown()
+        std::lock_guard<std::mutex> guard(recvWorkMutex_);
+        recvWork_ = work;
+      }
+      return rpcAgentRunning_.load() && work->wait();
+    };
+
     std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
-    work = pg_->recv(tensors, srcRank, pg_->getRank());
-    {
-      // Write class variable so it can be aborted by shutdown()
-      std::lock_guard<std::mutex> guard(recvWorkMutex_);
-      recvWork_ = work;
+    if (!recvFromSrc(tensors)) {
+      return;
     }
 
-    if (!rpcAgentRunning_.load() || !work->wait() /* aborted */) {
-      return;
+    // Receive the data of the tensors straight into the memory that becomes
+    // their storages.
+    auto segments = std::make_shared<std::vector<at::DataPtr>>();
+    for (size_t segmentSize :
+         wireSegmentSizes(tensors[0].storage().data(), size)) {
+      segments->push_back(at::getCPUAllocator()->allocate(segmentSize));
+      if (segmentSize == 0) {
+        continue;
+      }
+      std::vector<torch::Tensor> segment = {torch::from_blob(
+          segments->back().get(), {(int64_t)segmentSize}, {torch::kChar})};
+      if (!recvFromSrc(segment)) {
+        return;
+      }
     }
 
-    enqueueRecv(
-        RecvWork(allWorkerInfo_[srcRank], type, id, std::move(tensors[0])));
+    enqueueRecv(RecvWork(
+        allWorkerInfo_[srcRank],
+        type,
+        id,
+        std::move(tensors[0]),
+        std::move(segments)));
   }
 }
 
@@ -42,18 +42,27 @@ struct SendWork {
 
 // SendWork wraps a Message and RecvWork wraps a Tensor. The difference here is
 // to allow us to run serialization/deserialization in the worker threads.
+// The payload holds the header of wireSerializeSegments(), and the segments
+// hold the data of the message's tensors, which become their storages.
+// It's shared_ptr<> because RecvWork is copied into a std::function.
 struct RecvWork {
   RecvWork(
       const WorkerInfo& from,
       MessageType type,
       int64_t id,
-      torch::Tensor&& payload)
-      : from_(from), type_(type), id_(id), payload_(payload) {}
+      torch::Tensor&& payload,
+      std::shared_ptr<std::vector<at::DataPtr>> segments)
+      : from_(from),
+        type_(type),
+        id_(id),
+        payload_(payload),
+        segments_(std::move(segments)) {}
 
   const WorkerInfo& from_;
   const MessageType type_;
   const int64_t id_;
   torch::Tensor payload_;
+  std::shared_ptr<std::vector<at::DataPtr>> segments_;
 };
 
 class ProcessGroupAgent : public RpcAgent {
@@ -147,7 +156,8 @@ class ProcessGroupAgent : public RpcAgent {
   void collectNames();
   // handle a SendWork request. This serializes the payload inside the work
   // object, and sends the message to the receiver using the underlying
-  // ProcessGroup.
+  // ProcessGroup: a preamble, the header with the payload, and then the data
+  // of every tensor storage straight from the storage.
   void handleSend(const SendWork& work);
   // put RecvWork into a queue and notify the worker thread
   void enqueueRecv(RecvWork work);
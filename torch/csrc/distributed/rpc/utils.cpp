@@ -21,6 +21,8 @@
 #include <torch/csrc/jit/serialization/pickler.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
 
+#include <algorithm>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
@@ -246,11 +248,27 @@ namespace {
 //
 // Note that per the header comments, the format is subject to change,
 // and is best used for rpcs, rather than persistent disk storage.
-std::unordered_map<std::string, std::pair<const char*, size_t>>
-parseWireSections(const void* data, size_t data_size) {
-  const char* ptr = static_cast<const char*>(data);
-  const char* endp = ptr + data_size;
+//
+// In the header of wireSerializeSegments(), the tensor sections that are
+// sent as separate segments are listed with kSegmentPrefix before their name,
+// and their data is not part of the buffer.
+
+static const char* kMeta = "meta";
+static const char* kPayload = "payload";
+static const char kSegmentPrefix = '@';
+
+bool isTensorSection(const std::string& name) {
+  return name != kMeta && name != kPayload;
+}
 
+bool isSegmentSection(const std::string& name) {
+  return !name.empty() && name[0] == kSegmentPrefix;
+}
+
+// Parses the header, and leaves ptr past its final '\n'.
+std::vector<std::pair<std::string, size_t>> parseWireHeader(
+    const char*& ptr,
+    const char* endp) {
   std::vector<std::pair<std::string, size_t>> headerEnts;
   bool ok = false;
   while (ptr != endp) {
@@ -286,9 +304,34 @@ parseWireSections(const void* data, size_t data_size) {
   if (!ok) {
     throw std::runtime_error("failed parse");
   }
+  return headerEnts;
+}
+
+// Returns the sections whose data is in the buffer. The names of the
+// sections sent as separate segments, without kSegmentPrefix, are appended to
+// segmentNames in order.
+std::unordered_map<std::string, std::pair<const char*, size_t>>
+parseWireSections(
+    const void* data,
+    size_t data_size,
+    std::vector<std::string>* segmentNames = nullptr) {
+  const char* ptr = static_cast<const char*>(data);
+  const char* endp = ptr + data_size;
+
+  auto headerEnts = parseWireHeader(ptr, endp);
 
   std::unordered_map<std::string, std::pair<const char*, size_t>> out;
   for (const auto& headerEnt : headerEnts) {
+    if (isSegmentSection(headerEnt.first)) {
+      if (segmentNames == nullptr) {
+        throw std::runtime_error("unexpected segment " + headerEnt.first);
+      }
+      segmentNames->push_back(headerEnt.first.substr(1));
+      continue;
+    }
+    if (headerEnt.second > static_cast<size_t>(endp - ptr)) {
+      throw std::runtime_error("failed bounds");
+    }
     out[headerEnt.first] = {ptr, headerEnt.second};
     ptr += headerEnt.second;
   }
@@ -298,37 +341,20 @@ parseWireSections(const void* data, size_t data_size) {
   return out;
 }
 
-static const char* kMeta = "meta";
-static const char* kPayload = "payload";
-}; // namespace
+struct WireEntry {
+  std::string name;
+  const char* data;
+  size_t size;
+};
 
-c10::List<at::Tensor> cloneSparseTensors(
-    const std::vector<at::Tensor>& tensors) {
-  // Sanity-check: If the majority of bits don't need to go over the wire,
-  // force a clone(). Some Tensors are effectively small views, only using
-  // ~1% of the underlying Storage.
-  auto worthRecopying = [](const at::Tensor& t) -> bool {
-    if (!t.has_storage()) {
-      return false; // avoid throwing below.
-    }
-    auto storageSize = t.storage().nbytes();
-    auto usefulSize = t.element_size() * t.numel();
-    constexpr size_t kMinMultiple = 2;
-    constexpr size_t kMinRecopyBytes = 8 * 1024;
-    return storageSize >= kMinRecopyBytes &&
-        storageSize >= usefulSize * kMinMultiple;
-  };
-  c10::List<at::Tensor> pTensors;
-  pTensors.reserve(tensors.size());
-  for (const auto& t : tensors) {
-    pTensors.push_back(worthRecopying(t) ? t.clone() : t);
-  }
-  return pTensors;
-}
-
-std::string wireSerialize(
+// Returns the sections of a message. The data of the meta section is kept
+// in metaEntry, and that of the tensor sections in the storages of
+// tensorData.
+std::vector<WireEntry> wireEntries(
     const std::vector<char>& payload,
-    const std::vector<at::Tensor>& tensors) {
+    const std::vector<at::Tensor>& tensors,
+    std::string& metaEntry,
+    std::vector<at::Tensor>& tensorData) {
   for (const auto& tensor : tensors) {
     TORCH_CHECK(
         tensor.device().is_cpu(),
@@ -338,15 +364,7 @@ std::string wireSerialize(
         tensor.device());
   }
 
-  struct Ent {
-    std::string name;
-    const char* data;
-    size_t size;
-  };
-  std::vector<Ent> entries;
-  std::string metaEntry;
-  std::vector<at::Tensor> tensorData;
-
+  std::vector<WireEntry> entries;
   if (!payload.empty()) {
     entries.push_back({kPayload, payload.data(), payload.size()});
   }
@@ -363,7 +381,7 @@ std::string wireSerialize(
     entries.push_back({kMeta, metaEntry.data(), metaEntry.size()});
     for (size_t i = 0; i < tensorData.size(); i++) {
       // Construct WritableTensorData for each tensor in the pickler tensorData
-      // Since tensorData is in function scope, and getWritableTensorData just
+      // Since tensorData is kept by the caller, and getWritableTensorData just
       // record the tensors, the data() pointers stay valid for CPU tensors
       // Note that RPC serde doesn't support CUDA tensors yet, if we should
       // support CUDA tensor, we need to be careful since getWritableTensorData
@@ -375,32 +393,33 @@ std::string wireSerialize(
                          writeableTensorData.sizeInBytes()});
     }
   }
+  return entries;
+}
 
+std::string wireHeader(const std::vector<WireEntry>& entries) {
   std::string header;
-  size_t tot = 0;
   for (const auto& e : entries) {
-    tot += e.size;
     header.append(e.name)
         .append(" ")
         .append(c10::to_string(e.size))
         .append("\n");
   }
   header.push_back('\n');
+  return header;
+}
 
-  std::string out;
-  out.reserve(header.size() + tot);
-  out.append(header);
-  for (const auto& e : entries) {
-    out.append(e.data, e.size);
+at::DataPtr copySection(const std::pair<const char*, size_t>& section) {
+  auto dptr = at::getCPUAllocator()->allocate(section.second);
+  if (section.second != 0) {
+    memcpy(dptr.get(), section.first, section.second);
   }
-  return out;
+  return dptr;
 }
 
-std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
-    const void* data,
-    size_t data_size) {
-  auto sections = parseWireSections(data, data_size);
-
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeSections(
+    const std::unordered_map<std::string, std::pair<const char*, size_t>>&
+        sections,
+    std::function<at::DataPtr(const std::string&)> sectionReadFunc) {
   std::vector<char> payload;
   auto payloadIt = sections.find(kPayload);
   if (payloadIt != sections.end() && payloadIt->second.second != 0) {
@@ -413,33 +432,15 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
   auto metaIt = sections.find(kMeta);
   if (metaIt != sections.end()) {
     const auto& metaData = metaIt->second;
-    size_t metaDataPos = 0;
-    auto metaDataReadFunc = [&](char* buf, size_t n) -> size_t {
-      if (metaDataPos >= metaData.second || n == 0) {
-        return 0;
-      }
-      size_t toCopy = std::min(metaDataPos + n, metaData.second) - metaDataPos;
-      memcpy(buf, metaData.first + metaDataPos, toCopy);
-      metaDataPos += toCopy;
-      return toCopy;
-    };
-    auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
-      auto it = sections.find(ename);
-      if (it == sections.end()) {
-        throw std::runtime_error("Couldn't find entity " + ename);
-      }
-      const auto& idat = it->second;
-      auto dptr = at::getCPUAllocator()->allocate(idat.second);
-      if (idat.second != 0) {
-        memcpy(dptr.get(), idat.first, idat.second);
-      }
-      return dptr;
-    };
-
     // No need to pass typeResolver here, as it always processes string and
     // tensors only
     torch::jit::Unpickler unpickler(
-        metaDataReadFunc, nullptr, nullptr, sectionReadFunc, {});
+        metaData.first,
+        metaData.second,
+        nullptr,
+        nullptr,
+        std::move(sectionReadFunc),
+        {});
     auto ival = unpickler.parse_ivalue();
     for (auto&& t : ival.toTensorList()) {
       tensors.emplace_back(std::move(t));
@@ -448,6 +449,133 @@ std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
   return {std::move(payload), std::move(tensors)};
 }
 
+}; // namespace
+
+c10::List<at::Tensor> cloneSparseTensors(
+    const std::vector<at::Tensor>& tensors) {
+  // Sanity-check: If the majority of bits don't need to go over the wire,
+  // force a clone(). Some Tensors are effectively small views, only using
+  // ~1% of the underlying Storage.
+  auto worthRecopying = [](const at::Tensor& t) -> bool {
+    if (!t.has_storage()) {
+      return false; // avoid throwing below.
+    }
+    auto storageSize = t.storage().nbytes();
+    auto usefulSize = t.element_size() * t.numel();
+    constexpr size_t kMinMultiple = 2;
+    constexpr size_t kMinRecopyBytes = 8 * 1024;
+    return storageSize >= kMinRecopyBytes &&
+        storageSize >= usefulSize * kMinMultiple;
+  };
+  c10::List<at::Tensor> pTensors;
+  pTensors.reserve(tensors.size());
+  for (const auto& t : tensors) {
+    pTensors.push_back(worthRecopying(t) ? t.clone() : t);
+  }
+  return pTensors;
+}
+
+std::string wireSerialize(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors) {
+  std::string metaEntry;
+  std::vector<at::Tensor> tensorData;
+  auto entries = wireEntries(payload, tensors, metaEntry, tensorData);
+
+  size_t tot = 0;
+  for (const auto& e : entries) {
+    tot += e.size;
+  }
+  std::string header = wireHeader(entries);
+
+  std::string out;
+  out.reserve(header.size() + tot);
+  out.append(header);
+  for (const auto& e : entries) {
+    out.append(e.data, e.size);
+  }
+  return out;
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
+    const void* data,
+    size_t data_size) {
+  auto sections = parseWireSections(data, data_size);
+  auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
+    auto it = sections.find(ename);
+    if (it == sections.end()) {
+      throw std::runtime_error("Couldn't find entity " + ename);
+    }
+    return copySection(it->second);
+  };
+  return wireDeserializeSections(sections, sectionReadFunc);
+}
+
+WireSegments wireSerializeSegments(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors,
+    size_t inlineThreshold) {
+  WireSegments out;
+  std::string metaEntry;
+  auto entries = wireEntries(payload, tensors, metaEntry, out.tensors);
+
+  size_t inlineSize = 0;
+  for (auto& e : entries) {
+    if (isTensorSection(e.name) && e.size >= inlineThreshold) {
+      out.segments.emplace_back(e.data, e.size);
+      e.name.insert(e.name.begin(), kSegmentPrefix);
+    } else {
+      inlineSize += e.size;
+    }
+  }
+  std::string header = wireHeader(entries);
+  out.header.reserve(header.size() + inlineSize);
+  out.header.append(header);
+  for (const auto& e : entries) {
+    if (!isSegmentSection(e.name)) {
+      out.header.append(e.data, e.size);
+    }
+  }
+  return out;
+}
+
+std::vector<size_t> wireSegmentSizes(const void* header, size_t header_size) {
+  const char* ptr = static_cast<const char*>(header);
+  std::vector<size_t> sizes;
+  for (const auto& headerEnt : parseWireHeader(ptr, ptr + header_size)) {
+    if (isSegmentSection(headerEnt.first)) {
+      sizes.push_back(headerEnt.second);
+    }
+  }
+  return sizes;
+}
+
+std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserializeSegments(
+    const void* header,
+    size_t header_size,
+    std::vector<at::DataPtr> segments) {
+  std::vector<std::string> segmentNames;
+  auto sections = parseWireSections(header, header_size, &segmentNames);
+  if (segmentNames.size() != segments.size()) {
+    throw std::runtime_error("failed segment count");
+  }
+  auto sectionReadFunc = [&](const std::string& ename) -> at::DataPtr {
+    // Small tensor sections are in the header; the others were received
+    // into the segments, which become their storages.
+    auto it = sections.find(ename);
+    if (it != sections.end()) {
+      return copySection(it->second);
+    }
+    auto segmentIt =
+        std::find(segmentNames.begin(), segmentNames.end(), ename);
+    if (segmentIt == segmentNames.end()) {
+      throw std::runtime_error("Couldn't find entity " + ename);
+    }
+    return std::move(segments[segmentIt - segmentNames.begin()]);
+  };
+  return wireDeserializeSections(sections, sectionReadFunc);
+}
+
 namespace {
 
 // The TensorPipe agent splits the RPC message's information across multiple
@@ -575,18 +703,6 @@ Message tensorpipeDeserialize(
     TensorpipeReadBuffers&& buffers) {
   // Tensors
   std::vector<at::Tensor> tensors;
-  const char* pickleData = buffers.pickle.data();
-  size_t pickleLen = buffers.pickle.size();
-  size_t picklePos = 0;
-  auto pickleReadFunc = [&](char* buf, size_t n) -> size_t {
-    if (picklePos >= pickleLen || n == 0) {
-      return 0;
-    }
-    size_t toCopy = std::min(picklePos + n, pickleLen) - picklePos;
-    memcpy(buf, pickleData + picklePos, toCopy);
-    picklePos += toCopy;
-    return toCopy;
-  };
   auto tensorReadFunc = [&](const std::string& ename) -> at::DataPtr {
     unsigned long index = std::stoul(ename);
     return std::move(buffers.tensors.at(index));
@@ -595,7 +711,12 @@ Message tensorpipeDeserialize(
   // No need to pass typeResolver here, as it always processes string and
   // tensors only
   torch::jit::Unpickler unpickler(
-      pickleReadFunc, nullptr, nullptr, tensorReadFunc, {});
+      buffers.pickle.data(),
+      buffers.pickle.size(),
+      nullptr,
+      nullptr,
+      tensorReadFunc,
+      {});
   auto ival = unpickler.parse_ivalue();
   for (auto&& t : ival.toTensorList()) {
     tensors.emplace_back(std::move(t));
@@ -49,6 +49,43 @@ TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>> wireDeserialize(
     const void* data,
     size_t data_size);
 
+// A message serialized for a transport that can send it as several buffers,
+// so that tensor data isn't copied into a contiguous buffer on either end.
+struct WireSegments {
+  // Same format as the output of wireSerialize(), except that the data of
+  // the tensor sections sent as segments is left out. Their sizes are still
+  // in the header.
+  std::string header;
+  // The data of the tensor sections sent as segments, in order, to be sent
+  // after the header. It points into the storages of the tensors below.
+  std::vector<std::pair<const char*, size_t>> segments;
+  // Keeps the storages alive.
+  std::vector<at::Tensor> tensors;
+};
+
+// Tensor sections smaller than this are copied into the header rather than
+// sent as segments of their own, since a separate send costs more than the
+// copy.
+constexpr size_t kWireSegmentInlineThreshold = 64 * 1024;
+
+TORCH_API WireSegments wireSerializeSegments(
+    const std::vector<char>& payload,
+    const std::vector<at::Tensor>& tensors,
+    size_t inlineThreshold = kWireSegmentInlineThreshold);
+
+// Returns the sizes of the segments that follow the header, so that the
+// receiver can allocate them before receiving them.
+TORCH_API std::vector<size_t> wireSegmentSizes(
+    const void* header,
+    size_t header_size);
+
+// The deserialized tensors use the segments as their storages.
+TORCH_API std::pair<std::vector<char>, std::vector<at::Tensor>>
+wireDeserializeSegments(
+    const void* header,
+    size_t header_size,
+    std::vector<at::DataPtr> segments);
+
 // We use vector<char> as the type of blobs because it's what rpc::Message uses
 // for its payload, even though it has the disadvantage that it cannot be
 // allocated with uninitialized memory: it is always zeroed out.
@@ -192,20 +192,6 @@ c10::IValue BytecodeDeserializer::readArchive(
   size_t pickle_size;
   std::tie(pickle_ptr, pickle_size) = reader_->getRecord(picklename.str());
 
-  size_t bytes_read = 0;
-  auto data = reinterpret_cast<const char*>(pickle_ptr.get());
-  auto reader = [&](char* buffer, size_t len) -> size_t {
-    if (bytes_read >= pickle_size) {
-      return 0;
-    }
-    len = std::min(pickle_size - bytes_read, len);
-    // Copy len bytes into buffer
-    const char* start = data + bytes_read;
-    std::memcpy(buffer, start, len);
-    bytes_read += len;
-    return len;
-  };
-
   static const c10::QualifiedName torchPrefix = "__torch__";
   auto type_resolver = [&](const c10::QualifiedName& qn) {
     TypePtr type;
@@ -268,7 +254,8 @@ c10::IValue BytecodeDeserializer::readArchive(
   };
 
   Unpickler unpickler(
-      reader,
+      reinterpret_cast<const char*>(pickle_ptr.get()),
+      pickle_size,
       std::move(type_resolver),
       std::move(obj_loader),
       std::move(read_record),
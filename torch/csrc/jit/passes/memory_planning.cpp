@@ -0,0 +1,269 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <torch/csrc/jit/ir/alias_analysis.h>
+#include <torch/csrc/jit/jit_log.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Index of the first and last node (inclusive) of the top-level block during
+// which a value has to stay in memory.
+struct LiveRange {
+  size_t begin;
+  size_t end;
+
+  bool overlaps(const LiveRange& other) const {
+    return begin <= other.end && other.begin <= end;
+  }
+};
+
+size_t alignUp(size_t n) {
+  return (n + kMemoryPlanAlignment - 1) / kMemoryPlanAlignment *
+      kMemoryPlanAlignment;
+}
+
+// Disjoint sets of values, each of which tracks the last use of any of its
+// members.
+class AliasSets {
+ public:
+  explicit AliasSets(const std::unordered_map<const Value*, size_t>& last_use)
+      : last_use_(last_use) {
+    for (const auto& p : last_use) {
+      parent_[p.first] = p.first;
+    }
+  }
+
+  const Value* find(const Value* value) {
+    const Value* root = value;
+    while (parent_.at(root) != root) {
+      root = parent_.at(root);
+    }
+    while (parent_.at(value) != root) {
+      const Value* next = parent_.at(value);
+      parent_[value] = root;
+      value = next;
+    }
+    return root;
+  }
+
+  void unite(const Value* a, const Value* b) {
+    a = find(a);
+    b = find(b);
+    if (a != b) {
+      parent_[b] = a;
+      last_use_[a] = std::max(last_use_.at(a), last_use_.at(b));
+    }
+  }
+
+  size_t lastUse(const Value* value) {
+    return last_use_.at(find(value));
+  }
+
+ private:
+  std::unordered_map<const Value*, const Value*> parent_;
+  std::unordered_map<const Value*, size_t> last_use_;
+};
+
+// Outputs of these operators have sizes that depend on the values of their
+// inputs rather than only on their sizes, so they can't be written into
+// buffers planned from the sizes of a previous run.
+bool hasDataDependentOutputSize(const Node* node) {
+  return node->kind() == aten::nonzero || node->kind() == aten::masked_select;
+}
+
+} // namespace
+
+const Operator* findOutVariant(const Node* node) {
+  const FunctionSchema* schema = node->maybeSchema();
+  if (!schema || hasDataDependentOutputSize(node) || schema->returns().size() != 1 ||
+      schema->returns()[0].alias_info() ||
+      !schema->returns()[0].type()->isSubtypeOf(TensorType::get())) {
+    return nullptr;
+  }
+  const auto& args = schema->arguments();
+  for (const auto& arg : args) {
+    if (arg.alias_info() && arg.alias_info()->isWrite()) {
+      return nullptr;
+    }
+  }
+
+  for (const auto& op : getAllOperatorsFor(node->kind())) {
+    const FunctionSchema& out_schema = op->schema();
+    const auto& out_args = out_schema.arguments();
+    if (out_schema.overload_name() != "out" ||
+        out_args.size() != args.size() + 1 ||
+        out_schema.returns().size() != 1) {
+      continue;
+    }
+    const Argument& out = out_args.back();
+    if (out.name() != "out" || !out.alias_info() ||
+        !out.alias_info()->isWrite()) {
+      continue;
+    }
+    bool same_args = true;
+    for (size_t i = 0; i < args.size() && same_args; i++) {
+      same_args = out_args[i].name() == args[i].name() &&
+          *out_args[i].type() == *args[i].type();
+    }
+    if (same_args) {
+      return op.get();
+    }
+  }
+  return nullptr;
+}
+
+MemoryPlan planMemory(
+    const std::shared_ptr<Graph>& graph,
+    const std::unordered_map<const Value*, size_t>& sizes) {
+  AliasDb alias_db(graph);
+
+  // Number the top-level nodes and find the last use of every value defined
+  // in the top-level block. Uses from nested blocks count as uses by the node
+  // that owns the block.
+  std::unordered_map<const Node*, size_t> node_index;
+  std::vector<Value*> values;
+  std::unordered_map<const Value*, size_t> last_use;
+  size_t index = 0;
+  for (Node* node : graph->nodes()) {
+    node_index[node] = index++;
+    for (Value* output : node->outputs()) {
+      values.push_back(output);
+      last_use[output] = node_index[node];
+    }
+  }
+  for (Value* input : graph->inputs()) {
+    values.push_back(input);
+    last_use[input] = 0;
+  }
+  for (Value* value : values) {
+    for (const Use& use : value->uses()) {
+      Node* user = use.user;
+      while (user->owningBlock() != graph->block()) {
+        user = user->owningBlock()->owningNode();
+      }
+      if (user == graph->return_node()) {
+        last_use[value] = index;
+      } else {
+        last_use[value] = std::max(last_use[value], node_index.at(user));
+      }
+    }
+  }
+
+  // Anything that may alias or contain a value (a view of it, a list it was
+  // put in, ...) keeps it alive as well. Memory only flows between values
+  // through the nodes that use them, so group the values that may alias
+  // each other at some node, which over-approximates the aliasing pairs
+  // with a number of alias queries linear in the size of the graph.
+  AliasSets alias_sets(last_use);
+  for (Node* node : graph->nodes()) {
+    // Outputs go first, so that the inputs a result may contain (like the
+    // elements of a list) are grouped through it without querying every
+    // pair of inputs.
+    std::vector<Value*> node_values(
+        node->outputs().begin(), node->outputs().end());
+    node_values.insert(
+        node_values.end(), node->inputs().begin(), node->inputs().end());
+    // Values of the top-level block used in nested blocks act as inputs of
+    // the node that owns the blocks.
+    std::function<void(Block*)> addBlockUses = [&](Block* block) {
+      for (Node* inner : block->nodes()) {
+        for (Value* input : inner->inputs()) {
+          if (last_use.count(input)) {
+            node_values.push_back(input);
+          }
+        }
+        for (Block* nested : inner->blocks()) {
+          addBlockUses(nested);
+        }
+      }
+      for (Value* output : block->outputs()) {
+        if (last_use.count(output)) {
+          node_values.push_back(output);
+        }
+      }
+    };
+    for (Block* block : node->blocks()) {
+      addBlockUses(block);
+    }
+    for (size_t i = 0; i < node_values.size(); i++) {
+      for (size_t j = i + 1; j < node_values.size(); j++) {
+        if (alias_sets.find(node_values[i]) !=
+                alias_sets.find(node_values[j]) &&
+            alias_db.mayContainAlias(node_values[i], node_values[j])) {
+          alias_sets.unite(node_values[i], node_values[j]);
+        }
+      }
+    }
+  }
+
+  // Collect the values to plan, in decreasing order of size.
+  std::vector<std::pair<Value*, LiveRange>> planned;
+  for (Value* value : values) {
+    auto size_it = sizes.find(value);
+    if (size_it == sizes.end() || value->node()->kind() == prim::Param ||
+        value->node()->owningBlock() != graph->block() ||
+        alias_db.mayContainAlias(value, graph->outputs())) {
+      continue;
+    }
+    LiveRange range{node_index.at(value->node()), alias_sets.lastUse(value)};
+    planned.emplace_back(value, range);
+  }
+  std::stable_sort(
+      planned.begin(),
+      planned.end(),
+      [&](const std::pair<Value*, LiveRange>& a,
+          const std::pair<Value*, LiveRange>& b) {
+        return sizes.at(a.first) > sizes.at(b.first);
+      });
+
+  // Greedily place each value at the lowest offset where it does not overlap
+  // a value that is already placed and alive at the same time.
+  MemoryPlan plan;
+  std::vector<std::pair<LiveRange, MemoryRegion>> placed;
+  for (const auto& entry : planned) {
+    const LiveRange& range = entry.second;
+    size_t size = alignUp(sizes.at(entry.first));
+
+    std::vector<MemoryRegion> conflicts;
+    for (const auto& p : placed) {
+      if (p.first.overlaps(range)) {
+        conflicts.push_back(p.second);
+      }
+    }
+    std::sort(
+        conflicts.begin(),
+        conflicts.end(),
+        [](const MemoryRegion& a, const MemoryRegion& b) {
+          return a.offset < b.offset;
+        });
+
+    size_t offset = 0;
+    for (const MemoryRegion& region : conflicts) {
+      if (offset + size <= region.offset) {
+        break;
+      }
+      offset = std::max(offset, region.offset + region.size);
+    }
+
+    MemoryRegion region{offset, size};
+    placed.emplace_back(range, region);
+    plan.regions[entry.first] = region;
+    plan.arena_size = std::max(plan.arena_size, offset + size);
+  }
+
+  GRAPH_DEBUG(
+      "Planned ",
+      plan.regions.size(),
+      " values into an arena of ",
+      plan.arena_size,
+      " bytes");
+  return plan;
+}
+
+} // namespace jit
+} // namespace torch
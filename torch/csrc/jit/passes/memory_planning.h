@@ -0,0 +1,47 @@
+#pragma once
+
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/runtime/operator.h>
+
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+
+// Where a value lives in a planned arena, in bytes.
+struct MemoryRegion {
+  size_t offset;
+  size_t size;
+};
+
+struct MemoryPlan {
+  // Total number of bytes the arena needs.
+  size_t arena_size = 0;
+  std::unordered_map<const Value*, MemoryRegion> regions;
+};
+
+// Offsets in a planned arena are multiples of this many bytes.
+constexpr size_t kMemoryPlanAlignment = 64;
+
+// Returns the out= overload of the operator called by `node` (e.g.
+// aten::add.out for aten::add.Tensor), or nullptr if there is none. Only
+// operators with a single, non-aliasing result are considered, and the out=
+// overload has to take exactly the node's arguments followed by `out`.
+// Operators whose result sizes depend on the data (aten::nonzero,
+// aten::masked_select) are left out, since their results can't be planned.
+TORCH_API const Operator* findOutVariant(const Node* node);
+
+// Assigns the tensors in `sizes` (mapping a value to the number of bytes it
+// needs) offsets in a single arena, such that two values share memory only if
+// their lifetimes do not overlap.
+//
+// `graph` must be straight-line code. A value's lifetime runs from the node
+// that produces it to the last use of it or of anything that may alias or
+// contain it. Values that are not produced by a node in the top-level block,
+// or that may be returned from the graph, are left out of the plan.
+TORCH_API MemoryPlan planMemory(
+    const std::shared_ptr<Graph>& graph,
+    const std::unordered_map<const Value*, size_t>& sizes);
+
+} // namespace jit
+} // namespace torch
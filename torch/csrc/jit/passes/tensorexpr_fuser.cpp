@@ -14,6 +14,51 @@ namespace torch {
 namespace jit {
 
 namespace tensorexpr {
+
+// Reductions (and softmax, which is built from them) are only lowered for
+// float tensors on CPU, and every argument other than the input has to be a
+// constant: the reduced dimensions determine the loop structure, and only the
+// default result dtype is supported.
+static bool isSupportedReduction(Node* node) {
+  auto const& inputs = node->inputs();
+  auto tt = inputs[0]->type()->cast<TensorType>();
+  if (!tt || tt->scalarType() != at::kFloat || !tt->device() ||
+      !tt->device()->is_cpu()) {
+    return false;
+  }
+  std::vector<c10::optional<IValue>> args;
+  for (size_t i = 1; i < inputs.size(); i++) {
+    args.push_back(toIValue(inputs[i]));
+    if (!args.back()) {
+      return false;
+    }
+  }
+
+  switch (node->kind()) {
+    case aten::sum:
+    case aten::mean:
+      // sum(self, dtype) or sum(self, dim, keepdim, dtype)
+      if (args.size() == 1) {
+        return args[0]->isNone();
+      }
+      return args.size() == 3 && args[0]->isIntList() && args[1]->isBool() &&
+          args[2]->isNone();
+    case aten::max:
+      // max(self) or max(self, dim, keepdim) with unused indices
+      if (args.empty()) {
+        return true;
+      }
+      return args.size() == 2 && args[0]->isInt() && args[1]->isBool() &&
+          !node->output(1)->hasUses();
+    case aten::softmax:
+    case aten::log_softmax:
+      // softmax(self, dim, dtype)
+      return args.size() == 2 && args[0]->isInt() && args[1]->isNone();
+    default:
+      return false;
+  }
+}
+
 bool isSupported(Node* node) {
   // TODO:
   switch (node->kind()) {
@@ -82,11 +127,16 @@ bool isSupported(Node* node) {
     case aten::__rshift__:
     case aten::where:
       return true;
+    case aten::sum:
+    case aten::mean:
+    case aten::softmax:
+    case aten::log_softmax:
+      return isSupportedReduction(node);
     // Operators that can be both elementwise or reductions:
     case aten::min:
     case aten::max:
       if (node->inputs().size() != 2) {
-        return false;
+        return node->kind() == aten::max && isSupportedReduction(node);
       }
       if (!node->inputs()[0]->type()->cast<TensorType>() ||
           !node->inputs()[1]->type()->cast<TensorType>()) {
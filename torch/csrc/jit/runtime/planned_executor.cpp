@@ -0,0 +1,376 @@
+#include <torch/csrc/jit/runtime/planned_executor.h>
+
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/jit_log.h>
+#include <torch/csrc/jit/runtime/vararg_functions.h>
+
+#include <algorithm>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Container construction is implemented by the interpreter rather than by
+// registered operators, so wrap the same helpers here.
+Operation operationFor(Node* node) {
+  size_t num_inputs = node->inputs().size();
+  switch (node->kind()) {
+    case prim::ListConstruct: {
+      auto type = node->output()->type()->expect<ListType>();
+      return [type, num_inputs](Stack& stack) {
+        listConstruct(stack, type, num_inputs);
+        return 0;
+      };
+    }
+    case prim::DictConstruct: {
+      auto type = node->output()->type()->expect<DictType>();
+      return [type, num_inputs](Stack& stack) {
+        dictConstruct(stack, type, num_inputs);
+        return 0;
+      };
+    }
+    case prim::TupleConstruct: {
+      auto type = node->output()->type()->expect<TupleType>();
+      if (type->name()) {
+        return [type, num_inputs](Stack& stack) {
+          namedTupleConstruct(stack, type, num_inputs);
+          return 0;
+        };
+      }
+      return [num_inputs](Stack& stack) {
+        tupleConstruct(stack, num_inputs);
+        return 0;
+      };
+    }
+    case prim::ListUnpack: {
+      size_t num_outputs = node->outputs().size();
+      return [num_outputs](Stack& stack) {
+        listUnpack(stack, num_outputs);
+        return 0;
+      };
+    }
+    default:
+      return node->getOperation();
+  }
+}
+
+bool isComparable(const IValue& value) {
+  return value.isNone() || value.isInt() || value.isDouble() ||
+      value.isBool() || value.isString() || value.isIntList() ||
+      value.isDoubleList() || value.isBoolList() || value.isDevice();
+}
+
+template <typename Keys>
+bool allComparable(const Keys& keys) {
+  return std::all_of(keys.begin(), keys.end(), [](const auto& key) {
+    return key.comparable();
+  });
+}
+
+template <typename Keys>
+bool allMatch(const Keys& keys, at::ArrayRef<IValue> values) {
+  if (keys.size() != values.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (!keys[i].matches(values[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+} // namespace
+
+PlannedExecutor::TensorKey::TensorKey(const at::Tensor& tensor)
+    : defined(tensor.defined()) {
+  if (defined) {
+    sizes = tensor.sizes().vec();
+    layout = tensor.layout();
+    if (layout == at::kStrided) {
+      strides = tensor.strides().vec();
+    }
+    dtype = tensor.scalar_type();
+    device = tensor.device();
+  }
+}
+
+bool PlannedExecutor::TensorKey::matches(const at::Tensor& tensor) const {
+  if (!defined || !tensor.defined()) {
+    return defined == tensor.defined();
+  }
+  return tensor.layout() == layout && tensor.sizes() == sizes &&
+      (layout != at::kStrided || tensor.strides() == strides) &&
+      tensor.scalar_type() == dtype && tensor.device() == device;
+}
+
+PlannedExecutor::ValueKey PlannedExecutor::ValueKey::of(const IValue& value) {
+  ValueKey key;
+  if (value.isTensor()) {
+    key.kind = Kind::Tensor;
+    key.tensors.emplace_back(value.toTensor());
+  } else if (value.isTensorList()) {
+    key.kind = Kind::TensorList;
+    for (const at::Tensor& tensor : value.toTensorVector()) {
+      key.tensors.emplace_back(tensor);
+    }
+  } else if (isComparable(value)) {
+    key.kind = Kind::Value;
+    // Lists can be modified in place, so keep a copy.
+    key.value = value.isList() ? value.deepcopy() : value;
+  }
+  return key;
+}
+
+bool PlannedExecutor::ValueKey::matches(const IValue& other) const {
+  switch (kind) {
+    case Kind::Tensor:
+      return other.isTensor() && tensors[0].matches(other.toTensor());
+    case Kind::TensorList: {
+      if (!other.isTensorList()) {
+        return false;
+      }
+      c10::List<at::Tensor> list = other.toTensorList();
+      if (list.size() != tensors.size()) {
+        return false;
+      }
+      for (size_t i = 0; i < tensors.size(); i++) {
+        if (!tensors[i].matches(list.get(i))) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case Kind::Value:
+      return !other.isTensor() && !other.isTensorList() && value == other;
+    case Kind::Other:
+      break;
+  }
+  return false;
+}
+
+PlannedExecutor::PlannedExecutor(std::shared_ptr<Graph> graph)
+    : graph_(std::move(graph)) {
+  std::unordered_map<const Value*, size_t> value_registers;
+  auto registerFor = [&](const Value* value) {
+    auto it = value_registers.find(value);
+    if (it == value_registers.end()) {
+      it = value_registers.emplace(value, registers_.size()).first;
+      registers_.emplace_back();
+    }
+    return it->second;
+  };
+
+  for (const Value* input : graph_->inputs()) {
+    input_registers_.push_back(registerFor(input));
+  }
+
+  // Registers that must outlive a single call (constants) are never freed.
+  std::vector<bool> persistent;
+  for (Node* node : graph_->nodes()) {
+    TORCH_CHECK(
+        node->blocks().empty(),
+        "PlannedExecutor only runs graphs without control flow, found ",
+        node->kind().toQualString());
+    if (node->kind() == prim::Constant) {
+      auto value = toIValue(node->output());
+      TORCH_CHECK(value, "Unsupported constant ", *node);
+      registers_[registerFor(node->output())] = *value;
+      persistent.resize(registers_.size(), false);
+      persistent[value_registers.at(node->output())] = true;
+      continue;
+    }
+
+    Step step;
+    step.node = node;
+    step.op = operationFor(node);
+    for (const Value* input : node->inputs()) {
+      step.inputs.push_back(value_registers.at(input));
+    }
+    for (const Value* output : node->outputs()) {
+      step.outputs.push_back(registerFor(output));
+    }
+    if (findOutVariant(node)) {
+      candidates_.emplace(node->output(), step.outputs[0]);
+    }
+    steps_.push_back(std::move(step));
+  }
+  persistent.resize(registers_.size(), false);
+
+  for (const Value* output : graph_->outputs()) {
+    size_t reg = value_registers.at(output);
+    output_registers_.push_back(reg);
+    if (!persistent[reg]) {
+      output_frees_.push_back(reg);
+      persistent[reg] = true;
+    }
+  }
+
+  // Free every register after the last step that reads it, or right after
+  // it is written if nothing reads it.
+  std::vector<size_t> last_step(registers_.size(), 0);
+  for (size_t i = 0; i < steps_.size(); i++) {
+    for (size_t reg : steps_[i].outputs) {
+      last_step[reg] = i;
+    }
+    for (size_t reg : steps_[i].inputs) {
+      last_step[reg] = i;
+    }
+  }
+  for (size_t reg = 0; reg < registers_.size(); reg++) {
+    if (!persistent[reg] && !steps_.empty()) {
+      steps_[last_step[reg]].frees.push_back(reg);
+    }
+  }
+}
+
+void PlannedExecutor::run(Stack& stack) {
+  // This is an inference runtime, and out= variants do not support autograd.
+  at::NoGradGuard no_grad;
+
+  auto inputs = last(stack, input_registers_.size());
+  if (planned_ && allMatch(planned_inputs_, inputs)) {
+    execute(stack, /*profile=*/false);
+    return;
+  }
+
+  clearPlan();
+  planned_inputs_.clear();
+  for (const IValue& input : inputs) {
+    planned_inputs_.push_back(ValueKey::of(input));
+  }
+  if (!allComparable(planned_inputs_)) {
+    // There is no telling whether a later call is like this one.
+    execute(stack, /*profile=*/false);
+    return;
+  }
+
+  GRAPH_DEBUG("Profiling intermediate sizes for ", *graph_);
+  execute(stack, /*profile=*/true);
+  plan();
+}
+
+void PlannedExecutor::clearPlan() {
+  for (Step& step : steps_) {
+    step.out_op = nullptr;
+    step.out.reset();
+    step.input_keys.clear();
+  }
+  arena_.reset();
+  planned_values_ = 0;
+  planned_ = false;
+}
+
+void PlannedExecutor::execute(Stack& stack, bool profile) {
+  size_t num_inputs = input_registers_.size();
+  for (size_t i = 0; i < num_inputs; i++) {
+    registers_[input_registers_[i]] =
+        std::move(stack[stack.size() - num_inputs + i]);
+  }
+  drop(stack, num_inputs);
+
+  Stack op_stack;
+  for (Step& step : steps_) {
+    for (size_t reg : step.inputs) {
+      op_stack.push_back(registers_[reg]);
+    }
+    bool candidate = profile && step.outputs.size() == 1 &&
+        candidates_.count(step.node->output()) > 0;
+    if (candidate) {
+      step.input_keys.clear();
+      for (const IValue& input : op_stack) {
+        step.input_keys.push_back(ValueKey::of(input));
+      }
+    }
+    bool planned = false;
+    if (step.out_op && allMatch(step.input_keys, op_stack)) {
+      op_stack.push_back(step.out);
+      step.out_op(op_stack);
+      planned = step.out.sizes() == step.out_key.sizes &&
+          step.out.strides() == step.out_key.strides;
+      if (!planned) {
+        // The op resized its result, so it doesn't only depend on the
+        // metadata of its inputs. Restore the planned buffer and run the op
+        // normally.
+        step.out = at::from_blob(
+            step.out.data_ptr(),
+            step.out_key.sizes,
+            step.out_key.strides,
+            step.out.options());
+        op_stack.clear();
+        for (size_t reg : step.inputs) {
+          op_stack.push_back(registers_[reg]);
+        }
+      }
+    }
+    if (!planned) {
+      step.op(op_stack);
+    }
+    size_t num_outputs = step.outputs.size();
+    for (size_t i = 0; i < num_outputs; i++) {
+      registers_[step.outputs[i]] =
+          std::move(op_stack[op_stack.size() - num_outputs + i]);
+    }
+    op_stack.clear();
+
+    if (candidate && allComparable(step.input_keys)) {
+      size_t reg = candidates_.at(step.node->output());
+      if (registers_[reg].isTensor()) {
+        profiled_[step.node->output()] = registers_[reg].toTensor();
+      }
+    }
+    for (size_t reg : step.frees) {
+      registers_[reg] = IValue();
+    }
+  }
+
+  for (size_t reg : output_registers_) {
+    stack.push_back(registers_[reg]);
+  }
+  for (size_t reg : output_frees_) {
+    registers_[reg] = IValue();
+  }
+}
+
+void PlannedExecutor::plan() {
+  std::unordered_map<const Value*, size_t> sizes;
+  for (const auto& p : profiled_) {
+    const at::Tensor& t = p.second;
+    if (!t.defined() || !t.device().is_cpu() || t.layout() != at::kStrided ||
+        t.is_quantized()) {
+      continue;
+    }
+    sizes[p.first] = at::detail::computeStorageNbytes(
+        t.sizes(), t.strides(), t.dtype().itemsize());
+  }
+  MemoryPlan memory_plan = planMemory(graph_, sizes);
+
+  if (memory_plan.arena_size > 0) {
+    arena_ = at::empty(
+        {static_cast<int64_t>(memory_plan.arena_size)},
+        at::TensorOptions(at::kByte));
+  }
+  uint8_t* base = arena_.defined() ? arena_.data_ptr<uint8_t>() : nullptr;
+  for (Step& step : steps_) {
+    if (step.node->outputs().size() != 1) {
+      continue;
+    }
+    auto it = memory_plan.regions.find(step.node->output());
+    if (it == memory_plan.regions.end()) {
+      continue;
+    }
+    const at::Tensor& t = profiled_.at(step.node->output());
+    step.out = at::from_blob(
+        base + it->second.offset, t.sizes(), t.strides(), t.options());
+    step.out_key = TensorKey(step.out);
+    step.out_op = findOutVariant(step.node)->getOperation(step.node);
+  }
+  planned_values_ = memory_plan.regions.size();
+  profiled_.clear();
+  planned_ = true;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <ATen/core/stack.h>
+#include <torch/csrc/jit/ir/ir.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+namespace torch {
+namespace jit {
+
+// Runs a straight-line graph for inference with fixed input shapes, writing
+// intermediate tensors into one preallocated arena instead of allocating a
+// fresh output for every op on every call.
+//
+// The first call runs every op normally and records the size of each
+// intermediate tensor. The intermediates that are produced by an op with an
+// out= variant (see findOutVariant) and are not returned from the graph are
+// then given offsets in a single arena by planMemory, and later calls run the
+// out= variants of their ops directly into those slots. A plan is made for
+// the sizes, strides, dtypes and devices of the tensor inputs and the values
+// of the other inputs, and a call with different ones profiles again and
+// replaces it. Graphs with inputs whose values can't be compared, like lists
+// of tensors, are run without a plan. Every op whose result is in the arena
+// also checks its own inputs against the profiled ones before it writes into
+// the arena, and allocates its result as usual if they differ or if the op
+// resized its planned result.
+//
+// The arena is reused across calls, so an instance must not be run from
+// several threads at the same time.
+class TORCH_API PlannedExecutor {
+ public:
+  explicit PlannedExecutor(std::shared_ptr<Graph> graph);
+
+  // Pops the graph inputs from `stack` and pushes its outputs.
+  void run(Stack& stack);
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  // Number of bytes in the arena, 0 until a plan has been made.
+  size_t arenaSize() const {
+    return arena_.defined() ? arena_.nbytes() : 0;
+  }
+
+  // Number of intermediate tensors written into the arena.
+  size_t numPlannedValues() const {
+    return planned_values_;
+  }
+
+ private:
+  // The metadata of a tensor that the results of ops depend on.
+  struct TensorKey {
+    explicit TensorKey(const at::Tensor& tensor);
+
+    bool matches(const at::Tensor& tensor) const;
+
+    bool defined;
+    std::vector<int64_t> sizes;
+    std::vector<int64_t> strides;
+    at::Layout layout = at::kStrided;
+    at::ScalarType dtype = at::ScalarType::Undefined;
+    at::Device device = at::kCPU;
+  };
+
+  // What the plan depends on in a value: the metadata of a tensor or of the
+  // elements of a list of tensors, or the value of anything else that can be
+  // compared with ==.
+  struct ValueKey {
+    enum class Kind { Tensor, TensorList, Value, Other };
+
+    static ValueKey of(const IValue& value);
+
+    bool matches(const IValue& value) const;
+
+    bool comparable() const {
+      return kind != Kind::Other;
+    }
+
+    Kind kind = Kind::Other;
+    std::vector<TensorKey> tensors;
+    IValue value;
+  };
+
+  struct Step {
+    Node* node;
+    Operation op;
+    // Set when the node's result is in the arena.
+    Operation out_op;
+    at::Tensor out;
+    // The node's inputs when it was profiled, which out_op is valid for.
+    std::vector<ValueKey> input_keys;
+    // The planned sizes and strides of `out`.
+    TensorKey out_key{at::Tensor()};
+    std::vector<size_t> inputs;
+    std::vector<size_t> outputs;
+    // Registers that are no longer needed once the node has run.
+    std::vector<size_t> frees;
+  };
+
+  void execute(Stack& stack, bool profile);
+  void plan();
+  void clearPlan();
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<Step> steps_;
+  std::vector<IValue> registers_;
+  std::vector<size_t> input_registers_;
+  std::vector<size_t> output_registers_;
+  // Output registers to clear once the outputs are pushed.
+  std::vector<size_t> output_frees_;
+  // Registers of the tensors the plan is made for, and their profiled values.
+  std::unordered_map<const Value*, size_t> candidates_;
+  std::unordered_map<const Value*, at::Tensor> profiled_;
+  std::vector<ValueKey> planned_inputs_;
+  at::Tensor arena_;
+  size_t planned_values_ = 0;
+  bool planned_ = false;
+};
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,475 @@
+#include <torch/csrc/jit/runtime/static_runtime.h>
+
+#include <ATen/ATen.h>
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/jit/ir/constants.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using ProcessedNode = StaticRuntime::ProcessedNode;
+using Kernel = ProcessedNode::Kernel;
+
+at::Tensor optionalTensor(const IValue& value) {
+  return value.isNone() ? at::Tensor() : value.toTensor();
+}
+
+// An int[] input of a node. Constant lists, which is what sizes, strides and
+// dims almost always are in a frozen graph, are converted only once.
+class IntListArg {
+ public:
+  IntListArg(const ProcessedNode& p, size_t index)
+      : index_(index),
+        constant_(p.node->input(index)->node()->kind() == prim::Constant) {
+    if (constant_) {
+      values_ = p.input(index).toIntVector();
+    }
+  }
+
+  at::IntArrayRef get(const ProcessedNode& p) {
+    if (!constant_) {
+      values_ = p.input(index_).toIntVector();
+    }
+    return values_;
+  }
+
+ private:
+  size_t index_;
+  bool constant_;
+  std::vector<int64_t> values_;
+};
+
+// Kernels that do not depend on the node they run, keyed by the qualified
+// operator name and overload of the schema they implement.
+const std::unordered_map<std::string, Kernel>& statelessKernels() {
+  static const std::unordered_map<std::string, Kernel> kernels = {
+      {"aten::add.Tensor",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::add(
+             p.input(0).toTensor(),
+             p.input(1).toTensor(),
+             p.input(2).toScalar());
+       }},
+      {"aten::mul.Tensor",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::mul(p.input(0).toTensor(), p.input(1).toTensor());
+       }},
+      {"aten::div.Tensor",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::div(p.input(0).toTensor(), p.input(1).toTensor());
+       }},
+      {"aten::relu",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::relu(p.input(0).toTensor());
+       }},
+      {"aten::sigmoid",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::sigmoid(p.input(0).toTensor());
+       }},
+      {"aten::tanh",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::tanh(p.input(0).toTensor());
+       }},
+      {"aten::gelu",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::gelu(p.input(0).toTensor());
+       }},
+      {"aten::batch_norm",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::batch_norm(
+             p.input(0).toTensor(),
+             optionalTensor(p.input(1)),
+             optionalTensor(p.input(2)),
+             optionalTensor(p.input(3)),
+             optionalTensor(p.input(4)),
+             p.input(5).toBool(),
+             p.input(6).toDouble(),
+             p.input(7).toDouble(),
+             p.input(8).toBool());
+       }},
+      {"aten::flatten.using_ints",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::flatten(
+             p.input(0).toTensor(), p.input(1).toInt(), p.input(2).toInt());
+       }},
+      {"aten::linear",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::linear(
+             p.input(0).toTensor(),
+             p.input(1).toTensor(),
+             optionalTensor(p.input(2)));
+       }},
+      {"aten::addmm",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::addmm(
+             p.input(0).toTensor(),
+             p.input(1).toTensor(),
+             p.input(2).toTensor(),
+             p.input(3).toScalar(),
+             p.input(4).toScalar());
+       }},
+      {"aten::matmul",
+       [](const ProcessedNode& p) {
+         p.output(0) =
+             at::matmul(p.input(0).toTensor(), p.input(1).toTensor());
+       }},
+      {"aten::mm",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::mm(p.input(0).toTensor(), p.input(1).toTensor());
+       }},
+      {"aten::bmm",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::bmm(p.input(0).toTensor(), p.input(1).toTensor());
+       }},
+      {"aten::softmax.int",
+       [](const ProcessedNode& p) {
+         const IValue& dtype = p.input(2);
+         p.output(0) = at::softmax(
+             p.input(0).toTensor(),
+             p.input(1).toInt(),
+             dtype.isNone() ? c10::optional<at::ScalarType>()
+                            : dtype.toScalarType());
+       }},
+      {"aten::transpose.int",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::transpose(
+             p.input(0).toTensor(), p.input(1).toInt(), p.input(2).toInt());
+       }},
+      {"aten::t",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::t(p.input(0).toTensor());
+       }},
+      {"aten::contiguous",
+       [](const ProcessedNode& p) {
+         p.output(0) =
+             p.input(0).toTensor().contiguous(p.input(1).toMemoryFormat());
+       }},
+      {"aten::dropout",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::dropout(
+             p.input(0).toTensor(), p.input(1).toDouble(), p.input(2).toBool());
+       }},
+      {"aten::embedding",
+       [](const ProcessedNode& p) {
+         p.output(0) = at::embedding(
+             p.input(0).toTensor(),
+             p.input(1).toTensor(),
+             p.input(2).toInt(),
+             p.input(3).toBool(),
+             p.input(4).toBool());
+       }},
+      {"aten::cat",
+       [](const ProcessedNode& p) {
+         p.output(0) =
+             at::cat(p.input(0).toTensorVector(), p.input(1).toInt());
+       }},
+  };
+  return kernels;
+}
+
+// Returns a kernel for nodes whose kernel needs per-node state, or nullptr.
+Kernel statefulKernel(const ProcessedNode& pn, const std::string& name) {
+  if (name == "aten::conv2d") {
+    IntListArg stride(pn, 3), padding(pn, 4), dilation(pn, 5);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = at::conv2d(
+          p.input(0).toTensor(),
+          p.input(1).toTensor(),
+          optionalTensor(p.input(2)),
+          stride.get(p),
+          padding.get(p),
+          dilation.get(p),
+          p.input(6).toInt());
+    };
+  }
+  if (name == "aten::max_pool2d") {
+    IntListArg kernel_size(pn, 1), stride(pn, 2), padding(pn, 3),
+        dilation(pn, 4);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = at::max_pool2d(
+          p.input(0).toTensor(),
+          kernel_size.get(p),
+          stride.get(p),
+          padding.get(p),
+          dilation.get(p),
+          p.input(5).toBool());
+    };
+  }
+  if (name == "aten::adaptive_avg_pool2d") {
+    IntListArg output_size(pn, 1);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) =
+          at::adaptive_avg_pool2d(p.input(0).toTensor(), output_size.get(p));
+    };
+  }
+  if (name == "aten::layer_norm") {
+    IntListArg normalized_shape(pn, 1);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = at::layer_norm(
+          p.input(0).toTensor(),
+          normalized_shape.get(p),
+          optionalTensor(p.input(2)),
+          optionalTensor(p.input(3)),
+          p.input(4).toDouble(),
+          p.input(5).toBool());
+    };
+  }
+  if (name == "aten::permute") {
+    IntListArg dims(pn, 1);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = p.input(0).toTensor().permute(dims.get(p));
+    };
+  }
+  if (name == "aten::view") {
+    IntListArg size(pn, 1);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = p.input(0).toTensor().view(size.get(p));
+    };
+  }
+  if (name == "aten::reshape") {
+    IntListArg shape(pn, 1);
+    return [=](const ProcessedNode& p) mutable {
+      p.output(0) = at::reshape(p.input(0).toTensor(), shape.get(p));
+    };
+  }
+  return nullptr;
+}
+
+// Container construction is implemented by the interpreter rather than by
+// registered operators, so it is always done natively.
+Kernel primKernel(const ProcessedNode& p) {
+  Node* node = p.node;
+  switch (node->kind()) {
+    case prim::ListConstruct: {
+      auto type = node->output()->type()->expect<ListType>();
+      return [type](const ProcessedNode& p) {
+        c10::List<IValue> list(type->getElementType());
+        list.reserve(p.inputs.size());
+        for (const IValue* input : p.inputs) {
+          list.push_back(*input);
+        }
+        p.output(0) = std::move(list);
+      };
+    }
+    case prim::TupleConstruct: {
+      auto type = node->output()->type()->expect<TupleType>();
+      return [type](const ProcessedNode& p) {
+        std::vector<IValue> elements;
+        elements.reserve(p.inputs.size());
+        for (const IValue* input : p.inputs) {
+          elements.push_back(*input);
+        }
+        p.output(0) = type->name()
+            ? c10::ivalue::Tuple::createNamed(std::move(elements), type)
+            : c10::ivalue::Tuple::create(std::move(elements));
+      };
+    }
+    case prim::ListUnpack:
+      return [](const ProcessedNode& p) {
+        c10::ArrayRef<IValue> elements = p.input(0).toListRef();
+        TORCH_CHECK(
+            elements.size() == p.outputs.size(),
+            "Expected ",
+            p.outputs.size(),
+            " elements in a list but found ",
+            elements.size());
+        for (size_t i = 0; i < elements.size(); i++) {
+          p.output(i) = elements[i];
+        }
+      };
+    case prim::TupleUnpack:
+      return [](const ProcessedNode& p) {
+        const auto& elements = p.input(0).toTuple()->elements();
+        TORCH_CHECK(
+            elements.size() == p.outputs.size(),
+            "Expected ",
+            p.outputs.size(),
+            " elements in a tuple but found ",
+            elements.size());
+        for (size_t i = 0; i < elements.size(); i++) {
+          p.output(i) = elements[i];
+        }
+      };
+    default:
+      return nullptr;
+  }
+}
+
+Kernel nativeKernel(const ProcessedNode& p) {
+  if (Kernel kernel = primKernel(p)) {
+    return kernel;
+  }
+  const FunctionSchema* schema = p.node->maybeSchema();
+  if (!schema) {
+    return nullptr;
+  }
+  std::string name = schema->name();
+  if (!schema->overload_name().empty()) {
+    name += "." + schema->overload_name();
+  }
+  const auto& kernels = statelessKernels();
+  auto it = kernels.find(name);
+  if (it != kernels.end()) {
+    return it->second;
+  }
+  return statefulKernel(p, name);
+}
+
+std::shared_ptr<Graph> frozenForwardGraph(const Module& module) {
+  Module frozen = freeze_module(module);
+  auto graph = frozen.get_method("forward").graph()->copy();
+  TORCH_CHECK(
+      !graph->inputs().empty() && !graph->inputs()[0]->hasUses(),
+      "StaticRuntime requires the forward method of the frozen module to "
+      "not access module attributes");
+  graph->eraseInput(0);
+  return graph;
+}
+
+} // namespace
+
+StaticRuntime::StaticRuntime(std::shared_ptr<Graph> graph)
+    : graph_(std::move(graph)) {
+  init();
+}
+
+StaticRuntime::StaticRuntime(const Module& module)
+    : graph_(frozenForwardGraph(module)) {
+  init();
+}
+
+void StaticRuntime::init() {
+  for (const Value* input : graph_->inputs()) {
+    TORCH_CHECK(
+        !input->type()->cast<ClassType>(),
+        "StaticRuntime cannot run graphs that take objects as inputs, "
+        "freeze the module first");
+  }
+
+  // Give every value a slot. The slots are allocated once, up front, so that
+  // nodes can hold on to pointers to them.
+  std::unordered_map<const Value*, size_t> value_slots;
+  auto addSlot = [&](const Value* value) {
+    value_slots.emplace(value, value_slots.size());
+  };
+  for (const Value* input : graph_->inputs()) {
+    addSlot(input);
+  }
+  for (Node* node : graph_->nodes()) {
+    TORCH_CHECK(
+        node->blocks().empty(),
+        "StaticRuntime only runs graphs without control flow, found ",
+        node->kind().toQualString());
+    for (const Value* output : node->outputs()) {
+      addSlot(output);
+    }
+  }
+  slots_.resize(value_slots.size());
+  auto slotFor = [&](const Value* value) {
+    return &slots_[value_slots.at(value)];
+  };
+
+  for (const Value* input : graph_->inputs()) {
+    input_slots_.push_back(value_slots.at(input));
+    temporary_slots_.push_back(value_slots.at(input));
+  }
+  for (Node* node : graph_->nodes()) {
+    if (node->kind() == prim::Constant) {
+      auto value = toIValue(node->output());
+      TORCH_CHECK(value, "Unsupported constant ", *node);
+      *slotFor(node->output()) = std::move(*value);
+      continue;
+    }
+
+    ProcessedNode p;
+    p.node = node;
+    for (const Value* input : node->inputs()) {
+      p.inputs.push_back(slotFor(input));
+    }
+    for (const Value* output : node->outputs()) {
+      p.outputs.push_back(slotFor(output));
+      temporary_slots_.push_back(value_slots.at(output));
+    }
+    p.kernel = nativeKernel(p);
+    if (!p.kernel) {
+      p.fallback = node->getOperation();
+    }
+    nodes_.push_back(std::move(p));
+  }
+  for (const Value* output : graph_->outputs()) {
+    output_slots_.push_back(value_slots.at(output));
+  }
+}
+
+void StaticRuntime::runNodes() {
+  for (const ProcessedNode& p : nodes_) {
+    if (p.kernel) {
+      p.kernel(p);
+      continue;
+    }
+    for (const IValue* input : p.inputs) {
+      fallback_stack_.push_back(*input);
+    }
+    p.fallback(fallback_stack_);
+    size_t num_outputs = p.outputs.size();
+    for (size_t i = 0; i < num_outputs; i++) {
+      p.output(i) =
+          std::move(fallback_stack_[fallback_stack_.size() - num_outputs + i]);
+    }
+    fallback_stack_.clear();
+  }
+}
+
+std::vector<IValue> StaticRuntime::run(const std::vector<IValue>& inputs) {
+  TORCH_CHECK(
+      inputs.size() == input_slots_.size(),
+      "Expected ",
+      input_slots_.size(),
+      " inputs but got ",
+      inputs.size());
+  // This is an inference runtime.
+  at::NoGradGuard no_grad;
+
+  for (size_t i = 0; i < inputs.size(); i++) {
+    slots_[input_slots_[i]] = inputs[i];
+  }
+  runNodes();
+
+  std::vector<IValue> outputs;
+  outputs.reserve(output_slots_.size());
+  for (size_t slot : output_slots_) {
+    outputs.push_back(slots_[slot]);
+  }
+  for (size_t slot : temporary_slots_) {
+    slots_[slot] = IValue();
+  }
+  return outputs;
+}
+
+std::vector<at::Tensor> StaticRuntime::run(
+    const std::vector<at::Tensor>& inputs) {
+  std::vector<IValue> outputs =
+      run(std::vector<IValue>(inputs.begin(), inputs.end()));
+  std::vector<at::Tensor> tensors;
+  tensors.reserve(outputs.size());
+  for (IValue& output : outputs) {
+    tensors.push_back(std::move(output).toTensor());
+  }
+  return tensors;
+}
+
+size_t StaticRuntime::numFallbackNodes() const {
+  size_t count = 0;
+  for (const ProcessedNode& p : nodes_) {
+    if (!p.kernel) {
+      count++;
+    }
+  }
+  return count;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <ATen/core/ivalue.h>
+#include <ATen/core/stack.h>
+#include <torch/csrc/jit/api/module.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Runs straight-line inference graphs, such as the forward method of a frozen
+// module, with as little per-op overhead as possible.
+//
+// Unlike the interpreter, every value of the graph gets a fixed slot in a flat
+// array when the runtime is created, constants are materialized once, and
+// each node is bound to its kernel up front. Running a node reads its inputs
+// from and writes its outputs to those slots directly. Common ATen operators
+// call into ATen without going through a Stack; everything else falls back
+// to the operator's registered Operation.
+//
+// Graphs are run with gradient recording disabled, and graphs with control
+// flow are not supported. Slots are reused across calls, so an instance must
+// not be run from several threads at the same time.
+class TORCH_API StaticRuntime {
+ public:
+  // `graph` is run as is and must not take a module as input.
+  explicit StaticRuntime(std::shared_ptr<Graph> graph);
+
+  // Freezes `module`, which must be in eval mode, and runs its forward
+  // method.
+  explicit StaticRuntime(const Module& module);
+
+  StaticRuntime(const StaticRuntime&) = delete;
+  StaticRuntime& operator=(const StaticRuntime&) = delete;
+
+  // Runs the graph on `inputs` and returns its outputs.
+  std::vector<IValue> run(const std::vector<IValue>& inputs);
+
+  // Same as above for graphs that take and return tensors only.
+  std::vector<at::Tensor> run(const std::vector<at::Tensor>& inputs);
+
+  const std::shared_ptr<Graph>& graph() const {
+    return graph_;
+  }
+
+  // Number of nodes that are run through their registered Operation because
+  // there is no native kernel for them.
+  size_t numFallbackNodes() const;
+
+  // A node bound to the slots of its inputs and outputs. Slots are allocated
+  // once, so the pointers stay valid for the lifetime of the runtime.
+  struct ProcessedNode {
+    using Kernel = std::function<void(const ProcessedNode&)>;
+
+    const IValue& input(size_t i) const {
+      return *inputs[i];
+    }
+    IValue& output(size_t i) const {
+      return *outputs[i];
+    }
+
+    Node* node;
+    std::vector<IValue*> inputs;
+    std::vector<IValue*> outputs;
+    Kernel kernel;
+    // Set instead of `kernel` for nodes without a native kernel.
+    Operation fallback;
+  };
+
+ private:
+  void init();
+  void runNodes();
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<ProcessedNode> nodes_;
+  std::vector<IValue> slots_;
+  std::vector<size_t> input_slots_;
+  std::vector<size_t> output_slots_;
+  // Slots that hold intermediate values, cleared after every call so that
+  // tensors are not kept alive between calls.
+  std::vector<size_t> temporary_slots_;
+  Stack fallback_stack_;
+};
+
+} // namespace jit
+} // namespace torch
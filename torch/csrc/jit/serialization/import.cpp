@@ -16,11 +16,15 @@
 #include <caffe2/serialize/file_adapter.h>
 #include <caffe2/serialize/inline_container.h>
 #include <caffe2/serialize/istream_adapter.h>
+#include <caffe2/serialize/mmap_adapter.h>
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 #include <fmt/format.h>
 
+#include <condition_variable>
 #include <fstream>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -30,6 +34,7 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
@@ -55,6 +60,141 @@ void postSetStateValidate(const IValue& v) {
   }
 }
 
+namespace {
+
+// Reads the tensor records of an archive on the inter-op thread pool, while
+// the unpickler parses the object graph that refers to them. A record that
+// the unpickler asks for before any worker got to it is read by the
+// unpickler's thread, so loading makes progress even if the pool is busy,
+// and workers that only start after loading has finished do nothing.
+class RecordPrefetcher {
+ public:
+  RecordPrefetcher(
+      PyTorchStreamReader& stream_reader,
+      std::vector<std::string> names)
+      : state_(std::make_shared<State>()) {
+    state_->stream_reader = &stream_reader;
+    for (const auto& name : names) {
+      state_->records[name];
+    }
+    state_->names = std::move(names);
+    const size_t num_workers = std::min<size_t>(
+        state_->names.size(), std::max(at::get_num_interop_threads(), 1));
+    for (size_t i = 0; i < num_workers; i++) {
+      at::launch([state = state_] { work(state); });
+    }
+  }
+
+  ~RecordPrefetcher() {
+    // The stream reader must outlive the reads in progress.
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->stopped = true;
+    state_->cv.wait(lock, [this] { return state_->active == 0; });
+  }
+
+  at::DataPtr get(const std::string& name) {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    auto it = state_->records.find(name);
+    if (it == state_->records.end()) {
+      lock.unlock();
+      return std::get<0>(state_->stream_reader->getRecord(name));
+    }
+    auto& record = it->second;
+    if (record.status == Status::kPending) {
+      // No worker got to it yet.
+      state_->records.erase(it);
+      lock.unlock();
+      return std::get<0>(state_->stream_reader->getRecord(name));
+    }
+    state_->cv.wait(lock, [&] { return record.status == Status::kDone; });
+    auto data = std::move(record.data);
+    auto error = record.error;
+    state_->records.erase(it);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return data;
+  }
+
+ private:
+  enum class Status { kPending, kReading, kDone };
+
+  struct Record {
+    Status status = Status::kPending;
+    at::DataPtr data;
+    std::exception_ptr error;
+  };
+
+  struct State {
+    PyTorchStreamReader* stream_reader;
+    std::vector<std::string> names;
+    std::mutex mutex;
+    std::condition_variable cv;
+    // Records are removed once they are handed out.
+    std::unordered_map<std::string, Record> records;
+    size_t next = 0;
+    // Number of workers that are reading a record.
+    size_t active = 0;
+    bool stopped = false;
+  };
+
+  static void work(const std::shared_ptr<State>& state) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    while (!state->stopped && state->next < state->names.size()) {
+      const auto& name = state->names[state->next++];
+      auto it = state->records.find(name);
+      if (it == state->records.end()) {
+        continue;
+      }
+      auto& record = it->second;
+      record.status = Status::kReading;
+      state->active++;
+      lock.unlock();
+      at::DataPtr data;
+      std::exception_ptr error;
+      try {
+        data = std::get<0>(state->stream_reader->getRecord(name));
+      } catch (...) {
+        error = std::current_exception();
+      }
+      lock.lock();
+      record.data = std::move(data);
+      record.error = error;
+      record.status = Status::kDone;
+      state->active--;
+      state->cv.notify_all();
+    }
+  }
+
+  std::shared_ptr<State> state_;
+};
+
+// Returns the names of the records in the given archive, relative to the
+// root of the zip file.
+std::vector<std::string> getArchiveRecords(
+    PyTorchStreamReader& stream_reader,
+    const std::string& archive_name_plus_slash) {
+  std::vector<std::string> names;
+  for (const auto& record : stream_reader.getAllRecords()) {
+    // Drop the name of the zip file's root folder.
+    auto pos = record.find('/');
+    if (pos == std::string::npos) {
+      continue;
+    }
+    auto name = record.substr(pos + 1);
+    if (name.compare(
+            0,
+            archive_name_plus_slash.size(),
+            archive_name_plus_slash) == 0 &&
+        name.size() > archive_name_plus_slash.size()) {
+      names.push_back(std::move(name));
+    }
+  }
+  return names;
+}
+
+} // namespace
+
 IValue readArchiveAndTensors(
     const std::string& archive_name,
     c10::optional<TypeResolver> type_resolver,
@@ -66,28 +206,17 @@ IValue readArchiveAndTensors(
   size_t pickle_size;
   std::tie(pickle_ptr, pickle_size) = stream_reader.getRecord(picklename);
 
-  size_t bytes_read = 0;
-  auto data = reinterpret_cast<const char*>(pickle_ptr.get());
-  auto reader = [&](char* buffer, size_t len) -> size_t {
-    if (bytes_read >= pickle_size) {
-      return 0;
-    }
-    len = std::min(pickle_size - bytes_read, len);
-    // Copy len bytes into buffer
-    const char* start = data + bytes_read;
-    std::memcpy(buffer, start, len);
-    bytes_read += len;
-    return len;
-  };
-
   std::string archive_name_plus_slash = archive_name + "/";
+  RecordPrefetcher prefetcher(
+      stream_reader,
+      getArchiveRecords(stream_reader, archive_name_plus_slash));
   auto read_record = [&](const std::string& name) {
-    std::string ss = archive_name_plus_slash + name;
-    return std::get<0>(stream_reader.getRecord(ss));
+    return prefetcher.get(archive_name_plus_slash + name);
   };
 
   Unpickler unpickler(
-      reader,
+      reinterpret_cast<const char*>(pickle_ptr.get()),
+      pickle_size,
       type_resolver ? std::move(*type_resolver) : nullptr,
       obj_loader ? std::move(*obj_loader) : nullptr,
       std::move(read_record),
@@ -321,6 +450,17 @@ Module load(
   return module;
 }
 
+Module load_mmap(
+    const std::string& filename,
+    c10::optional<at::Device> device,
+    ExtraFilesMap& extra_files,
+    MmapAdapter::Mode mode) {
+  std::unique_ptr<MmapAdapter> rai =
+      std::make_unique<MmapAdapter>(filename, mode);
+  auto module = load(std::move(rai), device, extra_files);
+  return module;
+}
+
 Module load(
     std::unique_ptr<ReadAdapterInterface> rai,
     c10::optional<c10::Device> device,
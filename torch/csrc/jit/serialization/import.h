@@ -1,6 +1,7 @@
 #pragma once
 
 #include <caffe2/serialize/inline_container.h>
+#include <caffe2/serialize/mmap_adapter.h>
 #include <torch/csrc/jit/api/module.h>
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/serialization/unpickler.h>
@@ -55,6 +56,22 @@ TORCH_API Module load(
     c10::optional<c10::Device> device = c10::nullopt,
     ExtraFilesMap& extra_files = default_extra_files);
 
+/// Loads a serialized `Module` from the given `filename` by mapping the file
+/// into memory.
+///
+/// The storages of the CPU tensors of the module point into the mapping
+/// instead of holding a copy of the data, and processes that load the same
+/// file share its pages. With `MmapAdapter::Mode::CopyOnWrite`, writing to a
+/// tensor makes a private copy of the pages it touches. With
+/// `MmapAdapter::Mode::ReadOnly`, writing to a tensor faults. The file must
+/// not be modified while the module is alive.
+TORCH_API Module load_mmap(
+    const std::string& filename,
+    c10::optional<c10::Device> device = c10::nullopt,
+    ExtraFilesMap& extra_files = default_extra_files,
+    caffe2::serialize::MmapAdapter::Mode mode =
+        caffe2::serialize::MmapAdapter::Mode::CopyOnWrite);
+
 /// Loads a serialized `Module` from the given `rai`.
 ///
 /// The reader adapter, which is for customized input stream, must contain a
@@ -204,9 +204,12 @@ void Unpickler::run() {
 }
 void Unpickler::setInput(size_t memo_id) {
   AT_ASSERT(!stack_.empty());
-  if (memo_id >= memo_table_.size()) {
-    memo_table_.insert(
-        memo_table_.end(), memo_id - memo_table_.size(), IValue());
+  // The Pickler numbers memo entries in order, so this almost always
+  // appends.
+  if (memo_id == memo_table_.size()) {
+    memo_table_.push_back(stack_.back());
+  } else if (memo_id > memo_table_.size()) {
+    memo_table_.resize(memo_id);
     memo_table_.push_back(stack_.back());
   } else {
     memo_table_[memo_id] = stack_.back();
@@ -304,12 +307,10 @@ PickleOpCode Unpickler::readInstruction() {
     case PickleOpCode::TUPLE: {
       size_t start = marks_.back();
       marks_.pop_back();
-      auto tuple = c10::ivalue::Tuple::create({});
-      tuple->elements().reserve(stack_.size() - start);
       auto start_it = stack_.begin() + start;
-      for (auto it = start_it; it != stack_.end(); ++it) {
-        tuple->elements().emplace_back(*it);
-      }
+      auto tuple = c10::ivalue::Tuple::create(std::vector<IValue>(
+          std::make_move_iterator(start_it),
+          std::make_move_iterator(stack_.end())));
       stack_.erase(start_it, stack_.end());
       stack_.emplace_back(tuple);
     } break;
@@ -331,8 +332,9 @@ PickleOpCode Unpickler::readInstruction() {
       break;
     case PickleOpCode::APPENDS: {
       size_t start = marks_.back();
+      TORCH_CHECK(start > 0, "APPENDS without a list in pickle archive");
       auto list_ivalue = stack_.at(start - 1);
-      readList(list_ivalue);
+      readList(std::move(list_ivalue));
     } break;
     case PickleOpCode::LIST: {
       IValue list_ivalue = c10::impl::GenericList(AnyType::get());
@@ -340,23 +342,15 @@ PickleOpCode Unpickler::readInstruction() {
       stack_.push_back(std::move(list_ivalue));
     } break;
     case PickleOpCode::DICT: {
-      size_t start = marks_.back();
-      marks_.pop_back();
       auto dict = c10::impl::GenericDict(AnyType::get(), AnyType::get());
-      for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
-      }
-      stack_.erase(stack_.begin() + start, stack_.end());
+      readDict(dict);
       stack_.push_back(std::move(dict));
     } break;
     case PickleOpCode::SETITEMS: {
       size_t start = marks_.back();
-      marks_.pop_back();
+      TORCH_CHECK(start > 0, "SETITEMS without a dict in pickle archive");
       auto dict = stack_.at(start - 1).toGenericDict();
-      for (size_t i = start; i < stack_.size(); i += 2) {
-        dict.insert_or_assign(stack_[i], stack_[i + 1]);
-      }
-      stack_.erase(stack_.begin() + start, stack_.end());
+      readDict(dict);
     } break;
     case PickleOpCode::BINGET: {
       stack_.push_back(memo_table_.at(read<uint8_t>()));
@@ -389,7 +383,8 @@ PickleOpCode Unpickler::readInstruction() {
       globals_.at(idx)();
     } break;
     case PickleOpCode::BINPERSID: {
-      auto args = pop(stack_).toTuple()->elements();
+      auto tuple = pop(stack_).toTuple();
+      const auto& args = tuple->elements();
       AT_ASSERT(
           args.at(0).toStringRef() == "storage",
           "unknown PERSID key ",
@@ -475,9 +470,9 @@ void Unpickler::readGlobal(
       });
     } else if (class_name == "restore_type_tag") {
       globals_.emplace_back([this] {
-        auto data = stack_.back().toTuple()->elements();
-        auto type_str = data.at(1).toStringRef();
-        stack_.pop_back();
+        auto tuple = pop(stack_).toTuple();
+        const auto& data = tuple->elements();
+        const std::string& type_str = data.at(1).toStringRef();
         TypePtr type = nullptr;
         auto entry = type_cache_.find(type_str);
         if (entry != type_cache_.end()) {
@@ -513,8 +508,7 @@ void Unpickler::readGlobal(
       // Unpickle a list specialization (e.g. List[Tensor], List[int], ...)
       globals_.emplace_back([this, elem_type] {
         // Pop reduce arg off the stack
-        auto data = stack_.back().toTuple()->elements().at(0).toList();
-        stack_.pop_back();
+        auto data = pop(stack_).toTuple()->elements().at(0).toList();
         data.unsafeSetElementType(elem_type);
         stack_.emplace_back(std::move(data));
       });
@@ -688,58 +682,71 @@ void Unpickler::rebuildRRef() {
 }
 #endif
 
+// Size of the chunks read through reader_. Large enough that the reader is
+// called rarely, since every call goes through a std::function and usually
+// a memcpy.
+static constexpr size_t kChunkSize = 64 * 1024;
+
+// Replaces the (consumed) buffer with the next chunk from reader_. Returns
+// false at the end of the pickle.
+bool Unpickler::refillBuffer() {
+  AT_ASSERT(buffer_remaining_ == 0);
+  if (!reader_) {
+    return false;
+  }
+  if (!chunk_) {
+    chunk_.reset(new char[kChunkSize]);
+  }
+  buffer_ = chunk_.get();
+  buffer_remaining_ = reader_(chunk_.get(), kChunkSize);
+  return buffer_remaining_ != 0;
+}
+
 void Unpickler::readSlowWithBuffer(char* dest, size_t sz) {
-  // First, read any partial from buffer (may be 0).
-  // We explicitly assume that sz > buffer_remaining_,
-  // and that sz is never bigger than buffer_.size().
+  // We explicitly assume that sz > buffer_remaining_. The reader may return
+  // fewer bytes than asked for, so this can take several chunks.
   AT_ASSERT(sz > buffer_remaining_);
-  const size_t from_old_buf = buffer_remaining_;
-  if (from_old_buf != 0) {
-    memcpy(dest, buffer_.data() + buffer_pos_, from_old_buf);
-  }
-  const size_t needed = sz - from_old_buf;
-  // Full read into the buffer. The calls here all explicitly
-  // assume that one buffer will be enough for any sz.
-  AT_ASSERT(sz <= buffer_.size());
-  buffer_remaining_ = reader_(buffer_.data(), buffer_.size());
-  if (buffer_remaining_ < needed) {
-    AT_ERROR("Unexpected end of pickler archive.");
+  while (sz > 0) {
+    if (buffer_remaining_ == 0 && !refillBuffer()) {
+      AT_ERROR("Unexpected end of pickler archive.");
+    }
+    const size_t n = std::min(sz, buffer_remaining_);
+    memcpy(dest, buffer_, n);
+    dest += n;
+    sz -= n;
+    buffer_ += n;
+    buffer_remaining_ -= n;
   }
-  memcpy(dest + from_old_buf, buffer_.data(), needed);
-  buffer_pos_ = needed; // assignment (0'ed from read)
-  buffer_remaining_ -= needed;
 }
 
 // Read a number of bytes from the input stream
 std::string Unpickler::readBytes(size_t length) {
   std::string data;
-  static const size_t kSmallString = 64;
   if (length <= buffer_remaining_) {
     // Fast-path: entirely in buffer.
-    data.assign(buffer_.data() + buffer_pos_, length);
-    buffer_pos_ += length;
+    data.assign(buffer_, length);
+    buffer_ += length;
     buffer_remaining_ -= length;
-  } else if (length <= kSmallString) {
-    // If the string is smallish, do a full buffer read,
-    // and read out of that buffer.
+  } else if (length <= kChunkSize || !reader_) {
     data.resize(length);
     readSlowWithBuffer(&data[0], length);
   } else {
-    // Otherwise, for larger strings, read what we can from
-    // the buffer, and then read directly to the destination.
+    // Otherwise, for strings larger than a chunk, read what we can from the
+    // buffer, and then read directly to the destination.
     const size_t from_old_buf = buffer_remaining_;
-    if (from_old_buf != 0) {
-      data.reserve(length);
-      data.append(buffer_.data() + buffer_pos_, from_old_buf);
-    }
     data.resize(length);
-    const size_t needed = length - from_old_buf;
-    size_t nread = reader_(&data[from_old_buf], needed);
-    if (nread != needed) {
-      AT_ERROR("Unexpected end of pickler archive.");
+    if (from_old_buf != 0) {
+      memcpy(&data[0], buffer_, from_old_buf);
     }
     buffer_remaining_ = 0;
-    // buffer_pos_ has no meaning with buffer_remaining_ == 0.
+    size_t pos = from_old_buf;
+    while (pos < length) {
+      size_t nread = reader_(&data[pos], length - pos);
+      if (nread == 0) {
+        AT_ERROR("Unexpected end of pickler archive.");
+      }
+      pos += nread;
+    }
   }
   return data;
 }
@@ -760,8 +767,8 @@ void Unpickler::readList(IValue list_ivalue) {
   } else if (list_ivalue.isTensorList()) {
     auto list = std::move(list_ivalue).toTensorList();
     list.reserve(num_elements);
-    for (const auto& elem : elements) {
-      list.emplace_back(elem.toTensor());
+    for (size_t i = start; i < stack_.size(); ++i) {
+      list.emplace_back(std::move(stack_[i]).toTensor());
     }
   } else if (list_ivalue.isDoubleList()) {
     auto list = std::move(list_ivalue).toDoubleList();
@@ -777,9 +784,9 @@ void Unpickler::readList(IValue list_ivalue) {
     }
   } else if (list_ivalue.isList()) {
     auto list = std::move(list_ivalue).toList();
-    list.reserve(num_elements);
-    for (const auto& elem : elements) {
-      list.emplace_back(elem);
+    list.reserve(list.size() + num_elements);
+    for (size_t i = start; i < stack_.size(); ++i) {
+      list.emplace_back(std::move(stack_[i]));
     }
   } else {
     AT_ERROR("Unknown IValue list kind: ", list_ivalue.tagKind());
@@ -788,6 +795,22 @@ void Unpickler::readList(IValue list_ivalue) {
   stack_.erase(stack_.begin() + start, stack_.end());
 }
 
+// Pop all the key/value pairs off of the stack and insert them into the
+// dict. Keys and values are moved, so that a dict of strings to tensors
+// doesn't touch the refcounts of its items.
+void Unpickler::readDict(c10::impl::GenericDict& dict) {
+  size_t start = marks_.back();
+  marks_.pop_back();
+  TORCH_CHECK(
+      (stack_.size() - start) % 2 == 0,
+      "Odd number of items for a dict in pickle archive");
+  dict.reserve(dict.size() + (stack_.size() - start) / 2);
+  for (size_t i = start; i < stack_.size(); i += 2) {
+    dict.insert_or_assign(std::move(stack_[i]), std::move(stack_[i + 1]));
+  }
+  stack_.erase(stack_.begin() + start, stack_.end());
+}
+
 inline bool is_valid_python_id_char(char c) {
   return c == '_' || c == '.' || (c >= '0' && c <= '9') ||
       (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
@@ -797,21 +820,29 @@ inline bool is_valid_python_id_char(char c) {
 std::string Unpickler::readString() {
   std::string ss;
   while (true) {
-    char c = read<char>();
-    if (c == '\n') {
-      break;
+    if (buffer_remaining_ == 0 && !refillBuffer()) {
+      AT_ERROR("Unexpected end of pickler archive.");
+    }
+    auto newline = static_cast<const char*>(
+        memchr(buffer_, '\n', buffer_remaining_));
+    const size_t length = newline ? newline - buffer_ : buffer_remaining_;
+    for (size_t i = 0; i < length; ++i) {
+      // Simple check just in case there is no terminating '\n'
+      TORCH_CHECK(
+          is_valid_python_id_char(buffer_[i]),
+          "Found character '",
+          int(uint8_t(buffer_[i])),
+          "' in string, ",
+          "strings must be qualified Python identifiers");
+    }
+    ss.append(buffer_, length);
+    const size_t consumed = newline ? length + 1 : length;
+    buffer_ += consumed;
+    buffer_remaining_ -= consumed;
+    if (newline) {
+      return ss;
     }
-    ss.push_back(c);
-
-    // Simple check just in case there is no terminating '\n'
-    TORCH_CHECK(
-        is_valid_python_id_char(c),
-        "Found character '",
-        int(uint8_t(c)),
-        "' in string, ",
-        "strings must be qualified Python identifiers");
   }
-  return ss;
 }
 
 } // namespace jit
@@ -35,6 +35,19 @@ class Unpickler {
         type_resolver_(std::move(type_resolver)),
         version_(caffe2::serialize::kProducedFileFormatVersion) {}
 
+  // Same as above, for a pickle that is already in memory. It is read in
+  // place, without going through a reader, and must outlive the Unpickler.
+  Unpickler(
+      const char* data,
+      size_t size,
+      TypeResolver type_resolver,
+      const std::vector<at::Tensor>* tensor_table)
+      : buffer_(data),
+        buffer_remaining_(size),
+        tensor_table_(tensor_table),
+        type_resolver_(std::move(type_resolver)),
+        version_(caffe2::serialize::kProducedFileFormatVersion) {}
+
   // tensors inside the pickle contain meta-data, the raw tensor
   // dead is retrieved by calling `read_record`.
   Unpickler(
@@ -51,6 +64,22 @@ class Unpickler {
         device_(std::move(device)),
         version_(caffe2::serialize::kProducedFileFormatVersion) {}
 
+  Unpickler(
+      const char* data,
+      size_t size,
+      TypeResolver type_resolver,
+      ObjLoader obj_loader,
+      std::function<at::DataPtr(const std::string&)> read_record,
+      c10::optional<at::Device> device)
+      : buffer_(data),
+        buffer_remaining_(size),
+        tensor_table_(nullptr),
+        type_resolver_(std::move(type_resolver)),
+        obj_loader_(std::move(obj_loader)),
+        read_record_(std::move(read_record)),
+        device_(std::move(device)),
+        version_(caffe2::serialize::kProducedFileFormatVersion) {}
+
   // consume the pickle stream, producing an IValue from the contents.
   // Type Tags: the pickler will restore the type tags on
   // List and Dict objects when possible IValue is an Object.
@@ -79,9 +108,9 @@ class Unpickler {
     T item;
     if (sizeof(T) <= buffer_remaining_) {
       // Fast path: entirely from buffer.
-      memcpy(&item, buffer_.data() + buffer_pos_, sizeof(T));
+      memcpy(&item, buffer_, sizeof(T));
       buffer_remaining_ -= sizeof(T);
-      buffer_pos_ += sizeof(T);
+      buffer_ += sizeof(T);
     } else {
       // Don't over-template the slow path, to avoid code size bloat.
       readSlowWithBuffer(reinterpret_cast<char*>(&item), sizeof(T));
@@ -89,6 +118,7 @@ class Unpickler {
     return item;
   }
   void readSlowWithBuffer(char* dest, size_t sz);
+  bool refillBuffer();
   std::string readBytes(size_t num_bytes);
 
   double readFloat();
@@ -105,15 +135,20 @@ class Unpickler {
   }
   std::string readString();
   void readList(IValue list_ivalue);
+  void readDict(c10::impl::GenericDict& dict);
   void setInput(size_t memo_id);
   void run();
 
   // Returns the number of bytes read. This should statefully
-  // remember the position. Don't call reader_ directly.
+  // remember the position. Don't call reader_ directly. Null when the
+  // whole pickle was given in memory.
   std::function<size_t(char*, size_t)> reader_;
-  // Small buffer to avoid calling reader_ on a per-byte basis.
-  std::array<char, 256> buffer_;
-  size_t buffer_pos_{0};
+  // Chunk that reader_ reads into, to avoid calling it on a per-opcode
+  // basis. Allocated on the first read.
+  std::unique_ptr<char[]> chunk_;
+  // The bytes that have not been consumed yet, either in chunk_ or in the
+  // pickle given in memory.
+  const char* buffer_{nullptr};
   size_t buffer_remaining_{0};
 
   std::vector<IValue> stack_;
@@ -0,0 +1,1269 @@
+#include <torch/csrc/jit/tensorexpr/closure_eval.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/execution_counter.h>
+#include <torch/csrc/jit/tensorexpr/hash_provider.h>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+DEFINE_TRIGGER(closure_ir_eval_executed);
+
+RegisterCodeGen<ClosureIREvaluator> closure_ir_eval_codegen_reg(
+    "closure_ir_eval");
+
+constexpr int ClosureIREvaluator::kBlockSize;
+
+namespace {
+
+constexpr int kBlockSize = ClosureIREvaluator::kBlockSize;
+
+#define FORALL_INTEGRAL_TYPES(_) \
+  _(uint8_t, Byte)               \
+  _(int8_t, Char)                \
+  _(int16_t, Short)              \
+  _(int, Int)                    \
+  _(int64_t, Long)
+
+// Per-call state. Variables hold a single scalar; temporaries hold one value
+// per lane of a block. Each element is 8 bytes, enough for any scalar type.
+struct Frame {
+  Frame(int num_vars, int num_temps, int num_buffers)
+      : vars(new uint64_t[std::max(num_vars, 1)]),
+        temps(new uint64_t[std::max(num_temps, 1) * kBlockSize]),
+        buffers(num_buffers, nullptr),
+        allocations(num_buffers) {}
+
+  template <typename T>
+  T* var(int slot) {
+    return reinterpret_cast<T*>(vars.get() + slot);
+  }
+
+  template <typename T>
+  T* temp(int slot) {
+    return reinterpret_cast<T*>(temps.get() + slot * kBlockSize);
+  }
+
+  std::unique_ptr<uint64_t[]> vars;
+  std::unique_ptr<uint64_t[]> temps;
+  std::vector<void*> buffers;
+  std::vector<std::unique_ptr<uint64_t[]>> allocations;
+};
+
+// Computes the first n lanes of an expression into out.
+using ExprFn = std::function<void(Frame&, int, void*)>;
+// Runs a statement for the first n lanes of the enclosing vectorized loop, or
+// once (n == 1) outside of one.
+using StmtFn = std::function<void(Frame&, int)>;
+
+} // namespace
+
+struct ClosureIREvaluator::Program {
+  struct ArgBinding {
+    bool is_var;
+    int slot;
+    ScalarType type;
+  };
+
+  StmtFn body;
+  std::vector<ArgBinding> args;
+  int num_vars = 0;
+  int num_temps = 0;
+  int num_buffers = 0;
+};
+
+namespace {
+
+struct CompiledExpr {
+  ScalarType type;
+  ExprFn fn;
+  // Whether the value differs between the lanes of the enclosing vectorized
+  // loop. Uniform expressions are only ever evaluated for one lane.
+  bool varying;
+};
+
+size_t elementSize(ScalarType type) {
+  switch (type) {
+#define TYPE_CASE(Type, Name) \
+  case ScalarType::Name:      \
+    return sizeof(Type);
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+template <typename T>
+void fillLanes(void* out, int n) {
+  T* o = static_cast<T*>(out);
+  T value = o[0];
+  for (int i = 1; i < n; i++) {
+    o[i] = value;
+  }
+}
+
+// Returns a function that computes all lanes of e, broadcasting its value if
+// it is uniform.
+ExprFn asVarying(const CompiledExpr& e) {
+  if (e.varying) {
+    return e.fn;
+  }
+  void (*fill)(void*, int) = nullptr;
+  switch (e.type) {
+#define TYPE_CASE(Type, Name) \
+  case ScalarType::Name:      \
+    fill = fillLanes<Type>;   \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+  ExprFn fn = e.fn;
+  return [fn, fill](Frame& f, int n, void* out) {
+    fn(f, 1, out);
+    fill(out, n);
+  };
+}
+
+// Computes op(lhs, rhs) lane-wise. The lhs is evaluated straight into the
+// output and the rhs into temporary tmp; a uniform operand is evaluated once
+// and read as a scalar.
+template <typename T, typename Op>
+ExprFn binaryLanes(
+    const CompiledExpr& lhs,
+    const CompiledExpr& rhs,
+    int tmp,
+    Op op) {
+  ExprFn l = lhs.fn;
+  ExprFn r = rhs.fn;
+  if (lhs.varying && !rhs.varying) {
+    return [l, r, tmp, op](Frame& f, int n, void* out) {
+      T* o = static_cast<T*>(out);
+      T* t = f.temp<T>(tmp);
+      l(f, n, o);
+      r(f, 1, t);
+      const T b = t[0];
+      for (int i = 0; i < n; i++) {
+        o[i] = op(o[i], b);
+      }
+    };
+  }
+  if (!lhs.varying && rhs.varying) {
+    return [l, r, tmp, op](Frame& f, int n, void* out) {
+      T* o = static_cast<T*>(out);
+      T* t = f.temp<T>(tmp);
+      l(f, 1, o);
+      r(f, n, t);
+      const T a = o[0];
+      for (int i = 0; i < n; i++) {
+        o[i] = op(a, t[i]);
+      }
+    };
+  }
+  return [l, r, tmp, op](Frame& f, int n, void* out) {
+    T* o = static_cast<T*>(out);
+    T* t = f.temp<T>(tmp);
+    l(f, n, o);
+    r(f, n, t);
+    for (int i = 0; i < n; i++) {
+      o[i] = op(o[i], t[i]);
+    }
+  };
+}
+
+template <typename T, typename Op>
+ExprFn unaryLanes(const ExprFn& a, Op op) {
+  return [a, op](Frame& f, int n, void* out) {
+    T* o = static_cast<T*>(out);
+    a(f, n, o);
+    for (int i = 0; i < n; i++) {
+      o[i] = op(o[i]);
+    }
+  };
+}
+
+template <typename T>
+void compareLanes(
+    CompareSelectOperation op,
+    const void* lhs,
+    const void* rhs,
+    uint8_t* mask,
+    int n) {
+  const T* a = static_cast<const T*>(lhs);
+  const T* b = static_cast<const T*>(rhs);
+  switch (op) {
+    case CompareSelectOperation::kEQ:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] == b[i];
+      }
+      break;
+    case CompareSelectOperation::kNE:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] != b[i];
+      }
+      break;
+    case CompareSelectOperation::kGT:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] > b[i];
+      }
+      break;
+    case CompareSelectOperation::kGE:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] >= b[i];
+      }
+      break;
+    case CompareSelectOperation::kLT:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] < b[i];
+      }
+      break;
+    case CompareSelectOperation::kLE:
+      for (int i = 0; i < n; i++) {
+        mask[i] = a[i] <= b[i];
+      }
+      break;
+    default:
+      throw std::runtime_error("invalid operator type");
+  }
+}
+
+template <typename T>
+void selectLanes(const uint8_t* mask, void* out, const void* other, int n) {
+  T* o = static_cast<T*>(out);
+  const T* t = static_cast<const T*>(other);
+  for (int i = 0; i < n; i++) {
+    o[i] = mask[i] ? o[i] : t[i];
+  }
+}
+
+template <typename SrcType, typename DstType>
+void castLanes(const void* src, void* dst, int n) {
+  const SrcType* s = static_cast<const SrcType*>(src);
+  DstType* d = static_cast<DstType*>(dst);
+  for (int i = 0; i < n; i++) {
+    d[i] = static_cast<DstType>(s[i]);
+  }
+}
+
+template <typename SrcType>
+void (*castLanesTo(ScalarType dst_type))(const void*, void*, int) {
+  switch (dst_type) {
+#define DST_TYPE_CASE(Type, Name) \
+  case ScalarType::Name:          \
+    return castLanes<SrcType, Type>;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, DST_TYPE_CASE);
+#undef DST_TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+template <typename T>
+ExprFn intrinsicLanes(IntrinsicsOp op_type, const ExprFn& a) {
+  switch (op_type) {
+#define UNARY_INTRINSIC(Op, expr) \
+  case Op:                        \
+    return unaryLanes<T>(a, [](T x) -> T { return expr; });
+    UNARY_INTRINSIC(kSin, std::sin(x))
+    UNARY_INTRINSIC(kCos, std::cos(x))
+    UNARY_INTRINSIC(kTan, std::tan(x))
+    UNARY_INTRINSIC(kAsin, std::asin(x))
+    UNARY_INTRINSIC(kAcos, std::acos(x))
+    UNARY_INTRINSIC(kAtan, std::atan(x))
+    UNARY_INTRINSIC(kSinh, std::sinh(x))
+    UNARY_INTRINSIC(kCosh, std::cosh(x))
+    UNARY_INTRINSIC(kTanh, std::tanh(x))
+    UNARY_INTRINSIC(kSigmoid, T(1) / (T(1) + std::exp(-x)))
+    UNARY_INTRINSIC(kExp, std::exp(x))
+    UNARY_INTRINSIC(kExpm1, std::expm1(x))
+    UNARY_INTRINSIC(kFabs, std::fabs(x))
+    UNARY_INTRINSIC(kLog, std::log(x))
+    UNARY_INTRINSIC(kLog2, std::log2(x))
+    UNARY_INTRINSIC(kLog10, std::log10(x))
+    UNARY_INTRINSIC(kLog1p, std::log1p(x))
+    UNARY_INTRINSIC(kErf, std::erf(x))
+    UNARY_INTRINSIC(kErfc, std::erfc(x))
+    UNARY_INTRINSIC(kSqrt, std::sqrt(x))
+    UNARY_INTRINSIC(kRsqrt, T(1) / std::sqrt(x))
+    UNARY_INTRINSIC(kCeil, std::ceil(x))
+    UNARY_INTRINSIC(kFloor, std::floor(x))
+    UNARY_INTRINSIC(kRound, std::round(x))
+    UNARY_INTRINSIC(kTrunc, std::trunc(x))
+    UNARY_INTRINSIC(kLgamma, std::lgamma(x))
+#undef UNARY_INTRINSIC
+    case kFrac:
+      return unaryLanes<T>(a, [](T x) -> T {
+        T intpart;
+        return std::modf(x, &intpart);
+      });
+    default:
+      throw unimplemented_lowering();
+  }
+}
+
+template <typename T>
+ExprFn intrinsicLanes(
+    IntrinsicsOp op_type,
+    const CompiledExpr& a,
+    const CompiledExpr& b,
+    int tmp) {
+  switch (op_type) {
+    case kPow:
+      return binaryLanes<T>(
+          a, b, tmp, [](T x, T y) -> T { return std::pow(x, y); });
+    case kFmod:
+      return binaryLanes<T>(
+          a, b, tmp, [](T x, T y) -> T { return std::fmod(x, y); });
+    case kRemainder:
+      return binaryLanes<T>(
+          a, b, tmp, [](T x, T y) -> T { return std::remainder(x, y); });
+    case kAtan2:
+      return binaryLanes<T>(
+          a, b, tmp, [](T x, T y) -> T { return std::atan2(x, y); });
+    default:
+      throw unimplemented_lowering();
+  }
+}
+
+bool dependsOn(const Expr* e, const Var* var) {
+  NodeFinder<Var> finder;
+  e->accept(&finder);
+  return std::find(finder.nodes.begin(), finder.nodes.end(), var) !=
+      finder.nodes.end();
+}
+
+// How much e changes from one iteration of var to the next, if it is affine in
+// var with a known constant coefficient.
+c10::optional<int64_t> laneStride(const Expr* e, const Var* var) {
+  if (!dependsOn(e, var)) {
+    return 0;
+  }
+  if (e == var) {
+    return 1;
+  }
+  if (const Add* add = dynamic_cast<const Add*>(e)) {
+    auto lhs = laneStride(add->lhs(), var);
+    auto rhs = laneStride(add->rhs(), var);
+    if (lhs && rhs) {
+      return *lhs + *rhs;
+    }
+  } else if (const Sub* sub = dynamic_cast<const Sub*>(e)) {
+    auto lhs = laneStride(sub->lhs(), var);
+    auto rhs = laneStride(sub->rhs(), var);
+    if (lhs && rhs) {
+      return *lhs - *rhs;
+    }
+  } else if (const Mul* mul = dynamic_cast<const Mul*>(e)) {
+    if (const IntImm* c = dynamic_cast<const IntImm*>(mul->lhs())) {
+      auto rhs = laneStride(mul->rhs(), var);
+      if (rhs) {
+        return c->value() * *rhs;
+      }
+    } else if (const IntImm* c = dynamic_cast<const IntImm*>(mul->rhs())) {
+      auto lhs = laneStride(mul->lhs(), var);
+      if (lhs) {
+        return *lhs * c->value();
+      }
+    }
+  }
+  return c10::nullopt;
+}
+
+bool isConstantOne(const Expr* e) {
+  const IntImm* imm = dynamic_cast<const IntImm*>(e);
+  return imm && imm->value() == 1;
+}
+
+// Whether the iterations of an innermost loop can be run a block at a time:
+// the blocked order executes each statement for all lanes before the next
+// one, so no iteration may read what another iteration of the same block
+// writes.
+bool isVectorizable(const For* loop) {
+  Block* body = loop->body();
+  if (!NodeFinder<For>::find(body).empty() ||
+      !NodeFinder<Allocate>::find(body).empty() ||
+      !NodeFinder<Free>::find(body).empty() ||
+      !NodeFinder<AtomicAdd>::find(body).empty()) {
+    return false;
+  }
+  for (Block* block : NodeFinder<Block>::find(body)) {
+    if (!block->varBindings().empty()) {
+      return false;
+    }
+  }
+  for (Cond* cond : NodeFinder<Cond>::find(body)) {
+    if (dependsOn(cond->condition(), loop->var())) {
+      return false;
+    }
+  }
+
+  // Every buffer written in the loop must be accessed at one index per
+  // iteration, and if it is also read, that index must differ between
+  // iterations.
+  HashProvider hasher;
+  std::unordered_map<const Var*, SimplifierHashType> store_index;
+  for (Store* store : NodeFinder<Store>::find(body)) {
+    SimplifierHashType hash =
+        hasher.hash(flatten_index(store->buf()->dims(), store->indices()));
+    auto it = store_index.find(store->base_handle());
+    if (it != store_index.end() && it->second != hash) {
+      return false;
+    }
+    store_index.emplace(store->base_handle(), hash);
+  }
+  for (Load* load : NodeFinder<Load>::find(body)) {
+    auto it = store_index.find(load->base_handle());
+    if (it == store_index.end()) {
+      continue;
+    }
+    const Expr* flat_idx = flatten_index(load->buf()->dims(), load->indices());
+    if (hasher.hash(flat_idx) != it->second) {
+      return false;
+    }
+    auto stride = laneStride(flat_idx, loop->var());
+    if (!stride || *stride == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+class ClosureCompiler : public IRVisitor {
+ public:
+  explicit ClosureCompiler(ClosureIREvaluator::Program* program)
+      : program_(program) {}
+
+  void bindArgs(const std::vector<CodeGen::BufferArg>& args);
+
+  CompiledExpr compileExpr(const Expr* e, int tmp) {
+    if (e->dtype().lanes() != 1) {
+      throw unimplemented_lowering(e);
+    }
+    int old_tmp = tmp_;
+    tmp_ = tmp;
+    e->accept(this);
+    tmp_ = old_tmp;
+    return expr_;
+  }
+
+  StmtFn compileStmt(const Stmt* s, int tmp) {
+    int old_tmp = tmp_;
+    tmp_ = tmp;
+    s->accept(this);
+    tmp_ = old_tmp;
+    return stmt_;
+  }
+
+  // Expressions.
+  void visit(const Add* v) override {
+    visitArith(v, [](auto a, auto b) { return a + b; });
+  }
+  void visit(const Sub* v) override {
+    visitArith(v, [](auto a, auto b) { return a - b; });
+  }
+  void visit(const Mul* v) override {
+    visitArith(v, [](auto a, auto b) { return a * b; });
+  }
+  void visit(const Div* v) override {
+    visitArith(v, [](auto a, auto b) { return div_value(a, b); });
+  }
+  void visit(const Mod* v) override {
+    visitArith(v, [](auto a, auto b) { return mod_value(a, b); });
+  }
+  void visit(const Max* v) override {
+    if (v->propagate_nans()) {
+      visitArith(v, [](auto a, auto b) {
+        return a != a ? a : (b != b ? b : (a > b ? a : b));
+      });
+    } else {
+      visitArith(v, [](auto a, auto b) { return a > b ? a : b; });
+    }
+  }
+  void visit(const Min* v) override {
+    if (v->propagate_nans()) {
+      visitArith(v, [](auto a, auto b) {
+        return a != a ? a : (b != b ? b : (a < b ? a : b));
+      });
+    } else {
+      visitArith(v, [](auto a, auto b) { return a < b ? a : b; });
+    }
+  }
+  void visit(const And* v) override {
+    visitBitwise(v, [](auto a, auto b) { return a & b; });
+  }
+  void visit(const Or* v) override {
+    visitBitwise(v, [](auto a, auto b) { return a | b; });
+  }
+  void visit(const Xor* v) override {
+    visitBitwise(v, [](auto a, auto b) { return a ^ b; });
+  }
+  void visit(const Lshift* v) override {
+    visitBitwise(v, [](auto a, auto b) { return a << b; });
+  }
+  void visit(const Rshift* v) override {
+    visitBitwise(v, [](auto a, auto b) { return a >> b; });
+  }
+
+  void visit(const CompareSelect* v) override;
+
+#define IMM_VISIT(Type, Name)                                     \
+  void visit(const Name##Imm* v) override {                       \
+    const Type value = v->value();                                \
+    expr_ = {ScalarType::Name,                                    \
+             [value](Frame& f, int n, void* out) {                \
+               Type* o = static_cast<Type*>(out);                 \
+               for (int i = 0; i < n; i++) {                      \
+                 o[i] = value;                                    \
+               }                                                  \
+             },                                                   \
+             false};                                              \
+  }
+  AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, IMM_VISIT);
+#undef IMM_VISIT
+
+  void visit(const Cast* v) override;
+  void visit(const Var* v) override;
+  void visit(const Load* v) override;
+  void visit(const IfThenElse* v) override;
+  void visit(const Intrinsics* v) override;
+
+  // Statements.
+  void visit(const Block* v) override;
+  void visit(const For* v) override;
+  void visit(const Store* v) override;
+  void visit(const Cond* v) override;
+  void visit(const Allocate* v) override;
+  void visit(const Free* v) override;
+
+  // Everything else has to be lowered before it reaches a code generator, or
+  // is left to SimpleIREvaluator.
+  void visit(const Buf* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const Ramp* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const Broadcast* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const BaseCallNode* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const FunctionCall* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const Term* v) override {
+    throw unimplemented_lowering();
+  }
+  void visit(const Polynomial* v) override {
+    throw unimplemented_lowering();
+  }
+  void visit(const RoundOff* v) override {
+    throw unimplemented_lowering();
+  }
+  void visit(const ReduceOp* v) override {
+    throw unimplemented_lowering(v);
+  }
+  void visit(const AtomicAdd* v) override {
+    throw unimplemented_lowering(v);
+  }
+
+ private:
+  int useTemps(int count) {
+    program_->num_temps = std::max(program_->num_temps, tmp_ + count);
+    return tmp_;
+  }
+
+  int bindVar(const Var* v) {
+    if (var_slots_.count(v)) {
+      throw malformed_input("Var bound twice", v);
+    }
+    int slot = program_->num_vars++;
+    var_slots_[v] = slot;
+    return slot;
+  }
+
+  void unbindVar(const Var* v) {
+    var_slots_.erase(v);
+  }
+
+  int bufferSlot(const Var* v) {
+    auto it = buffer_slots_.find(v);
+    if (it == buffer_slots_.end()) {
+      throw malformed_input("could not find base node", v);
+    }
+    return it->second;
+  }
+
+  // Evaluates a uniform int expression, e.g. a loop bound, for one lane.
+  std::function<int(Frame&)> compileInt(const Expr* e, int tmp) {
+    if (e->dtype() != kInt) {
+      throw unsupported_dtype();
+    }
+    ExprFn fn = compileExpr(e, tmp + 1).fn;
+    return [fn, tmp](Frame& f) {
+      int* t = f.temp<int>(tmp);
+      fn(f, 1, t);
+      return t[0];
+    };
+  }
+
+  template <typename Node, typename Op>
+  void visitArith(const Node* v, Op op) {
+    int tmp = useTemps(1);
+    CompiledExpr lhs = compileExpr(v->lhs(), tmp);
+    CompiledExpr rhs = compileExpr(v->rhs(), tmp + 1);
+    if (lhs.type != rhs.type) {
+      throw malformed_input("bad dtype in binary op", v);
+    }
+    switch (lhs.type) {
+#define TYPE_CASE(Type, Name)                                                \
+  case ScalarType::Name:                                                     \
+    expr_ = {lhs.type,                                                       \
+             binaryLanes<Type>(                                              \
+                 lhs,                                                        \
+                 rhs,                                                        \
+                 tmp,                                                        \
+                 [op](Type a, Type b) { return static_cast<Type>(op(a, b)); }), \
+             lhs.varying || rhs.varying};                                    \
+    break;
+      AT_FORALL_SCALAR_TYPES(TYPE_CASE);
+#undef TYPE_CASE
+      default:
+        throw unsupported_dtype();
+    }
+  }
+
+  template <typename Node, typename Op>
+  void visitBitwise(const Node* v, Op op) {
+    int tmp = useTemps(1);
+    CompiledExpr lhs = compileExpr(v->lhs(), tmp);
+    CompiledExpr rhs = compileExpr(v->rhs(), tmp + 1);
+    if (lhs.type != rhs.type) {
+      throw malformed_input("bad dtype in binary op", v);
+    }
+    switch (lhs.type) {
+#define TYPE_CASE(Type, Name)                                                \
+  case ScalarType::Name:                                                     \
+    expr_ = {lhs.type,                                                       \
+             binaryLanes<Type>(                                              \
+                 lhs,                                                        \
+                 rhs,                                                        \
+                 tmp,                                                        \
+                 [op](Type a, Type b) { return static_cast<Type>(op(a, b)); }), \
+             lhs.varying || rhs.varying};                                    \
+    break;
+      FORALL_INTEGRAL_TYPES(TYPE_CASE);
+#undef TYPE_CASE
+      default:
+        throw unsupported_dtype();
+    }
+  }
+
+  ClosureIREvaluator::Program* program_;
+  std::unordered_map<const Var*, int> var_slots_;
+  std::unordered_map<const Var*, int> buffer_slots_;
+  // The loop being vectorized, if any, and the slot holding the index of the
+  // first iteration of the current block.
+  const Var* vec_var_ = nullptr;
+  int vec_slot_ = -1;
+  // First temporary the node being compiled may use.
+  int tmp_ = 0;
+  CompiledExpr expr_;
+  StmtFn stmt_;
+};
+
+void ClosureCompiler::bindArgs(const std::vector<CodeGen::BufferArg>& args) {
+  for (const auto& arg : args) {
+    if (arg.isVar()) {
+      int slot = bindVar(arg.var());
+      program_->args.push_back({true, slot, arg.dtype().scalar_type()});
+    } else {
+      if (buffer_slots_.count(arg.var())) {
+        throw malformed_input("buffer passed twice", arg.var());
+      }
+      int slot = program_->num_buffers++;
+      buffer_slots_[arg.var()] = slot;
+      program_->args.push_back({false, slot, arg.dtype().scalar_type()});
+    }
+  }
+}
+
+void ClosureCompiler::visit(const CompareSelect* v) {
+  // Temporaries: tmp and tmp + 1 hold the operands, tmp + 2 the comparison.
+  int tmp = useTemps(3);
+  CompiledExpr lhs = compileExpr(v->lhs(), tmp + 1);
+  CompiledExpr rhs = compileExpr(v->rhs(), tmp + 2);
+  CompiledExpr ret1 = compileExpr(v->ret_val1(), tmp + 3);
+  CompiledExpr ret2 = compileExpr(v->ret_val2(), tmp + 3);
+  if (lhs.type != rhs.type || ret1.type != ret2.type) {
+    throw malformed_input("bad dtype in CompareSelect", v);
+  }
+
+  void (*compare)(CompareSelectOperation, const void*, const void*, uint8_t*, int) =
+      nullptr;
+  void (*select)(const uint8_t*, void*, const void*, int) = nullptr;
+  switch (lhs.type) {
+#define TYPE_CASE(Type, Name)   \
+  case ScalarType::Name:        \
+    compare = compareLanes<Type>; \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+  switch (ret1.type) {
+#define TYPE_CASE(Type, Name)  \
+  case ScalarType::Name:       \
+    select = selectLanes<Type>; \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+
+  bool varying = lhs.varying || rhs.varying || ret1.varying || ret2.varying;
+  ExprFn l = varying ? asVarying(lhs) : lhs.fn;
+  ExprFn r = varying ? asVarying(rhs) : rhs.fn;
+  ExprFn r1 = varying ? asVarying(ret1) : ret1.fn;
+  ExprFn r2 = varying ? asVarying(ret2) : ret2.fn;
+  CompareSelectOperation cmp_op = v->compare_select_op();
+  expr_ = {ret1.type,
+           [l, r, r1, r2, compare, select, cmp_op, tmp](
+               Frame& f, int n, void* out) {
+             void* a = f.temp<void>(tmp);
+             void* b = f.temp<void>(tmp + 1);
+             uint8_t* mask = f.temp<uint8_t>(tmp + 2);
+             l(f, n, a);
+             r(f, n, b);
+             compare(cmp_op, a, b, mask, n);
+             r1(f, n, out);
+             r2(f, n, a);
+             select(mask, out, a, n);
+           },
+           varying};
+}
+
+void ClosureCompiler::visit(const Cast* v) {
+  int tmp = useTemps(1);
+  CompiledExpr src = compileExpr(v->src_value(), tmp + 1);
+  ScalarType dst_type = v->dtype().scalar_type();
+  if (src.type == dst_type) {
+    expr_ = src;
+    return;
+  }
+  void (*cast)(const void*, void*, int) = nullptr;
+  switch (src.type) {
+#define SRC_TYPE_CASE(Type, Name)          \
+  case ScalarType::Name:                   \
+    cast = castLanesTo<Type>(dst_type);    \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, SRC_TYPE_CASE);
+#undef SRC_TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+  ExprFn fn = src.fn;
+  expr_ = {dst_type,
+           [fn, cast, tmp](Frame& f, int n, void* out) {
+             void* t = f.temp<void>(tmp);
+             fn(f, n, t);
+             cast(t, out, n);
+           },
+           src.varying};
+}
+
+void ClosureCompiler::visit(const Var* v) {
+  if (v == vec_var_) {
+    int slot = vec_slot_;
+    expr_ = {ScalarType::Int,
+             [slot](Frame& f, int n, void* out) {
+               const int base = *f.var<int>(slot);
+               int* o = static_cast<int*>(out);
+               for (int i = 0; i < n; i++) {
+                 o[i] = base + i;
+               }
+             },
+             true};
+    return;
+  }
+
+  auto it = var_slots_.find(v);
+  if (it == var_slots_.end()) {
+    throw malformed_input("could not find Var in context", v);
+  }
+  int slot = it->second;
+  ScalarType type = v->dtype().scalar_type();
+  switch (type) {
+#define TYPE_CASE(Type, Name)                              \
+  case ScalarType::Name:                                   \
+    expr_ = {type,                                         \
+             [slot](Frame& f, int n, void* out) {          \
+               const Type value = *f.var<Type>(slot);      \
+               Type* o = static_cast<Type*>(out);          \
+               for (int i = 0; i < n; i++) {               \
+                 o[i] = value;                             \
+               }                                           \
+             },                                            \
+             false};                                       \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+void ClosureCompiler::visit(const Load* v) {
+  // Temporaries: tmp holds the index, tmp + 1 the mask.
+  int tmp = useTemps(2);
+  int buf = bufferSlot(v->base_handle());
+  const Expr* flat_idx = flatten_index(v->buf()->dims(), v->indices());
+  if (flat_idx->dtype() != kInt) {
+    throw unsupported_dtype();
+  }
+  CompiledExpr index = compileExpr(flat_idx, tmp + 2);
+  bool masked = !isConstantOne(v->mask());
+  CompiledExpr mask;
+  if (masked) {
+    mask = compileExpr(v->mask(), tmp + 2);
+    if (mask.type != ScalarType::Int) {
+      throw unsupported_dtype();
+    }
+  }
+  bool varying = index.varying || (masked && mask.varying);
+  bool contiguous = varying && !masked && vec_var_ &&
+      laneStride(flat_idx, vec_var_) == c10::optional<int64_t>(1);
+  ScalarType type = v->dtype().scalar_type();
+
+  ExprFn index_fn = varying ? asVarying(index) : index.fn;
+  ExprFn mask_fn = masked && varying ? asVarying(mask) : mask.fn;
+  switch (type) {
+#define TYPE_CASE(Type, Name)                                       \
+  case ScalarType::Name:                                            \
+    if (contiguous) {                                               \
+      expr_ = {type,                                                \
+               [index_fn, buf, tmp](Frame& f, int n, void* out) {   \
+                 int* idx = f.temp<int>(tmp);                       \
+                 index_fn(f, 1, idx);                               \
+                 const Type* p =                                    \
+                     static_cast<const Type*>(f.buffers[buf]) + idx[0]; \
+                 Type* o = static_cast<Type*>(out);                 \
+                 for (int i = 0; i < n; i++) {                      \
+                   o[i] = p[i];                                     \
+                 }                                                  \
+               },                                                   \
+               true};                                               \
+    } else {                                                        \
+      expr_ = {type,                                                \
+               [index_fn, mask_fn, masked, buf, tmp](               \
+                   Frame& f, int n, void* out) {                    \
+                 int* idx = f.temp<int>(tmp);                       \
+                 index_fn(f, n, idx);                               \
+                 const Type* p = static_cast<const Type*>(f.buffers[buf]); \
+                 Type* o = static_cast<Type*>(out);                 \
+                 if (masked) {                                      \
+                   int* m = f.temp<int>(tmp + 1);                   \
+                   mask_fn(f, n, m);                                \
+                   for (int i = 0; i < n; i++) {                    \
+                     o[i] = m[i] ? p[idx[i]] : Type(0);             \
+                   }                                                \
+                 } else {                                           \
+                   for (int i = 0; i < n; i++) {                    \
+                     o[i] = p[idx[i]];                              \
+                   }                                                \
+                 }                                                  \
+               },                                                   \
+               varying};                                            \
+    }                                                               \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+void ClosureCompiler::visit(const IfThenElse* v) {
+  // Temporaries: tmp holds the condition.
+  int tmp = useTemps(1);
+  CompiledExpr cond = compileExpr(v->condition(), tmp + 1);
+  CompiledExpr true_value = compileExpr(v->true_value(), tmp + 1);
+  CompiledExpr false_value = compileExpr(v->false_value(), tmp + 1);
+  if (cond.type != ScalarType::Int) {
+    throw unsupported_dtype();
+  }
+  if (true_value.type != false_value.type) {
+    throw malformed_input("bad dtype in IfThenElse", v);
+  }
+  bool varying = cond.varying || true_value.varying || false_value.varying;
+  ExprFn cond_fn = cond.fn;
+  ExprFn true_fn = varying ? asVarying(true_value) : true_value.fn;
+  ExprFn false_fn = varying ? asVarying(false_value) : false_value.fn;
+
+  if (!cond.varying) {
+    expr_ = {true_value.type,
+             [cond_fn, true_fn, false_fn, tmp](Frame& f, int n, void* out) {
+               int* c = f.temp<int>(tmp);
+               cond_fn(f, 1, c);
+               if (c[0]) {
+                 true_fn(f, n, out);
+               } else {
+                 false_fn(f, n, out);
+               }
+             },
+             varying};
+    return;
+  }
+
+  // Only the selected value may be evaluated for a lane: the other one can
+  // e.g. load out of bounds. Split the block into runs of lanes with the
+  // same condition and evaluate each run on its own, by shifting the first
+  // iteration of the block to the start of the run.
+  size_t elem_size = elementSize(true_value.type);
+  int slot = vec_slot_;
+  expr_ = {true_value.type,
+           [cond_fn, true_fn, false_fn, tmp, slot, elem_size](
+               Frame& f, int n, void* out) {
+             int* c = f.temp<int>(tmp);
+             cond_fn(f, n, c);
+             int* base = f.var<int>(slot);
+             const int block_start = *base;
+             int start = 0;
+             while (start < n) {
+               const bool taken = c[start] != 0;
+               int end = start + 1;
+               while (end < n && (c[end] != 0) == taken) {
+                 end++;
+               }
+               *base = block_start + start;
+               char* run_out = static_cast<char*>(out) + start * elem_size;
+               if (taken) {
+                 true_fn(f, end - start, run_out);
+               } else {
+                 false_fn(f, end - start, run_out);
+               }
+               start = end;
+             }
+             *base = block_start;
+           },
+           true};
+}
+
+void ClosureCompiler::visit(const Intrinsics* v) {
+  int tmp = useTemps(1);
+  std::vector<CompiledExpr> params;
+  for (int i = 0; i < v->nparams(); i++) {
+    params.push_back(compileExpr(v->param(i), i == 0 ? tmp : tmp + 1));
+  }
+  if (params.empty() || params.size() > 2) {
+    throw unimplemented_lowering(v);
+  }
+  ScalarType type = params[0].type;
+  if (params.size() == 2 && params[1].type != type) {
+    throw malformed_input("bad dtype in Intrinsics", v);
+  }
+  bool varying = params[0].varying || (params.size() == 2 && params[1].varying);
+  switch (type) {
+#define TYPE_CASE(Type, Name)                                          \
+  case ScalarType::Name:                                               \
+    if (params.size() == 1) {                                          \
+      expr_ = {type, intrinsicLanes<Type>(v->op_type(), params[0].fn), \
+               varying};                                               \
+    } else {                                                           \
+      expr_ = {type,                                                   \
+               intrinsicLanes<Type>(                                   \
+                   v->op_type(), params[0], params[1], tmp),           \
+               varying};                                               \
+    }                                                                  \
+    break;
+    TYPE_CASE(float, Float)
+    TYPE_CASE(double, Double)
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+void ClosureCompiler::visit(const Block* v) {
+  std::vector<std::pair<int, ExprFn>> bindings;
+  for (const auto& pair : v->varBindings()) {
+    ExprFn fn = compileExpr(pair.second, tmp_).fn;
+    bindings.emplace_back(bindVar(pair.first), fn);
+  }
+  std::vector<StmtFn> stmts;
+  for (Stmt* s : v->stmts()) {
+    stmts.push_back(compileStmt(s, tmp_));
+  }
+  for (const auto& pair : v->varBindings()) {
+    unbindVar(pair.first);
+  }
+
+  if (bindings.empty() && stmts.size() == 1) {
+    stmt_ = stmts[0];
+    return;
+  }
+  stmt_ = [bindings, stmts](Frame& f, int n) {
+    for (const auto& binding : bindings) {
+      binding.second(f, 1, f.var<void>(binding.first));
+    }
+    for (const auto& s : stmts) {
+      s(f, n);
+    }
+  };
+}
+
+void ClosureCompiler::visit(const For* v) {
+  if (v->var()->dtype() != kInt) {
+    throw unsupported_dtype();
+  }
+  int tmp = useTemps(1);
+  std::function<int(Frame&)> start = compileInt(v->start(), tmp);
+  std::function<int(Frame&)> stop = compileInt(v->stop(), tmp);
+  int slot = bindVar(v->var());
+
+  if (!vec_var_ && isVectorizable(v)) {
+    vec_var_ = v->var();
+    vec_slot_ = slot;
+    StmtFn body = compileStmt(v->body(), tmp_);
+    vec_var_ = nullptr;
+    vec_slot_ = -1;
+    unbindVar(v->var());
+    stmt_ = [start, stop, body, slot](Frame& f, int /*n*/) {
+      const int begin = start(f);
+      const int end = stop(f);
+      int* var = f.var<int>(slot);
+      for (int i = begin; i < end; i += kBlockSize) {
+        *var = i;
+        body(f, std::min(kBlockSize, end - i));
+      }
+    };
+    return;
+  }
+
+  StmtFn body = compileStmt(v->body(), tmp_);
+  unbindVar(v->var());
+  stmt_ = [start, stop, body, slot](Frame& f, int /*n*/) {
+    const int begin = start(f);
+    const int end = stop(f);
+    int* var = f.var<int>(slot);
+    for (int i = begin; i < end; i++) {
+      *var = i;
+      body(f, 1);
+    }
+  };
+}
+
+void ClosureCompiler::visit(const Store* v) {
+  // Temporaries: tmp holds the index, tmp + 1 the value, tmp + 2 the mask.
+  int tmp = useTemps(3);
+  int buf = bufferSlot(v->base_handle());
+  const Expr* flat_idx = flatten_index(v->buf()->dims(), v->indices());
+  if (flat_idx->dtype() != kInt) {
+    throw unsupported_dtype();
+  }
+  CompiledExpr index = compileExpr(flat_idx, tmp + 3);
+  CompiledExpr value = compileExpr(v->value(), tmp + 3);
+  bool masked = !isConstantOne(v->mask());
+  CompiledExpr mask;
+  if (masked) {
+    mask = compileExpr(v->mask(), tmp + 3);
+    if (mask.type != ScalarType::Int) {
+      throw unsupported_dtype();
+    }
+  }
+  bool contiguous = !masked && vec_var_ &&
+      laneStride(flat_idx, vec_var_) == c10::optional<int64_t>(1);
+  ScalarType type = value.type;
+
+  ExprFn index_fn = asVarying(index);
+  ExprFn value_fn = asVarying(value);
+  ExprFn mask_fn = masked ? asVarying(mask) : nullptr;
+  switch (type) {
+#define TYPE_CASE(Type, Name)                                                \
+  case ScalarType::Name:                                                     \
+    if (contiguous) {                                                        \
+      stmt_ = [index_fn, value_fn, buf, tmp](Frame& f, int n) {              \
+        int* idx = f.temp<int>(tmp);                                         \
+        Type* val = f.temp<Type>(tmp + 1);                                   \
+        index_fn(f, 1, idx);                                                 \
+        value_fn(f, n, val);                                                 \
+        Type* p = static_cast<Type*>(f.buffers[buf]) + idx[0];               \
+        for (int i = 0; i < n; i++) {                                        \
+          p[i] = val[i];                                                     \
+        }                                                                    \
+      };                                                                     \
+    } else {                                                                 \
+      stmt_ = [index_fn, value_fn, mask_fn, masked, buf, tmp](               \
+                  Frame& f, int n) {                                         \
+        int* idx = f.temp<int>(tmp);                                         \
+        Type* val = f.temp<Type>(tmp + 1);                                   \
+        index_fn(f, n, idx);                                                 \
+        value_fn(f, n, val);                                                 \
+        Type* p = static_cast<Type*>(f.buffers[buf]);                        \
+        if (masked) {                                                        \
+          int* m = f.temp<int>(tmp + 2);                                     \
+          mask_fn(f, n, m);                                                  \
+          for (int i = 0; i < n; i++) {                                      \
+            if (m[i]) {                                                      \
+              p[idx[i]] = val[i];                                            \
+            }                                                                \
+          }                                                                  \
+        } else {                                                             \
+          for (int i = 0; i < n; i++) {                                      \
+            p[idx[i]] = val[i];                                              \
+          }                                                                  \
+        }                                                                    \
+      };                                                                     \
+    }                                                                        \
+    break;
+    AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+    default:
+      throw unsupported_dtype();
+  }
+}
+
+void ClosureCompiler::visit(const Cond* v) {
+  int tmp = useTemps(1);
+  CompiledExpr cond = compileExpr(v->condition(), tmp + 1);
+  if (cond.type != ScalarType::Int) {
+    throw unsupported_dtype();
+  }
+  if (cond.varying) {
+    throw malformed_input("Cond depends on a vectorized loop", v);
+  }
+  ExprFn cond_fn = cond.fn;
+  StmtFn true_stmt =
+      v->true_stmt() ? compileStmt(v->true_stmt(), tmp_) : nullptr;
+  StmtFn false_stmt =
+      v->false_stmt() ? compileStmt(v->false_stmt(), tmp_) : nullptr;
+  stmt_ = [cond_fn, true_stmt, false_stmt, tmp](Frame& f, int n) {
+    int* c = f.temp<int>(tmp);
+    cond_fn(f, 1, c);
+    if (c[0]) {
+      if (true_stmt) {
+        true_stmt(f, n);
+      }
+    } else if (false_stmt) {
+      false_stmt(f, n);
+    }
+  };
+}
+
+void ClosureCompiler::visit(const Allocate* v) {
+  const Var* buffer_var = v->buffer_var();
+  if (buffer_slots_.count(buffer_var)) {
+    throw std::runtime_error(
+        "Allocate a buffer that has already been allocated: " +
+        buffer_var->name_hint());
+  }
+  int tmp = useTemps(1);
+  std::vector<std::function<int(Frame&)>> dims;
+  for (const Expr* dim : v->dims()) {
+    dims.push_back(compileInt(dim, tmp));
+  }
+  int slot = program_->num_buffers++;
+  buffer_slots_[buffer_var] = slot;
+  int64_t elem_size = v->dtype().byte_size();
+  stmt_ = [dims, slot, elem_size](Frame& f, int /*n*/) {
+    int64_t total_byte_size = elem_size;
+    for (const auto& dim : dims) {
+      total_byte_size *= dim(f);
+    }
+    f.allocations[slot].reset(
+        new uint64_t[(total_byte_size + sizeof(uint64_t) - 1) / sizeof(uint64_t)]);
+    f.buffers[slot] = f.allocations[slot].get();
+  };
+}
+
+void ClosureCompiler::visit(const Free* v) {
+  const Var* buffer_var = v->buffer_var();
+  auto it = buffer_slots_.find(buffer_var);
+  if (it == buffer_slots_.end()) {
+    throw std::runtime_error(
+        "Free a buffer that is not currently bound: " +
+        buffer_var->name_hint());
+  }
+  int slot = it->second;
+  buffer_slots_.erase(it);
+  stmt_ = [slot](Frame& f, int /*n*/) {
+    f.allocations[slot].reset();
+    f.buffers[slot] = nullptr;
+  };
+}
+
+} // namespace
+
+ClosureIREvaluator::ClosureIREvaluator(
+    Stmt* stmt,
+    const std::vector<BufferArg>& buffer_args,
+    at::Device device)
+    : CodeGen(stmt, buffer_args, device) {
+  compile();
+}
+
+ClosureIREvaluator::~ClosureIREvaluator() {}
+
+void ClosureIREvaluator::compile() {
+  GenericIntrinsicsExpander intrinsics_expander;
+  apply_mutator(&intrinsics_expander);
+
+  try {
+    std::unique_ptr<Program> program(new Program());
+    ClosureCompiler compiler(program.get());
+    compiler.bindArgs(buffer_args());
+    program->body = compiler.compileStmt(stmt(), 0);
+    program_ = std::move(program);
+  } catch (const unimplemented_lowering&) {
+    fallback_.reset(new SimpleIREvaluator(stmt(), buffer_args(), device()));
+  } catch (const unsupported_dtype&) {
+    fallback_.reset(new SimpleIREvaluator(stmt(), buffer_args(), device()));
+  }
+}
+
+void ClosureIREvaluator::call(const std::vector<CallArg>& args) {
+  if (fallback_) {
+    fallback_->call(args);
+    return;
+  }
+  if (args.size() != buffer_args().size()) {
+    throw malformed_input("bad args in ClosureIREvaluator call");
+  }
+
+  Frame frame(program_->num_vars, program_->num_temps, program_->num_buffers);
+  for (size_t i = 0; i < args.size(); i++) {
+    const Program::ArgBinding& binding = program_->args[i];
+    if (!binding.is_var) {
+      frame.buffers[binding.slot] = args[i].data();
+      continue;
+    }
+    switch (binding.type) {
+#define TYPE_CASE(Type, Name)                                  \
+  case ScalarType::Name:                                       \
+    *frame.var<Type>(binding.slot) = args[i].Name##Data();     \
+    break;
+      AT_FORALL_SCALAR_TYPES_AND2(Bool, Half, TYPE_CASE);
+#undef TYPE_CASE
+      default:
+        throw unsupported_dtype();
+    }
+  }
+  program_->body(frame, 1);
+  USE_TRIGGER(closure_ir_eval_executed);
+}
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/tensorexpr/codegen.h>
+#include <torch/csrc/jit/tensorexpr/eval.h>
+
+namespace torch {
+namespace jit {
+namespace tensorexpr {
+
+// A CPU code generator that does not need LLVM.
+//
+// Instead of walking the IR for every element like SimpleIREvaluator, the
+// statement is compiled once into a tree of closures. Innermost loops whose
+// iterations are independent are run a block of iterations at a time: every
+// expression node computes all lanes of the block in one tight loop over
+// plain arrays, which the C++ compiler can vectorize, and contiguous loads and
+// stores become straight array copies. Other loops run one iteration at a
+// time through the same closures.
+//
+// Statements that use IR the closure compiler does not handle (e.g. vector
+// dtypes, random numbers or reductions that were not lowered) are run by a
+// SimpleIREvaluator instead; isFallback() reports when this happens.
+//
+// Calls do not share mutable state, so one instance can be called from
+// several threads at once.
+class TORCH_API ClosureIREvaluator : public CodeGen {
+ public:
+  template <typename... Ts>
+  ClosureIREvaluator(Stmt* stmt, Ts... ts)
+      : ClosureIREvaluator(stmt, std::vector<BufferArg>({BufferArg(ts)...})) {}
+
+  ClosureIREvaluator(
+      Stmt* stmt,
+      const std::vector<BufferArg>& buffer_args,
+      at::Device device = at::kCPU);
+
+  ~ClosureIREvaluator() override;
+
+  TORCH_API void call(const std::vector<CallArg>& args) override;
+
+  template <typename... Ts>
+  void operator()(const Ts&... ts) {
+    std::vector<CallArg> args({CallArg(ts)...});
+    call(args);
+  }
+
+  bool isFallback() const {
+    return fallback_ != nullptr;
+  }
+
+  // The number of loop iterations a vectorized loop processes per step.
+  static constexpr int kBlockSize = 64;
+
+  struct Program;
+
+ private:
+  void compile();
+
+  std::unique_ptr<Program> program_;
+  std::unique_ptr<SimpleIREvaluator> fallback_;
+};
+
+} // namespace tensorexpr
+} // namespace jit
+} // namespace torch
@@ -3,9 +3,11 @@
 #include <c10/util/string_utils.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/tensorexpr/analysis.h>
+#include <torch/csrc/jit/tensorexpr/closure_eval.h>
 #include <torch/csrc/jit/tensorexpr/ir_printer.h>
 #include <torch/csrc/jit/tensorexpr/ir_simplifier.h>
 #include <torch/csrc/jit/tensorexpr/loopnest.h>
+#include <torch/csrc/jit/tensorexpr/var_substitutor.h>
 
 using namespace torch::jit;
 using namespace torch::jit::tensorexpr;
@@ -413,6 +415,168 @@ Tensor* TensorExprKernel::computeFourOperand(
       });
 }
 
+static size_t normalizeDim(int64_t dim, size_t rank) {
+  if (dim < 0) {
+    dim += rank;
+  }
+  if (dim < 0 || dim >= static_cast<int64_t>(rank)) {
+    throw malformed_input("dimension out of range");
+  }
+  return dim;
+}
+
+// Returns the dimensions of the input reduced by a sum, mean or max node. A
+// node without a dimension argument, or with an empty list, reduces all of
+// them.
+static std::vector<size_t> reductionDims(
+    const torch::jit::Node* n,
+    size_t rank) {
+  std::vector<size_t> dims;
+  if (n->inputs().size() > 2) {
+    auto dimArg = toIValue(n->inputs()[1]);
+    if (!dimArg) {
+      throw malformed_input("reduction dimensions are not constant");
+    }
+    if (dimArg->isInt()) {
+      dims.push_back(normalizeDim(dimArg->toInt(), rank));
+    } else {
+      for (int64_t dim : dimArg->toIntVector()) {
+        dims.push_back(normalizeDim(dim, rank));
+      }
+    }
+  }
+  if (dims.empty()) {
+    for (size_t i = 0; i < rank; i++) {
+      dims.push_back(i);
+    }
+  }
+  std::sort(dims.begin(), dims.end());
+  dims.erase(std::unique(dims.begin(), dims.end()), dims.end());
+  return dims;
+}
+
+static bool reductionKeepdim(const torch::jit::Node* n) {
+  if (n->inputs().size() <= 2) {
+    return false;
+  }
+  auto keepdim = toIValue(n->inputs()[2]);
+  if (!keepdim || !keepdim->isBool()) {
+    throw malformed_input("keepdim is not a constant bool");
+  }
+  return keepdim->toBool();
+}
+
+Tensor* TensorExprKernel::computeReduction(
+    const std::string& name,
+    const torch::jit::Value* input,
+    const std::vector<size_t>& reduceDims,
+    bool keepdim,
+    const Reducer& reducer,
+    const std::function<ExprHandle(const std::vector<ExprHandle>&)>& body) {
+  std::vector<ExprHandle> inputShape = valueShape(input);
+  std::vector<bool> reduced(inputShape.size(), false);
+  for (size_t dim : reduceDims) {
+    reduced.at(dim) = true;
+  }
+
+  std::vector<DimArg> outputArgs;
+  std::vector<DimArg> reduceArgs;
+  for (size_t i = 0; i < inputShape.size(); i++) {
+    std::string axisName = "i" + c10::to_string(i);
+    if (!reduced[i]) {
+      outputArgs.emplace_back(DimArg(inputShape[i], axisName));
+      continue;
+    }
+    reduceArgs.emplace_back(DimArg(inputShape[i], "r" + c10::to_string(i)));
+    if (keepdim) {
+      outputArgs.emplace_back(DimArg(IntImm::make(1), axisName));
+    }
+  }
+
+  size_t nOutputArgs = outputArgs.size();
+  std::function<ExprHandle(ParameterList&)> reduceBody =
+      [reduced, keepdim, nOutputArgs, body](ParameterList& vars) {
+        // `vars` holds the output axes followed by the reduction axes.
+        std::vector<ExprHandle> axes;
+        size_t outputIdx = 0;
+        size_t reduceIdx = nOutputArgs;
+        for (size_t i = 0; i < reduced.size(); i++) {
+          if (!reduced[i]) {
+            axes.push_back(vars[outputIdx++]);
+            continue;
+          }
+          axes.push_back(vars[reduceIdx++]);
+          if (keepdim) {
+            outputIdx++;
+          }
+        }
+        return body(axes);
+      };
+
+  Tensor* t = Reduce(name, outputArgs, reducer, reduceBody, reduceArgs);
+  if (!reduced.empty() && reduced.back()) {
+    innerReductions_.push_back(t);
+  }
+  return t;
+}
+
+Tensor* TensorExprKernel::computeSoftmax(
+    const torch::jit::Value* v,
+    bool logSoftmax) {
+  // Softmax is computed as
+  //   m = max(x, dim)
+  //   s = sum(exp(x - m), dim)
+  //   softmax(x) = exp(x - m) / s
+  //   log_softmax(x) = x - m - log(s)
+  // The two reductions are intermediate tensors; exp(x - m) is recomputed in
+  // the final loop rather than stored.
+  auto const& n = v->node();
+  const torch::jit::Value* input = n->inputs()[0];
+  size_t rank = valueShape(input).size();
+  size_t dim = normalizeDim(
+      constant(n->inputs()[1]).AsNode<IntImm>()->value(), rank);
+  auto outerAxes = [dim](const std::vector<ExprHandle>& axes) {
+    std::vector<ExprHandle> outer(axes);
+    outer.erase(outer.begin() + dim);
+    return outer;
+  };
+
+  Tensor* maxValues = computeReduction(
+      "aten_softmax_max",
+      input,
+      {dim},
+      false,
+      Maximum(ExprHandle(-std::numeric_limits<float>::infinity())),
+      [this, input](const std::vector<ExprHandle>& axes) {
+        return tensorOrConstant(input, axes);
+      });
+  Tensor* expSums = computeReduction(
+      "aten_softmax_sum",
+      input,
+      {dim},
+      false,
+      Sum(),
+      [this, input, maxValues, outerAxes](const std::vector<ExprHandle>& axes) {
+        return exp(
+            tensorOrConstant(input, axes) - maxValues->call(outerAxes(axes)));
+      });
+
+  return Compute(
+      logSoftmax ? "aten_log_softmax" : "aten_softmax",
+      texprDims(v),
+      [this, input, maxValues, expSums, outerAxes, logSoftmax](
+          const std::vector<VarHandle>& axes) {
+        std::vector<ExprHandle> inputAxes(axes.begin(), axes.end());
+        std::vector<ExprHandle> reducedAxes = outerAxes(inputAxes);
+        ExprHandle shifted =
+            tensorOrConstant(input, inputAxes) - maxValues->call(reducedAxes);
+        if (logSoftmax) {
+          return shifted - log(expSums->call(reducedAxes));
+        }
+        return exp(shifted) / expSums->call(reducedAxes);
+      });
+}
+
 Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
   switch (v->node()->kind()) {
     case aten::add: {
@@ -551,10 +715,73 @@ Tensor* TensorExprKernel::computeValue(const torch::jit::Value* v) {
     } break;
 
     case aten::max: {
-      return computeTwoOperand(
-          "aten_max", v, [](const ExprHandle& lhs, const ExprHandle& rhs) {
-            return Max::make(lhs, rhs, false);
+      if (v->node()->inputs().size() == 2) {
+        return computeTwoOperand(
+            "aten_max", v, [](const ExprHandle& lhs, const ExprHandle& rhs) {
+              return Max::make(lhs, rhs, false);
+            });
+      }
+      auto const& n = v->node();
+      const torch::jit::Value* input = n->inputs()[0];
+      size_t rank = valueShape(input).size();
+      return computeReduction(
+          "aten_max",
+          input,
+          reductionDims(n, rank),
+          reductionKeepdim(n),
+          Maximum(ExprHandle(-std::numeric_limits<float>::infinity())),
+          [this, input](const std::vector<ExprHandle>& axes) {
+            return tensorOrConstant(input, axes);
+          });
+    } break;
+
+    case aten::sum: {
+      auto const& n = v->node();
+      const torch::jit::Value* input = n->inputs()[0];
+      size_t rank = valueShape(input).size();
+      return computeReduction(
+          "aten_sum",
+          input,
+          reductionDims(n, rank),
+          reductionKeepdim(n),
+          Sum(),
+          [this, input](const std::vector<ExprHandle>& axes) {
+            return tensorOrConstant(input, axes);
+          });
+    } break;
+
+    case aten::mean: {
+      auto const& n = v->node();
+      const torch::jit::Value* input = n->inputs()[0];
+      std::vector<ExprHandle> inputShape = valueShape(input);
+      std::vector<size_t> dims = reductionDims(n, inputShape.size());
+      int64_t count = 1;
+      for (size_t dim : dims) {
+        count *= inputShape[dim].AsNode<IntImm>()->value();
+      }
+      Tensor* sum = computeReduction(
+          "aten_mean_sum",
+          input,
+          dims,
+          reductionKeepdim(n),
+          Sum(),
+          [this, input](const std::vector<ExprHandle>& axes) {
+            return tensorOrConstant(input, axes);
           });
+      return Compute(
+          "aten_mean",
+          texprDims(v),
+          [sum, count](const std::vector<VarHandle>& axes) {
+            return sum->call(axes) / FloatImm::make(static_cast<float>(count));
+          });
+    } break;
+
+    case aten::softmax: {
+      return computeSoftmax(v, false);
+    } break;
+
+    case aten::log_softmax: {
+      return computeSoftmax(v, true);
     } break;
 
     case aten::clamp: {
@@ -1018,14 +1245,65 @@ void TensorExprKernel::flattenTensors(BackendType backendType) {
   }
 }
 
+static const int kBodyVectorWidth = 8;
+
+// Splits the innermost reduction loop of `t` by `width` and rfactors the
+// reduction over the split-off inner index. The partial results are then
+// accumulated by a loop that writes a different element on each iteration,
+//
+//   for (n_outer) for (n_inner) t_rfac[n_inner] += x[n_outer * width + n_inner]
+//   for (n_inner) t += t_rfac[n_inner]
+//
+// so the inner loop of the first nest can be vectorized.
+static void rfactorInnerReduction(LoopNest& l, Tensor* t, int width) {
+  std::vector<For*> loops = l.getLoopStmtsFor(t);
+  if (loops.empty()) {
+    return;
+  }
+  const IntImm* extent = dynamic_cast<const IntImm*>(loops.back()->stop());
+  if (!extent || extent->value() < 2 * width) {
+    return;
+  }
+
+  For* outer;
+  For* inner;
+  For* tail;
+  l.splitWithTail(loops.back(), width, &outer, &inner, &tail);
+  for (ReduceOp* reduce : NodeFinder<ReduceOp>::find(outer)) {
+    if (reduce->accumulator() == t->buf()) {
+      l.rfactor(reduce, inner->var());
+      return;
+    }
+  }
+}
+
+// Returns true if some store in the loop does not depend on the loop
+// variable, i.e. the loop accumulates into the same element on every
+// iteration. Such loops must not be vectorized.
+static bool isReductionLoop(For* f) {
+  VarFinder varFinder;
+  for (Store* store : NodeFinder<Store>::find(f->body())) {
+    bool dependsOnLoopVar = false;
+    for (const Expr* index : store->indices()) {
+      dependsOnLoopVar |= varFinder.findVars(index).count(f->var()) > 0;
+    }
+    if (!dependsOnLoopVar) {
+      return true;
+    }
+  }
+  return false;
+}
+
 Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
   flattenTensors(backendType);
 
   torch::jit::tensorexpr::LoopNest l(flatTensorOutputs_);
 
-  // Compute non-output tensors_ inline
+  // Compute non-output tensors_ inline, except reductions: inlining those
+  // would repeat the whole reduction for every element of the consumer.
   for (auto& p : tensors_) {
-    if (!l.hasLoopBodyFor(p.second)) {
+    if (!l.hasLoopBodyFor(p.second) ||
+        dynamic_cast<const ReduceOp*>(p.second->body())) {
       continue;
     }
     Stmt* loop = l.getLoopBodyFor(p.second);
@@ -1082,6 +1360,14 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
     }
   }
 
+  if (backendType == kLLVMCodeGen || backendType == kClosureIREval) {
+    int width = backendType == kLLVMCodeGen ? kBodyVectorWidth
+                                            : ClosureIREvaluator::kBlockSize;
+    for (Tensor* t : innerReductions_) {
+      rfactorInnerReduction(l, t, width);
+    }
+  }
+
   l.prepareForCodegen();
 
   if (backendType == kLLVMCodeGen) {
@@ -1123,7 +1409,7 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
         }
       }
 
-      if (!containsSubLoops) {
+      if (!containsSubLoops && !isReductionLoop(f)) {
         innerLoops.push_back(f);
       }
     }
@@ -1134,7 +1420,6 @@ Stmt* TensorExprKernel::generateStmt(BackendType backendType) {
       For* split1;
       For* tail1;
 
-      static const int kBodyVectorWidth = 8;
       l.splitWithTail(loop, kBodyVectorWidth, &outer1, &split1, &tail1);
       l.vectorize(split1);
 
@@ -1163,6 +1448,8 @@ std::string TensorExprKernel::getCodeGenName(BackendType backendType) {
       return "llvm_codegen";
     case kSimpleIREval:
       return "simple_ir_eval";
+    case kClosureIREval:
+      return "closure_ir_eval";
     default:
       throw std::runtime_error(
           "invalid backend type: " +
@@ -1288,7 +1575,7 @@ TensorExprKernel::BackendType TensorExprKernel::inferBackendTypeFromDevice(
 #ifdef TORCH_ENABLE_LLVM
     backendType = kLLVMCodeGen;
 #else
-    backendType = kSimpleIREval;
+    backendType = kClosureIREval;
 #endif
   } else {
     throw std::runtime_error("Invalid device type");
@@ -3,6 +3,7 @@
 #include <torch/csrc/jit/ir/ir.h>
 #include <torch/csrc/jit/runtime/interpreter.h>
 #include <torch/csrc/jit/tensorexpr/codegen.h>
+#include <torch/csrc/jit/tensorexpr/reduction.h>
 #include <torch/csrc/jit/tensorexpr/tensor.h>
 
 namespace torch {
@@ -58,6 +59,7 @@ class TORCH_API TensorExprKernel {
   enum BackendType {
     kUninitialized,
     kSimpleIREval,
+    kClosureIREval,
     kLLVMCodeGen,
     kCudaCodeGen,
   };
@@ -153,6 +155,18 @@ class TORCH_API TensorExprKernel {
           const ExprHandle&,
           const ExprHandle&)>& innerExpr);
 
+  // Reduces `input` over `reduceDims` with `reducer`. `body` maps a full set
+  // of input axes to the value being reduced.
+  Tensor* computeReduction(
+      const std::string& name,
+      const torch::jit::Value* input,
+      const std::vector<size_t>& reduceDims,
+      bool keepdim,
+      const Reducer& reducer,
+      const std::function<ExprHandle(const std::vector<ExprHandle>&)>& body);
+
+  Tensor* computeSoftmax(const torch::jit::Value* v, bool logSoftmax);
+
   Tensor* computeValue(const torch::jit::Value* v);
 
   void flattenTensors(BackendType backendType);
@@ -210,6 +224,9 @@ class TORCH_API TensorExprKernel {
   std::vector<Tensor*> flatTensorOutputs_;
   std::unordered_map<int64_t, Tensor*> tensors_;
   std::unordered_map<int64_t, VarHandle> scalars_;
+  // Reductions over the innermost dimension of their input. These are
+  // rfactored in generateStmt so that the partial results can be vectorized.
+  std::vector<Tensor*> innerReductions_;
   std::unique_ptr<CodeGen> codegen_;
   at::Device device_ = at::kCPU;
   KernelArena kernelArena_;
@@ -87,4 +87,25 @@ bool HashStore::check(const std::vector<std::string>& keys) {
   return true;
 }
 
+std::vector<uint8_t> HashStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::unique_lock<std::mutex> lock(m_);
+  auto it = map_.find(key);
+  if (it == map_.end()) {
+    if (!expectedValue.empty()) {
+      return std::vector<uint8_t>();
+    }
+    map_[key] = desiredValue;
+    cv_.notify_all();
+    return desiredValue;
+  }
+  if (it->second == expectedValue) {
+    it->second = desiredValue;
+    cv_.notify_all();
+  }
+  return it->second;
+}
+
 } // namespace c10d
@@ -52,4 +52,24 @@ void PrefixStore::wait(
   store_->wait(joinedKeys, timeout);
 }
 
+std::vector<uint8_t> PrefixStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  return store_->compareSet(joinKey(key), expectedValue, desiredValue);
+}
+
+std::vector<std::vector<uint8_t>> PrefixStore::multiGet(
+    const std::vector<std::string>& keys) {
+  auto joinedKeys = joinKeys(keys);
+  return store_->multiGet(joinedKeys);
+}
+
+void PrefixStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  auto joinedKeys = joinKeys(keys);
+  store_->multiSet(joinedKeys, values);
+}
+
 } // namespace c10d
@@ -48,12 +48,66 @@ void ProcessGroup::Work::abort() {
   TORCH_CHECK(false, "ProcessGroup::Work::abort not implemented.")
 }
 
+namespace {
+
+void completeFuture(
+    const c10::intrusive_ptr<c10::ivalue::Future>& future,
+    const std::exception_ptr& exception) {
+  if (!exception) {
+    future->markCompleted();
+    return;
+  }
+  try {
+    std::rethrow_exception(exception);
+  } catch (const std::exception& e) {
+    future->setError(e.what());
+  } catch (...) {
+    future->setError("Unknown exception in ProcessGroup work");
+  }
+}
+
+} // namespace
+
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroup::Work::getFuture() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (future_) {
+    return future_;
+  }
+  future_ = c10::make_intrusive<c10::ivalue::Future>(c10::NoneType::get());
+  auto future = future_;
+  if (completed_) {
+    // finish() has already run and won't complete the future.
+    auto exception = exception_;
+    lock.unlock();
+    completeFuture(future, exception);
+  }
+  return future;
+}
+
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroup::Work::
+    getFutureAfterWait() {
+  auto future =
+      c10::make_intrusive<c10::ivalue::Future>(c10::NoneType::get());
+  std::exception_ptr exception;
+  try {
+    wait();
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  completeFuture(future, exception);
+  return future;
+}
+
 void ProcessGroup::Work::finish(std::exception_ptr exception) {
   std::unique_lock<std::mutex> lock(mutex_);
   completed_ = true;
   exception_ = exception;
+  auto future = future_;
   lock.unlock();
   cv_.notify_all();
+  if (future) {
+    completeFuture(future, exception);
+  }
 }
 
 ProcessGroup::ProcessGroup(int rank, int size) : rank_(rank), size_(size) {
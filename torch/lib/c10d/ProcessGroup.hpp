@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
@@ -8,11 +9,17 @@
 #include <vector>
 
 #include <ATen/ATen.h>
+#include <ATen/core/ivalue.h>
 
 #include <c10d/Types.hpp>
 
 namespace c10d {
 
+// Default timeout of the process groups, the same as default_pg_timeout in
+// torch/distributed/constants.py.
+constexpr auto kProcessGroupDefaultTimeout =
+    std::chrono::milliseconds(30 * 60 * 1000);
+
 // ProcessGroup is a base class that captures collective and point to
 // point communication in a fixed set of processes.
 //
@@ -87,13 +94,27 @@ class ProcessGroup {
 
     virtual void abort();
 
+    // Returns a Future that is marked completed (without a value) when this
+    // work completes, or that is set to its error. Callbacks added to the
+    // Future run on the thread that completes the work.
+    //
+    // The default implementation relies on the work being completed through
+    // finish(). Work types that complete in some other way override this,
+    // usually with getFutureAfterWait().
+    virtual c10::intrusive_ptr<c10::ivalue::Future> getFuture();
+
    protected:
     void finish(std::exception_ptr exception = nullptr);
 
+    // Waits for this work and returns a completed Future.
+    c10::intrusive_ptr<c10::ivalue::Future> getFutureAfterWait();
+
     mutable std::mutex mutex_;
     std::condition_variable cv_;
     bool completed_ = false;
     std::exception_ptr exception_;
+    // Created by getFuture(); completed by finish().
+    c10::intrusive_ptr<c10::ivalue::Future> future_;
   };
 
   explicit ProcessGroup(int rank, int size);
@@ -7,6 +7,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <type_traits>
 
 #include <gloo/allgather.h>
@@ -17,6 +18,7 @@
 #include <gloo/gather.h>
 #include <gloo/reduce.h>
 #include <gloo/scatter.h>
+#include <gloo/types.h>
 
 #include <ATen/SparseTensorUtils.h>
 
@@ -356,6 +358,11 @@ void ProcessGroupGloo::SendWork::abort() {
   buffer_->abortWaitSend();
 }
 
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupGloo::SendWork::
+    getFuture() {
+  return getFutureAfterWait();
+}
+
 ProcessGroupGloo::RecvWork::RecvWork(
     at::Tensor& tensor,
     std::unique_ptr<::gloo::transport::UnboundBuffer> buffer)
@@ -389,6 +396,11 @@ void ProcessGroupGloo::RecvWork::abort() {
   buffer_->abortWaitRecv();
 }
 
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupGloo::RecvWork::
+    getFuture() {
+  return getFutureAfterWait();
+}
+
 ProcessGroupGloo::Options::Options()
     : timeout(std::chrono::milliseconds(10 * 1000)), threads(2) {}
 
@@ -2239,11 +2251,392 @@ std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::scatter(
   return work;
 }
 
+namespace {
+
+// Slot prefixes of the collectives below that are implemented on top of
+// unbound buffers. Point-to-point operations use the user specified tag as
+// slot, so a non-zero prefix keeps their messages apart.
+constexpr uint8_t kReduceScatterSlotPrefix = 0x40;
+constexpr uint8_t kAlltoallSlotPrefix = 0x41;
+
+// Ring reduce-scatter. The inputs are flattened into a single buffer of
+// `size` chunks, where chunk i is the input for rank i. In step k every
+// process sends chunk (rank - k - 1) to its right neighbor and reduces
+// chunk (rank - k - 2), received from its left neighbor, into its own copy.
+// After size - 1 steps chunk `rank` holds the reduction of all processes.
+// Every process sends and receives (size - 1) / size of the input, which
+// is half of what an allreduce of the same input moves. The chunks don't
+// need to have the same size, but every process has to agree on them.
+class AsyncReduceScatterWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncReduceScatterWork(
+      const std::shared_ptr<gloo::Context>& context,
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      ReduceOp reduceOp,
+      uint32_t tag)
+      : context(context),
+        outputs(outputs),
+        inputs(inputs),
+        reduceOp(reduceOp),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  std::vector<at::Tensor> outputs;
+  std::vector<std::vector<at::Tensor>> inputs;
+  const ReduceOp reduceOp;
+  const uint32_t tag;
+
+  void reduceScatter(at::Tensor& output, std::vector<at::Tensor>& inputs) {
+    const auto rank = context->rank;
+    const auto size = context->size;
+    std::vector<int64_t> lengths(size);
+    std::vector<int64_t> offsets(size);
+    const auto numel = computeLengthsAndOffsets(inputs, &lengths, &offsets);
+    if (size == 1 || numel == 0) {
+      output.copy_(inputs[rank].reshape(output.sizes()));
+      return;
+    }
+
+    // The chunks are reduced in place, so always work on a copy.
+    at::Tensor flat = at::cat(fmap(inputs, [](const at::Tensor& t) {
+      return t.contiguous().view({-1});
+    }));
+    const auto maxLength = *std::max_element(lengths.begin(), lengths.end());
+    at::Tensor recvTensor = at::empty({maxLength}, flat.options());
+    const auto elementSize = flat.element_size();
+    auto fn = getFunction(flat.scalar_type(), reduceOp);
+
+    auto sendBuffer = context->createUnboundBuffer(
+        flat.data_ptr(), flat.numel() * elementSize);
+    auto recvBuffer = context->createUnboundBuffer(
+        recvTensor.data_ptr(), maxLength * elementSize);
+    const auto slot = gloo::Slot::build(kReduceScatterSlotPrefix, tag);
+    const auto left = (rank + size - 1) % size;
+    const auto right = (rank + 1) % size;
+    auto* base = static_cast<uint8_t*>(flat.data_ptr());
+    for (int step = 0; step < size - 1; step++) {
+      const auto sendChunk = (rank + 2 * size - step - 1) % size;
+      const auto recvChunk = (rank + 2 * size - step - 2) % size;
+      // Empty chunks are skipped by both their sender and their receiver.
+      if (lengths[sendChunk] > 0) {
+        sendBuffer->send(
+            right,
+            slot,
+            offsets[sendChunk] * elementSize,
+            lengths[sendChunk] * elementSize);
+      }
+      if (lengths[recvChunk] > 0) {
+        recvBuffer->recv(left, slot, 0, lengths[recvChunk] * elementSize);
+        recvBuffer->waitRecv();
+        auto* chunk = base + offsets[recvChunk] * elementSize;
+        fn(chunk, chunk, recvTensor.data_ptr(), lengths[recvChunk]);
+      }
+      // The chunk sent in this step is received into in the next one.
+      if (lengths[sendChunk] > 0) {
+        sendBuffer->waitSend();
+      }
+    }
+
+    output.copy_(
+        flat.narrow(0, offsets[rank], lengths[rank]).view(output.sizes()));
+  }
+
+  void run() override {
+    reduceScatter(outputs[0], inputs[0]);
+  }
+
+ protected:
+  template <typename T>
+  void getFunction(ReduceFunc& fn, const ReduceOp op) {
+    fn = toFunction<T>(op);
+  }
+
+  ReduceFunc getFunction(const at::ScalarType& dtype, const ReduceOp op) {
+    ReduceFunc fn;
+    GENERATE_ALL_TYPES(dtype, getFunction, fn, op);
+    return fn;
+  }
+};
+
+} // namespace
+
 std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::reduce_scatter(
     std::vector<at::Tensor>& outputs,
     std::vector<std::vector<at::Tensor>>& inputs,
     const ReduceScatterOptions& opts) {
-  throw std::runtime_error("ProcessGroupGloo does not support reduce_scatter");
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::reduce_scatter: " + msg);
+  };
+
+  assertSingleElementOutput(invalidArgument, outputs);
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, outputs);
+
+  if (inputs.size() != 1) {
+    invalidArgument(c10::str(
+        "requires a single-element input list containing a list with ",
+        getSize(),
+        " tensors"));
+  } else if (inputs[0].size() != static_cast<size_t>(getSize())) {
+    invalidArgument(c10::str(
+        "Incorrect input list size ",
+        inputs[0].size(),
+        ". Input list size should be ",
+        getSize(),
+        ", same as size of the process group."));
+  }
+  assertDense(invalidArgument, inputs[0]);
+  assertTypeMatch(invalidArgument, outputs[0].options(), inputs[0]);
+  assertCPU(invalidArgument, inputs[0]);
+
+  // The inputs for other ranks may have any size, as long as all processes
+  // agree on them. The input for this rank must match the output.
+  const auto& input = inputs[0][getRank()];
+  if (input.numel() != outputs[0].numel()) {
+    invalidArgument(c10::str(
+        "input tensor at index ",
+        getRank(),
+        " must have the same number of elements as the output tensor",
+        " (expected ",
+        outputs[0].numel(),
+        ", got ",
+        input.numel(),
+        ")"));
+  }
+
+  auto tag = nextTag();
+  auto context = getContext(tag);
+  auto work = std::make_shared<AsyncReduceScatterWork>(
+      std::move(context), outputs, inputs, opts.reduceOp, tag);
+  enqueue(work);
+  return work;
+}
+
+namespace {
+
+// Pairwise exchange. In step i every process sends its split for rank + i
+// and receives the split of rank - i, so that every pair of processes talks
+// directly and each process has a single send and receive in flight. The
+// lengths and offsets are in elements of `input` and `output`.
+void alltoallPairwise(
+    const std::shared_ptr<gloo::Context>& context,
+    uint32_t tag,
+    at::Tensor& output,
+    const std::vector<int64_t>& recvLengths,
+    const std::vector<int64_t>& recvOffsets,
+    at::Tensor& input,
+    const std::vector<int64_t>& sendLengths,
+    const std::vector<int64_t>& sendOffsets) {
+  const auto rank = context->rank;
+  const auto size = context->size;
+  const auto elementSize = input.element_size();
+
+  // The split for this process is a local copy.
+  if (sendLengths[rank] > 0) {
+    output.narrow(0, recvOffsets[rank], recvLengths[rank])
+        .copy_(input.narrow(0, sendOffsets[rank], sendLengths[rank]));
+  }
+  if (size == 1) {
+    return;
+  }
+
+  // Unbound buffers are only created for non-empty tensors. Empty splits
+  // are skipped by both their sender and their receiver.
+  std::unique_ptr<::gloo::transport::UnboundBuffer> sendBuffer;
+  std::unique_ptr<::gloo::transport::UnboundBuffer> recvBuffer;
+  if (input.numel() > 0) {
+    sendBuffer = context->createUnboundBuffer(
+        input.data_ptr(), input.numel() * elementSize);
+  }
+  if (output.numel() > 0) {
+    recvBuffer = context->createUnboundBuffer(
+        output.data_ptr(), output.numel() * elementSize);
+  }
+  const auto slot = gloo::Slot::build(kAlltoallSlotPrefix, tag);
+  for (int step = 1; step < size; step++) {
+    const auto dst = (rank + step) % size;
+    const auto src = (rank + size - step) % size;
+    if (sendLengths[dst] > 0) {
+      sendBuffer->send(
+          dst,
+          slot,
+          sendOffsets[dst] * elementSize,
+          sendLengths[dst] * elementSize);
+    }
+    if (recvLengths[src] > 0) {
+      recvBuffer->recv(
+          src,
+          slot,
+          recvOffsets[src] * elementSize,
+          recvLengths[src] * elementSize);
+      recvBuffer->waitRecv();
+    }
+    if (sendLengths[dst] > 0) {
+      sendBuffer->waitSend();
+    }
+  }
+}
+
+class AsyncAlltoallWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncAlltoallWork(
+      const std::shared_ptr<gloo::Context>& context,
+      at::Tensor& output,
+      at::Tensor& input,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      uint32_t tag)
+      : context(context),
+        output(output),
+        input(input),
+        outputSplitSizes(outputSplitSizes),
+        inputSplitSizes(inputSplitSizes),
+        tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  at::Tensor output;
+  at::Tensor input;
+  std::vector<int64_t> outputSplitSizes;
+  std::vector<int64_t> inputSplitSizes;
+  const uint32_t tag;
+
+  void run() override {
+    const auto size = context->size;
+    std::vector<int64_t> sendLengths(size);
+    std::vector<int64_t> sendOffsets(size);
+    std::vector<int64_t> recvLengths(size);
+    std::vector<int64_t> recvOffsets(size);
+    computeLengthsAndOffsets(
+        inputSplitSizes, input, &sendLengths, &sendOffsets);
+    computeLengthsAndOffsets(
+        outputSplitSizes, output, &recvLengths, &recvOffsets);
+    auto flatOutput = output.view({-1});
+    auto flatInput = input.view({-1});
+    alltoallPairwise(
+        context,
+        tag,
+        flatOutput,
+        recvLengths,
+        recvOffsets,
+        flatInput,
+        sendLengths,
+        sendOffsets);
+  }
+};
+
+// Alltoall of tensor lists. The inputs are flattened into a single buffer
+// and the outputs are received into a single buffer and copied out.
+class AsyncAlltoallListWork : public ProcessGroupGloo::AsyncWork {
+ public:
+  AsyncAlltoallListWork(
+      const std::shared_ptr<gloo::Context>& context,
+      std::vector<at::Tensor>& outputs,
+      std::vector<at::Tensor>& inputs,
+      uint32_t tag)
+      : context(context), outputs(outputs), inputs(inputs), tag(tag) {}
+
+  std::shared_ptr<gloo::Context> context;
+  std::vector<at::Tensor> outputs;
+  std::vector<at::Tensor> inputs;
+  const uint32_t tag;
+
+  void run() override {
+    const auto size = context->size;
+    std::vector<int64_t> sendLengths(size);
+    std::vector<int64_t> sendOffsets(size);
+    std::vector<int64_t> recvLengths(size);
+    std::vector<int64_t> recvOffsets(size);
+    computeLengthsAndOffsets(inputs, &sendLengths, &sendOffsets);
+    const auto recvNumel =
+        computeLengthsAndOffsets(outputs, &recvLengths, &recvOffsets);
+
+    at::Tensor flatInput = at::cat(fmap(inputs, [](const at::Tensor& t) {
+      return t.contiguous().view({-1});
+    }));
+    at::Tensor flatOutput = at::empty({recvNumel}, flatInput.options());
+    alltoallPairwise(
+        context,
+        tag,
+        flatOutput,
+        recvLengths,
+        recvOffsets,
+        flatInput,
+        sendLengths,
+        sendOffsets);
+
+    for (int i = 0; i < size; i++) {
+      outputs[i].copy_(flatOutput.narrow(0, recvOffsets[i], recvLengths[i])
+                           .view(outputs[i].sizes()));
+    }
+  }
+};
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::alltoall_base: " + msg);
+  };
+
+  std::vector<at::Tensor> tensors = {outputTensor, inputTensor};
+  assertDense(invalidArgument, tensors);
+  assertCPU(invalidArgument, tensors);
+  assertTypeMatch(invalidArgument, inputTensor.options(), tensors);
+  if (!outputTensor.is_contiguous() || !inputTensor.is_contiguous()) {
+    invalidArgument("requires contiguous input and output tensors");
+  }
+  if (outputTensor.dim() == 0 || inputTensor.dim() == 0) {
+    invalidArgument("requires input and output tensors of at least 1 dim");
+  }
+  checkSplitSizes(inputSplitSizes, inputTensor, size_);
+  checkSplitSizes(outputSplitSizes, outputTensor, size_);
+
+  auto tag = nextTag();
+  auto context = getContext(tag);
+  auto work = std::make_shared<AsyncAlltoallWork>(
+      std::move(context),
+      outputTensor,
+      inputTensor,
+      outputSplitSizes,
+      inputSplitSizes,
+      tag);
+  enqueue(work);
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupGloo::alltoall(
+    std::vector<at::Tensor>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const AllToAllOptions& /* unused */) {
+  static auto invalidArgument = [](const std::string& msg) {
+    throw std::invalid_argument("ProcessGroupGloo::alltoall: " + msg);
+  };
+
+  if (inputs.size() != static_cast<size_t>(size_)) {
+    invalidArgument("number of input tensors is not equal to group size");
+  }
+  if (outputs.size() != static_cast<size_t>(size_)) {
+    invalidArgument("number of output tensors is not equal to group size");
+  }
+  assertDense(invalidArgument, inputs);
+  assertDense(invalidArgument, outputs);
+  assertCPU(invalidArgument, inputs);
+  assertCPU(invalidArgument, outputs);
+  assertTypeMatch(invalidArgument, inputs[0].options(), inputs);
+  assertTypeMatch(invalidArgument, inputs[0].options(), outputs);
+
+  auto tag = nextTag();
+  auto context = getContext(tag);
+  auto work = std::make_shared<AsyncAlltoallListWork>(
+      std::move(context), outputs, inputs, tag);
+  enqueue(work);
+  return work;
 }
 
 at::Tensor& checkSingleTensor(std::vector<at::Tensor>& tensors) {
@@ -0,0 +1,566 @@
+#include <c10d/ProcessGroupHierarchical.hpp>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+
+#include <c10/util/Exception.h>
+#include <c10/util/StringUtil.h>
+#include <c10d/Utils.hpp>
+
+namespace c10d {
+
+namespace {
+
+// Offset of every slot in the shared memory segment is a multiple of this.
+constexpr size_t kSlotAlignment = 64;
+
+// Number of times the barrier polls before it goes to sleep.
+constexpr int kBarrierSpinCount = 1000;
+
+// Shortest time the barrier sleeps for. Used after the deadline passed while
+// the last process to arrive has yet to release the others.
+constexpr std::chrono::milliseconds kBarrierMinSleep(1);
+
+static_assert(
+    ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+    "ProcessGroupHierarchical requires lock-free atomics in shared memory");
+
+// The barrier state packs the generation in the high 32 bits and the number
+// of processes that arrived in this generation in the low 32 bits, so that
+// both are updated together.
+constexpr uint64_t kArrivedMask = 0xffffffff;
+
+uint32_t barrierGeneration(uint64_t state) {
+  return static_cast<uint32_t>(state >> 32);
+}
+
+uint32_t barrierArrived(uint64_t state) {
+  return static_cast<uint32_t>(state & kArrivedMask);
+}
+
+static_assert(
+    sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+    "futex words must be plain 32 bit integers");
+
+// Sleeps while `word` holds `expected`, for at most `timeout`. It can return
+// early, so the caller checks what it is waiting for again. The segment is
+// shared between processes, so this uses shared futexes, not private ones.
+// Elsewhere, it only yields.
+void futexWait(
+    std::atomic<uint32_t>& word,
+    uint32_t expected,
+    std::chrono::nanoseconds timeout) {
+#ifdef __linux__
+  struct timespec ts;
+  ts.tv_sec = timeout.count() / 1000000000;
+  ts.tv_nsec = timeout.count() % 1000000000;
+  syscall(
+      SYS_futex,
+      reinterpret_cast<uint32_t*>(&word),
+      FUTEX_WAIT,
+      expected,
+      &ts,
+      nullptr,
+      0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void futexWakeAll(std::atomic<uint32_t>& word) {
+#ifdef __linux__
+  syscall(
+      SYS_futex,
+      reinterpret_cast<uint32_t*>(&word),
+      FUTEX_WAKE,
+      INT_MAX,
+      nullptr,
+      nullptr,
+      0);
+#endif
+}
+
+void reduceInto(at::Tensor& result, const at::Tensor& other, ReduceOp op) {
+  switch (op) {
+    case ReduceOp::SUM:
+      result.add_(other);
+      return;
+    case ReduceOp::PRODUCT:
+      result.mul_(other);
+      return;
+    case ReduceOp::MIN:
+      at::min_out(result, result, other);
+      return;
+    case ReduceOp::MAX:
+      at::max_out(result, result, other);
+      return;
+    case ReduceOp::BAND:
+      result.bitwise_and_(other);
+      return;
+    case ReduceOp::BOR:
+      result.bitwise_or_(other);
+      return;
+    case ReduceOp::BXOR:
+      result.bitwise_xor_(other);
+      return;
+    case ReduceOp::UNUSED:
+      break;
+  }
+  throw std::runtime_error("Unhandled ReduceOp");
+}
+
+std::string segmentName(int rank) {
+  static std::atomic<uint32_t> counter{0};
+  return c10::str("/torch-c10d-", getpid(), "-", rank, "-", counter++);
+}
+
+} // namespace
+
+// Header of the shared memory segment. It is followed by one slot of
+// `slotSize` bytes per process on this machine. ftruncate zero fills the
+// segment, which is a valid initial state for all of the fields.
+struct alignas(kSlotAlignment) ProcessGroupHierarchical::Segment {
+  // Sense reversing barrier, see barrierGeneration and barrierArrived.
+  std::atomic<uint64_t> barrier;
+
+  // Set by the leader if the inter-node allreduce failed, to one more than
+  // the generation of the barrier that follows it. Stale values never match
+  // a later barrier, so it does not need to be reset.
+  std::atomic<uint64_t> failedGeneration;
+
+  // Generation of the barrier, stored after the barrier state. Processes
+  // that wait for the barrier for longer than kBarrierSpinCount polls sleep
+  // on it, and count themselves in sleepers while they do, so that the last
+  // process to arrive only makes the system call to wake them if needed.
+  std::atomic<uint32_t> generation;
+  std::atomic<uint32_t> sleepers;
+
+  void* slot(int index, size_t slotSize) {
+    return reinterpret_cast<uint8_t*>(this) + sizeof(Segment) +
+        index * slotSize;
+  }
+};
+
+ProcessGroupHierarchical::Options::Options(int localSize)
+    : localSize(localSize),
+      chunkSize(4 * 1024 * 1024),
+      timeout(kProcessGroupDefaultTimeout) {}
+
+void ProcessGroupHierarchical::AsyncWork::run() {
+  std::exception_ptr eptr;
+  try {
+    fn_();
+  } catch (...) {
+    eptr = std::current_exception();
+  }
+  finish(eptr);
+}
+
+ProcessGroupHierarchical::ProcessGroupHierarchical(
+    const std::shared_ptr<Store>& store,
+    int rank,
+    int size,
+    Options options)
+    : ProcessGroup(rank, size),
+      options_(std::move(options)),
+      localRank_(rank % options_.localSize),
+      segment_(nullptr),
+      segmentSize_(0),
+      stop_(false) {
+  const auto localSize = options_.localSize;
+  TORCH_CHECK(
+      localSize > 0 && size_ % localSize == 0,
+      "ProcessGroupHierarchical: the group size (",
+      size_,
+      ") must be a multiple of the number of processes per machine (",
+      localSize,
+      ")");
+  TORCH_CHECK(
+      options_.chunkSize >= kSlotAlignment,
+      "ProcessGroupHierarchical: chunk size must be at least ",
+      kSlotAlignment,
+      " bytes");
+  TORCH_CHECK(
+      options_.globalGroup && options_.globalGroup->getRank() == rank_ &&
+          options_.globalGroup->getSize() == size_,
+      "ProcessGroupHierarchical: the global process group must have the ",
+      "same rank and size");
+  const auto node = rank_ / localSize;
+  const auto numNodes = size_ / localSize;
+  if (localRank_ == 0 && numNodes > 1) {
+    TORCH_CHECK(
+        options_.interNodeGroup &&
+            options_.interNodeGroup->getRank() == node &&
+            options_.interNodeGroup->getSize() == numNodes,
+        "ProcessGroupHierarchical: leaders need an inter-node process group ",
+        "with rank ",
+        node,
+        " and size ",
+        numNodes);
+  } else {
+    TORCH_CHECK(
+        !options_.interNodeGroup,
+        "ProcessGroupHierarchical: only leaders of a group that spans ",
+        "multiple machines take an inter-node process group");
+  }
+
+  const auto slotSize =
+      (options_.chunkSize + kSlotAlignment - 1) / kSlotAlignment *
+      kSlotAlignment;
+  segmentSize_ = sizeof(Segment) + localSize * slotSize;
+
+  // The leader creates the segment and shares its name through the store.
+  // It is unlinked once every process on this machine has mapped it, so
+  // that it is cleaned up when they exit, even if they don't do so cleanly.
+  const auto key = c10::str("hierarchical/", node);
+  std::string name;
+  int fd = -1;
+  if (localRank_ == 0) {
+    name = segmentName(rank_);
+    SYSCHECK_ERR_RETURN_NEG1(
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600));
+    ResourceGuard guard([&] {
+      ::close(fd);
+      shm_unlink(name.c_str());
+    });
+    SYSCHECK_ERR_RETURN_NEG1(ftruncate(fd, segmentSize_));
+    guard.release();
+    store->set(key, std::vector<uint8_t>(name.begin(), name.end()));
+  } else {
+    const auto value = store->get(key);
+    name = std::string(value.begin(), value.end());
+    SYSCHECK_ERR_RETURN_NEG1(fd = shm_open(name.c_str(), O_RDWR, 0));
+  }
+
+  void* ptr = mmap(
+      nullptr, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    throw std::system_error(errno, std::system_category());
+  }
+  segment_ = static_cast<Segment*>(ptr);
+
+  localBarrier();
+  if (localRank_ == 0) {
+    shm_unlink(name.c_str());
+  }
+
+  thread_ = std::thread(&ProcessGroupHierarchical::runLoop, this);
+}
+
+ProcessGroupHierarchical::~ProcessGroupHierarchical() {
+  std::unique_lock<std::mutex> lock(workMutex_);
+  workConsumeCV_.wait(lock, [&] { return workQueue_.empty(); });
+
+  // Queue is empty, signal stop
+  stop_ = true;
+
+  // Release lock to allow the thread to terminate
+  lock.unlock();
+
+  workProduceCV_.notify_all();
+  thread_.join();
+
+  munmap(segment_, segmentSize_);
+}
+
+void ProcessGroupHierarchical::runLoop() {
+  std::unique_lock<std::mutex> lock(workMutex_);
+
+  while (!stop_) {
+    if (workQueue_.empty()) {
+      workProduceCV_.wait(lock);
+      continue;
+    }
+
+    auto work = std::move(workQueue_.front());
+    workQueue_.pop_front();
+    lock.unlock();
+
+    // Notify after releasing the lock so that the waiter
+    // does not immediately block.
+    workConsumeCV_.notify_one();
+
+    work->run();
+    lock.lock();
+  }
+}
+
+void ProcessGroupHierarchical::enqueue(std::shared_ptr<AsyncWork> work) {
+  std::unique_lock<std::mutex> lock(workMutex_);
+  workQueue_.push_back(std::move(work));
+  lock.unlock();
+
+  // Notify after releasing the lock so that the waiter
+  // does not immediately block.
+  workProduceCV_.notify_one();
+}
+
+uint32_t ProcessGroupHierarchical::localBarrier() {
+  auto& barrier = segment_->barrier;
+  const auto localSize = static_cast<uint32_t>(options_.localSize);
+  const auto state = barrier.fetch_add(1, std::memory_order_acq_rel);
+  const auto current = barrierGeneration(state);
+  if (barrierArrived(state) + 1 == localSize) {
+    // Everyone arrived, so nobody else writes the state until it is reset.
+    barrier.store(
+        static_cast<uint64_t>(current + 1) << 32, std::memory_order_release);
+    // Sequentially consistent, so that either this sees a process that is
+    // about to sleep, or the process sees the new generation and doesn't.
+    segment_->generation.store(current + 1);
+    if (segment_->sleepers.load() > 0) {
+      futexWakeAll(segment_->generation);
+    }
+    return current;
+  }
+
+  // The processes on this machine are expected to arrive at about the same
+  // time, except while the leader runs the inter-node allreduce.
+  const auto deadline = std::chrono::steady_clock::now() + options_.timeout;
+  for (int spin = 0;;) {
+    auto observed = barrier.load(std::memory_order_acquire);
+    if (barrierGeneration(observed) != current) {
+      return current;
+    }
+    if (spin < kBarrierSpinCount) {
+      spin++;
+      continue;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    if (now > deadline && barrierArrived(observed) != localSize) {
+      // Leave the barrier before giving up, so that the processes that wait
+      // in it or arrive later still count the others correctly.
+      if (barrier.compare_exchange_strong(
+              observed, observed - 1, std::memory_order_acq_rel)) {
+        throw std::runtime_error(
+            "ProcessGroupHierarchical: timed out waiting for the other "
+            "processes on this machine");
+      }
+      continue;
+    }
+    segment_->sleepers.fetch_add(1);
+    futexWait(
+        segment_->generation,
+        current,
+        std::max<std::chrono::nanoseconds>(deadline - now, kBarrierMinSleep));
+    segment_->sleepers.fetch_sub(1);
+  }
+}
+
+void ProcessGroupHierarchical::runAllreduce(at::Tensor& tensor, ReduceOp op) {
+  const auto localSize = options_.localSize;
+  const auto slotSize =
+      (segmentSize_ - sizeof(Segment)) / static_cast<size_t>(localSize);
+  const auto chunkNumel =
+      static_cast<int64_t>(options_.chunkSize / tensor.element_size());
+  TORCH_CHECK(chunkNumel > 0, "ProcessGroupHierarchical: chunk size too small");
+
+  auto flat = tensor.view({-1});
+  const auto numel = flat.numel();
+  for (int64_t offset = 0; offset < numel; offset += chunkNumel) {
+    const auto length = std::min(chunkNumel, numel - offset);
+    auto chunk = flat.narrow(0, offset, length);
+    std::vector<at::Tensor> slots;
+    slots.reserve(localSize);
+    for (int i = 0; i < localSize; i++) {
+      slots.push_back(at::from_blob(
+          segment_->slot(i, slotSize), {length}, tensor.options()));
+    }
+
+    // Phase 1: every process reduces its share of the chunk across all
+    // slots into slot 0.
+    slots[localRank_].copy_(chunk);
+    localBarrier();
+    const auto share = (length + localSize - 1) / localSize;
+    const auto begin = std::min(length, localRank_ * share);
+    const auto end = std::min(length, begin + share);
+    if (end > begin) {
+      auto result = slots[0].narrow(0, begin, end - begin);
+      for (int i = 1; i < localSize; i++) {
+        reduceInto(result, slots[i].narrow(0, begin, end - begin), op);
+      }
+    }
+    localBarrier();
+
+    // Phase 2: the leader allreduces slot 0 with the other machines.
+    if (size_ > localSize) {
+      if (localRank_ == 0) {
+        std::exception_ptr eptr;
+        try {
+          std::vector<at::Tensor> tensors = {slots[0]};
+          AllreduceOptions opts;
+          opts.reduceOp = op;
+          options_.interNodeGroup->allreduce(tensors, opts)->wait();
+        } catch (...) {
+          eptr = std::current_exception();
+          // The barrier can't complete without the leader, so its generation
+          // is still that of the barrier below.
+          const auto generation = barrierGeneration(
+              segment_->barrier.load(std::memory_order_acquire));
+          segment_->failedGeneration.store(
+              static_cast<uint64_t>(generation) + 1,
+              std::memory_order_relaxed);
+        }
+        localBarrier();
+        if (eptr) {
+          std::rethrow_exception(eptr);
+        }
+      } else {
+        const auto generation = localBarrier();
+        if (segment_->failedGeneration.load(std::memory_order_relaxed) ==
+            static_cast<uint64_t>(generation) + 1) {
+          throw std::runtime_error(
+              "ProcessGroupHierarchical: inter-node allreduce failed on the "
+              "leader of this machine");
+        }
+      }
+    }
+
+    // Phase 3: copy the result out. Slot 0 is overwritten by the leader
+    // in the next chunk, so wait for everyone to be done with it.
+    chunk.copy_(slots[0]);
+    localBarrier();
+  }
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::broadcast(
+    std::vector<at::Tensor>& tensors,
+    const BroadcastOptions& opts) {
+  return options_.globalGroup->broadcast(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allreduce(
+    std::vector<at::Tensor>& tensors,
+    const AllreduceOptions& opts) {
+  if (tensors.size() != 1 || tensors[0].device().type() != at::kCPU ||
+      tensors[0].layout() != at::kStrided || !tensors[0].is_contiguous()) {
+    return options_.globalGroup->allreduce(tensors, opts);
+  }
+
+  auto tensor = tensors[0];
+  const auto op = opts.reduceOp;
+  auto work = std::make_shared<AsyncWork>(
+      [this, tensor, op]() mutable { runAllreduce(tensor, op); });
+  enqueue(work);
+  return work;
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allreduce_coalesced(
+        std::vector<at::Tensor>& tensors,
+        const AllreduceCoalescedOptions& opts) {
+  return options_.globalGroup->allreduce_coalesced(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce(
+    std::vector<at::Tensor>& tensors,
+    const ReduceOptions& opts) {
+  return options_.globalGroup->reduce(tensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const AllgatherOptions& opts) {
+  return options_.globalGroup->allgather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::allgather_base(
+    at::Tensor& outputBuffer,
+    at::Tensor& inputBuffer,
+    const AllgatherOptions& opts) {
+  return options_.globalGroup->allgather_base(outputBuffer, inputBuffer, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::
+    allgather_coalesced(
+        std::vector<std::vector<at::Tensor>>& outputTensorLists,
+        std::vector<at::Tensor>& inputTensors,
+        const AllgatherOptions& opts) {
+  return options_.globalGroup->allgather_coalesced(
+      outputTensorLists, inputTensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::gather(
+    std::vector<std::vector<at::Tensor>>& outputs,
+    std::vector<at::Tensor>& inputs,
+    const GatherOptions& opts) {
+  return options_.globalGroup->gather(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ScatterOptions& opts) {
+  return options_.globalGroup->scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::reduce_scatter(
+    std::vector<at::Tensor>& outputs,
+    std::vector<std::vector<at::Tensor>>& inputs,
+    const ReduceScatterOptions& opts) {
+  return options_.globalGroup->reduce_scatter(outputs, inputs, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::alltoall_base(
+    at::Tensor& outputTensor,
+    at::Tensor& inputTensor,
+    std::vector<int64_t>& outputSplitSizes,
+    std::vector<int64_t>& inputSplitSizes,
+    const AllToAllOptions& opts) {
+  return options_.globalGroup->alltoall_base(
+      outputTensor, inputTensor, outputSplitSizes, inputSplitSizes, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::alltoall(
+    std::vector<at::Tensor>& outputTensors,
+    std::vector<at::Tensor>& inputTensors,
+    const AllToAllOptions& opts) {
+  return options_.globalGroup->alltoall(outputTensors, inputTensors, opts);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::send(
+    std::vector<at::Tensor>& tensors,
+    int dstRank,
+    int tag) {
+  return options_.globalGroup->send(tensors, dstRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recv(
+    std::vector<at::Tensor>& tensors,
+    int srcRank,
+    int tag) {
+  return options_.globalGroup->recv(tensors, srcRank, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::recvAnysource(
+    std::vector<at::Tensor>& tensors,
+    int tag) {
+  return options_.globalGroup->recvAnysource(tensors, tag);
+}
+
+std::shared_ptr<ProcessGroup::Work> ProcessGroupHierarchical::barrier(
+    const BarrierOptions& opts) {
+  // The global barrier is started here, in the same order as the other
+  // collectives forwarded to the global group, and is waited for on the
+  // allreduce thread, so that the hierarchical allreduces that were started
+  // before it are done as well.
+  auto globalWork = options_.globalGroup->barrier(opts);
+  auto work = std::make_shared<AsyncWork>(
+      [globalWork]() { globalWork->wait(); });
+  enqueue(work);
+  return work;
+}
+
+} // namespace c10d
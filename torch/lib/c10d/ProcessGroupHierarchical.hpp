@@ -0,0 +1,189 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10d/ProcessGroup.hpp>
+#include <c10d/Store.hpp>
+
+namespace c10d {
+
+// ProcessGroupHierarchical implements allreduce for CPU tensors in three
+// phases, for jobs that run several processes per machine:
+//
+//   1. The processes on the same machine reduce their tensors through a
+//      POSIX shared memory segment.
+//   2. One process per machine (the leader) allreduces the result with the
+//      leaders of the other machines, using the inter-node process group.
+//   3. The processes on the same machine copy the result out of the
+//      shared memory segment.
+//
+// Only the leaders send data over the network, and none of the intra-node
+// traffic goes through the loopback interface of the network stack.
+//
+// Ranks are expected to be assigned machine by machine: the processes with
+// ranks [n * localSize, (n + 1) * localSize) run on machine n and the one
+// with the lowest rank is its leader. The inter-node process group has a
+// rank for every leader, equal to n, and is null on every other process.
+//
+// Every other collective, and allreduce of tensors that are not dense
+// contiguous CPU tensors, is forwarded to the global process group. As with
+// other process groups, all functions of the class are expected to be
+// called in the same order across all processes.
+//
+class ProcessGroupHierarchical final : public ProcessGroup {
+ public:
+  struct Options {
+    explicit Options(int localSize);
+
+    // Number of processes per machine.
+    int localSize;
+
+    // Number of bytes of every process in the shared memory segment.
+    // Tensors that are larger are reduced in chunks of this size.
+    size_t chunkSize;
+
+    // Defaults to kProcessGroupDefaultTimeout.
+    std::chrono::milliseconds timeout;
+
+    // Allreduces across leaders. Only set on leaders.
+    std::shared_ptr<ProcessGroup> interNodeGroup;
+
+    // Spans all processes. Runs everything but the hierarchical allreduce.
+    std::shared_ptr<ProcessGroup> globalGroup;
+  };
+
+  class AsyncWork : public ProcessGroup::Work {
+   public:
+    explicit AsyncWork(std::function<void()> fn) : fn_(std::move(fn)) {}
+
+    void run();
+
+   private:
+    std::function<void()> fn_;
+  };
+
+  // The store is used to share the name of the shared memory segment
+  // between the processes on the same machine.
+  ProcessGroupHierarchical(
+      const std::shared_ptr<Store>& store,
+      int rank,
+      int size,
+      Options options);
+
+  ~ProcessGroupHierarchical() override;
+
+  std::shared_ptr<ProcessGroup::Work> broadcast(
+      std::vector<at::Tensor>& tensors,
+      const BroadcastOptions& opts = BroadcastOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceOptions& opts = AllreduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allreduce_coalesced(
+      std::vector<at::Tensor>& tensors,
+      const AllreduceCoalescedOptions& opts =
+          AllreduceCoalescedOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce(
+      std::vector<at::Tensor>& tensors,
+      const ReduceOptions& opts = ReduceOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_base(
+      at::Tensor& outputBuffer,
+      at::Tensor& inputBuffer,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> allgather_coalesced(
+      std::vector<std::vector<at::Tensor>>& outputTensorLists,
+      std::vector<at::Tensor>& inputTensors,
+      const AllgatherOptions& opts = AllgatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> gather(
+      std::vector<std::vector<at::Tensor>>& outputs,
+      std::vector<at::Tensor>& inputs,
+      const GatherOptions& opts = GatherOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ScatterOptions& opts = ScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> reduce_scatter(
+      std::vector<at::Tensor>& outputs,
+      std::vector<std::vector<at::Tensor>>& inputs,
+      const ReduceScatterOptions& opts = ReduceScatterOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall_base(
+      at::Tensor& outputTensor,
+      at::Tensor& inputTensor,
+      std::vector<int64_t>& outputSplitSizes,
+      std::vector<int64_t>& inputSplitSizes,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> alltoall(
+      std::vector<at::Tensor>& outputTensors,
+      std::vector<at::Tensor>& inputTensors,
+      const AllToAllOptions& opts = AllToAllOptions()) override;
+
+  std::shared_ptr<ProcessGroup::Work> send(
+      std::vector<at::Tensor>& tensors,
+      int dstRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recv(
+      std::vector<at::Tensor>& tensors,
+      int srcRank,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> recvAnysource(
+      std::vector<at::Tensor>& tensors,
+      int tag) override;
+
+  std::shared_ptr<ProcessGroup::Work> barrier(
+      const BarrierOptions& opts = BarrierOptions()) override;
+
+ protected:
+  struct Segment;
+
+  // Reduces the tensor in place, chunk by chunk, in the three phases
+  // described above.
+  void runAllreduce(at::Tensor& tensor, ReduceOp op);
+
+  // Waits until all processes on this machine have called it and returns
+  // the generation of the barrier. Polls for a short while, then sleeps on
+  // a futex. On timeout, leaves the barrier and throws.
+  uint32_t localBarrier();
+
+  void runLoop();
+
+  void enqueue(std::shared_ptr<AsyncWork> work);
+
+  const Options options_;
+  const int localRank_;
+
+  // Shared memory segment, mapped by every process on this machine.
+  Segment* segment_;
+  size_t segmentSize_;
+
+  // The hierarchical allreduces run on a single thread, so that they use
+  // the shared memory segment in the same order on every process.
+  std::deque<std::shared_ptr<AsyncWork>> workQueue_;
+  std::mutex workMutex_;
+  std::condition_variable workProduceCV_;
+  std::condition_variable workConsumeCV_;
+  bool stop_;
+  std::thread thread_;
+};
+
+} // namespace c10d
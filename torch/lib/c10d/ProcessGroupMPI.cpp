@@ -92,72 +92,6 @@ void checkSameSizeAndType(
   }
 }
 
-void checkSplitSizes(
-    const std::vector<int64_t>& split_sizes,
-    const at::Tensor& tensor,
-    int group_size) {
-  if (split_sizes.size() == 0) {
-    TORCH_CHECK(
-        tensor.size(0) % group_size == 0,
-        "Tensor's dim 0 does not divide equally across group size");
-  } else {
-    TORCH_CHECK(
-        split_sizes.size() == group_size,
-        "Number of tensor splits not equal to group size");
-    int sum = std::accumulate(split_sizes.begin(), split_sizes.end(), 0);
-    TORCH_CHECK(
-        sum == tensor.size(0), "Split sizes doesn't match total dim 0 size");
-  }
-}
-
-int64_t computeLengthsAndOffsets(
-    const std::vector<int64_t>& split_sizes,
-    const at::Tensor& tensor,
-    std::vector<int>* lengths,
-    std::vector<int>* offsets) {
-  int64_t group_size = lengths->size();
-  bool equal_splits = false;
-  int64_t dim0_size = tensor.size(0);
-  int64_t row_size = (dim0_size ? tensor.numel() / dim0_size : 1);
-  int64_t split_size = 0;
-  int64_t offset = 0;
-
-  if (split_sizes.size() == 0) {
-    equal_splits = true;
-    split_size = tensor.size(0) / group_size;
-  }
-  for (int i = 0; i < group_size; i++) {
-    int64_t length = row_size * (equal_splits ? split_size : split_sizes[i]);
-    TORCH_INTERNAL_ASSERT(
-        length <= std::numeric_limits<int>::max() &&
-            offset <= std::numeric_limits<int>::max(),
-        "Length or offset larger than INT_MAX not supported");
-    (*lengths)[i] = length;
-    (*offsets)[i] = offset;
-    offset += length;
-  }
-  return offset;
-}
-
-int64_t computeLengthsAndOffsets(
-    const std::vector<at::Tensor>& tensors,
-    std::vector<int>* lengths,
-    std::vector<int>* offsets) {
-  int64_t group_size = lengths->size();
-  int64_t offset = 0;
-  for (int i = 0; i < group_size; i++) {
-    int64_t length = tensors[i].numel();
-    TORCH_INTERNAL_ASSERT(
-        length <= std::numeric_limits<int>::max() &&
-            offset <= std::numeric_limits<int>::max(),
-        "Length or offset larger than INT_MAX not supported");
-    (*lengths)[i] = length;
-    (*offsets)[i] = offset;
-    offset += length;
-  }
-  return offset;
-}
-
 } // namespace
 
 ProcessGroupMPI::AsyncWork::AsyncWork(at::Tensor tensor, MPI_Request request)
@@ -228,6 +162,11 @@ void ProcessGroupMPI::AsyncWork::abort() {
   TORCH_CHECK(false, "ProcessGroupMPI::AsyncWork::abort not implemented.")
 }
 
+c10::intrusive_ptr<c10::ivalue::Future> ProcessGroupMPI::AsyncWork::
+    getFuture() {
+  return getFutureAfterWait();
+}
+
 void ProcessGroupMPI::AsyncWork::populateException() {
   std::array<char, MPI_MAX_ERROR_STRING> buf;
   int len = buf.size();
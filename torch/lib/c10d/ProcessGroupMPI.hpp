@@ -92,6 +92,8 @@ class ProcessGroupMPI : public ProcessGroup {
 
     void abort() override;
 
+    c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
+
    protected:
     void populateException();
 
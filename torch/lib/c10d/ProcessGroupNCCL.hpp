@@ -72,6 +72,10 @@ class ProcessGroupNCCL : public ProcessGroup {
 
     void abort() override;
 
+    // NCCL work is not completed through finish(). The returned Future is
+    // completed once the current stream waits on the NCCL work.
+    c10::intrusive_ptr<c10::ivalue::Future> getFuture() override;
+
     // Let current stream wait on the completing of the NCCL work
     // Throws on exceptions. Blocking operation, which will wait for work
     // completion.
@@ -38,6 +38,23 @@ class Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) = 0;
 
+  // Sets the key to desiredValue if its current value is expectedValue, and
+  // returns the value of the key after the operation. A key that doesn't
+  // exist matches an empty expectedValue, and is returned as empty.
+  virtual std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue);
+
+  // Batched versions of get and set. Stores that talk to a server should
+  // override them to avoid a round trip per key.
+  virtual std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys);
+
+  virtual void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values);
+
   void setTimeout(const std::chrono::milliseconds& timeout);
 
  protected:
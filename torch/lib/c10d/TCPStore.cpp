@@ -2,26 +2,144 @@
 
 #include <poll.h>
 
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <algorithm>
+#include <cstring>
 #include <system_error>
 
 namespace c10d {
 
 namespace {
 
-enum class QueryType : uint8_t { SET, GET, ADD, CHECK, WAIT };
+enum class QueryType : uint8_t {
+  SET,
+  GET,
+  ADD,
+  CHECK,
+  WAIT,
+  MULTI_GET,
+  MULTI_SET,
+  COMPARE_SET
+};
 
 enum class CheckResponseType : uint8_t { READY, NOT_READY };
 
 enum class WaitResponseType : uint8_t { STOP_WAITING };
 
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+constexpr size_t kReceiveBufferSize = 64 * 1024;
+
+template <typename T>
+void appendValue(std::vector<uint8_t>& buffer, const T& value) {
+  auto bytes = reinterpret_cast<const uint8_t*>(&value);
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void appendVector(std::vector<uint8_t>& buffer, const std::vector<T>& vec) {
+  appendValue<SizeType>(buffer, vec.size());
+  auto bytes = reinterpret_cast<const uint8_t*>(vec.data());
+  buffer.insert(buffer.end(), bytes, bytes + sizeof(T) * vec.size());
+}
+
+// send the number of strings followed by the strings
+void sendStrings(
+    int socket,
+    const std::vector<std::string>& strings,
+    bool moreData = false) {
+  SizeType size = strings.size();
+  tcputil::sendBytes<SizeType>(socket, &size, 1, moreData || size > 0);
+  for (size_t i = 0; i < size; i++) {
+    tcputil::sendString(socket, strings[i], moreData || i != (size - 1));
+  }
+}
+
 } // anonymous namespace
 
+// Reads the arguments of a query out of the input buffer of a connection.
+// Every read returns false once the buffer runs out, in which case the
+// query is parsed again when more data has arrived.
+class TCPStoreDaemon::QueryReader {
+ public:
+  QueryReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+  template <typename T>
+  bool read(T& value) {
+    if (size_ - offset_ < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, data_ + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return true;
+  }
+
+  template <typename T>
+  bool readVector(std::vector<T>& vec) {
+    SizeType size;
+    if (!read(size) || (size_ - offset_) / sizeof(T) < size) {
+      return false;
+    }
+    vec.assign(
+        reinterpret_cast<const T*>(data_ + offset_),
+        reinterpret_cast<const T*>(data_ + offset_) + size);
+    offset_ += sizeof(T) * size;
+    return true;
+  }
+
+  bool readString(std::string& str) {
+    SizeType size;
+    if (!read(size) || size_ - offset_ < size) {
+      return false;
+    }
+    str.assign(reinterpret_cast<const char*>(data_ + offset_), size);
+    offset_ += size;
+    return true;
+  }
+
+  bool readStrings(std::vector<std::string>& strings) {
+    SizeType size;
+    if (!read(size)) {
+      return false;
+    }
+    strings.resize(0);
+    for (SizeType i = 0; i < size; i++) {
+      std::string str;
+      if (!readString(str)) {
+        return false;
+      }
+      strings.push_back(std::move(str));
+    }
+    return true;
+  }
+
+  // Number of bytes read so far.
+  size_t offset() const {
+    return offset_;
+  }
+
+ private:
+  const uint8_t* data_;
+  const size_t size_;
+  size_t offset_ = 0;
+};
+
 // TCPStoreDaemon class methods
 // Simply start the daemon thread
 TCPStoreDaemon::TCPStoreDaemon(int storeListenSocket)
     : storeListenSocket_(storeListenSocket) {
+  // Accept connections until there are none left, without blocking.
+  int flags;
+  SYSCHECK_ERR_RETURN_NEG1(flags = ::fcntl(storeListenSocket_, F_GETFL));
+  SYSCHECK_ERR_RETURN_NEG1(
+      ::fcntl(storeListenSocket_, F_SETFL, flags | O_NONBLOCK));
   // Use control pipe to signal instance destruction to the daemon thread.
   if (pipe(controlPipeFd_.data()) == -1) {
     throw std::runtime_error(
@@ -37,10 +155,8 @@ TCPStoreDaemon::~TCPStoreDaemon() {
   // Join the thread
   join();
   // Close unclosed sockets
-  for (auto socket : sockets_) {
-    if (socket != -1) {
-      ::close(socket);
-    }
+  for (auto& it : connections_) {
+    ::close(it.first);
   }
   // Now close the rest control pipe
   for (auto fd : controlPipeFd_) {
@@ -55,58 +171,67 @@ void TCPStoreDaemon::join() {
 }
 
 void TCPStoreDaemon::run() {
-  std::vector<struct pollfd> fds;
-  fds.push_back({.fd = storeListenSocket_, .events = POLLIN});
+  pollFds_.push_back({.fd = storeListenSocket_, .events = POLLIN});
   // Push the read end of the pipe to signal the stopping of the daemon run
-  fds.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
+  pollFds_.push_back({.fd = controlPipeFd_[0], .events = POLLHUP});
 
   // receive the queries
-  bool finished = false;
-  while (!finished) {
-    for (size_t i = 0; i < sockets_.size(); i++) {
-      fds[i].revents = 0;
+  while (true) {
+    for (auto& fd : pollFds_) {
+      fd.revents = 0;
     }
 
-    SYSCHECK_ERR_RETURN_NEG1(::poll(fds.data(), fds.size(), -1));
+    SYSCHECK_ERR_RETURN_NEG1(::poll(pollFds_.data(), pollFds_.size(), -1));
 
-    // TCPStore's listening socket has an event and it should now be able to
-    // accept new connections.
-    if (fds[0].revents != 0) {
-      if (fds[0].revents ^ POLLIN) {
+    // The pipe receives an event which tells us to shutdown the daemon
+    if (pollFds_[1].revents != 0) {
+      // Will be POLLUP when the pipe is closed
+      if (pollFds_[1].revents ^ POLLHUP) {
         throw std::system_error(
             ECONNABORTED,
             std::system_category(),
-            "Unexpected poll revent on the master's listening socket: " +
-                std::to_string(fds[0].revents));
+            "Unexpected poll revent on the control pipe's reading fd: " +
+                std::to_string(pollFds_[1].revents));
       }
-      int sockFd = std::get<0>(tcputil::accept(storeListenSocket_));
-      sockets_.push_back(sockFd);
-      fds.push_back({.fd = sockFd, .events = POLLIN});
+      break;
     }
-    // The pipe receives an event which tells us to shutdown the daemon
-    if (fds[1].revents != 0) {
-      // Will be POLLUP when the pipe is closed
-      if (fds[1].revents ^ POLLHUP) {
+    // TCPStore's listening socket has an event and it should now be able to
+    // accept new connections.
+    if (pollFds_[0].revents != 0) {
+      if (pollFds_[0].revents ^ POLLIN) {
         throw std::system_error(
             ECONNABORTED,
             std::system_category(),
-            "Unexpected poll revent on the control pipe's reading fd: " +
-                std::to_string(fds[1].revents));
+            "Unexpected poll revent on the master's listening socket: " +
+                std::to_string(pollFds_[0].revents));
       }
-      finished = true;
-      break;
+      acceptConnections();
     }
-    // Skipping the fds[0] and fds[1],
-    // fds[0] is master's listening socket
-    // fds[1] is control pipe's reading fd
-    for (size_t fdIdx = 2; fdIdx < fds.size(); ++fdIdx) {
-      if (fds[fdIdx].revents == 0) {
+    // Skipping the pollFds_[0] and pollFds_[1],
+    // pollFds_[0] is master's listening socket
+    // pollFds_[1] is control pipe's reading fd
+    for (size_t index = 2; index < pollFds_.size();) {
+      const auto revents = pollFds_[index].revents;
+      if (revents == 0) {
+        index++;
         continue;
       }
 
-      // Now query the socket that has the event
+      auto& conn = connections_.at(pollFds_[index].fd);
+      bool open = true;
       try {
-        query(fds[fdIdx].fd);
+        if (revents & POLLOUT) {
+          flush(conn);
+        }
+        if (revents & ~POLLOUT) {
+          // The queries that arrived before the peer closed the connection
+          // still take effect, the responses are dropped.
+          open = receive(conn);
+          processQueries(conn);
+          if (open) {
+            flush(conn);
+          }
+        }
       } catch (...) {
         // There was an error when processing query. Probably an exception
         // occurred in recv/send what would indicate that socket on the other
@@ -115,34 +240,31 @@ void TCPStoreDaemon::run() {
         // exception, other connections will get an exception once they try to
         // use the store. We will go ahead and close this connection whenever
         // we hit an exception here.
-        ::close(fds[fdIdx].fd);
-
-        // Remove all the tracking state of the close FD
-        for (auto it = waitingSockets_.begin(); it != waitingSockets_.end();) {
-          for (auto vecIt = it->second.begin(); vecIt != it->second.end();) {
-            if (*vecIt == fds[fdIdx].fd) {
-              vecIt = it->second.erase(vecIt);
-            } else {
-              ++vecIt;
-            }
-          }
-          if (it->second.size() == 0) {
-            it = waitingSockets_.erase(it);
-          } else {
-            ++it;
-          }
+        open = false;
+      }
+      if (!open) {
+        // Moves the last entry to this index, which is visited next.
+        closeConnection(index);
+        continue;
+      }
+      index++;
+    }
+    // Serve the queries that the connections which stopped waiting have
+    // buffered. Those can wake up more connections in turn.
+    while (!resumed_.empty()) {
+      std::vector<int> resumed;
+      resumed.swap(resumed_);
+      for (int socket : resumed) {
+        auto it = connections_.find(socket);
+        if (it == connections_.end()) {
+          continue;
         }
-        for (auto it = keysAwaited_.begin(); it != keysAwaited_.end();) {
-          if (it->first == fds[fdIdx].fd) {
-            it = keysAwaited_.erase(it);
-          } else {
-            ++it;
-          }
+        try {
+          processQueries(it->second);
+          flush(it->second);
+        } catch (...) {
+          closeConnection(it->second.index);
         }
-        fds.erase(fds.begin() + fdIdx);
-        sockets_.erase(sockets_.begin() + fdIdx - 2);
-        --fdIdx;
-        continue;
       }
     }
   }
@@ -156,29 +278,147 @@ void TCPStoreDaemon::stop() {
   }
 }
 
+void TCPStoreDaemon::acceptConnections() {
+  while (true) {
+    int socket = ::accept(storeListenSocket_, nullptr, nullptr);
+    if (socket == -1) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return;
+      }
+      throw std::system_error(errno, std::system_category());
+    }
+    int flag = 1;
+    SYSCHECK_ERR_RETURN_NEG1(::setsockopt(
+        socket,
+        IPPROTO_TCP,
+        TCP_NODELAY,
+        reinterpret_cast<char*>(&flag),
+        sizeof(flag)));
+    SYSCHECK_ERR_RETURN_NEG1(::fcntl(socket, F_SETFL, O_NONBLOCK));
+
+    auto& conn = connections_.emplace(socket, Connection(socket)).first->second;
+    conn.index = pollFds_.size();
+    pollFds_.push_back({.fd = socket, .events = POLLIN});
+  }
+}
+
+void TCPStoreDaemon::closeConnection(size_t index) {
+  const int socket = pollFds_[index].fd;
+  // Remove all the tracking state of the closed socket
+  for (const auto& key : connections_.at(socket).awaitedKeys) {
+    auto it = waitingSockets_.find(key);
+    if (it == waitingSockets_.end()) {
+      continue;
+    }
+    auto& sockets = it->second;
+    sockets.erase(
+        std::remove(sockets.begin(), sockets.end(), socket), sockets.end());
+    if (sockets.empty()) {
+      waitingSockets_.erase(it);
+    }
+  }
+  connections_.erase(socket);
+  ::close(socket);
+
+  pollFds_[index] = pollFds_.back();
+  pollFds_.pop_back();
+  if (index < pollFds_.size()) {
+    connections_.at(pollFds_[index].fd).index = index;
+  }
+}
+
+bool TCPStoreDaemon::receive(Connection& conn) {
+  uint8_t buffer[kReceiveBufferSize];
+  while (true) {
+    ssize_t bytesReceived = ::recv(conn.socket, buffer, sizeof(buffer), 0);
+    if (bytesReceived > 0) {
+      conn.input.insert(conn.input.end(), buffer, buffer + bytesReceived);
+    } else if (bytesReceived == 0) {
+      return false;
+    } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+      return true;
+    } else if (errno != EINTR) {
+      throw std::system_error(errno, std::system_category());
+    }
+  }
+}
+
+void TCPStoreDaemon::processQueries(Connection& conn) {
+  size_t offset = 0;
+  // Nothing after a WAIT runs until the keys are set, so that a client can
+  // send a WAIT together with the query that needs the keys.
+  while (conn.keysAwaited == 0 && offset < conn.input.size()) {
+    QueryReader reader(conn.input.data() + offset, conn.input.size() - offset);
+    if (!query(conn, reader)) {
+      break;
+    }
+    offset += reader.offset();
+  }
+  conn.input.erase(conn.input.begin(), conn.input.begin() + offset);
+}
+
+void TCPStoreDaemon::flush(Connection& conn) {
+  while (conn.outputOffset < conn.output.size()) {
+    ssize_t bytesSent = ::send(
+        conn.socket,
+        conn.output.data() + conn.outputOffset,
+        conn.output.size() - conn.outputOffset,
+        kSendFlags);
+    if (bytesSent == -1) {
+      if (errno == EINTR) {
+        continue;
+      } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // Continue once the socket is writable again.
+        pollFds_[conn.index].events = POLLIN | POLLOUT;
+        return;
+      }
+      throw std::system_error(errno, std::system_category());
+    }
+    conn.outputOffset += bytesSent;
+  }
+  conn.output.clear();
+  conn.outputOffset = 0;
+  pollFds_[conn.index].events = POLLIN;
+}
+
 // query communicates with the worker. The format
 // of the query is as follows:
 // type of query | size of arg1 | arg1 | size of arg2 | arg2 | ...
-// or, in the case of wait
+// or, in the case of check, wait and multi get
 // type of query | number of args | size of arg1 | arg1 | ...
-void TCPStoreDaemon::query(int socket) {
+// or, in the case of multi set
+// type of query | number of keys | size of key1 | key1 | size of value1 | ...
+bool TCPStoreDaemon::query(Connection& conn, QueryReader& reader) {
   QueryType qt;
-  tcputil::recvBytes<QueryType>(socket, &qt, 1);
+  if (!reader.read(qt)) {
+    return false;
+  }
 
   if (qt == QueryType::SET) {
-    setHandler(socket);
+    return setHandler(conn, reader);
+
+  } else if (qt == QueryType::MULTI_SET) {
+    return multiSetHandler(conn, reader);
+
+  } else if (qt == QueryType::COMPARE_SET) {
+    return compareSetHandler(conn, reader);
 
   } else if (qt == QueryType::ADD) {
-    addHandler(socket);
+    return addHandler(conn, reader);
 
   } else if (qt == QueryType::GET) {
-    getHandler(socket);
+    return getHandler(conn, reader);
+
+  } else if (qt == QueryType::MULTI_GET) {
+    return multiGetHandler(conn, reader);
 
   } else if (qt == QueryType::CHECK) {
-    checkHandler(socket);
+    return checkHandler(conn, reader);
 
   } else if (qt == QueryType::WAIT) {
-    waitHandler(socket);
+    return waitHandler(conn, reader);
 
   } else {
     throw std::runtime_error("Unexpected query type");
@@ -189,25 +429,84 @@ void TCPStoreDaemon::wakeupWaitingClients(const std::string& key) {
   auto socketsToWait = waitingSockets_.find(key);
   if (socketsToWait != waitingSockets_.end()) {
     for (int socket : socketsToWait->second) {
-      if (--keysAwaited_[socket] == 0) {
-        tcputil::sendValue<WaitResponseType>(
-            socket, WaitResponseType::STOP_WAITING);
+      auto& conn = connections_.at(socket);
+      if (--conn.keysAwaited == 0) {
+        conn.awaitedKeys.clear();
+        appendValue<WaitResponseType>(
+            conn.output, WaitResponseType::STOP_WAITING);
+        resumed_.push_back(socket);
       }
     }
     waitingSockets_.erase(socketsToWait);
   }
 }
 
-void TCPStoreDaemon::setHandler(int socket) {
-  std::string key = tcputil::recvString(socket);
-  tcpStore_[key] = tcputil::recvVector<uint8_t>(socket);
+bool TCPStoreDaemon::setHandler(Connection& /* unused */, QueryReader& reader) {
+  std::string key;
+  std::vector<uint8_t> value;
+  if (!reader.readString(key) || !reader.readVector(value)) {
+    return false;
+  }
+  tcpStore_[key] = std::move(value);
   // On "set", wake up all clients that have been waiting
   wakeupWaitingClients(key);
+  return true;
 }
 
-void TCPStoreDaemon::addHandler(int socket) {
-  std::string key = tcputil::recvString(socket);
-  int64_t addVal = tcputil::recvValue<int64_t>(socket);
+bool TCPStoreDaemon::multiSetHandler(
+    Connection& /* unused */,
+    QueryReader& reader) {
+  SizeType nargs;
+  if (!reader.read(nargs)) {
+    return false;
+  }
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> items;
+  for (size_t i = 0; i < nargs; i++) {
+    std::string key;
+    std::vector<uint8_t> value;
+    if (!reader.readString(key) || !reader.readVector(value)) {
+      return false;
+    }
+    items.emplace_back(std::move(key), std::move(value));
+  }
+  for (auto& item : items) {
+    tcpStore_[item.first] = std::move(item.second);
+    wakeupWaitingClients(item.first);
+  }
+  return true;
+}
+
+bool TCPStoreDaemon::compareSetHandler(Connection& conn, QueryReader& reader) {
+  std::string key;
+  std::vector<uint8_t> expectedValue;
+  std::vector<uint8_t> desiredValue;
+  if (!reader.readString(key) || !reader.readVector(expectedValue) ||
+      !reader.readVector(desiredValue)) {
+    return false;
+  }
+  auto it = tcpStore_.find(key);
+  if (it == tcpStore_.end()) {
+    // A key that doesn't exist only matches an empty expected value.
+    if (!expectedValue.empty()) {
+      appendVector<uint8_t>(conn.output, std::vector<uint8_t>());
+      return true;
+    }
+    it = tcpStore_.emplace(key, std::move(desiredValue)).first;
+    wakeupWaitingClients(key);
+  } else if (it->second == expectedValue) {
+    it->second = std::move(desiredValue);
+    wakeupWaitingClients(key);
+  }
+  appendVector<uint8_t>(conn.output, it->second);
+  return true;
+}
+
+bool TCPStoreDaemon::addHandler(Connection& conn, QueryReader& reader) {
+  std::string key;
+  int64_t addVal;
+  if (!reader.readString(key) || !reader.read(addVal)) {
+    return false;
+  }
 
   if (tcpStore_.find(key) != tcpStore_.end()) {
     auto buf = reinterpret_cast<const char*>(tcpStore_[key].data());
@@ -217,48 +516,73 @@ void TCPStoreDaemon::addHandler(int socket) {
   auto addValStr = std::to_string(addVal);
   tcpStore_[key] = std::vector<uint8_t>(addValStr.begin(), addValStr.end());
   // Now send the new value
-  tcputil::sendValue<int64_t>(socket, addVal);
+  appendValue<int64_t>(conn.output, addVal);
   // On "add", wake up all clients that have been waiting
   wakeupWaitingClients(key);
+  return true;
 }
 
-void TCPStoreDaemon::getHandler(int socket) const {
-  std::string key = tcputil::recvString(socket);
-  auto data = tcpStore_.at(key);
-  tcputil::sendVector<uint8_t>(socket, data);
+bool TCPStoreDaemon::getHandler(Connection& conn, QueryReader& reader) {
+  std::string key;
+  if (!reader.readString(key)) {
+    return false;
+  }
+  appendVector<uint8_t>(conn.output, tcpStore_.at(key));
+  return true;
 }
 
-void TCPStoreDaemon::checkHandler(int socket) const {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
+bool TCPStoreDaemon::multiGetHandler(Connection& conn, QueryReader& reader) {
+  std::vector<std::string> keys;
+  if (!reader.readStrings(keys)) {
+    return false;
+  }
+  for (const auto& key : keys) {
+    appendVector<uint8_t>(conn.output, tcpStore_.at(key));
+  }
+  return true;
+}
+
+bool TCPStoreDaemon::checkHandler(Connection& conn, QueryReader& reader) {
+  std::vector<std::string> keys;
+  if (!reader.readStrings(keys)) {
+    return false;
   }
   // Now we have received all the keys
   if (checkKeys(keys)) {
-    tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::READY);
+    appendValue<CheckResponseType>(conn.output, CheckResponseType::READY);
   } else {
-    tcputil::sendValue<CheckResponseType>(socket, CheckResponseType::NOT_READY);
+    appendValue<CheckResponseType>(conn.output, CheckResponseType::NOT_READY);
   }
+  return true;
 }
 
-void TCPStoreDaemon::waitHandler(int socket) {
-  SizeType nargs;
-  tcputil::recvBytes<SizeType>(socket, &nargs, 1);
-  std::vector<std::string> keys(nargs);
-  for (size_t i = 0; i < nargs; i++) {
-    keys[i] = tcputil::recvString(socket);
+bool TCPStoreDaemon::waitHandler(Connection& conn, QueryReader& reader) {
+  std::vector<std::string> keys;
+  if (!reader.readStrings(keys)) {
+    return false;
   }
-  if (checkKeys(keys)) {
-    tcputil::sendValue<WaitResponseType>(
-        socket, WaitResponseType::STOP_WAITING);
+  // Only register for the keys that are missing, so that setting a key
+  // twice doesn't count twice.
+  std::vector<std::string> missingKeys;
+  for (auto& key : keys) {
+    if (tcpStore_.count(key) == 0) {
+      missingKeys.push_back(std::move(key));
+    }
+  }
+  std::sort(missingKeys.begin(), missingKeys.end());
+  missingKeys.erase(
+      std::unique(missingKeys.begin(), missingKeys.end()), missingKeys.end());
+
+  if (missingKeys.empty()) {
+    appendValue<WaitResponseType>(conn.output, WaitResponseType::STOP_WAITING);
   } else {
-    for (auto& key : keys) {
-      waitingSockets_[key].push_back(socket);
+    for (const auto& key : missingKeys) {
+      waitingSockets_[key].push_back(conn.socket);
     }
-    keysAwaited_[socket] = keys.size();
+    conn.keysAwaited = missingKeys.size();
+    conn.awaitedKeys = std::move(missingKeys);
   }
+  return true;
 }
 
 bool TCPStoreDaemon::checkKeys(const std::vector<std::string>& keys) const {
@@ -346,9 +670,67 @@ std::vector<uint8_t> TCPStore::get(const std::string& key) {
 }
 
 std::vector<uint8_t> TCPStore::getHelper_(const std::string& key) {
-  waitHelper_({key}, timeout_);
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET);
+  // The daemon holds the GET back until the key is set.
+  sendWait_({key}, timeout_, /* moreData= */ true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::GET, true);
   tcputil::sendString(storeSocket_, key);
+  recvWaitResponse_();
+  return tcputil::recvVector<uint8_t>(storeSocket_);
+}
+
+std::vector<std::vector<uint8_t>> TCPStore::multiGet(
+    const std::vector<std::string>& keys) {
+  if (keys.empty()) {
+    return {};
+  }
+  std::vector<std::string> regKeys;
+  regKeys.reserve(keys.size());
+  for (const auto& key : keys) {
+    regKeys.push_back(regularPrefix_ + key);
+  }
+  sendWait_(regKeys, timeout_, /* moreData= */ true);
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_GET, true);
+  sendStrings(storeSocket_, regKeys);
+  recvWaitResponse_();
+  std::vector<std::vector<uint8_t>> values;
+  values.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    values.push_back(tcputil::recvVector<uint8_t>(storeSocket_));
+  }
+  return values;
+}
+
+void TCPStore::multiSet(
+    const std::vector<std::string>& keys,
+    const std::vector<std::vector<uint8_t>>& values) {
+  if (keys.size() != values.size()) {
+    throw std::invalid_argument(
+        "multiSet requires as many values as keys, got " +
+        std::to_string(values.size()) + " values for " +
+        std::to_string(keys.size()) + " keys");
+  }
+  if (keys.empty()) {
+    return;
+  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::MULTI_SET, true);
+  SizeType nkeys = keys.size();
+  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, true);
+  for (size_t i = 0; i < nkeys; i++) {
+    tcputil::sendString(storeSocket_, regularPrefix_ + keys[i], true);
+    tcputil::sendVector<uint8_t>(
+        storeSocket_, values[i], (i != (nkeys - 1)));
+  }
+}
+
+std::vector<uint8_t> TCPStore::compareSet(
+    const std::string& key,
+    const std::vector<uint8_t>& expectedValue,
+    const std::vector<uint8_t>& desiredValue) {
+  std::string regKey = regularPrefix_ + key;
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::COMPARE_SET, true);
+  tcputil::sendString(storeSocket_, regKey, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, expectedValue, true);
+  tcputil::sendVector<uint8_t>(storeSocket_, desiredValue);
   return tcputil::recvVector<uint8_t>(storeSocket_);
 }
 
@@ -400,6 +782,14 @@ void TCPStore::wait(
 void TCPStore::waitHelper_(
     const std::vector<std::string>& keys,
     const std::chrono::milliseconds& timeout) {
+  sendWait_(keys, timeout, /* moreData= */ false);
+  recvWaitResponse_();
+}
+
+void TCPStore::sendWait_(
+    const std::vector<std::string>& keys,
+    const std::chrono::milliseconds& timeout,
+    bool moreData) {
   // Set the socket timeout if there is a wait timeout
   if (timeout != kNoTimeout) {
     struct timeval timeoutTV = {.tv_sec = timeout.count() / 1000,
@@ -411,12 +801,11 @@ void TCPStore::waitHelper_(
         reinterpret_cast<char*>(&timeoutTV),
         sizeof(timeoutTV)));
   }
-  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT);
-  SizeType nkeys = keys.size();
-  tcputil::sendBytes<SizeType>(storeSocket_, &nkeys, 1, (nkeys > 0));
-  for (size_t i = 0; i < nkeys; i++) {
-    tcputil::sendString(storeSocket_, keys[i], (i != (nkeys - 1)));
-  }
+  tcputil::sendValue<QueryType>(storeSocket_, QueryType::WAIT, true);
+  sendStrings(storeSocket_, keys, moreData);
+}
+
+void TCPStore::recvWaitResponse_() {
   auto waitResponse = tcputil::recvValue<WaitResponseType>(storeSocket_);
   if (waitResponse != WaitResponseType::STOP_WAITING) {
     throw std::runtime_error("Stop_waiting response is expected");
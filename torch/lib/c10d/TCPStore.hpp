@@ -1,5 +1,7 @@
 #pragma once
 
+#include <poll.h>
+
 #include <memory>
 #include <thread>
 #include <unordered_map>
@@ -9,6 +11,12 @@
 
 namespace c10d {
 
+// The daemon serves all clients from a single thread. Sockets are
+// non-blocking, and every connection buffers its input until a complete
+// query has arrived, so that a slow client never stalls the others.
+// Queries of a connection are processed in order; a connection that waits
+// for keys is parked until they are set, so that clients can pipeline a
+// wait with the query that depends on it.
 class TCPStoreDaemon {
  public:
   explicit TCPStoreDaemon(int storeListenSocket);
@@ -17,16 +25,50 @@ class TCPStoreDaemon {
   void join();
 
  protected:
+  struct Connection {
+    explicit Connection(int socket) : socket(socket) {}
+
+    int socket;
+    // Index into pollFds_.
+    size_t index = 0;
+    // Received bytes that don't form a complete query yet.
+    std::vector<uint8_t> input;
+    // Response bytes that could not be sent without blocking.
+    std::vector<uint8_t> output;
+    size_t outputOffset = 0;
+    // Number of keys a WAIT query is blocked on, and the keys that the
+    // connection was registered for in waitingSockets_.
+    size_t keysAwaited = 0;
+    std::vector<std::string> awaitedKeys;
+  };
+
+  class QueryReader;
+
   void run();
   void stop();
 
-  void query(int socket);
-
-  void setHandler(int socket);
-  void addHandler(int socket);
-  void getHandler(int socket) const;
-  void checkHandler(int socket) const;
-  void waitHandler(int socket);
+  void acceptConnections();
+  void closeConnection(size_t index);
+
+  // Reads everything available on the socket. Returns false if the peer
+  // closed the connection.
+  bool receive(Connection& conn);
+  // Runs the complete queries in the input buffer. Responses are appended
+  // to the output buffer, and sent by flush.
+  void processQueries(Connection& conn);
+  void flush(Connection& conn);
+
+  // Each handler returns false, without any effect, if the query is not
+  // complete yet.
+  bool query(Connection& conn, QueryReader& reader);
+  bool setHandler(Connection& conn, QueryReader& reader);
+  bool multiSetHandler(Connection& conn, QueryReader& reader);
+  bool compareSetHandler(Connection& conn, QueryReader& reader);
+  bool addHandler(Connection& conn, QueryReader& reader);
+  bool getHandler(Connection& conn, QueryReader& reader);
+  bool multiGetHandler(Connection& conn, QueryReader& reader);
+  bool checkHandler(Connection& conn, QueryReader& reader);
+  bool waitHandler(Connection& conn, QueryReader& reader);
 
   bool checkKeys(const std::vector<std::string>& keys) const;
   void wakeupWaitingClients(const std::string& key);
@@ -35,10 +77,14 @@ class TCPStoreDaemon {
   std::unordered_map<std::string, std::vector<uint8_t>> tcpStore_;
   // From key -> the list of sockets waiting on it
   std::unordered_map<std::string, std::vector<int>> waitingSockets_;
-  // From socket -> number of keys awaited
-  std::unordered_map<int, size_t> keysAwaited_;
 
-  std::vector<int> sockets_;
+  // From socket -> connection state
+  std::unordered_map<int, Connection> connections_;
+  // The listening socket, the control pipe and one entry per connection.
+  std::vector<struct pollfd> pollFds_;
+  // Connections that stopped waiting and may have more queries buffered.
+  std::vector<int> resumed_;
+
   int storeListenSocket_;
   std::vector<int> controlPipeFd_{-1, -1};
 };
@@ -69,6 +115,20 @@ class TCPStore : public Store {
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout) override;
 
+  // The following take a single round trip to the server.
+
+  std::vector<uint8_t> compareSet(
+      const std::string& key,
+      const std::vector<uint8_t>& expectedValue,
+      const std::vector<uint8_t>& desiredValue) override;
+
+  std::vector<std::vector<uint8_t>> multiGet(
+      const std::vector<std::string>& keys) override;
+
+  void multiSet(
+      const std::vector<std::string>& keys,
+      const std::vector<std::vector<uint8_t>>& values) override;
+
   // Waits for all workers to join.
   void waitForWorkers();
 
@@ -81,6 +141,13 @@ class TCPStore : public Store {
   void waitHelper_(
       const std::vector<std::string>& keys,
       const std::chrono::milliseconds& timeout);
+  // Sends a WAIT query without waiting for its response, so that the
+  // query that depends on it can be sent right after.
+  void sendWait_(
+      const std::vector<std::string>& keys,
+      const std::chrono::milliseconds& timeout,
+      bool moreData);
+  void recvWaitResponse_();
 
   bool isServer_;
   int storeSocket_ = -1;
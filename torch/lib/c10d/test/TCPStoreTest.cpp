@@ -116,3 +116,88 @@ TEST(TCPStoreTest, testHelper) {
 TEST(TCPStoreTest, testHelperPrefix) {
   testHelper("testPrefix");
 }
+
+std::vector<uint8_t> toVec(const std::string& str) {
+  return std::vector<uint8_t>(str.begin(), str.end());
+}
+
+TEST(TCPStoreTest, testCompareSet) {
+  auto store = std::make_shared<c10d::TCPStore>(
+      "127.0.0.1", 0, 1, true, std::chrono::seconds(30), false);
+  c10d::PrefixStore prefixStore("testPrefix", store);
+
+  // A key that doesn't exist only matches an empty expected value.
+  EXPECT_EQ(prefixStore.compareSet("key", toVec("a"), toVec("b")), toVec(""));
+  EXPECT_EQ(prefixStore.compareSet("key", toVec(""), toVec("a")), toVec("a"));
+  EXPECT_EQ(prefixStore.compareSet("key", toVec("x"), toVec("b")), toVec("a"));
+  EXPECT_EQ(prefixStore.compareSet("key", toVec("a"), toVec("b")), toVec("b"));
+  c10d::test::check(prefixStore, "key", "b");
+}
+
+TEST(TCPStoreTest, testMultiGetMultiSet) {
+  auto serverStore = std::make_shared<c10d::TCPStore>(
+      "127.0.0.1", 0, 2, true, std::chrono::seconds(30), false);
+  auto clientStore = std::make_shared<c10d::TCPStore>(
+      "127.0.0.1",
+      serverStore->getPort(),
+      2,
+      false,
+      std::chrono::seconds(30),
+      false);
+
+  std::vector<std::string> keys;
+  std::vector<std::vector<uint8_t>> values;
+  for (auto i = 0; i < 100; i++) {
+    keys.push_back("key" + std::to_string(i));
+    values.push_back(toVec("value" + std::to_string(i)));
+  }
+
+  // multiGet waits for keys that are set later on.
+  std::vector<std::vector<uint8_t>> result;
+  std::thread getThread([&] { result = clientStore->multiGet(keys); });
+  serverStore->multiSet(keys, values);
+  getThread.join();
+  EXPECT_EQ(result, values);
+
+  EXPECT_TRUE(serverStore->multiGet({}).empty());
+  EXPECT_THROW(serverStore->multiSet(keys, {}), std::invalid_argument);
+}
+
+// Clients that wait for a key must not hold up the others, and must all be
+// woken up once the key is set.
+TEST(TCPStoreTest, testManyWaitingClients) {
+  const auto numClients = 128;
+  auto serverStore = std::make_shared<c10d::TCPStore>(
+      "127.0.0.1", 0, numClients + 1, true, std::chrono::seconds(30), false);
+
+  std::vector<std::unique_ptr<c10d::TCPStore>> clientStores;
+  for (auto i = 0; i < numClients; i++) {
+    clientStores.push_back(std::make_unique<c10d::TCPStore>(
+        "127.0.0.1",
+        serverStore->getPort(),
+        numClients + 1,
+        false,
+        std::chrono::seconds(30),
+        false));
+  }
+
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < numClients; i++) {
+    threads.push_back(std::thread([&clientStores, i] {
+      c10d::test::set(*clientStores[i], "rank" + std::to_string(i), "up");
+      c10d::test::check(*clientStores[i], "go", "now");
+      clientStores[i]->add("done", 1);
+    }));
+  }
+
+  std::vector<std::string> keys;
+  for (auto i = 0; i < numClients; i++) {
+    keys.push_back("rank" + std::to_string(i));
+  }
+  serverStore->wait(keys);
+  c10d::test::set(*serverStore, "go", "now");
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(serverStore->add("done", 0), numClients);
+}
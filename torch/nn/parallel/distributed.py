@@ -497,6 +497,34 @@ class DistributedDataParallel(Module):
         finally:
             self.require_backward_grad_sync = old_require_backward_grad_sync
 
+    def _register_builtin_comm_hook(self, comm_hook_type, **kwargs):
+        r"""
+        Replaces the allreduce of gradient buckets with a built-in
+        communication hook that compresses them. Must be called before the
+        first backward pass, and only works with a single device per process.
+
+        Arguments:
+            comm_hook_type (str): ``'fp16'`` allreduces buckets in half
+                precision. ``'topk'`` only communicates the largest ``ratio``
+                fraction of each bucket. ``'powersgd'`` communicates a
+                low-rank approximation of each bucket of the given ``rank``
+                (and optional ``seed``). ``'topk'`` and ``'powersgd'`` add
+                what was not communicated to the next iteration.
+
+        Example::
+
+            >>> ddp = torch.nn.DistributedDataParallel(model, pg)
+            >>> ddp._register_builtin_comm_hook('powersgd', rank=4)
+        """
+        if comm_hook_type == 'fp16':
+            self.reducer._register_fp16_compress_hook(self.process_group, **kwargs)
+        elif comm_hook_type == 'topk':
+            self.reducer._register_topk_compress_hook(self.process_group, **kwargs)
+        elif comm_hook_type == 'powersgd':
+            self.reducer._register_powersgd_hook(self.process_group, **kwargs)
+        else:
+            raise ValueError("Unknown communication hook: {}".format(comm_hook_type))
+
     def forward(self, *inputs, **kwargs):
         if self.require_forward_param_sync:
             self._sync_params()